@@ -186,6 +186,8 @@ public:
 	const float4& GetFrustumPlane(uint32_t i) const { return frustum.planes[i]; }
 	const float3& GetFrustumEdge (uint32_t i) const { return frustum.edges [i]; }
 	const float4& GetFrustumScales() const { return frustum.scales; }
+	// FRUSTUM_PLANE_* bits tested by InView
+	uint8_t GetInViewPlanesMask() const { return inViewPlanesMask; }
 
 	void LoadMatrices() const;
 	void LoadViewport() const;
@@ -81,6 +81,7 @@
 #include "Sim/Misc/InterceptHandler.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/SideParser.h"
+#include "Sim/Misc/SimStageGraph.h"
 #include "Sim/Misc/SmoothHeightMesh.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/Wind.h"
@@ -130,6 +131,7 @@
 #include "System/Sync/DumpState.h"
 #include "System/TimeProfiler.h"
 #include "System/LoadLock.h"
+#include "System/MemAccounting.h"
 
 #include "System/Misc/TracyDefs.h"
 
@@ -150,6 +152,7 @@ CONFIG(float, GuiOpacity).defaultValue(0.8f).minimumValue(0.0f).maximumValue(1.0
 CONFIG(std::string, InputTextGeo).defaultValue("");
 
 CONFIG(int, SmoothTimeOffset).defaultValue(0).headlessValue(0).description("Enables frametimeoffset smoothing, 0 = off (old version), -1 = forced 0.5,  1-20 smooth, recommended = 2-3");
+CONFIG_HANDLE(int, SmoothTimeOffset);
 
 CGame* game = nullptr;
 
@@ -219,6 +222,8 @@ CR_REG_METADATA(CGame, (
 	CR_IGNORED(curKeyCodeChain),
 	CR_IGNORED(curScanCodeChain),
 	CR_IGNORED(worldDrawer),
+	CR_IGNORED(simStageGraph),
+	CR_IGNORED(snapshotUpload),
 	CR_IGNORED(saveFileHandler),
 
 	// Post Load
@@ -291,6 +296,8 @@ CGame::CGame(const std::string& mapFileName, const std::string& modFileName, ILo
 
 	CResourceHandler::CreateInstance();
 	CCategoryHandler::CreateInstance();
+
+	InitSimStageGraph();
 }
 
 CGame::~CGame()
@@ -464,6 +471,9 @@ void CGame::Load(const std::string& mapFileName)
 				auto lock = CLoadLock::GetUniqueLock();
 				saveFileHandler->LoadGame();
 				Watchdog::ClearTimer(WDT_LOAD);
+
+				// the state was saved while playing; wait for NETMSG_STARTPLAYING like a new game
+				playing = false;
 			}
 			LoadLua(false, true);
 			Watchdog::ClearTimer(WDT_LOAD);
@@ -1319,7 +1329,7 @@ bool CGame::UpdateUnsynced(const spring_time currentTime)
 		globalRendering->lastTimeOffset = globalRendering->timeOffset;
 		globalRendering->timeOffset = (currentTime - lastFrameTime).toMilliSecsf() * globalRendering->weightedSpeedFactor;
 
-		int SmoothTimeOffset = configHandler->GetInt("SmoothTimeOffset");
+		int SmoothTimeOffset = cfgHandleSmoothTimeOffset;
 		float strictness = 0.9f; // This defines how strict we are going to be when trying to keep frame timings
 		if (SmoothTimeOffset > 0) {
 			strictness = 1.0f - (SmoothTimeOffset) * 0.025f;
@@ -1495,6 +1505,9 @@ bool CGame::Draw() {
 
 	SetDrawMode(gameNormalDraw);
 
+	// deliver render-events queued by unsynced updates since the last sim-frame
+	eventHandler.FlushBatchedEvents();
+
 	// Bind per-drawFrame UBO
 	UniformConstants::GetInstance().Bind();
 
@@ -1722,6 +1735,75 @@ void CGame::StartPlaying()
 		eventHandler.GameStart();
 }
 
+void CGame::InitSimStageGraph()
+{
+	using SSG = CSimStageGraph;
+
+	// SmoothHeightMesh only looks at the height bounds in its asserts
+	#ifdef NDEBUG
+	constexpr uint32_t smoothMeshReads = SSG::RES_HEIGHTMAP;
+	#else
+	constexpr uint32_t smoothMeshReads = SSG::RES_HEIGHTMAP | SSG::RES_HEIGHT_BOUNDS;
+	#endif
+
+	simStageGraph.Clear();
+
+	// stages that run synced Lua callins (directly or through unit scripts,
+	// weapons, commands, ...) can touch anything and are declared RES_ALL
+	simStageGraph.AddStage("Sim::GameFrame", SSG::RES_ALL, SSG::RES_ALL, true, [this]() {
+		SCOPED_TIMER("Sim::GameFrame");
+
+		// keep garbage-collection rate tied to sim-speed
+		// (fixed 30Hz gc is not enough while catching up)
+		if (luaGCControl == 0)
+			eventHandler.CollectGarbage(false);
+
+		eventHandler.GameFrame(gs->frameNum);
+	});
+	simStageGraph.AddStage("Sim::Helper", SSG::RES_ALL, SSG::RES_ALL, true, []() { helper->Update(); });
+	simStageGraph.AddStage("Sim::HeightBounds", SSG::RES_HEIGHTMAP, SSG::RES_HEIGHT_BOUNDS, false, []() { readMap->Update(); });
+	simStageGraph.AddStage("Sim::SmoothMesh", smoothMeshReads, SSG::RES_SMOOTH_MESH, false, []() { smoothGround.UpdateSmoothMesh(); });
+	simStageGraph.AddStage("Sim::MapDamage", SSG::RES_ALL, SSG::RES_ALL, true, []() { mapDamage->Update(); });
+	simStageGraph.AddStage("Sim::Units", SSG::RES_ALL, SSG::RES_ALL, true, []() {
+		MemAccounting::ScopedTag memTag("Units");
+		unitHandler.Update();
+	});
+	simStageGraph.AddStage("Sim::Paths", SSG::RES_HEIGHTMAP | SSG::RES_UNITS | SSG::RES_FEATURES, SSG::RES_PATHS, false, []() {
+		MemAccounting::ScopedTag memTag("Paths");
+		pathManager->Update();
+	});
+	simStageGraph.AddStage("Sim::Projectiles", SSG::RES_ALL, SSG::RES_ALL, true, []() {
+		MemAccounting::ScopedTag memTag("Projectiles");
+		projectileHandler.Update();
+	});
+	simStageGraph.AddStage("Sim::Features", SSG::RES_ALL, SSG::RES_ALL, true, []() { featureHandler.Update(); });
+	simStageGraph.AddStage("Sim::Script", SSG::RES_ALL, SSG::RES_ALL, true, []() {
+		/* The default GAME_SPEED is 30, which doesn't divide 1000 well,
+		 * so scripts will perceive 990ms per second. But this is fine,
+		 * since doing "29th February" style of extra counting would be
+		 * disruptive to sleeps that assume a constant tick length while
+		 * not being otherwise perceptible since most animations don't
+		 * run that long. */
+		static constexpr int tickMs = 1000 / GAME_SPEED;
+
+		SCOPED_TIMER("Sim::Script");
+		unitScriptEngine->Tick(tickMs);
+	});
+	simStageGraph.AddStage("Sim::EnvResources", SSG::RES_ALL, SSG::RES_ALL, true, []() { envResHandler.Update(); });
+	simStageGraph.AddStage("Sim::Los", SSG::RES_UNITS | SSG::RES_HEIGHTMAP, SSG::RES_LOS, false, []() { losHandler->Update(); });
+	// dead ghosts have to be updated in sim, after los,
+	// to make sure they represent the current knowledge correctly.
+	// should probably be split from drawer
+	simStageGraph.AddStage("Sim::Ghosts", SSG::RES_LOS, SSG::RES_GHOSTS, true, []() { CUnitDrawer::UpdateGhostedBuildings(); });
+	simStageGraph.AddStage("Sim::Intercept", SSG::RES_ALL, SSG::RES_ALL, true, []() { interceptHandler.Update(false); });
+	simStageGraph.AddStage("Sim::Teams", SSG::RES_ALL, SSG::RES_ALL, true, []() { teamHandler.GameFrame(gs->frameNum); });
+	simStageGraph.AddStage("Sim::Players", SSG::RES_ALL, SSG::RES_ALL, true, []() { playerHandler.GameFrame(gs->frameNum); });
+	simStageGraph.AddStage("Sim::GameFramePost", SSG::RES_ALL, SSG::RES_ALL, true, []() {
+		eventHandler.FlushBatchedEvents();
+		eventHandler.GameFramePost(gs->frameNum);
+	});
+}
+
 static const char* const tracingSimFrameName = "SimFrame";
 
 void CGame::SimFrame() {
@@ -1788,49 +1870,11 @@ void CGame::SimFrame() {
 	// everything from here is simulation
 	{
 		SCOPED_SPECIAL_TIMER("Sim");
+		ConfigHandler::SetReadAuditScope(true);
 
-		{
-			SCOPED_TIMER("Sim::GameFrame");
-
-			// keep garbage-collection rate tied to sim-speed
-			// (fixed 30Hz gc is not enough while catching up)
-			if (luaGCControl == 0)
-				eventHandler.CollectGarbage(false);
-
-			eventHandler.GameFrame(gs->frameNum);
-		}
+		simStageGraph.Run();
 
-		helper->Update();
-		readMap->Update();
-		smoothGround.UpdateSmoothMesh();
-		mapDamage->Update();
-		unitHandler.Update();
-		pathManager->Update();
-		projectileHandler.Update();
-		featureHandler.Update();
-		{
-			/* The default GAME_SPEED is 30, which doesn't divide 1000 well,
-			 * so scripts will perceive 990ms per second. But this is fine,
-			 * since doing "29th February" style of extra counting would be
-			 * disruptive to sleeps that assume a constant tick length while
-			 * not being otherwise perceptible since most animations don't
-			 * run that long. */
-			static constexpr int tickMs = 1000 / GAME_SPEED;
-
-			SCOPED_TIMER("Sim::Script");
-			unitScriptEngine->Tick(tickMs);
-		}
-		envResHandler.Update();
-		losHandler->Update();
-		// dead ghosts have to be updated in sim, after los,
-		// to make sure they represent the current knowledge correctly.
-		// should probably be split from drawer
-		CUnitDrawer::UpdateGhostedBuildings();
-		interceptHandler.Update(false);
-
-		teamHandler.GameFrame(gs->frameNum);
-		playerHandler.GameFrame(gs->frameNum);
-		eventHandler.GameFramePost(gs->frameNum);
+		ConfigHandler::SetReadAuditScope(false);
 	}
 
 	lastSimFrameTime = spring_gettime();
@@ -1896,6 +1940,7 @@ void CGame::GameEnd(const std::vector<unsigned char>& winningAllyTeams, bool tim
 	CEndGameBox::Create(winningAllyTeams);
 #ifdef    HEADLESS
 	CTimeProfiler::GetInstance().PrintProfilingInfo();
+	MemAccounting::LogStats();
 #endif // HEADLESS
 
 	CDemoRecorder* record = clientNet->GetDemoRecorder();
@@ -4,6 +4,8 @@
 #define _GAME_H
 
 #include <atomic>
+#include <future>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -12,6 +14,7 @@
 #include "Game/UI/KeySet.h"
 #include "Game/Action.h"
 #include "Rendering/WorldDrawer.h"
+#include "Sim/Misc/SimStageGraph.h"
 #include "System/UnorderedMap.hpp"
 #include "System/creg/creg_cond.h"
 #include "System/Misc/SpringTime.h"
@@ -141,9 +144,13 @@ private:
 	void ClientReadNet();
 	void UpdateNumQueuedSimFrames();
 	void UpdateNetMessageProcessingTimeLeft();
+	void InitSimStageGraph();
 	void SimFrame();
 	void StartPlaying();
 
+	void SaveSnapshot(int32_t frameNum);
+	void SendSnapshotData();
+
 public:
 	GameDrawMode gameDrawMode = gameNotDrawing;
 
@@ -221,6 +228,20 @@ private:
 
 	CWorldDrawer worldDrawer;
 
+	CSimStageGraph simStageGraph;
+
+	/// savestate the server asked for via NETMSG_SNAPSHOT_REQUEST, uploaded in chunks
+	struct SnapshotUpload {
+		// compresses the serialized state off the main thread
+		std::shared_ptr< std::future< std::vector<uint8_t> > > job;
+		std::vector<uint8_t> data;
+
+		int32_t frameNum = -1;
+		uint32_t syncChecksum = 0;
+		uint32_t dataChecksum = 0;
+		uint32_t dataOffset = 0;
+	} snapshotUpload;
+
 	/// <playerID, <packetCode, total bytes> >
 	spring::unordered_map<int, PlayerTrafficInfo> playerTraffic;
 
@@ -50,6 +50,20 @@ void CPlayerHandler::LoadFromSetup(const CGameSetup* setup)
 	}
 }
 
+void CPlayerHandler::PostLoad()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// AddPlayer relies on this to never reallocate
+	players.reserve(MAX_PLAYERS);
+
+	for (CPlayer& player: players) {
+		player.fpsController.SetControllerPlayer(&player);
+	}
+
+	if (selectedUnitsHandler.netSelected.size() < players.size())
+		selectedUnitsHandler.netSelected.resize(players.size());
+}
+
 
 int CPlayerHandler::Player(const std::string& name) const
 {
@@ -19,6 +19,8 @@ public:
 
 	void ResetState();
 	void LoadFromSetup(const CGameSetup* setup);
+	/// restores what creg does not serialize after the players were loaded from a savestate
+	void PostLoad();
 
 	/**
 	 * @brief Player
@@ -40,6 +40,7 @@
 #include "System/FileSystem/ArchiveScanner.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/VFSHandler.h"
+#include "System/LoadSave/CregLoadSaveHandler.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/LoadSave/DemoReader.h"
 #include "System/LoadSave/LoadSaveHandler.h"
@@ -403,6 +404,14 @@ void CPreGame::UpdateClientNet()
 				GameDataReceived(packet);
 			} break;
 
+			case NETMSG_SNAPSHOT_DATA: {
+				// when rejoining a running game the server may send a recent
+				// savestate in between NETMSG_GAMEDATA and NETMSG_SETPLAYERNUM
+				// so only the frames since then have to be simulated; if it is
+				// unusable the server sends the whole game instead
+				SnapshotDataReceived(packet);
+			} break;
+
 			case NETMSG_SETPLAYERNUM: {
 				// this is sent after NETMSG_GAMEDATA, to let us know which
 				// player number we have (server assigns them based on order
@@ -515,6 +524,71 @@ void CPreGame::ReadDataFromDemo(const std::string& demoName)
 	assert(gameServer != nullptr);
 }
 
+void CPreGame::SnapshotDataReceived(std::shared_ptr<const netcode::RawPacket> packet)
+{
+	if (snapshotAnswered)
+		return;
+
+	const bool firstChunk = snapshotData.IsEmpty();
+
+	try {
+		if (firstChunk)
+			snapshotData.ExpectAny();
+
+		// the server sends all chunks in order over one reliable link
+		if (snapshotData.AddChunk(packet) != CSnapshotData::CHUNK_ADDED) {
+			LOG_L(L_WARNING, "[PreGame::%s] snapshot data out of order or larger than announced", __func__);
+			SnapshotAnswer(false);
+			return;
+		}
+	} catch (const netcode::UnpackPacketException& ex) {
+		LOG_L(L_WARNING, "[PreGame::%s] invalid snapshot received: %s", __func__, ex.what());
+		SnapshotAnswer(false);
+		return;
+	}
+
+	if (firstChunk)
+		LOG("[PreGame::%s] receiving snapshot of frame %d (%u bytes)", __func__, snapshotData.frameNum, snapshotData.dataSize);
+
+	if (snapshotData.IsComplete())
+		SnapshotAnswer(LoadSnapshot());
+}
+
+bool CPreGame::LoadSnapshot()
+{
+	if (!snapshotData.CheckData()) {
+		LOG_L(L_WARNING, "[PreGame::%s] snapshot of frame %d does not match its data checksum", __func__, snapshotData.frameNum);
+		return false;
+	}
+
+	CCregLoadSaveHandler* snapshotHandler = new CCregLoadSaveHandler();
+
+	// no LoadBadSaves override, the full game is always there to fall back on
+	if (!snapshotHandler->LoadSnapshotStartInfo(snapshotData.data, snapshotData.syncChecksum)) {
+		LOG_L(L_WARNING, "[PreGame::%s] snapshot of frame %d is not compatible with this engine", __func__, snapshotData.frameNum);
+		delete snapshotHandler;
+		return false;
+	}
+
+	// a demo recorded from here on would be missing everything the snapshot holds
+	clientNet->ResetDemoRecorder();
+
+	saveFileHandler = snapshotHandler;
+	return true;
+}
+
+void CPreGame::SnapshotAnswer(bool loaded)
+{
+	if (!loaded)
+		LOG("[PreGame::%s] requesting the full game instead of the snapshot", __func__);
+
+	clientNet->Send(CBaseNetProtocol::Get().SendSnapshotLoaded(snapshotData.frameNum, loaded));
+
+	snapshotData = {};
+	snapshotAnswered = true;
+}
+
+
 void CPreGame::GameDataReceived(std::shared_ptr<const netcode::RawPacket> packet)
 {
 	SCOPED_ONCE_TIMER("PreGame::GameDataReceived");
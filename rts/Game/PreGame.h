@@ -3,10 +3,13 @@
 #ifndef PREGAME_H
 #define PREGAME_H
 
+#include <cstdint>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "GameController.h"
+#include "Net/Protocol/SnapshotData.h"
 #include "System/Misc/SpringTime.h"
 
 class ILoadSaveHandler;
@@ -63,6 +66,11 @@ private:
 	void UpdateClientNet();
 
 	void GameDataReceived(std::shared_ptr<const netcode::RawPacket> packet);
+	void SnapshotDataReceived(std::shared_ptr<const netcode::RawPacket> packet);
+	/// checks the complete snapshot, false if this client can not load it
+	bool LoadSnapshot();
+	/// tells the server whether the snapshot loaded, it withholds our player number until then
+	void SnapshotAnswer(bool loaded);
 
 private:
 	/**
@@ -76,6 +84,10 @@ private:
 	std::string modFileName;
 	ILoadSaveHandler* saveFileHandler;
 
+	/// savestate of a running game the server sends to rejoining clients
+	CSnapshotData snapshotData;
+	bool snapshotAnswered = false;
+
 	spring_time connectTimer;
 
 	bool wantDemo;
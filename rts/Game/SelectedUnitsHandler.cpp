@@ -35,6 +35,7 @@
 #include "System/StringUtil.h"
 #include "Net/Protocol/NetProtocol.h"
 #include "System/Net/PackPacket.h"
+#include "System/Net/VarIntCoding.h"
 #include "System/FileSystem/SimpleParser.h"
 #include "System/Input/KeyInput.h"
 #include "System/Sound/ISound.h"
@@ -1076,6 +1077,13 @@ void CSelectedUnitsHandler::SendCommandsToUnits(const std::vector<int>& unitIDs,
 			refCmdSize = 0xFFFF;
 	}
 
+	// pairwise orders differing only in their parameters, e.g. one move
+	// per unit of a widget-made formation, go into a delta-coded batch
+	if (pairwise && refCmdID != 0 && refCmdOpts != 0xFF && refCmdSize <= 0xFF) {
+		SendUnitCommands(unitIDs, commands);
+		return;
+	}
+
 	unsigned int optBytesPerCmd = 0;
 	unsigned int totalPacketLen = 0;
 
@@ -1145,3 +1153,33 @@ void CSelectedUnitsHandler::SendCommandsToUnits(const std::vector<int>& unitIDs,
 	clientNet->Send(std::shared_ptr<netcode::RawPacket>(packet));
 }
 
+void CSelectedUnitsHandler::SendUnitCommands(const std::vector<int>& unitIDs, const std::vector<Command>& commands)
+{
+	const Command& refCmd = commands[0];
+	const size_t numOrders = std::min(unitIDs.size(), commands.size());
+
+	// snap positions to the grid NETMSG_UNITCOMMANDS can store as small deltas
+	// (1/16 elmo), other parameters are sent as they are
+	const bool snapParams = (refCmd.GetID() == CMD_MOVE || refCmd.GetID() == CMD_PATROL || refCmd.GetID() == CMD_FIGHT);
+
+	std::vector<int16_t> orderUnitIDs;
+	std::vector<float> orderParams;
+
+	orderUnitIDs.reserve(numOrders);
+	orderParams.reserve(numOrders * refCmd.GetNumParams());
+
+	for (size_t i = 0; i < numOrders; i++) {
+		orderUnitIDs.push_back(unitIDs[i]);
+
+		for (unsigned int j = 0, n = commands[i].GetNumParams(); j < n; j++) {
+			orderParams.push_back(snapParams? netcode::QuantizeDeltaFloat(commands[i].GetParam(j)): commands[i].GetParam(j));
+		}
+	}
+
+	try {
+		clientNet->Send(CBaseNetProtocol::Get().SendUnitCommands(gu->myPlayerNum, refCmd.GetID(), refCmd.GetOpts(), refCmd.GetNumParams(), orderUnitIDs, orderParams));
+	} catch (const netcode::PackPacketException& ex) {
+		LOG_L(L_WARNING, "[%s] discarded oversized NETMSG_UNITCOMMANDS packet (%s)", __func__, ex.what());
+	}
+}
+
@@ -88,6 +88,9 @@ public:
 	spring::unordered_set<int> selectedUnits;
 	std::vector< std::vector<int> > netSelected;
 
+private:
+	void SendUnitCommands(const std::vector<int>& unitIDs, const std::vector<Command>& commands);
+
 private:
 	// buffer for SendCommand unordered_set->vector conversion
 	std::vector<int16_t> selectedUnitIDs;
@@ -221,7 +221,7 @@ static void DrawThreadBarcode(TypedRenderBuffer<VA_TYPE_C   >& rb)
 	}
 	{
 		// need to lock; DrawTimeSlice pop_front()'s old entries from
-		// threadProf while ~ScopedMtTimer can modify it concurrently
+		// threadProf while MergeThreadRecords can append concurrently
 		profiler.ToggleLock(true);
 
 		// bars for each pool-thread profile
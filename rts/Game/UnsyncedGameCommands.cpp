@@ -100,6 +100,7 @@
 #include "System/GlobalConfig.h"
 #include "System/SafeUtil.h"
 #include "System/TimeProfiler.h"
+#include "System/MemAccounting.h"
 #include "System/Log/ILog.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/SimpleParser.h"
@@ -3655,7 +3656,7 @@ class DebugInfoActionExecutor : public IUnsyncedActionExecutor {
 public:
 	DebugInfoActionExecutor() : IUnsyncedActionExecutor(
 		"DebugInfo",
-		"Print debug info to the chat/log-file about either sound, profiling, or command-descriptions"
+		"Print debug info to the chat/log-file about either sound, profiling, memory, event dispatch, or command-descriptions, or export profiler flame-graph data"
 	) {
 	}
 
@@ -3669,11 +3670,26 @@ public:
 			case hashString("profiling"): {
 				CTimeProfiler::GetInstance().PrintProfilingInfo();
 			} break;
+			case hashString("memory"): {
+				MemAccounting::LogStats();
+			} break;
+			case hashString("events"): {
+				eventHandler.LogDispatchStats();
+			} break;
+			case hashString("flamegraph"): {
+				const char* fileName = "profiler_flamegraph.json";
+
+				if (CTimeProfiler::GetInstance().WriteFlameGraphJSON(fileName)) {
+					LOG("[DbgInfoAction::%s] wrote profiler flame-graph to \"%s\"", __func__, fileName);
+				} else {
+					LOG_L(L_WARNING, "[DbgInfoAction::%s] could not write profiler flame-graph to \"%s\"", __func__, fileName);
+				}
+			} break;
 			case hashString("cmddescrs"): {
 				commandDescriptionCache.Dump(true);
 			} break;
 			default: {
-				LOG_L(L_WARNING, "[DbgInfoAction::%s] unknown argument \"%s\" (use \"sound\", \"profiling\", or \"cmddescrs\")", __func__, args.c_str());
+				LOG_L(L_WARNING, "[DbgInfoAction::%s] unknown argument \"%s\" (use \"sound\", \"profiling\", \"memory\", \"events\", \"flamegraph\", or \"cmddescrs\")", __func__, args.c_str());
 			} break;
 		}
 
@@ -0,0 +1,489 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+
+#include "LuaCommandLists.h"
+
+#include "lib/sol2/sol.hpp"
+
+#include "LuaInclude.h"
+
+#include "LuaHandle.h"
+#include "LuaOpenGL.h"
+#include "LuaShaders.h"
+#include "LuaUtils.h"
+#include "LuaVAOImpl.h"
+#include "System/Matrix44f.h"
+#include "System/Log/ILog.h"
+
+
+/******************************************************************************
+ * Command lists
+ *
+ * Recorded replacement for display lists that also works with core profiles.
+ * While the function given to gl.CreateCommandList or gl.RecordCommandList
+ * runs, these calls are recorded instead of executed:
+ * gl.Blending, gl.BlendFunc, gl.DepthTest, gl.DepthMask, gl.Culling,
+ * gl.ColorMask, gl.Scissor, gl.LineWidth, gl.Texture, gl.UseShader,
+ * gl.Uniform, gl.UniformInt, gl.UniformMatrix, VAO:DrawArrays,
+ * VAO:DrawElements and gl.CallCommandList. Any other gl.* call that draws
+ * or changes GL state raises an error while recording.
+ *
+ * Textures, shader ids, named matrices and uniforms given by name are
+ * resolved on every replay, the latter in the shader of the last recorded
+ * gl.UseShader. Nested gl.CallCommandList calls are resolved when replaying
+ * too, so re-recording a child list updates every list that calls it.
+ *
+ * @module CommandLists
+ * @see rts/Lua/LuaCommandLists.cpp
+******************************************************************************/
+
+static constexpr uint8_t UNIFORM_FLAG_NAMED = 1;
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+bool LuaCommandLists::PushEntries(lua_State* L)
+{
+	REGISTER_LUA_CFUNC(CreateCommandList);
+	REGISTER_LUA_CFUNC(RecordCommandList);
+	REGISTER_LUA_CFUNC(CallCommandList);
+	REGISTER_LUA_CFUNC(DeleteCommandList);
+	REGISTER_LUA_CFUNC(GetCommandListStats);
+
+	return true;
+}
+
+
+LuaCommandLists::CommandList* LuaCommandLists::GetRecording(lua_State* L)
+{
+	LuaCommandLists& cmdLists = CLuaHandle::GetActiveCommandLists(L);
+
+	if (cmdLists.recordingIdx == 0)
+		return nullptr;
+
+	return &cmdLists.lists[cmdLists.recordingIdx];
+}
+
+
+void LuaCommandLists::CheckNotRecording(lua_State* L, const char* caller)
+{
+	if (GetRecording(L) == nullptr)
+		return;
+
+	luaL_error(L, "%s(): cannot be recorded into a command list", caller);
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+void LuaCommandLists::CommandList::LineWidth(GLfloat width)
+{
+	commands.push_back({CMD_LINE_WIDTH, 1, 0, {GLint(values.size())}});
+	values.push_back(width);
+}
+
+
+void LuaCommandLists::CommandList::BindTexture(const LuaMatTexture& tex)
+{
+	// named and Lua textures can be recreated, keep the reference
+	commands.push_back({CMD_BIND_TEXTURE, 0, 0, {GLint(textures.size())}});
+	textures.push_back(tex);
+}
+
+
+void LuaCommandLists::CommandList::UseShader(uint32_t progIdx)
+{
+	commands.push_back({CMD_USE_SHADER, 0, 0, {GLint(progIdx)}});
+	program = progIdx;
+}
+
+
+void LuaCommandLists::CommandList::Uniform(GLint location, const char* name, const GLfloat* v, int count)
+{
+	PushUniform({CMD_UNIFORM_FLOAT, uint8_t(count), 0, {location, GLint(values.size())}}, name);
+	values.insert(values.end(), v, v + count);
+}
+
+
+void LuaCommandLists::CommandList::UniformInt(GLint location, const char* name, const GLint* v, int count)
+{
+	Command cmd = {CMD_UNIFORM_INT, uint8_t(count), 0, {location}};
+	std::copy(v, v + count, &cmd.args[1]);
+	PushUniform(cmd, name);
+}
+
+
+void LuaCommandLists::CommandList::UniformMatrix(GLint location, const char* name, const GLfloat* m, int count)
+{
+	PushUniform({CMD_UNIFORM_MATRIX, uint8_t(count), 0, {location, GLint(values.size())}}, name);
+	values.insert(values.end(), m, m + count);
+}
+
+
+void LuaCommandLists::CommandList::UniformMatrix(GLint location, const char* name, LuaMatrixType matType)
+{
+	PushUniform({CMD_UNIFORM_NAMED_MATRIX, 0, 0, {location, matType}}, name);
+}
+
+
+void LuaCommandLists::CommandList::PushUniform(Command cmd, const char* name)
+{
+	// args[0] holds the location, at most five values follow it
+	if (name != nullptr) {
+		cmd.flags |= UNIFORM_FLAG_NAMED;
+		cmd.args[0] = GLint(uniformNames.size());
+		cmd.args[6] = GLint(program);
+		uniformNames.emplace_back(name);
+	}
+
+	commands.push_back(cmd);
+}
+
+
+void LuaCommandLists::CommandList::DrawArrays(std::weak_ptr<LuaVAOImpl> vao, GLenum mode, const GLint (&args)[4])
+{
+	commands.push_back({CMD_DRAW_ARRAYS, 0, 0, {GLint(vaos.size()), GLint(mode), args[0], args[1], args[2], args[3]}});
+	vaos.push_back(std::move(vao));
+}
+
+
+void LuaCommandLists::CommandList::DrawElements(std::weak_ptr<LuaVAOImpl> vao, GLenum mode, const GLint (&args)[5])
+{
+	commands.push_back({CMD_DRAW_ELEMENTS, 0, 0, {GLint(vaos.size()), GLint(mode), args[0], args[1], args[2], args[3], args[4]}});
+	vaos.push_back(std::move(vao));
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+uint32_t LuaCommandLists::NewList()
+{
+	uint32_t listIdx = lists.size();
+
+	if (!unused.empty()) {
+		listIdx = unused.back();
+		unused.pop_back();
+	} else {
+		lists.emplace_back();
+	}
+
+	lists[listIdx] = {};
+	lists[listIdx].active = true;
+	return listIdx;
+}
+
+
+void LuaCommandLists::FreeList(uint32_t listIdx)
+{
+	if (GetList(listIdx) == nullptr)
+		return;
+
+	lists[listIdx] = {};
+	unused.push_back(listIdx);
+}
+
+
+bool LuaCommandLists::Record(lua_State* L, uint32_t listIdx, int funcIndex)
+{
+	lists[listIdx].Clear();
+
+	// the list function runs with drawing enabled like gl.CreateList's
+	const bool origDrawingEnabled = LuaOpenGL::IsDrawingEnabled(L);
+	LuaOpenGL::SetDrawingEnabled(L, true);
+
+	recordingIdx = listIdx;
+	const int error = lua_pcall(L, lua_gettop(L) - funcIndex, 0, 0);
+	recordingIdx = 0;
+
+	LuaOpenGL::SetDrawingEnabled(L, origDrawingEnabled);
+
+	if (error != 0) {
+		LOG_L(L_ERROR, "[LuaCommandLists::%s] error(%i) = %s", __func__, error, lua_tostring(L, -1));
+		lua_pop(L, 1);
+		lists[listIdx].Clear();
+		return false;
+	}
+
+	lists[listIdx].commands.shrink_to_fit();
+	lists[listIdx].values.shrink_to_fit();
+	return true;
+}
+
+
+void LuaCommandLists::Replay(lua_State* L, LuaShaders& shaders, const CommandList& list, int depth)
+{
+	const auto OptArg = [](GLint arg) { return (arg == CommandList::NO_ARG)? sol::optional<int>(): sol::optional<int>(arg); };
+	const auto UniformLocation = [&](const Command& cmd) {
+		if ((cmd.flags & UNIFORM_FLAG_NAMED) == 0)
+			return cmd.args[0];
+
+		// the shader may have been recreated since recording
+		return shaders.GetProgramUniformLocation(cmd.args[6], list.uniformNames[cmd.args[0]]);
+	};
+
+	for (const Command& cmd: list.commands) {
+		const GLint* args = &cmd.args[0];
+
+		switch (cmd.type) {
+			case CMD_ENABLE: {
+				glEnable(args[0]);
+			} break;
+			case CMD_DISABLE: {
+				glDisable(args[0]);
+			} break;
+			case CMD_BLEND_FUNC: {
+				glBlendFunc(args[0], args[1]);
+			} break;
+			case CMD_DEPTH_FUNC: {
+				glDepthFunc(args[0]);
+			} break;
+			case CMD_DEPTH_MASK: {
+				glDepthMask(args[0]);
+			} break;
+			case CMD_CULL_FACE: {
+				glCullFace(args[0]);
+			} break;
+			case CMD_COLOR_MASK: {
+				glColorMask(args[0], args[1], args[2], args[3]);
+			} break;
+			case CMD_SCISSOR: {
+				glScissor(args[0], args[1], args[2], args[3]);
+			} break;
+			case CMD_LINE_WIDTH: {
+				glLineWidth(list.values[args[0]]);
+			} break;
+			case CMD_ACTIVE_TEXTURE: {
+				glActiveTexture(args[0]);
+			} break;
+			case CMD_BIND_TEXTURE: {
+				list.textures[args[0]].Bind();
+			} break;
+
+			case CMD_USE_SHADER: {
+				shaders.UseProgram(args[0]);
+			} break;
+			case CMD_UNIFORM_FLOAT: {
+				const GLint location = UniformLocation(cmd);
+				const GLfloat* v = &list.values[args[1]];
+
+				switch (cmd.numValues) {
+					case 1: { glUniform1fv(location, 1, v); } break;
+					case 2: { glUniform2fv(location, 1, v); } break;
+					case 3: { glUniform3fv(location, 1, v); } break;
+					case 4: { glUniform4fv(location, 1, v); } break;
+					default: {} break;
+				}
+			} break;
+			case CMD_UNIFORM_INT: {
+				const GLint location = UniformLocation(cmd);
+
+				switch (cmd.numValues) {
+					case 1: { glUniform1iv(location, 1, &args[1]); } break;
+					case 2: { glUniform2iv(location, 1, &args[1]); } break;
+					case 3: { glUniform3iv(location, 1, &args[1]); } break;
+					case 4: { glUniform4iv(location, 1, &args[1]); } break;
+					default: {} break;
+				}
+			} break;
+			case CMD_UNIFORM_MATRIX: {
+				const GLint location = UniformLocation(cmd);
+				const GLfloat* m = &list.values[args[1]];
+
+				switch (cmd.numValues) {
+					case (2 * 2): { glUniformMatrix2fv(location, 1, GL_FALSE, m); } break;
+					case (3 * 3): { glUniformMatrix3fv(location, 1, GL_FALSE, m); } break;
+					case (4 * 4): { glUniformMatrix4fv(location, 1, GL_FALSE, m); } break;
+					default: {} break;
+				}
+			} break;
+			case CMD_UNIFORM_NAMED_MATRIX: {
+				const GLint location = UniformLocation(cmd);
+
+				// camera matrices change between passes, fetch the current one
+				const CMatrix44f* mat = LuaOpenGLUtils::GetNamedMatrix(LuaMatrixType(args[1]));
+
+				if (mat != nullptr)
+					glUniformMatrix4fv(location, 1, GL_FALSE, *mat);
+			} break;
+
+			case CMD_DRAW_ARRAYS: {
+				const std::shared_ptr<LuaVAOImpl> vao = list.vaos[args[0]].lock();
+
+				if (vao == nullptr)
+					break;
+
+				vao->DrawArrays(args[1], OptArg(args[2]), OptArg(args[3]), OptArg(args[4]), OptArg(args[5]), L);
+			} break;
+			case CMD_DRAW_ELEMENTS: {
+				const std::shared_ptr<LuaVAOImpl> vao = list.vaos[args[0]].lock();
+
+				if (vao == nullptr)
+					break;
+
+				vao->DrawElements(args[1], OptArg(args[2]), OptArg(args[3]), OptArg(args[4]), OptArg(args[5]), OptArg(args[6]), L);
+			} break;
+			case CMD_CALL_LIST: {
+				const CommandList* subList = GetList(args[0]);
+
+				// also stops lists that (indirectly) call themselves
+				if (subList == nullptr || depth >= MAX_CALL_DEPTH)
+					break;
+
+				Replay(L, shaders, *subList, depth + 1);
+			} break;
+		}
+	}
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+/*** Creates a command list, recording the calls made by func if given.
+ *
+ * @function gl.CreateCommandList
+ * @func[opt] func
+ * @tparam[opt] any arg1
+ * @tparam[opt] any arg2
+ * @tparam[opt] any argn
+ * @treturn number listID, 0 if func raised an error
+ */
+int LuaCommandLists::CreateCommandList(lua_State* L)
+{
+	LuaCommandLists& cmdLists = CLuaHandle::GetActiveCommandLists(L);
+
+	if (cmdLists.recordingIdx != 0)
+		luaL_error(L, "gl.CreateCommandList() cannot be called while recording");
+
+	if (!lua_isnoneornil(L, 1))
+		luaL_checktype(L, 1, LUA_TFUNCTION);
+
+	const uint32_t listIdx = cmdLists.NewList();
+
+	if (lua_isfunction(L, 1) && !cmdLists.Record(L, listIdx, 1)) {
+		cmdLists.FreeList(listIdx);
+		lua_pushnumber(L, 0);
+		return 1;
+	}
+
+	lua_pushnumber(L, listIdx);
+	return 1;
+}
+
+
+/*** Replaces the contents of a command list with the calls made by func.
+ *
+ * Lists calling this one pick up the new contents without being re-recorded.
+ *
+ * @function gl.RecordCommandList
+ * @number listID
+ * @func func
+ * @tparam[opt] any arg1
+ * @tparam[opt] any arg2
+ * @tparam[opt] any argn
+ * @treturn bool success
+ */
+int LuaCommandLists::RecordCommandList(lua_State* L)
+{
+	LuaCommandLists& cmdLists = CLuaHandle::GetActiveCommandLists(L);
+
+	if (cmdLists.recordingIdx != 0)
+		luaL_error(L, "gl.RecordCommandList() cannot be called while recording");
+
+	const uint32_t listIdx = luaL_checkint(L, 1);
+	luaL_checktype(L, 2, LUA_TFUNCTION);
+
+	if (cmdLists.GetList(listIdx) == nullptr) {
+		lua_pushboolean(L, false);
+		return 1;
+	}
+
+	lua_pushboolean(L, cmdLists.Record(L, listIdx, 2));
+	return 1;
+}
+
+
+/*** Replays a command list, or records a call to it while recording.
+ *
+ * @function gl.CallCommandList
+ * @number listID
+ * @treturn nil
+ */
+int LuaCommandLists::CallCommandList(lua_State* L)
+{
+	LuaCommandLists& cmdLists = CLuaHandle::GetActiveCommandLists(L);
+
+	const uint32_t listIdx = luaL_checkint(L, 1);
+
+	if (cmdLists.recordingIdx != 0) {
+		cmdLists.lists[cmdLists.recordingIdx].CallList(listIdx);
+		return 0;
+	}
+
+	if (!LuaOpenGL::IsDrawingEnabled(L))
+		luaL_error(L, "gl.CallCommandList(): OpenGL calls can only be used in Draw() call-ins");
+
+	CommandList* list = cmdLists.GetList(listIdx);
+
+	if (list == nullptr)
+		return 0;
+
+	const spring_time startTime = spring_gettime();
+
+	cmdLists.Replay(L, CLuaHandle::GetActiveShaders(L), *list, 0);
+
+	// list is still valid, nothing can be created or freed during replay
+	list->numReplays += 1;
+	list->replayTime += (spring_gettime() - startTime);
+	return 0;
+}
+
+
+/***
+ *
+ * @function gl.DeleteCommandList
+ * @number listID
+ * @treturn nil
+ */
+int LuaCommandLists::DeleteCommandList(lua_State* L)
+{
+	LuaCommandLists& cmdLists = CLuaHandle::GetActiveCommandLists(L);
+
+	if (lua_isnil(L, 1))
+		return 0;
+
+	const uint32_t listIdx = luaL_checkint(L, 1);
+
+	if (listIdx != 0 && listIdx == cmdLists.recordingIdx)
+		luaL_error(L, "gl.DeleteCommandList() cannot delete the list being recorded");
+
+	cmdLists.FreeList(listIdx);
+	return 0;
+}
+
+
+/*** Recorded size and accumulated replay cost of a command list, for profiling.
+ *
+ * @function gl.GetCommandListStats
+ * @number listID
+ * @treturn nil|number numCommands
+ * @treturn number numReplays top-level gl.CallCommandList calls
+ * @treturn number replayTime milliseconds spent in them, including nested lists
+ */
+int LuaCommandLists::GetCommandListStats(lua_State* L)
+{
+	LuaCommandLists& cmdLists = CLuaHandle::GetActiveCommandLists(L);
+
+	const CommandList* list = cmdLists.GetList(luaL_checkint(L, 1));
+
+	if (list == nullptr)
+		return 0;
+
+	lua_pushnumber(L, list->commands.size());
+	lua_pushnumber(L, list->numReplays);
+	lua_pushnumber(L, list->replayTime.toMilliSecsf());
+	return 3;
+}
@@ -0,0 +1,163 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_COMMAND_LISTS_H
+#define LUA_COMMAND_LISTS_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LuaOpenGLUtils.h"
+#include "Rendering/GL/myGL.h"
+#include "System/Misc/SpringTime.h"
+
+
+struct lua_State;
+class LuaShaders;
+class LuaVAOImpl;
+
+
+// Engine-side replacement for display lists: a Lua function is run once in
+// recording mode, the recordable gl.* calls it makes (state changes, texture
+// and shader binds, uniforms, VAO draws) are appended to a compact command
+// stream which gl.CallCommandList replays without entering Lua again.
+class LuaCommandLists {
+	public:
+		enum CommandType: uint8_t {
+			CMD_ENABLE,
+			CMD_DISABLE,
+			CMD_BLEND_FUNC,
+			CMD_DEPTH_FUNC,
+			CMD_DEPTH_MASK,
+			CMD_CULL_FACE,
+			CMD_COLOR_MASK,
+			CMD_SCISSOR,
+			CMD_LINE_WIDTH,
+			CMD_ACTIVE_TEXTURE,
+			CMD_BIND_TEXTURE,
+			CMD_USE_SHADER,
+			CMD_UNIFORM_FLOAT,
+			CMD_UNIFORM_INT,
+			CMD_UNIFORM_MATRIX,
+			CMD_UNIFORM_NAMED_MATRIX,
+			CMD_DRAW_ARRAYS,
+			CMD_DRAW_ELEMENTS,
+			CMD_CALL_LIST,
+		};
+
+		struct Command {
+			CommandType type;
+			uint8_t numValues; // of args or, for float uniforms, of CommandList::values
+			uint8_t flags;
+			GLint args[7];
+		};
+
+		struct CommandList {
+		public:
+			void Clear() {
+				commands.clear();
+				values.clear();
+				vaos.clear();
+				textures.clear();
+				uniformNames.clear();
+				program = 0;
+			}
+
+			void Enable(GLenum cap) { commands.push_back({CMD_ENABLE, 0, 0, {GLint(cap)}}); }
+			void Disable(GLenum cap) { commands.push_back({CMD_DISABLE, 0, 0, {GLint(cap)}}); }
+			void BlendFunc(GLenum src, GLenum dst) { commands.push_back({CMD_BLEND_FUNC, 0, 0, {GLint(src), GLint(dst)}}); }
+			void DepthFunc(GLenum func) { commands.push_back({CMD_DEPTH_FUNC, 0, 0, {GLint(func)}}); }
+			void DepthMask(GLboolean flag) { commands.push_back({CMD_DEPTH_MASK, 0, 0, {GLint(flag)}}); }
+			void CullFace(GLenum mode) { commands.push_back({CMD_CULL_FACE, 0, 0, {GLint(mode)}}); }
+			void ColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a) { commands.push_back({CMD_COLOR_MASK, 0, 0, {r, g, b, a}}); }
+			void Scissor(GLint x, GLint y, GLsizei w, GLsizei h) { commands.push_back({CMD_SCISSOR, 0, 0, {x, y, w, h}}); }
+			void LineWidth(GLfloat width);
+			void ActiveTexture(GLenum texUnit) { commands.push_back({CMD_ACTIVE_TEXTURE, 0, 0, {GLint(texUnit)}}); }
+			void BindTexture(const LuaMatTexture& tex);
+
+			// progIdx is resolved through the handle's LuaShaders on replay
+			void UseShader(uint32_t progIdx);
+
+			// uniforms given by name instead of location (nullptr) are looked
+			// up in the program of the last recorded UseShader on each replay
+			void Uniform(GLint location, const char* name, const GLfloat* v, int count);
+			void UniformInt(GLint location, const char* name, const GLint* v, int count);
+			void UniformMatrix(GLint location, const char* name, const GLfloat* m, int count);
+			void UniformMatrix(GLint location, const char* name, LuaMatrixType matType);
+
+			// absent optional arguments are passed as NO_ARG
+			void DrawArrays(std::weak_ptr<LuaVAOImpl> vao, GLenum mode, const GLint (&args)[4]);
+			void DrawElements(std::weak_ptr<LuaVAOImpl> vao, GLenum mode, const GLint (&args)[5]);
+			void CallList(uint32_t listIdx) { commands.push_back({CMD_CALL_LIST, 0, 0, {GLint(listIdx)}}); }
+
+		private:
+			void PushUniform(Command cmd, const char* name);
+
+		public:
+			static constexpr GLint NO_ARG = -0x7FFFFFFF;
+
+			std::vector<Command> commands;
+			std::vector<GLfloat> values;
+			std::vector<std::weak_ptr<LuaVAOImpl>> vaos;
+			std::vector<LuaMatTexture> textures;
+			std::vector<std::string> uniformNames;
+
+			// shader bound by the last recorded UseShader, for uniform names
+			uint32_t program = 0;
+
+			uint32_t numReplays = 0;
+			spring_time replayTime;
+
+			bool active = false;
+		};
+
+	public:
+		LuaCommandLists() { Clear(); }
+
+		void Clear() {
+			lists.clear();
+			unused.clear();
+			lists.emplace_back(); // index 0 is never a valid list
+			recordingIdx = 0;
+		}
+
+		static bool PushEntries(lua_State* L);
+
+		// list recordable gl.* calls have to go to instead of GL, if any
+		static CommandList* GetRecording(lua_State* L);
+		// raises a Lua error for gl.* calls that can not be recorded, if a list is
+		static void CheckNotRecording(lua_State* L, const char* caller);
+
+	private:
+		CommandList* GetList(uint32_t listIdx) {
+			if (listIdx == 0 || listIdx >= lists.size() || !lists[listIdx].active)
+				return nullptr;
+
+			return &lists[listIdx];
+		}
+
+		uint32_t NewList();
+		void FreeList(uint32_t listIdx);
+
+		bool Record(lua_State* L, uint32_t listIdx, int funcIndex);
+		void Replay(lua_State* L, LuaShaders& shaders, const CommandList& list, int depth);
+
+	private:
+		static constexpr int MAX_CALL_DEPTH = 8;
+
+		std::vector<CommandList> lists;
+		std::vector<uint32_t> unused; // references slots in lists
+
+		uint32_t recordingIdx = 0;
+
+	private:
+		static int CreateCommandList(lua_State* L);
+		static int RecordCommandList(lua_State* L);
+		static int CallCommandList(lua_State* L);
+		static int DeleteCommandList(lua_State* L);
+		static int GetCommandListStats(lua_State* L);
+};
+
+
+#endif /* LUA_COMMAND_LISTS_H */
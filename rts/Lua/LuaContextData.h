@@ -15,6 +15,7 @@
 #include "LuaVBO.h"
 #include "LuaVAO.h"
 #include "LuaDisplayLists.h"
+#include "LuaCommandLists.h"
 #endif
 
 #include "System/EventClient.h"
@@ -73,6 +74,7 @@ public:
 		fbos.Clear();
 		rbos.Clear();
 		displayLists.Clear();
+		commandLists.Clear();
 		#endif
 	}
 
@@ -116,6 +118,7 @@ public:
 	LuaVBOs vbos;
 	LuaVAOs vaos;
 	CLuaDisplayLists displayLists;
+	LuaCommandLists commandLists;
 
 	GLMatrixStateTracker glMatrixTracker;
 #endif
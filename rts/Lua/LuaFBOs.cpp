@@ -5,6 +5,7 @@
 
 #include "LuaInclude.h"
 
+#include "LuaCommandLists.h"
 #include "LuaHandle.h"
 #include "LuaHashString.h"
 #include "LuaUtils.h"
@@ -78,6 +79,7 @@ inline void CheckDrawingEnabled(lua_State* L, const char* caller)
 		luaL_error(L, "%s(): OpenGL calls can only be used in Draw() "
 		              "call-ins, or while creating display lists", caller);
 	}
+	LuaCommandLists::CheckNotRecording(L, caller);
 }
 
 
@@ -651,6 +653,7 @@ int LuaFBOs::ActiveFBO(lua_State* L)
 int LuaFBOs::RawBindFBO(lua_State* L)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	LuaCommandLists::CheckNotRecording(L, __func__);
 	//CheckDrawingEnabled(L, __func__);
 
 	if (lua_isnil(L, 1)) {
@@ -708,6 +711,7 @@ int LuaFBOs::RawBindFBO(lua_State* L)
 int LuaFBOs::BlitFBO(lua_State* L)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	LuaCommandLists::CheckNotRecording(L, __func__);
 	if (lua_israwnumber(L, 1)) {
 		const GLint x0Src = (GLint)luaL_checknumber(L, 1);
 		const GLint y0Src = (GLint)luaL_checknumber(L, 2);
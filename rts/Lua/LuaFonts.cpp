@@ -5,6 +5,7 @@
 
 #include "LuaInclude.h"
 
+#include "LuaCommandLists.h"
 #include "LuaHandle.h"
 #include "LuaHashString.h"
 #include "LuaUtils.h"
@@ -52,6 +53,7 @@ bool LuaFonts::CreateMetatable(lua_State* L)
 
 		REGISTER_LUA_CFUNC(GetTextWidth);
 		REGISTER_LUA_CFUNC(GetTextHeight);
+		REGISTER_LUA_CFUNC(GetLayoutCacheStats);
 
 		REGISTER_LUA_CFUNC(SetTextColor);
 		REGISTER_LUA_CFUNC(SetOutlineColor);
@@ -70,8 +72,10 @@ bool LuaFonts::CreateMetatable(lua_State* L)
 inline void CheckDrawingEnabled(lua_State* L, const char* caller)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	if (LuaOpenGL::IsDrawingEnabled(L))
+	if (LuaOpenGL::IsDrawingEnabled(L)) {
+		LuaCommandLists::CheckNotRecording(L, caller);
 		return;
+	}
 
 	luaL_error(L, "[%s::%s] OpenGL calls can only be used in Draw() call-ins", __func__, caller);
 }
@@ -395,6 +399,21 @@ int LuaFonts::GetTextHeight(lua_State* L)
 }
 
 
+int LuaFonts::GetLayoutCacheStats(lua_State* L)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	auto f = tofont(L, 1);
+
+	const CglFont::LayoutCacheStats& stats = f->GetLayoutCacheStats();
+
+	// hits, misses, total time spent laying out missed strings
+	lua_pushnumber(L, stats.numLookups - stats.numLayouts);
+	lua_pushnumber(L, stats.numLayouts);
+	lua_pushnumber(L, stats.layoutTime.toMilliSecsf());
+	return 3;
+}
+
+
 /******************************************************************************/
 /******************************************************************************/
 
@@ -36,6 +36,7 @@ class LuaFonts {
 
 		static int GetTextWidth(lua_State* L);
 		static int GetTextHeight(lua_State* L);
+		static int GetLayoutCacheStats(lua_State* L);
 
 		static int SetTextColor(lua_State* L);
 		static int SetOutlineColor(lua_State* L);
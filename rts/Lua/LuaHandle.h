@@ -41,6 +41,7 @@ class LuaVAOs;
 class LuaTextures;
 class LuaShaders;
 class CLuaDisplayLists;
+class LuaCommandLists;
 class CLuaRules;
 
 
@@ -368,6 +369,7 @@ class CLuaHandle : public CEventClient
 		static inline LuaVBOs& GetActiveVBOs(lua_State* L) { return GetLuaContextData(L)->vbos; }
 		static inline LuaVAOs& GetActiveVAOs(lua_State* L) { return GetLuaContextData(L)->vaos; }
 		static inline CLuaDisplayLists& GetActiveDisplayLists(lua_State* L) { return GetLuaContextData(L)->displayLists; }
+		static inline LuaCommandLists& GetActiveCommandLists(lua_State* L) { return GetLuaContextData(L)->commandLists; }
 #endif
 
 		static void SetDevMode(bool value) { devMode = value; }
@@ -19,6 +19,7 @@
 #include "LuaOpenGL.h"
 
 #include "LuaInclude.h"
+#include "LuaCommandLists.h"
 #include "LuaContextData.h"
 #include "LuaDisplayLists.h"
 #include "LuaFBOs.h"
@@ -175,6 +176,26 @@ static float3 screenViewTrans;
 std::vector<LuaOpenGL::OcclusionQuery*> LuaOpenGL::occlusionQueries;
 
 
+// state calls of the recordable gl.* functions, these go
+// to the command list instead of GL while one is recorded
+struct GLCommandSink {
+	void Enable(GLenum cap) const { (cmdList != nullptr)? cmdList->Enable(cap): glEnable(cap); }
+	void Disable(GLenum cap) const { (cmdList != nullptr)? cmdList->Disable(cap): glDisable(cap); }
+	void BlendFunc(GLenum src, GLenum dst) const { (cmdList != nullptr)? cmdList->BlendFunc(src, dst): glBlendFunc(src, dst); }
+	void DepthFunc(GLenum func) const { (cmdList != nullptr)? cmdList->DepthFunc(func): glDepthFunc(func); }
+	void DepthMask(GLboolean flag) const { (cmdList != nullptr)? cmdList->DepthMask(flag): glDepthMask(flag); }
+	void CullFace(GLenum mode) const { (cmdList != nullptr)? cmdList->CullFace(mode): glCullFace(mode); }
+	void ColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a) const { (cmdList != nullptr)? cmdList->ColorMask(r, g, b, a): glColorMask(r, g, b, a); }
+	void Scissor(GLint x, GLint y, GLsizei w, GLsizei h) const { (cmdList != nullptr)? cmdList->Scissor(x, y, w, h): glScissor(x, y, w, h); }
+	void LineWidth(GLfloat width) const { (cmdList != nullptr)? cmdList->LineWidth(width): glLineWidth(width); }
+	void ActiveTexture(GLenum texUnit) const { (cmdList != nullptr)? cmdList->ActiveTexture(texUnit): glActiveTexture(texUnit); }
+
+	LuaCommandLists::CommandList* cmdList;
+};
+
+static inline GLCommandSink GetCommandSink(lua_State* L) { return {LuaCommandLists::GetRecording(L)}; }
+
+
 
 
 static inline CUnit* ParseUnit(lua_State* L, const char* caller, int index)
@@ -482,6 +503,8 @@ bool LuaOpenGL::PushEntries(lua_State* L)
 	LuaVAOs::PushEntries(L);
 	LuaVBOs::PushEntries(L);
 
+	LuaCommandLists::PushEntries(L);
+
 	LuaFonts::PushEntries(L);
 
 	return true;
@@ -1095,7 +1118,7 @@ void LuaOpenGL::ResetMiniMapMatrices()
 /******************************************************************************/
 
 
-inline void LuaOpenGL::CheckDrawingEnabled(lua_State* L, const char* caller)
+inline void LuaOpenGL::CheckRecordableDrawingEnabled(lua_State* L, const char* caller)
 {
 	if (!IsDrawingEnabled(L)) {
 		luaL_error(L, "%s(): OpenGL calls can only be used in Draw() "
@@ -1103,6 +1126,12 @@ inline void LuaOpenGL::CheckDrawingEnabled(lua_State* L, const char* caller)
 	}
 }
 
+inline void LuaOpenGL::CheckDrawingEnabled(lua_State* L, const char* caller)
+{
+	CheckRecordableDrawingEnabled(L, caller);
+	LuaCommandLists::CheckNotRecording(L, caller);
+}
+
 inline void LuaOpenGL::CondWarnDeprecatedGL(lua_State* L, const char* caller)
 {
 	if (deprecatedGLWarnLevel <= 0)
@@ -2479,6 +2508,8 @@ int LuaOpenGL::TexRect(lua_State* L)
 
 int LuaOpenGL::DispatchCompute(lua_State* L)
 {
+	LuaCommandLists::CheckNotRecording(L, __func__);
+
 	const GLuint numGroupX = (GLuint)luaL_checknumber(L, 1);
 	const GLuint numGroupY = (GLuint)luaL_checknumber(L, 2);
 	const GLuint numGroupZ = (GLuint)luaL_checknumber(L, 3);
@@ -2511,6 +2542,8 @@ int LuaOpenGL::DispatchCompute(lua_State* L)
 
 int LuaOpenGL::MemoryBarrier(lua_State* L)
 {
+	LuaCommandLists::CheckNotRecording(L, __func__);
+
 	GLbitfield barriers = (GLbitfield)luaL_optint(L, 1, 0);
 	//skip checking the correctness of values :)
 
@@ -2690,25 +2723,26 @@ int LuaOpenGL::ShadeModel(lua_State* L)
 
 int LuaOpenGL::Scissor(lua_State* L)
 {
-	CheckDrawingEnabled(L, __func__);
+	CheckRecordableDrawingEnabled(L, __func__);
+	const GLCommandSink gls = GetCommandSink(L);
 
 	const int args = lua_gettop(L); // number of arguments
 	if (args == 1) {
 		if (luaL_checkboolean(L, 1)) {
-			glEnable(GL_SCISSOR_TEST);
+			gls.Enable(GL_SCISSOR_TEST);
 		} else {
-			glDisable(GL_SCISSOR_TEST);
+			gls.Disable(GL_SCISSOR_TEST);
 		}
 	}
 	else if (args == 4) {
-		glEnable(GL_SCISSOR_TEST);
+		gls.Enable(GL_SCISSOR_TEST);
 		const GLint   x =   (GLint)luaL_checkint(L, 1);
 		const GLint   y =   (GLint)luaL_checkint(L, 2);
 		const GLsizei w = (GLsizei)luaL_checkint(L, 3);
 		const GLsizei h = (GLsizei)luaL_checkint(L, 4);
 		if (w < 0) luaL_argerror(L, 3, "<width> must be greater than or equal zero!");
 		if (h < 0) luaL_argerror(L, 4, "<height> must be greater than or equal zero!");
-		glScissor(x + globalRendering->viewPosX, y + globalRendering->viewPosY, w, h);
+		gls.Scissor(x + globalRendering->viewPosX, y + globalRendering->viewPosY, w, h);
 	}
 	else {
 		luaL_error(L, "Incorrect arguments to gl.Scissor()");
@@ -2736,19 +2770,20 @@ int LuaOpenGL::Viewport(lua_State* L)
 
 int LuaOpenGL::ColorMask(lua_State* L)
 {
-	CheckDrawingEnabled(L, __func__);
+	CheckRecordableDrawingEnabled(L, __func__);
+	const GLCommandSink gls = GetCommandSink(L);
 
 	const int args = lua_gettop(L); // number of arguments
 	if (args == 1) {
 		if (luaL_checkboolean(L, 1)) {
-			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+			gls.ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 		} else {
-			glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+			gls.ColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
 		}
 	}
 	else if (args == 4) {
-		glColorMask(luaL_checkboolean(L, 1), luaL_checkboolean(L, 2),
-		            luaL_checkboolean(L, 3), luaL_checkboolean(L, 4));
+		gls.ColorMask(luaL_checkboolean(L, 1), luaL_checkboolean(L, 2),
+		              luaL_checkboolean(L, 3), luaL_checkboolean(L, 4));
 	}
 	else {
 		luaL_error(L, "Incorrect arguments to gl.ColorMask()");
@@ -2759,11 +2794,12 @@ int LuaOpenGL::ColorMask(lua_State* L)
 
 int LuaOpenGL::DepthMask(lua_State* L)
 {
-	CheckDrawingEnabled(L, __func__);
+	CheckRecordableDrawingEnabled(L, __func__);
+	const GLCommandSink gls = GetCommandSink(L);
 	if (luaL_checkboolean(L, 1)) {
-		glDepthMask(GL_TRUE);
+		gls.DepthMask(GL_TRUE);
 	} else {
-		glDepthMask(GL_FALSE);
+		gls.DepthMask(GL_FALSE);
 	}
 	return 0;
 }
@@ -2771,7 +2807,8 @@ int LuaOpenGL::DepthMask(lua_State* L)
 
 int LuaOpenGL::DepthTest(lua_State* L)
 {
-	CheckDrawingEnabled(L, __func__);
+	CheckRecordableDrawingEnabled(L, __func__);
+	const GLCommandSink gls = GetCommandSink(L);
 
 	const int args = lua_gettop(L); // number of arguments
 	if (args != 1) {
@@ -2780,14 +2817,14 @@ int LuaOpenGL::DepthTest(lua_State* L)
 
 	if (lua_isboolean(L, 1)) {
 		if (lua_toboolean(L, 1)) {
-			glEnable(GL_DEPTH_TEST);
+			gls.Enable(GL_DEPTH_TEST);
 		} else {
-			glDisable(GL_DEPTH_TEST);
+			gls.Disable(GL_DEPTH_TEST);
 		}
 	}
 	else if (lua_isnumber(L, 1)) {
-		glEnable(GL_DEPTH_TEST);
-		glDepthFunc((GLenum)lua_tonumber(L, 1));
+		gls.Enable(GL_DEPTH_TEST);
+		gls.DepthFunc((GLenum)lua_tonumber(L, 1));
 	}
 	else {
 		luaL_error(L, "Incorrect arguments to gl.DepthTest()");
@@ -2811,7 +2848,8 @@ int LuaOpenGL::DepthClamp(lua_State* L)
 
 int LuaOpenGL::Culling(lua_State* L)
 {
-	CheckDrawingEnabled(L, __func__);
+	CheckRecordableDrawingEnabled(L, __func__);
+	const GLCommandSink gls = GetCommandSink(L);
 
 	const int args = lua_gettop(L); // number of arguments
 	if (args != 1) {
@@ -2820,14 +2858,14 @@ int LuaOpenGL::Culling(lua_State* L)
 
 	if (lua_isboolean(L, 1)) {
 		if (lua_toboolean(L, 1)) {
-			glEnable(GL_CULL_FACE);
+			gls.Enable(GL_CULL_FACE);
 		} else {
-			glDisable(GL_CULL_FACE);
+			gls.Disable(GL_CULL_FACE);
 		}
 	}
 	else if (lua_isnumber(L, 1)) {
-		glEnable(GL_CULL_FACE);
-		glCullFace((GLenum)lua_tonumber(L, 1));
+		gls.Enable(GL_CULL_FACE);
+		gls.CullFace((GLenum)lua_tonumber(L, 1));
 	}
 	else {
 		luaL_error(L, "Incorrect arguments to gl.Culling()");
@@ -2879,44 +2917,45 @@ int LuaOpenGL::Fog(lua_State* L)
 
 int LuaOpenGL::Blending(lua_State* L)
 {
-	CheckDrawingEnabled(L, __func__);
+	CheckRecordableDrawingEnabled(L, __func__);
+	const GLCommandSink gls = GetCommandSink(L);
 
 	const int args = lua_gettop(L); // number of arguments
 	if (args == 1) {
 		if (lua_isboolean(L, 1)) {
 			if (lua_toboolean(L, 1)) {
-				glEnable(GL_BLEND);
+				gls.Enable(GL_BLEND);
 			} else {
-				glDisable(GL_BLEND);
+				gls.Disable(GL_BLEND);
 			}
 		}
 		else if (lua_israwstring(L, 1)) {
 			switch (hashString(lua_tostring(L, 1))) {
 				case hashString("add"): {
-					glBlendFunc(GL_ONE, GL_ONE);
-					glEnable(GL_BLEND);
+					gls.BlendFunc(GL_ONE, GL_ONE);
+					gls.Enable(GL_BLEND);
 				} break;
 				case hashString("alpha_add"): {
-					glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-					glEnable(GL_BLEND);
+					gls.BlendFunc(GL_SRC_ALPHA, GL_ONE);
+					gls.Enable(GL_BLEND);
 				} break;
 
 				case hashString("alpha"):
 				case hashString("reset"): {
-					glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-					glEnable(GL_BLEND);
+					gls.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+					gls.Enable(GL_BLEND);
 				} break;
 				case hashString("color"): {
-					glBlendFunc(GL_SRC_COLOR, GL_ONE_MINUS_SRC_COLOR);
-					glEnable(GL_BLEND);
+					gls.BlendFunc(GL_SRC_COLOR, GL_ONE_MINUS_SRC_COLOR);
+					gls.Enable(GL_BLEND);
 				} break;
 				case hashString("modulate"): {
-					glBlendFunc(GL_DST_COLOR, GL_ZERO);
-					glEnable(GL_BLEND);
+					gls.BlendFunc(GL_DST_COLOR, GL_ZERO);
+					gls.Enable(GL_BLEND);
 				} break;
 				case hashString("disable"): {
-					glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-					glDisable(GL_BLEND);
+					gls.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+					gls.Disable(GL_BLEND);
 				} break;
 				default: {
 				} break;
@@ -2929,8 +2968,8 @@ int LuaOpenGL::Blending(lua_State* L)
 	else if (args == 2) {
 		const GLenum src = (GLenum)luaL_checkint(L, 1);
 		const GLenum dst = (GLenum)luaL_checkint(L, 2);
-		glBlendFunc(src, dst);
-		glEnable(GL_BLEND);
+		gls.BlendFunc(src, dst);
+		gls.Enable(GL_BLEND);
 	}
 	else {
 		luaL_error(L, "Incorrect arguments to gl.Blending()");
@@ -2950,10 +2989,11 @@ int LuaOpenGL::BlendEquation(lua_State* L)
 
 int LuaOpenGL::BlendFunc(lua_State* L)
 {
-	CheckDrawingEnabled(L, __func__);
+	CheckRecordableDrawingEnabled(L, __func__);
+	const GLCommandSink gls = GetCommandSink(L);
 	const GLenum src = (GLenum)luaL_checkint(L, 1);
 	const GLenum dst = (GLenum)luaL_checkint(L, 2);
-	glBlendFunc(src, dst);
+	gls.BlendFunc(src, dst);
 	return 0;
 }
 
@@ -3194,9 +3234,10 @@ int LuaOpenGL::LineStipple(lua_State* L)
 int LuaOpenGL::LineWidth(lua_State* L)
 {
 	CondWarnDeprecatedGL(L, __func__);
+	const GLCommandSink gls = GetCommandSink(L);
 	const float width = luaL_checkfloat(L, 1);
 	if (width <= 0.0f) luaL_argerror(L, 1, "Incorrect Width (must be greater zero)");
-	glLineWidth(width);
+	gls.LineWidth(width);
 	return 0;
 }
 
@@ -3204,6 +3245,7 @@ int LuaOpenGL::LineWidth(lua_State* L)
 int LuaOpenGL::PointSize(lua_State* L)
 {
 	CondWarnDeprecatedGL(L, __func__);
+	LuaCommandLists::CheckNotRecording(L, __func__);
 	const float size = luaL_checkfloat(L, 1);
 	if (size <= 0.0f) luaL_argerror(L, 1, "Incorrect Size (must be greater zero)");
 	glPointSize(size);
@@ -3214,6 +3256,7 @@ int LuaOpenGL::PointSize(lua_State* L)
 int LuaOpenGL::PointSprite(lua_State* L)
 {
 	CondWarnDeprecatedGL(L, __func__);
+	LuaCommandLists::CheckNotRecording(L, __func__);
 	const int args = lua_gettop(L); // number of arguments
 
 	if (luaL_checkboolean(L, 1)) {
@@ -3242,6 +3285,7 @@ int LuaOpenGL::PointSprite(lua_State* L)
 int LuaOpenGL::PointParameter(lua_State* L)
 {
 	CondWarnDeprecatedGL(L, __func__);
+	LuaCommandLists::CheckNotRecording(L, __func__);
 	GLfloat atten[3];
 	atten[0] = (GLfloat)luaL_checknumber(L, 1);
 	atten[1] = (GLfloat)luaL_checknumber(L, 2);
@@ -3281,7 +3325,8 @@ int LuaOpenGL::Texture(lua_State* L)
 	// ...          --  named textures
 	//
 
-	CheckDrawingEnabled(L, __func__);
+	CheckRecordableDrawingEnabled(L, __func__);
+	const GLCommandSink gls = GetCommandSink(L);
 
 	if (lua_gettop(L) < 1)
 		luaL_error(L, "Incorrect [number of] arguments to gl.Texture()");
@@ -3299,18 +3344,18 @@ int LuaOpenGL::Texture(lua_State* L)
 		texUnit += texNum;
 
 		if (texUnit != GL_TEXTURE0)
-			glActiveTexture(texUnit);
+			gls.ActiveTexture(texUnit);
 	}
 
 	if (lua_isboolean(L, nextArg)) {
 		if (lua_toboolean(L, nextArg)) {
-			glEnable(GL_TEXTURE_2D);
+			gls.Enable(GL_TEXTURE_2D);
 		} else {
-			glDisable(GL_TEXTURE_2D);
+			gls.Disable(GL_TEXTURE_2D);
 		}
 
 		if (texUnit != GL_TEXTURE0)
-			glActiveTexture(GL_TEXTURE0);
+			gls.ActiveTexture(GL_TEXTURE0);
 
 		lua_pushboolean(L, true);
 		return 1;
@@ -3318,7 +3363,7 @@ int LuaOpenGL::Texture(lua_State* L)
 
 	if (!lua_isstring(L, nextArg)) {
 		if (texUnit != GL_TEXTURE0)
-			glActiveTexture(GL_TEXTURE0);
+			gls.ActiveTexture(GL_TEXTURE0);
 
 		luaL_error(L, "Incorrect arguments to gl.Texture()");
 	}
@@ -3330,13 +3375,18 @@ int LuaOpenGL::Texture(lua_State* L)
 		lua_pushboolean(L, true);
 
 		tex.Enable(true);
-		tex.Bind();
+
+		if (gls.cmdList != nullptr) {
+			gls.cmdList->BindTexture(tex);
+		} else {
+			tex.Bind();
+		}
 	} else {
 		lua_pushboolean(L, false);
 	}
 
 	if (texUnit != GL_TEXTURE0)
-		glActiveTexture(GL_TEXTURE0);
+		gls.ActiveTexture(GL_TEXTURE0);
 
 	return 1;
 }
@@ -4893,6 +4943,7 @@ int LuaOpenGL::GetFixedState(lua_State* L)
 int LuaOpenGL::CreateList(lua_State* L)
 {
 	CondWarnDeprecatedGL(L, __func__);
+	LuaCommandLists::CheckNotRecording(L, __func__);
 	const int args = lua_gettop(L); // number of arguments
 	if ((args < 1) || !lua_isfunction(L, 1)) {
 		luaL_error(L,
@@ -5228,6 +5279,8 @@ int LuaOpenGL::DeleteQuery(lua_State* L)
 
 int LuaOpenGL::RunQuery(lua_State* L)
 {
+	LuaCommandLists::CheckNotRecording(L, __func__);
+
 	static bool running = false;
 
 	if (running)
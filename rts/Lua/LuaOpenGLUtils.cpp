@@ -165,9 +165,9 @@ LuaMatrixType LuaOpenGLUtils::GetLuaMatrixType(const char* name)
 	return LUAMATRICES_NONE;
 }
 
-const CMatrix44f* LuaOpenGLUtils::GetNamedMatrix(const char* name)
+const CMatrix44f* LuaOpenGLUtils::GetNamedMatrix(LuaMatrixType matType)
 {
-	switch (GetLuaMatrixType(name)) {
+	switch (matType) {
 		case LUAMATRICES_SHADOW:
 			return &shadowHandler.GetShadowMatrix();
 		case LUAMATRICES_VIEW:
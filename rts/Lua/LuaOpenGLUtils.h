@@ -126,7 +126,8 @@ class LuaOpenGLUtils {
 public:
 	static void ResetState();
 
-	static const CMatrix44f* GetNamedMatrix(const char* name);
+	static const CMatrix44f* GetNamedMatrix(const char* name) { return GetNamedMatrix(GetLuaMatrixType(name)); }
+	static const CMatrix44f* GetNamedMatrix(LuaMatrixType matType);
 
 	static LuaMatTexture::Type GetLuaMatTextureType(const std::string& name);
 	static LuaMatrixType GetLuaMatrixType(const char* name);
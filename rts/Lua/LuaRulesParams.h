@@ -35,7 +35,7 @@ namespace LuaRulesParams
 		std::variant <bool, float, std::string> value;
 	};
 
-	typedef spring::unordered_map<std::string, Param> Params;
+	typedef spring::flat_hash_map<std::string, Param> Params;
 }
 
 #endif // LUA_RULESPARAMS_H
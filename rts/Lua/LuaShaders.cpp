@@ -2,6 +2,7 @@
 
 
 #include "LuaShaders.h"
+#include "LuaCommandLists.h"
 
 #include "lib/sol2/sol.hpp"
 
@@ -93,7 +94,7 @@ LuaShaders::~LuaShaders()
 /******************************************************************************/
 /******************************************************************************/
 
-inline void CheckDrawingEnabled(lua_State* L, const char* caller)
+inline void CheckRecordableDrawingEnabled(lua_State* L, const char* caller)
 {
 	if (LuaOpenGL::IsDrawingEnabled(L))
 		return;
@@ -101,6 +102,12 @@ inline void CheckDrawingEnabled(lua_State* L, const char* caller)
 	luaL_error(L, "%s(): OpenGL calls can only be used in Draw() " "call-ins, or while creating display lists", caller);
 }
 
+inline void CheckDrawingEnabled(lua_State* L, const char* caller)
+{
+	CheckRecordableDrawingEnabled(L, caller);
+	LuaCommandLists::CheckNotRecording(L, caller);
+}
+
 
 /******************************************************************************/
 /******************************************************************************/
@@ -768,28 +775,47 @@ int LuaShaders::DeleteShader(lua_State* L)
  */
 int LuaShaders::UseShader(lua_State* L)
 {
-	CheckDrawingEnabled(L, __func__);
+	CheckRecordableDrawingEnabled(L, __func__);
 
 	const int progIdx = luaL_checkint(L, 1);
+
+	LuaShaders& shaders = CLuaHandle::GetActiveShaders(L);
+
+	if (LuaCommandLists::CommandList* cmdList = LuaCommandLists::GetRecording(L); cmdList != nullptr) {
+		cmdList->UseShader(progIdx);
+		lua_pushboolean(L, progIdx == 0 || shaders.GetProgram(progIdx) != nullptr);
+		return 1;
+	}
+
+	lua_pushboolean(L, shaders.UseProgram(progIdx));
+	return 1;
+}
+
+
+bool LuaShaders::UseProgram(uint32_t progIdx)
+{
 	if (progIdx == 0) {
 		glUseProgram(0);
 		activeProgram = nullptr;
-		lua_pushboolean(L, true);
-		return 1;
+		return true;
 	}
 
-	LuaShaders& shaders = CLuaHandle::GetActiveShaders(L);
-	auto* prog = shaders.GetProgram(progIdx);
+	Program* prog = GetProgram(progIdx);
 
 	if (prog == nullptr) {
 		activeProgram = nullptr;
-		lua_pushboolean(L, false);
-	} else {
-		activeProgram = prog;
-		glUseProgram(prog->id);
-		lua_pushboolean(L, true);
+		return false;
 	}
-	return 1;
+
+	activeProgram = prog;
+	glUseProgram(prog->id);
+	return true;
+}
+
+
+GLint LuaShaders::GetProgramUniformLocation(uint32_t progIdx, const std::string& name)
+{
+	return (GetUniformLocation(GetProgram(progIdx), name.c_str()));
 }
 
 
@@ -807,6 +833,8 @@ int LuaShaders::UseShader(lua_State* L)
  */
 int LuaShaders::ActiveShader(lua_State* L)
 {
+	LuaCommandLists::CheckNotRecording(L, __func__);
+
 	const int progIdx = luaL_checkint(L, 1);
 	luaL_checktype(L, 2, LUA_TFUNCTION);
 
@@ -1001,11 +1029,29 @@ int LuaShaders::SetFeatureBufferUniforms(lua_State* L) { return SetObjectBufferU
 int LuaShaders::Uniform(lua_State* L)
 {
 	if (activeShaderDepth <= 0)
-		CheckDrawingEnabled(L, __func__);
+		CheckRecordableDrawingEnabled(L, __func__);
 
-	const GLuint location = (lua_type(L, 1) == LUA_TSTRING) ? GetUniformLocation(activeProgram, luaL_checkstring(L, 1)) : luaL_checkint(L, 1);
 	const int numValues = lua_gettop(L) - 1;
 
+	if (LuaCommandLists::CommandList* cmdList = LuaCommandLists::GetRecording(L); cmdList != nullptr) {
+		// names are looked up on replay, the shader can be recreated in between
+		const char* name = (lua_type(L, 1) == LUA_TSTRING)? lua_tostring(L, 1): nullptr;
+		const GLint location = (name == nullptr)? luaL_checkint(L, 1): -1;
+
+		if (numValues < 1 || numValues > 4)
+			luaL_error(L, "Incorrect arguments to gl.Uniform()");
+
+		GLfloat values[4];
+		for (int i = 0; i < numValues; i++) {
+			values[i] = luaL_checkfloat(L, i + 2);
+		}
+
+		cmdList->Uniform(location, name, values, numValues);
+		return 0;
+	}
+
+	const GLuint location = (lua_type(L, 1) == LUA_TSTRING) ? GetUniformLocation(activeProgram, luaL_checkstring(L, 1)) : luaL_checkint(L, 1);
+
 	switch (numValues) {
 		case 1: {
 			glUniform1f(location, luaL_checkfloat(L, 2));
@@ -1041,11 +1087,29 @@ int LuaShaders::Uniform(lua_State* L)
 int LuaShaders::UniformInt(lua_State* L)
 {
 	if (activeShaderDepth <= 0)
-		CheckDrawingEnabled(L, __func__);
+		CheckRecordableDrawingEnabled(L, __func__);
 
-	const GLuint location = (lua_type(L, 1) == LUA_TSTRING) ? GetUniformLocation(activeProgram, luaL_checkstring(L, 1)) : luaL_checkint(L, 1);
 	const int numValues = lua_gettop(L) - 1;
 
+	if (LuaCommandLists::CommandList* cmdList = LuaCommandLists::GetRecording(L); cmdList != nullptr) {
+		// names are looked up on replay, the shader can be recreated in between
+		const char* name = (lua_type(L, 1) == LUA_TSTRING)? lua_tostring(L, 1): nullptr;
+		const GLint location = (name == nullptr)? luaL_checkint(L, 1): -1;
+
+		if (numValues < 1 || numValues > 4)
+			luaL_error(L, "Incorrect arguments to gl.UniformInt()");
+
+		GLint values[4];
+		for (int i = 0; i < numValues; i++) {
+			values[i] = luaL_checkint(L, i + 2);
+		}
+
+		cmdList->UniformInt(location, name, values, numValues);
+		return 0;
+	}
+
+	const GLuint location = (lua_type(L, 1) == LUA_TSTRING) ? GetUniformLocation(activeProgram, luaL_checkstring(L, 1)) : luaL_checkint(L, 1);
+
 	switch (numValues) {
 		case 1: {
 			glUniform1i(location, luaL_checkint(L, 2));
@@ -1150,11 +1214,46 @@ int LuaShaders::UniformArray(lua_State* L)
 int LuaShaders::UniformMatrix(lua_State* L)
 {
 	if (activeShaderDepth <= 0)
-		CheckDrawingEnabled(L, __func__);
+		CheckRecordableDrawingEnabled(L, __func__);
 
-	const GLuint location = (lua_type(L, 1) == LUA_TSTRING) ? GetUniformLocation(activeProgram, luaL_checkstring(L, 1)) : luaL_checkint(L, 1);
 	const int numValues = lua_gettop(L) - 1;
 
+	if (LuaCommandLists::CommandList* cmdList = LuaCommandLists::GetRecording(L); cmdList != nullptr) {
+		// names are looked up on replay, the shader can be recreated in between
+		const char* name = (lua_type(L, 1) == LUA_TSTRING)? lua_tostring(L, 1): nullptr;
+		const GLint location = (name == nullptr)? luaL_checkint(L, 1): -1;
+
+		switch (numValues) {
+			case 1: {
+				// named matrices are looked up on every replay
+				const LuaMatrixType matType = LuaOpenGLUtils::GetLuaMatrixType(luaL_checkstring(L, 2));
+
+				if (matType == LUAMATRICES_NONE)
+					luaL_error(L, "Incorrect arguments to gl.UniformMatrix()");
+
+				cmdList->UniformMatrix(location, name, matType);
+			} break;
+			case (2 * 2):
+			case (3 * 3):
+			case (4 * 4): {
+				float array[4 * 4];
+
+				for (int i = 0; i < numValues; i++) {
+					array[i] = luaL_checkfloat(L, i + 2);
+				}
+
+				cmdList->UniformMatrix(location, name, array, numValues);
+			} break;
+			default: {
+				luaL_error(L, "Incorrect arguments to gl.UniformMatrix()");
+			}
+		}
+
+		return 0;
+	}
+
+	const GLuint location = (lua_type(L, 1) == LUA_TSTRING) ? GetUniformLocation(activeProgram, luaL_checkstring(L, 1)) : luaL_checkint(L, 1);
+
 	switch (numValues) {
 	case 1: {
 			if (!lua_isstring(L, 2))
@@ -1302,6 +1401,8 @@ int LuaShaders::SetGeometryShaderParameter(lua_State* L)
  */
 int LuaShaders::SetTesselationShaderParameter(lua_State* L)
 {
+	LuaCommandLists::CheckNotRecording(L, __func__);
+
 	if (!IS_GL_FUNCTION_AVAILABLE(glPatchParameteri))
 		return 0;
 
@@ -31,6 +31,11 @@ class LuaShaders {
 		GLuint GetProgramName(uint32_t progIdx) const;
 		const Program* GetProgram(uint32_t progIdx) const;
 		      Program* GetProgram(uint32_t progIdx);
+
+		// binds program <progIdx>, or unbinds for 0; false if there is no such program
+		bool UseProgram(uint32_t progIdx);
+		// location of uniform <name> in program <progIdx>, -1 if there is no such program
+		GLint GetProgramUniformLocation(uint32_t progIdx, const std::string& name);
 	private:
 		struct Object {
 			Object(GLuint _id, GLenum _type) : id(_id), type(_type) {}
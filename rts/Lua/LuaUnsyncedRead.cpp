@@ -61,6 +61,7 @@
 #include "Game/UI/Groups/GroupHandler.h"
 #include "Net/Protocol/NetProtocol.h" // NETMSG_*
 #include "System/TimeProfiler.h"
+#include "System/MemAccounting.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/Config/ConfigVariable.h"
 #include "System/Input/KeyInput.h"
@@ -104,9 +105,11 @@ bool LuaUnsyncedRead::PushEntries(lua_State* L)
 
 	REGISTER_LUA_CFUNC(GetProfilerTimeRecord);
 	REGISTER_LUA_CFUNC(GetProfilerRecordNames);
+	REGISTER_LUA_CFUNC(GetProfilerTaskGroupStats);
 
 	REGISTER_LUA_CFUNC(GetLuaMemUsage);
 	REGISTER_LUA_CFUNC(GetVidMemUsage);
+	REGISTER_LUA_CFUNC(GetMemAccountingStats);
 
 	REGISTER_LUA_CFUNC(GetDrawFrame);
 	REGISTER_LUA_CFUNC(GetFrameTimeOffset);
@@ -581,6 +584,42 @@ int LuaUnsyncedRead::GetProfilerRecordNames(lua_State* L)
 	return 1;
 }
 
+/***
+ * Scheduling statistics of all for_mt and parallel calls since the profiler was last reset
+ *
+ * @function Spring.GetProfilerTaskGroupStats
+ *
+ * @treturn {[string]={calls=number,chunks=number,wallTime=number,busyTime=number,idleTime=number,waitTime=number,avgImbalance=number,maxImbalance=number},...} stats
+ * keyed by the name of the profiler timer enclosing the calls, times in ms; imbalance is the max
+ * over mean per-thread busy time of a call (1 means perfectly balanced)
+ */
+int LuaUnsyncedRead::GetProfilerTaskGroupStats(lua_State* L)
+{
+	const auto taskGroupRecs = CTimeProfiler::GetInstance().GetTaskGroupRecords();
+
+	lua_createtable(L, 0, taskGroupRecs.size());
+
+	for (const auto& p: taskGroupRecs) {
+		const CTimeProfiler::TaskGroupRecord& r = p.second;
+
+		lua_pushsstring(L, p.first); // key
+		lua_createtable(L, 0, 8); // val
+
+		LuaPushNamedNumber(L, "calls"       , r.numCalls);
+		LuaPushNamedNumber(L, "chunks"      , r.numChunks);
+		LuaPushNamedNumber(L, "wallTime"    , r.wallTime.toMilliSecsf());
+		LuaPushNamedNumber(L, "busyTime"    , r.busyTime.toMilliSecsf());
+		LuaPushNamedNumber(L, "idleTime"    , r.idleTime.toMilliSecsf());
+		LuaPushNamedNumber(L, "waitTime"    , r.waitTime.toMilliSecsf());
+		LuaPushNamedNumber(L, "avgImbalance", r.sumImbalance / std::max(r.numCalls, uint64_t(1)));
+		LuaPushNamedNumber(L, "maxImbalance", r.maxImbalance);
+
+		lua_rawset(L, -3);
+	}
+
+	return 1;
+}
+
 
 /***
  *
@@ -651,6 +690,41 @@ int LuaUnsyncedRead::GetVidMemUsage(lua_State* L)
 	return 2;
 }
 
+/***
+ * Per-subsystem memory usage as reported by pools and containers to the engine's memory accounting
+ *
+ * @function Spring.GetMemAccountingStats
+ *
+ * @treturn {[string]={liveMem=number,peakMem=number,numAllocs=number,numFrees=number,allocRate=number,allocMemRate=number,heapMem=number,heapAllocMemRate=number},...} stats
+ * keyed by subsystem tag, memory in kilobytes and rates per second; heap values are
+ * estimates from sampling operator new and remain zero unless the engine was built
+ * with MEMORY_ACCOUNTING_SAMPLE_NEW
+ */
+int LuaUnsyncedRead::GetMemAccountingStats(lua_State* L)
+{
+	const std::vector<MemAccounting::TagStats> stats = MemAccounting::GetStats();
+
+	lua_createtable(L, 0, stats.size());
+
+	for (const MemAccounting::TagStats& s: stats) {
+		lua_pushstring(L, s.name); // key
+		lua_createtable(L, 0, 8); // val
+
+		LuaPushNamedNumber(L, "liveMem"         , s.liveBytes / 1024.0f);
+		LuaPushNamedNumber(L, "peakMem"         , s.peakLiveBytes / 1024.0f);
+		LuaPushNamedNumber(L, "numAllocs"       , s.numAllocs);
+		LuaPushNamedNumber(L, "numFrees"        , s.numFrees);
+		LuaPushNamedNumber(L, "allocRate"       , s.allocRate);
+		LuaPushNamedNumber(L, "allocMemRate"    , s.allocByteRate / 1024.0f);
+		LuaPushNamedNumber(L, "heapMem"         , s.heapLiveBytes / 1024.0f);
+		LuaPushNamedNumber(L, "heapAllocMemRate", s.heapAllocByteRate / 1024.0f);
+
+		lua_rawset(L, -3);
+	}
+
+	return 1;
+}
+
 
 static void PushTimer(lua_State* L, const spring_time& time, bool microseconds)
 {
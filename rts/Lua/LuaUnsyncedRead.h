@@ -21,9 +21,11 @@ class LuaUnsyncedRead {
 
 		static int GetProfilerTimeRecord(lua_State* L);
 		static int GetProfilerRecordNames(lua_State* L);
+		static int GetProfilerTaskGroupStats(lua_State* L);
 
 		static int GetLuaMemUsage(lua_State* L);
 		static int GetVidMemUsage(lua_State* L);
+		static int GetMemAccountingStats(lua_State* L);
 
 		static int GetDrawFrame(lua_State* L);
 		static int GetFrameTimeOffset(lua_State* L);
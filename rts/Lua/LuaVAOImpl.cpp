@@ -11,6 +11,7 @@
 #include "System/SafeUtil.h"
 #include "Rendering/GL/VBO.h"
 #include "Rendering/GL/VAO.h"
+#include "LuaCommandLists.h"
 #include "LuaVBOImpl.h"
 
 #include "LuaUtils.h"
@@ -374,8 +375,19 @@ LuaVAOImpl::DrawCheckResult LuaVAOImpl::DrawCheck(GLenum mode, const DrawCheckIn
  * @number[opt] instanceFirst
  * @treturn nil
  */
-void LuaVAOImpl::DrawArrays(GLenum mode, sol::optional<int> vertCountOpt, sol::optional<int> vertexFirstOpt, sol::optional<int> instanceCountOpt, sol::optional<int> instanceFirstOpt)
+void LuaVAOImpl::DrawArrays(GLenum mode, sol::optional<int> vertCountOpt, sol::optional<int> vertexFirstOpt, sol::optional<int> instanceCountOpt, sol::optional<int> instanceFirstOpt, sol::this_state L)
 {
+	if (LuaCommandLists::CommandList* cmdList = LuaCommandLists::GetRecording(L); cmdList != nullptr) {
+		constexpr GLint NO_ARG = LuaCommandLists::CommandList::NO_ARG;
+		cmdList->DrawArrays(weak_from_this(), mode, {
+			vertCountOpt.value_or(NO_ARG),
+			vertexFirstOpt.value_or(NO_ARG),
+			instanceCountOpt.value_or(NO_ARG),
+			instanceFirstOpt.value_or(NO_ARG)
+		});
+		return;
+	}
+
 	DrawCheckInput inputs{
 		vertCountOpt,
 		std::nullopt,
@@ -412,8 +424,20 @@ void LuaVAOImpl::DrawArrays(GLenum mode, sol::optional<int> vertCountOpt, sol::o
  * @number[opt] baseInstance
  * @treturn nil
  */
-void LuaVAOImpl::DrawElements(GLenum mode, sol::optional<int> indCountOpt, sol::optional<int> indElemOffsetOpt, sol::optional<int> instanceCountOpt, sol::optional<int> baseVertexOpt, sol::optional<int> instanceFirstOpt)
+void LuaVAOImpl::DrawElements(GLenum mode, sol::optional<int> indCountOpt, sol::optional<int> indElemOffsetOpt, sol::optional<int> instanceCountOpt, sol::optional<int> baseVertexOpt, sol::optional<int> instanceFirstOpt, sol::this_state L)
 {
+	if (LuaCommandLists::CommandList* cmdList = LuaCommandLists::GetRecording(L); cmdList != nullptr) {
+		constexpr GLint NO_ARG = LuaCommandLists::CommandList::NO_ARG;
+		cmdList->DrawElements(weak_from_this(), mode, {
+			indCountOpt.value_or(NO_ARG),
+			indElemOffsetOpt.value_or(NO_ARG),
+			instanceCountOpt.value_or(NO_ARG),
+			baseVertexOpt.value_or(NO_ARG),
+			instanceFirstOpt.value_or(NO_ARG)
+		});
+		return;
+	}
+
 	DrawCheckInput inputs{
 		indCountOpt,
 		baseVertexOpt,
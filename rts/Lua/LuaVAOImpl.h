@@ -15,7 +15,7 @@ class VAO;
 class VBO;
 class LuaVBOImpl;
 
-class LuaVAOImpl {
+class LuaVAOImpl : public std::enable_shared_from_this<LuaVAOImpl> {
 public:
 	LuaVAOImpl();
 
@@ -33,8 +33,9 @@ public:
 	void AttachInstanceBuffer(const LuaVBOImplSP& luaVBO);
 	void AttachIndexBuffer(const LuaVBOImplSP& luaVBO);
 
-	void DrawArrays(GLenum mode, sol::optional<int> vertCountOpt, sol::optional<int> vertexFirstOpt, sol::optional<int> instanceCountOpt, sol::optional<int> instanceFirstOpt);
-	void DrawElements(GLenum mode, sol::optional<int> indCountOpt, sol::optional<int> indElemOffsetOpt, sol::optional<int> instanceCountOpt, sol::optional<int> baseVertexOpt, sol::optional<int> instanceFirstOpt);
+	// recorded instead of drawn while a command list is being recorded
+	void DrawArrays(GLenum mode, sol::optional<int> vertCountOpt, sol::optional<int> vertexFirstOpt, sol::optional<int> instanceCountOpt, sol::optional<int> instanceFirstOpt, sol::this_state L);
+	void DrawElements(GLenum mode, sol::optional<int> indCountOpt, sol::optional<int> indElemOffsetOpt, sol::optional<int> instanceCountOpt, sol::optional<int> baseVertexOpt, sol::optional<int> instanceFirstOpt, sol::this_state L);
 
 	void ClearSubmission();
 	int AddUnitsToSubmission(int id);
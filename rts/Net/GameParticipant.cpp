@@ -22,7 +22,7 @@ GameParticipant::~GameParticipant()
 
 void GameParticipant::SendData(std::shared_ptr<const netcode::RawPacket> packet)
 {
-	if (clientLink != nullptr && myState != GameParticipant::State::DISCONNECTING)
+	if (clientLink != nullptr && myState != GameParticipant::State::DISCONNECTING && snapshotState != SNAPSHOT_SENT)
 		clientLink->SendData(packet);
 }
 
@@ -36,6 +36,9 @@ void GameParticipant::Connected(std::shared_ptr<netcode::CConnection> _link, boo
 	isLocal = local;
 	myState = CONNECTED;
 	lastFrameResponse = 0;
+
+	snapshotState = SNAPSHOT_NONE;
+	rejoinSnapshotFrame = -1;
 }
 
 void GameParticipant::Kill(const std::string& reason, const bool flush)
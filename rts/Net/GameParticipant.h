@@ -48,6 +48,20 @@ public:
 	bool isReconn = false;
 	bool isMidgameJoin = false;
 
+	enum SnapshotState {
+		SNAPSHOT_NONE,    // replays the game from the start, or has proven the snapshot
+		SNAPSHOT_SENT,    // nothing else is sent until the client answers with NETMSG_SNAPSHOT_LOADED
+		SNAPSHOT_LOADING, // loaded it, but sent no sync response for a frame at or past it yet
+	};
+	SnapshotState snapshotState = SNAPSHOT_NONE;
+
+	// frame of the rejoin snapshot this client was sent, -1 if it replayed the game
+	int rejoinSnapshotFrame = -1;
+	// packetCache index the snapshot was taken at
+	size_t rejoinCacheIndex = 0;
+	// set when a snapshot this client uploaded was dropped, see CGameServer::DropSnapshot
+	bool snapshotRejected = false;
+
 	PlayerStatistics lastStats;
 
 	spring_time disconnectDelay;
@@ -4,6 +4,7 @@
 #include "System/Net/UDPConnection.h"
 
 #include <functional>
+#include <cinttypes>
 
 #if defined DEDICATED || defined DEBUG
 	#include <iostream>
@@ -76,6 +77,10 @@ CONFIG(bool, ServerRecordDemos).defaultValue(false).dedicatedValue(true);
 CONFIG(bool, ServerLogInfoMessages).defaultValue(false);
 CONFIG(bool, ServerLogDebugMessages).defaultValue(false);
 CONFIG(std::string, AutohostIP).defaultValue("127.0.0.1");
+CONFIG(bool, ServerCompressSpectatorStreams).defaultValue(false).dedicatedValue(true)
+	.description("Whether the packet stream to remote spectators is sent zlib-compressed. Saves upload bandwidth with many spectators at the cost of some CPU time per spectator, players always get the uncompressed stream.");
+CONFIG(int, RejoinSnapshotInterval).defaultValue(0).minimumValue(0)
+	.description("Number of frames between the savestates the server requests from a spectator in sync, clients (re)joining a running game load the latest one instead of simulating it from the start. The server can only check that the uploader was in sync at the snapshot's frame, not the uploaded state itself; a snapshot is dropped as soon as a client it was sent to can not load it, leaves before it sent a sync response for a later frame, or desyncs. Such clients get the whole game instead. The spectator saves the game on its main thread. 0 disables.");
 
 
 // use the specific section for all LOG*() calls in this source file
@@ -110,6 +115,9 @@ static constexpr unsigned gameProgressFrameInterval = GAME_SPEED * 5;
 
 static constexpr unsigned syncResponseEchoInterval = GAME_SPEED * 2;
 
+/// size of the NETMSG_SNAPSHOT_DATA chunks sent to rejoining clients
+static constexpr uint32_t snapshotChunkSize = 8192;
+
 
 //FIXME remodularize server commands, so they get registered in word completion etc.
 decltype(CGameServer::commandBlacklist) CGameServer::commandBlacklist{
@@ -163,6 +171,12 @@ void CGameServer::Initialize()
 	whiteListAdditionalPlayers = configHandler->GetBool("WhiteListAdditionalPlayers");
 	logInfoMessages = configHandler->GetBool("ServerLogInfoMessages");
 	logDebugMessages = configHandler->GetBool("ServerLogDebugMessages");
+	compressSpectatorStreams = configHandler->GetBool("ServerCompressSpectatorStreams");
+#ifdef SYNCCHECK
+	// snapshots can only be trusted after checking them against the sync responses
+	snapshotInterval = configHandler->GetInt("RejoinSnapshotInterval");
+	nextSnapshotFrame = snapshotInterval;
+#endif
 
 	rng.Seed((myGameData->GetSetupText()).length());
 
@@ -262,7 +276,7 @@ void CGameServer::Initialize()
 
 	thread = spring::thread(std::bind(&CGameServer::UpdateLoop, this));
 
-	LOG("%s: thread affinity %x", __func__, Threading::GetAffinity());
+	LOG("%s: thread affinity %" PRIx64, __func__, Threading::GetAffinity());
 
 	// Something in CGameServer::CGameServer borks the FPU control word
 	// maybe the threading, or something in CNet::InitServer() ??
@@ -509,7 +523,8 @@ bool CGameServer::SendDemoData(int targetFrameNum)
 			case NETMSG_GAMEDATA:
 			case NETMSG_SETPLAYERNUM:
 			case NETMSG_USER_SPEED:
-			case NETMSG_INTERNAL_SPEED: {
+			case NETMSG_INTERNAL_SPEED:
+			case NETMSG_SNAPSHOT_REQUEST: {
 				// never send these from demos
 				break;
 			}
@@ -689,7 +704,14 @@ void CGameServer::CheckSync()
 
 			const unsigned pChecksum = pChecksumIt->second;
 
+			// the server never sees the state behind the uploader's checksum, the
+			// first sync response of a client that loaded the snapshot proves it
+			if (haveCorrectChecksum && pChecksum == correctChecksum && p.snapshotState == GameParticipant::SNAPSHOT_LOADING && outstandingSyncFrame >= p.rejoinSnapshotFrame)
+				p.snapshotState = GameParticipant::SNAPSHOT_NONE;
+
 			if ((p.desynced = (haveCorrectChecksum && pChecksum != correctChecksum))) {
+				DropSnapshot(p.id, "desynced after loading it");
+
 				if (demoReader || !p.spectator) {
 					desyncGroups[pChecksum].push_back(p.id);
 				} else {
@@ -762,6 +784,12 @@ void CGameServer::CheckSync()
 			}
 		}
 
+		if (completeResponseSet && haveCorrectChecksum && outstandingSyncFrame == pendingSnapshot.frameNum) {
+			pendingSnapshot.frameChecksum = correctChecksum;
+			pendingSnapshot.haveFrameChecksum = true;
+			CheckSnapshot();
+		}
+
 		// Remove complete sets (for which all player's checksums have been received).
 		if (completeResponseSet) {
 			for (GameParticipant& p: players) {
@@ -787,6 +815,144 @@ void CGameServer::CheckSync()
 }
 
 
+void CGameServer::RequestSnapshot()
+{
+	// rejoining clients are sent the packetCache after the snapshot
+	if (!canReconnect && !allowSpecJoin)
+		return;
+
+	int providerNum = -1;
+
+	// any spectator in sync that is not catching up can take it; players
+	// are never asked since saving the game stalls their client briefly
+	for (const GameParticipant& p: players) {
+		if (p.clientLink == nullptr || p.myState != GameParticipant::INGAME)
+			continue;
+		if (!p.spectator || p.desynced || p.isFromDemo || p.snapshotRejected)
+			continue;
+		if ((serverFrameNum - p.lastFrameResponse) > GAME_SPEED)
+			continue;
+
+		providerNum = p.id;
+		break;
+	}
+
+	if (providerNum == -1)
+		return;
+
+	// replaces an upload that has not finished by now
+	pendingSnapshot = {};
+	pendingSnapshot.Expect(providerNum, serverFrameNum);
+	pendingSnapshot.cacheIndex = packetCache.size();
+
+	// the request follows this frame's NEWFRAME through the provider's
+	// link, so the state includes exactly the first cacheIndex packets
+	players[providerNum].SendData(CBaseNetProtocol::Get().SendSnapshotRequest(serverFrameNum));
+}
+
+void CGameServer::CheckSnapshot()
+{
+	if (!pendingSnapshot.IsComplete() || !pendingSnapshot.haveFrameChecksum)
+		return;
+
+	const RejoinSnapshot& snapshot = pendingSnapshot;
+	const char* providerName = players[snapshot.playerNum].name.c_str();
+
+	if (snapshot.syncChecksum != snapshot.frameChecksum) {
+		Message(spring::format("Discarding snapshot of frame %d from %s: checksum %x does not match sync checksum %x", snapshot.frameNum, providerName, snapshot.syncChecksum, snapshot.frameChecksum), false);
+	} else if (!snapshot.CheckData()) {
+		Message(spring::format("Discarding snapshot of frame %d from %s: data checksum mismatch", snapshot.frameNum, providerName), false);
+	} else {
+		if (logInfoMessages)
+			Message(spring::format("Rejoining clients will load the snapshot of frame %d from %s (%u bytes)", snapshot.frameNum, providerName, snapshot.dataSize), false);
+
+		rejoinSnapshot = std::move(pendingSnapshot);
+	}
+
+	pendingSnapshot = {};
+}
+
+void CGameServer::DropSnapshot(int playerNum, const char* reason)
+{
+	const GameParticipant& player = players[playerNum];
+
+	// the snapshot the player was sent might be gone already
+	if (player.rejoinSnapshotFrame < 0 || player.rejoinSnapshotFrame != rejoinSnapshot.frameNum)
+		return;
+
+	GameParticipant& provider = players[rejoinSnapshot.playerNum];
+
+	Message(spring::format("Discarding snapshot of frame %d from %s: %s %s", rejoinSnapshot.frameNum, provider.name.c_str(), player.name.c_str(), reason), false);
+
+	// joining clients replay the whole game again until the next snapshot,
+	// which is never requested from the same client
+	provider.snapshotRejected = true;
+	rejoinSnapshot = {};
+}
+
+void CGameServer::CheckSnapshotLeaver(GameParticipant& player)
+{
+	// a client that fails to load the snapshot in its LoadScreen never gets to answer
+	if (player.snapshotState != GameParticipant::SNAPSHOT_NONE)
+		DropSnapshot(player.id, "left before it was in sync");
+
+	player.snapshotState = GameParticipant::SNAPSHOT_NONE;
+}
+
+void CGameServer::SnapshotLoaded(int playerNum, bool loaded)
+{
+	GameParticipant& player = players[playerNum];
+
+	if (loaded) {
+		player.snapshotState = GameParticipant::SNAPSHOT_LOADING;
+	} else {
+		DropSnapshot(playerNum, "could not load it");
+		Message(spring::format(" -> Sending the full game to %s", player.name.c_str()), false);
+
+		player.snapshotState = GameParticipant::SNAPSHOT_NONE;
+		player.rejoinSnapshotFrame = -1;
+	}
+
+	SendJoinData(player);
+	player.clientLink->Flush(false);
+}
+
+void CGameServer::SendJoinData(GameParticipant& player)
+{
+	const bool loadedSnapshot = (player.snapshotState == GameParticipant::SNAPSHOT_LOADING);
+
+	player.SendData(CBaseNetProtocol::Get().SendSetPlayerNum((unsigned char)player.id));
+
+	// after gamedata and playerNum, the player can start loading
+	if (demoReader == nullptr || myGameSetup->demoName.empty()) {
+		// player wants to play -> join team
+		if (!player.spectator) {
+			const unsigned newPlayerTeam = player.team;
+
+			if (!teams[newPlayerTeam].IsActive()) {
+				// create new team
+				player.SetReadyToStart(myGameSetup->startPosType != CGameSetup::StartPos_ChooseInGame);
+				teams[newPlayerTeam].SetActive(true);
+			}
+
+			Broadcast(CBaseNetProtocol::Get().SendJoinTeam(player.id, newPlayerTeam));
+		}
+	}
+
+	if (loadedSnapshot) {
+		// the snapshot does not contain what precedes the first frame
+		if (generatedGameID)
+			player.SendData(CBaseNetProtocol::Get().SendGameID(gameID.charArray));
+
+		player.SendData(CBaseNetProtocol::Get().SendStartPlaying(0));
+	}
+
+	// finally send player all packets he missed until now
+	for (size_t i = (loadedSnapshot? player.rejoinCacheIndex: 0); i < packetCache.size(); i++)
+		player.SendData(packetCache[i]);
+}
+
+
 float CGameServer::GetDemoTime() const {
 	if (!gameHasStarted) return gameTime;
 	return (startTime + serverFrameNum / float(GAME_SPEED));
@@ -1289,6 +1455,27 @@ void CGameServer::ProcessPacket(const unsigned playerNum, std::shared_ptr<const
 			}
 		} break;
 
+		case NETMSG_UNITCOMMANDS: {
+			try {
+				netcode::UnpackPacket pckt(packet, 3);
+				unsigned char playerNum;
+				pckt >> playerNum;
+
+				if (playerNum != a) {
+					Message(spring::format(WrongPlayer, msgCode , a , (unsigned) playerNum));
+					break;
+				}
+
+				// sent in place of NETMSG_AICOMMANDS, same rules
+				if (noHelperAIs)
+					Message(spring::format(NoHelperAI, players[a].name.c_str(), a));
+				else if (demoReader == nullptr)
+					Broadcast(packet); //forward data
+			} catch (const netcode::UnpackPacketException& ex) {
+				Message(spring::format("Player %s sent invalid UnitCommands: %s", players[a].name.c_str(), ex.what()));
+			}
+		} break;
+
 		case NETMSG_AISHARE: {
 			try {
 				netcode::UnpackPacket pckt(packet, 3);
@@ -1378,6 +1565,51 @@ void CGameServer::ProcessPacket(const unsigned playerNum, std::shared_ptr<const
 #endif
 		} break;
 
+		case NETMSG_SNAPSHOT_DATA: {
+			try {
+				netcode::UnpackPacket pckt(packet, 3);
+
+				uint8_t playerNum; pckt >> playerNum;
+
+				if (playerNum != a) {
+					Message(spring::format(WrongPlayer, msgCode, a, playerNum));
+					break;
+				}
+
+				// chunks of an upload that was replaced, or seen before (see ServerReadNet), are ignored
+				switch (pendingSnapshot.AddChunk(packet)) {
+					case CSnapshotData::CHUNK_ADDED: {
+						CheckSnapshot();
+					} break;
+					case CSnapshotData::CHUNK_INVALID: {
+						Message(spring::format("Discarding snapshot of frame %d from %s: invalid size or checksum", pendingSnapshot.frameNum, players[a].name.c_str()), false);
+						pendingSnapshot = {};
+					} break;
+					case CSnapshotData::CHUNK_IGNORED: {
+					} break;
+				}
+			} catch (const netcode::UnpackPacketException& ex) {
+				Message(spring::format("Player %s sent invalid SnapshotData: %s", players[a].name.c_str(), ex.what()));
+			}
+		} break;
+
+		case NETMSG_SNAPSHOT_LOADED: {
+			// seen more than once if bandwidth-limited (see ServerReadNet)
+			if (players[a].snapshotState != GameParticipant::SNAPSHOT_SENT)
+				break;
+
+			try {
+				netcode::UnpackPacket pckt(packet, 1);
+
+				int32_t frameNum; pckt >> frameNum;
+				uint8_t loaded; pckt >> loaded;
+
+				SnapshotLoaded(a, loaded != 0 && frameNum == players[a].rejoinSnapshotFrame);
+			} catch (const netcode::UnpackPacketException& ex) {
+				Message(spring::format("Player %s sent invalid SnapshotLoaded: %s", players[a].name.c_str(), ex.what()));
+			}
+		} break;
+
 		case NETMSG_SHARE:
 			if (inbuf[1] != a) {
 				Message(spring::format(WrongPlayer, msgCode, a, (unsigned)inbuf[1]));
@@ -1956,6 +2188,9 @@ void CGameServer::ServerReadNet()
 		spring::unordered_map<uint8_t, GameParticipant::ClientLinkData>& aiClientLinks = player.aiClientLinks;
 		std::array<uint8_t, MAX_AIS + 1> aiClientNumbers;
 
+		if (playerLink == nullptr || player.myState == GameParticipant::State::DISCONNECTING)
+			CheckSnapshotLeaver(player);
+
 		// if no link, player is not connected
 		if (playerLink == nullptr)
 			continue;
@@ -2038,7 +2273,7 @@ void CGameServer::ServerReadNet()
 				if (aiPacket == nullptr)
 					break;
 
-				const bool droppablePacket = (aiPacket->length <= 0 || (aiPacket->data[0] != NETMSG_SYNCRESPONSE && aiPacket->data[0] != NETMSG_KEYFRAME));
+				const bool droppablePacket = (aiPacket->length <= 0 || (aiPacket->data[0] != NETMSG_SYNCRESPONSE && aiPacket->data[0] != NETMSG_KEYFRAME && aiPacket->data[0] != NETMSG_SNAPSHOT_DATA && aiPacket->data[0] != NETMSG_SNAPSHOT_LOADED));
 
 				if (forcedDropPacket && droppablePacket) {
 					++numPktsDropped;
@@ -2678,6 +2913,13 @@ void CGameServer::CreateNewFrame(bool fromServerThread, bool fixedFrameTime)
 		#ifdef SYNCCHECK
 			outstandingSyncFrames.insert(serverFrameNum);
 		#endif
+
+			// clients reset their sync checksum after every 4096th frame, a
+			// snapshot taken then could not be matched against its response
+			if (snapshotInterval > 0 && serverFrameNum >= nextSnapshotFrame && (serverFrameNum & 4095) != 0) {
+				nextSnapshotFrame = serverFrameNum + snapshotInterval;
+				RequestSnapshot();
+			}
 		}
 	}
 }
@@ -2709,7 +2951,8 @@ void CGameServer::UpdateLoop()
 {
 	try {
 		Threading::SetThreadName("netcode");
-		Threading::SetAffinity(~0);
+		// keep off the sim thread's L3 domain where possible
+		Threading::SetAffinity(Threading::GetAffinityPlan().auxCores);
 
 		while (!quitServer) {
 			spring_msecs(loopSleepTime).sleep(true);
@@ -2725,7 +2968,7 @@ void CGameServer::UpdateLoop()
 		if (hostif != nullptr)
 			hostif->SendQuit();
 
-		LOG("%s: thread affinity %x", __func__, Threading::GetAffinity());
+		LOG("%s: thread affinity %" PRIx64, __func__, Threading::GetAffinity());
 
 		Broadcast(CBaseNetProtocol::Get().SendQuit("Server shutdown"));
 
@@ -2991,6 +3234,8 @@ unsigned CGameServer::BindConnection(
 		newPlayer.clientLink.reset();
 		newPlayer.Kill("Terminating connection");
 
+		CheckSnapshotLeaver(newPlayer);
+
 		if (hostif != nullptr)
 			hostif->SendPlayerLeft(newPlayerNumber, 0);
 	}
@@ -3015,29 +3260,44 @@ unsigned CGameServer::BindConnection(
 		return newPlayerNumber;
 	}
 
+	// clients joining a running game load the latest accepted snapshot
+	// and only need the packets cached since, instead of all of them
+	const bool sendSnapshot = (gameHasStarted && !isLocal && demoReader == nullptr && rejoinSnapshot.IsComplete());
+
 	newPlayer.Connected(clientLink, isLocal);
-	newPlayer.SendData(std::shared_ptr<const RawPacket>(myGameData->Pack()));
-	newPlayer.SendData(CBaseNetProtocol::Get().SendSetPlayerNum((unsigned char)newPlayerNumber));
 
-	// after gamedata and playerNum, the player can start loading
-	if (demoReader == nullptr || myGameSetup->demoName.empty()) {
-		// player wants to play -> join team
-		if (!newPlayer.spectator) {
-			const unsigned newPlayerTeam = newPlayer.team;
+	// spectators can take some extra delay, but get the same (large) stream as players
+	if (compressSpectatorStreams && newPlayer.spectator && !isLocal)
+		clientLink->SetStreamCompression(true);
 
-			if (!teams[newPlayerTeam].IsActive()) {
-				// create new team
-				newPlayer.SetReadyToStart(myGameSetup->startPosType != CGameSetup::StartPos_ChooseInGame);
-				teams[newPlayerTeam].SetActive(true);
-			}
+	newPlayer.SendData(std::shared_ptr<const RawPacket>(myGameData->Pack()));
 
-			Broadcast(CBaseNetProtocol::Get().SendJoinTeam(newPlayerNumber, newPlayerTeam));
+	if (sendSnapshot) {
+		Message(spring::format(" -> Sending snapshot of frame %d (%u bytes)", rejoinSnapshot.frameNum, rejoinSnapshot.dataSize), false);
+
+		for (uint32_t offset = 0; offset < rejoinSnapshot.dataSize; offset += snapshotChunkSize) {
+			const auto chunkBeg = rejoinSnapshot.data.begin() + offset;
+			const auto chunkEnd = chunkBeg + std::min(snapshotChunkSize, rejoinSnapshot.dataSize - offset);
+
+			newPlayer.SendData(CBaseNetProtocol::Get().SendSnapshotData(
+				rejoinSnapshot.playerNum,
+				rejoinSnapshot.frameNum,
+				rejoinSnapshot.syncChecksum,
+				rejoinSnapshot.dataChecksum,
+				rejoinSnapshot.dataSize,
+				offset,
+				{chunkBeg, chunkEnd}
+			));
 		}
-	}
 
-	// finally send player all packets he missed until now
-	for (const std::shared_ptr<const netcode::RawPacket>& p: packetCache)
-		newPlayer.SendData(p);
+		// the rest follows once the client answers whether it could load
+		// the snapshot, from its packetCache index or from the start
+		newPlayer.snapshotState = GameParticipant::SNAPSHOT_SENT;
+		newPlayer.rejoinSnapshotFrame = rejoinSnapshot.frameNum;
+		newPlayer.rejoinCacheIndex = rejoinSnapshot.cacheIndex;
+	} else {
+		SendJoinData(newPlayer);
+	}
 
 	// new connection established
 	Message(spring::format(" -> Connection established (given id %i)", newPlayerNumber));
@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "Game/GameData.h"
+#include "Net/Protocol/SnapshotData.h"
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/TeamBase.h"
 #include "System/float3.h"
@@ -161,6 +162,18 @@ private:
 	void Update();
 	void ProcessPacket(const unsigned playerNum, std::shared_ptr<const netcode::RawPacket> packet);
 	void CheckSync();
+	/// asks a client in sync for a savestate of the current frame
+	void RequestSnapshot();
+	/// keeps a completely uploaded snapshot if it matches its frame's sync checksum
+	void CheckSnapshot();
+	/// stops sending rejoinSnapshot after a client it was sent to failed on it
+	void DropSnapshot(int playerNum, const char* reason);
+	/// drops the snapshot if the player leaves before proving it, see GameParticipant::SnapshotState
+	void CheckSnapshotLeaver(GameParticipant& player);
+	/// completes the join withheld until the client answered whether the snapshot loaded
+	void SnapshotLoaded(int playerNum, bool loaded);
+	/// everything after NETMSG_GAMEDATA and the snapshot a joining client needs to load the game
+	void SendJoinData(GameParticipant& player);
 	void HandleConnectionAttempts();
 	void ServerReadNet();
 
@@ -228,6 +241,25 @@ private:
 	std::set<int> outstandingSyncFrames;
 #endif
 
+	/////////////////// rejoin snapshots ///////////////////
+	struct RejoinSnapshot: public CSnapshotData {
+		// checksum all clients agreed on for frameNum, set by CheckSync
+		uint32_t frameChecksum = 0;
+		bool haveFrameChecksum = false;
+
+		// packetCache entries below this index are contained in the state
+		size_t cacheIndex = 0;
+	};
+
+	/// being uploaded by the client it was requested from
+	RejoinSnapshot pendingSnapshot;
+	/// last snapshot whose uploader was in sync and that no client failed on yet,
+	/// sent to clients joining the running game
+	RejoinSnapshot rejoinSnapshot;
+
+	int snapshotInterval = 0;
+	int nextSnapshotFrame = 0;
+
 	/////////////////// game status variables ///////////////////
 	spring_time serverStartTime = spring_gettime();
 	spring_time readyTime = spring_notime;
@@ -280,6 +312,7 @@ private:
 
 	bool logInfoMessages = false;
 	bool logDebugMessages = false;
+	bool compressSpectatorStreams = false;
 
 
 	/// If the server receives a command, it will forward it to clients if it is not in this set
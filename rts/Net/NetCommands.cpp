@@ -22,6 +22,7 @@
 #include "Game/UI/MouseHandler.h"
 #include "Lua/LuaHandle.h"
 #include "Net/Protocol/NetProtocol.h"
+#include "Net/Protocol/SnapshotData.h"
 #include "Rendering/GlobalRendering.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/TeamHandler.h"
@@ -32,11 +33,16 @@
 #include "System/GlobalConfig.h"
 #include "System/Log/ILog.h"
 #include "System/SpringMath.h"
+#include "System/StringUtil.h"
 #include "System/TimeProfiler.h"
+#include "System/LoadSave/CregLoadSaveHandler.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/Net/UnpackPacket.h"
+#include "System/Net/VarIntCoding.h"
 #include "System/Sound/ISound.h"
 #include "System/Sync/DumpState.h"
+#include "System/Sync/SyncChecker.h"
+#include "System/Threading/ThreadPool.h"
 
 #include "System/Misc/TracyDefs.h"
 
@@ -255,6 +261,79 @@ float CGame::GetNetMessageProcessingTimeLimit() const
 	return std::clamp(simDrawRatio * gu->avgSimFrameTime, 5.0f, 1000.0f / globalConfig.minDrawFPS);
 }
 
+void CGame::SaveSnapshot(int32_t frameNum)
+{
+	ZoneScoped;
+
+	CCregLoadSaveHandler saveHandler;
+	std::shared_ptr<std::string> state = std::make_shared<std::string>();
+
+	saveHandler.SaveInfo(gameSetup->mapName, gameSetup->modName);
+
+	if (!saveHandler.SaveSnapshot(*state))
+		return;
+
+	LOG_L(L_INFO, "[Game::%s] saved snapshot of frame %d for rejoining clients (%u bytes)", __func__, frameNum, uint32_t(state->size()));
+
+	// replaces any upload still in progress, the server only wants the latest
+	snapshotUpload = {};
+	snapshotUpload.frameNum = frameNum;
+#ifdef SYNCCHECK
+	snapshotUpload.syncChecksum = CSyncChecker::GetChecksum();
+#endif
+	snapshotUpload.job = ThreadPool::Enqueue([state]() {
+		return zlib::deflate(reinterpret_cast<const uint8_t*>(state->data()), state->size());
+	});
+}
+
+void CGame::SendSnapshotData()
+{
+	if (snapshotUpload.job != nullptr) {
+		if (snapshotUpload.job->wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return;
+
+		snapshotUpload.data = snapshotUpload.job->get();
+		snapshotUpload.dataChecksum = CSnapshotData::GetChecksum(snapshotUpload.data);
+		snapshotUpload.job.reset();
+
+		if (snapshotUpload.data.empty()) {
+			LOG_L(L_ERROR, "[Game::%s] could not compress snapshot of frame %d", __func__, snapshotUpload.frameNum);
+			return;
+		}
+	}
+
+	if (snapshotUpload.dataOffset >= snapshotUpload.data.size())
+		return;
+
+	// one chunk per sim-frame, using at most half of the outgoing bandwidth
+	// at normal speed so the upload does not delay this client's own traffic
+	constexpr uint32_t maxChunkSize = 8192;
+	constexpr uint32_t minChunkSize = 256;
+
+	const uint32_t bandwidthChunkSize = (globalConfig.linkOutgoingBandwidth > 0)? (globalConfig.linkOutgoingBandwidth / (2 * GAME_SPEED)): maxChunkSize;
+	const uint32_t chunkSize = std::min(std::clamp(bandwidthChunkSize, minChunkSize, maxChunkSize), uint32_t(snapshotUpload.data.size()) - snapshotUpload.dataOffset);
+
+	const auto chunkBeg = snapshotUpload.data.begin() + snapshotUpload.dataOffset;
+	const std::vector<uint8_t> chunk(chunkBeg, chunkBeg + chunkSize);
+
+	clientNet->Send(CBaseNetProtocol::Get().SendSnapshotData(
+		gu->myPlayerNum,
+		snapshotUpload.frameNum,
+		snapshotUpload.syncChecksum,
+		snapshotUpload.dataChecksum,
+		snapshotUpload.data.size(),
+		snapshotUpload.dataOffset,
+		chunk
+	));
+
+	if ((snapshotUpload.dataOffset += chunkSize) < snapshotUpload.data.size())
+		return;
+
+	// all sent, the server keeps it from here
+	snapshotUpload = {};
+}
+
+
 void CGame::ClientReadNet()
 {
 	// first look ahead so we can adapt consumeSpeedMult to network fluctuations
@@ -630,6 +709,25 @@ void CGame::ClientReadNet()
 				if ((gs->frameNum & 4095) == 0)
 					CSyncChecker::NewFrame();
 #endif
+				SendSnapshotData();
+				AddTraffic(-1, packetCode, dataLength);
+			} break;
+
+			case NETMSG_SNAPSHOT_REQUEST: {
+				ZoneScopedN("Net::SnapshotRequest");
+				const int32_t frameNum = *reinterpret_cast<const int32_t*>(inbuf + 1);
+
+				// saving stalls the sim, only spectators take snapshots
+				if (!gu->spectating)
+					break;
+
+				// the server sends this right behind the frame it wants saved
+				if (frameNum != gs->frameNum) {
+					LOG_L(L_WARNING, "[Game::%s][NETMSG_SNAPSHOT_REQUEST] requested frame %d but at frame %d", __func__, frameNum, gs->frameNum);
+					break;
+				}
+
+				SaveSnapshot(frameNum);
 				AddTraffic(-1, packetCode, dataLength);
 			} break;
 
@@ -883,6 +981,60 @@ void CGame::ClientReadNet()
 				}
 			} break;
 
+			case NETMSG_UNITCOMMANDS: {
+				ZoneScopedN("Net::UnitCommands");
+				try {
+					netcode::UnpackPacket pckt(packet, 3);
+
+					uint8_t playerID;
+					int32_t cmdID;
+					uint8_t cmdOpt;
+					uint8_t paramCount;
+					uint16_t unitCount;
+
+					pckt >> playerID;
+
+					if (!playerHandler.IsValidPlayer(playerID))
+						throw netcode::UnpackPacketException("Invalid player number");
+
+					pckt >> cmdID;
+					pckt >> cmdOpt;
+					pckt >> paramCount;
+					pckt >> unitCount;
+
+					std::vector<int32_t> prevParams(paramCount, 0);
+					uint16_t unitID = 0;
+
+					// parse everything before applying anything, like NETMSG_AICOMMANDS
+					std::vector<int32_t> unitIDs;
+					std::vector<Command> commands;
+
+					unitIDs.reserve(unitCount);
+					commands.reserve(unitCount);
+
+					for (uint16_t u = 0; u < unitCount; u++) {
+						// sent as int16_t deltas, wraps like them
+						unitID += static_cast<uint16_t>(netcode::ZigZagDecode(netcode::UnpackVarInt(pckt)));
+
+						Command cmd(cmdID, cmdOpt);
+
+						for (uint8_t p = 0; p < paramCount; p++) {
+							cmd.PushParam(netcode::UnpackDeltaFloat(pckt, prevParams[p]));
+						}
+
+						unitIDs.push_back(static_cast<int16_t>(unitID));
+						commands.push_back(cmd);
+					}
+
+					for (uint16_t u = 0; u < unitCount; u++) {
+						selectedUnitsHandler.AINetOrder(unitIDs[u], MAX_TEAMS, playerID, commands[u]);
+					}
+					AddTraffic(playerID, packetCode, dataLength);
+				} catch (const netcode::UnpackPacketException& ex) {
+					LOG_L(L_ERROR, "[Game::%s][NETMSG_UNITCOMMANDS] exception \"%s\"", __func__, ex.what());
+				}
+			} break;
+
 			case NETMSG_AISHARE: {
 				ZoneScopedN("Net::AIShare");
 				try {
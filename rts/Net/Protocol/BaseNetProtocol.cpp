@@ -7,6 +7,7 @@
 #include "System/Net/RawPacket.h"
 #include "System/Net/PackPacket.h"
 #include "System/Net/ProtocolDef.h"
+#include "System/Net/VarIntCoding.h"
 #include <cinttypes>
 
 using netcode::PackPacket;
@@ -176,6 +177,45 @@ PacketType CBaseNetProtocol::SendAICommand(
 	return PacketType(packet);
 }
 
+PacketType CBaseNetProtocol::SendUnitCommands(
+	uint8_t playerNum,
+	int32_t commandID,
+	uint8_t options,
+	uint8_t numParams,
+	const std::vector<int16_t>& unitIDs,
+	const std::vector<float>& params
+) {
+	assert(params.size() == (unitIDs.size() * numParams));
+
+	std::vector<uint8_t> unitData;
+	std::vector<int32_t> prevParams(numParams, 0);
+
+	// neighbouring orders of a batch tend to differ only a little, store the deltas
+	unitData.reserve(unitIDs.size() * (1 + numParams * 2));
+
+	for (size_t i = 0, n = unitIDs.size(); i < n; i++) {
+		netcode::PackVarInt(unitData, netcode::ZigZagEncode(unitIDs[i] - ((i > 0)? unitIDs[i - 1]: 0)));
+
+		for (uint8_t j = 0; j < numParams; j++) {
+			netcode::PackDeltaFloat(unitData, params[i * numParams + j], prevParams[j]);
+		}
+	}
+
+	const uint16_t unitCount = unitIDs.size();
+
+	const uint32_t payloadSize = sizeof(playerNum) + sizeof(commandID) + sizeof(options) + sizeof(numParams) + sizeof(unitCount) + unitData.size();
+	const uint32_t headerSize = sizeof(uint8_t) + sizeof(uint16_t);
+	const uint32_t packetSize = headerSize + payloadSize;
+
+	// every unit takes at least one byte, so this also covers unitCount
+	if (packetSize >= (1 << (sizeof(uint16_t) * 8)))
+		throw netcode::PackPacketException("[BaseNetProto::SendUnitCommands] maximum packet-size exceeded");
+
+	PackPacket* packet = new PackPacket(packetSize, NETMSG_UNITCOMMANDS);
+	*packet << static_cast<uint16_t>(packetSize) << playerNum << commandID << options << numParams << unitCount << unitData;
+	return PacketType(packet);
+}
+
 PacketType CBaseNetProtocol::SendAIShare(
 	uint8_t playerNum,
 	uint8_t aiID,
@@ -543,6 +583,34 @@ PacketType CBaseNetProtocol::SendPing(uint8_t playerNum, uint8_t pingTag, float
 	return PacketType(packet);
 }
 
+PacketType CBaseNetProtocol::SendSnapshotRequest(int32_t frameNum)
+{
+	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(frameNum), NETMSG_SNAPSHOT_REQUEST);
+	*packet << frameNum;
+	return PacketType(packet);
+}
+
+PacketType CBaseNetProtocol::SendSnapshotData(uint8_t playerNum, int32_t frameNum, uint32_t syncChecksum, uint32_t dataChecksum, uint32_t dataSize, uint32_t dataOffset, const std::vector<uint8_t>& data)
+{
+	const uint32_t payloadSize = sizeof(playerNum) + sizeof(frameNum) + sizeof(syncChecksum) + sizeof(dataChecksum) + sizeof(dataSize) + sizeof(dataOffset) + data.size();
+	const uint32_t headerSize = sizeof(uint8_t) + sizeof(uint16_t);
+	const uint32_t packetSize = headerSize + payloadSize;
+
+	if (packetSize >= (1 << (sizeof(uint16_t) * 8)))
+		throw netcode::PackPacketException("[BaseNetProto::SendSnapshotData] maximum packet-size exceeded");
+
+	PackPacket* packet = new PackPacket(packetSize, NETMSG_SNAPSHOT_DATA);
+	*packet << static_cast<uint16_t>(packetSize) << playerNum << frameNum << syncChecksum << dataChecksum << dataSize << dataOffset << data;
+	return PacketType(packet);
+}
+
+PacketType CBaseNetProtocol::SendSnapshotLoaded(int32_t frameNum, uint8_t loaded)
+{
+	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(frameNum) + sizeof(loaded), NETMSG_SNAPSHOT_LOADED);
+	*packet << frameNum << loaded;
+	return PacketType(packet);
+}
+
 
 PacketType CBaseNetProtocol::SendClientData(uint8_t playerNum, const std::vector<uint8_t>& data)
 {
@@ -671,6 +739,11 @@ CBaseNetProtocol::CBaseNetProtocol()
 	proto->AddType(NETMSG_AI_STATE_CHANGED, 4);
 	proto->AddType(NETMSG_GAME_FRAME_PROGRESS, 5);
 	proto->AddType(NETMSG_PING, 1 + (1 + 1 + 4));
+	proto->AddType(NETMSG_SNAPSHOT_REQUEST, 5);
+	proto->AddType(NETMSG_SNAPSHOT_DATA, -2);
+	proto->AddType(NETMSG_UNITCOMMANDS, -2);
+	proto->AddType(NETMSG_STREAM_BUNDLE, -2);
+	proto->AddType(NETMSG_SNAPSHOT_LOADED, 6);
 
 #ifdef SYNCDEBUG
 	proto->AddType(NETMSG_SD_CHKREQUEST, 5);
@@ -56,6 +56,7 @@ public:
 
 	PacketType SendCommand(uint8_t playerNum, int32_t commandID, int32_t timeout, uint8_t options, uint32_t numParams, const float* params);
 	PacketType SendAICommand(uint8_t playerNum, uint8_t aiInstID, uint8_t aiTeamID, int16_t unitID, int32_t commandID, int32_t aiCommandID, int32_t timeout, uint8_t options, uint32_t numParams, const float* params);
+	PacketType SendUnitCommands(uint8_t playerNum, int32_t commandID, uint8_t options, uint8_t numParams, const std::vector<int16_t>& unitIDs, const std::vector<float>& params);
 	PacketType SendAIShare(uint8_t playerNum, uint8_t aiID, uint8_t sourceTeam, uint8_t destTeam, float metal, float energy, const std::vector<int16_t>& unitIDs);
 
 	PacketType SendUserSpeed(uint8_t playerNum, float userSpeed);
@@ -82,6 +83,9 @@ public:
 	PacketType SendLuaMsg(uint8_t playerNum, uint16_t script, uint8_t mode, const std::vector<uint8_t>& rawData);
 	PacketType SendCurrentFrameProgress(int32_t frameNum);
 	PacketType SendPing(uint8_t playerNum, uint8_t pingTag, float localTime);
+	PacketType SendSnapshotRequest(int32_t frameNum);
+	PacketType SendSnapshotData(uint8_t playerNum, int32_t frameNum, uint32_t syncChecksum, uint32_t dataChecksum, uint32_t dataSize, uint32_t dataOffset, const std::vector<uint8_t>& data);
+	PacketType SendSnapshotLoaded(int32_t frameNum, uint8_t loaded);
 
 	PacketType SendPlayerStat(uint8_t playerNum, const PlayerStatistics& currentStats);
 	PacketType SendTeamStat(uint8_t teamNum, const TeamStatistics& currentStats);
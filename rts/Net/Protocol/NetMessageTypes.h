@@ -95,6 +95,16 @@ enum NETMSG {
 
 	NETMSG_PING = 78, // uint8_t playerNum, uint8_t pingTag, float localTime
 
+	NETMSG_SNAPSHOT_REQUEST = 79, // int32_t frameNum # server asks one client for a savestate of this frame, used to rejoin other clients #
+	NETMSG_SNAPSHOT_DATA    = 80, // uint16_t messageSize, uint8_t playerNum, int32_t frameNum, uint32_t syncChecksum, uint32_t dataChecksum, uint32_t dataSize, uint32_t dataOffset, std::vector<uint8_t> data
+
+	NETMSG_UNITCOMMANDS     = 81, // uint16_t messageSize, uint8_t playerNum, int32_t id, uint8_t options, uint8_t numParams, uint16_t unitCount;
+	                              // unitCount * { varint unitIDDelta; numParams * deltaFloat param } # one order per unit, see VarIntCoding.h #
+
+	NETMSG_STREAM_BUNDLE    = 82, // uint16_t messageSize, std::vector<uint8_t> deflatedPackets # packets compressed by the sending UDPConnection, see SetStreamCompression #
+
+	NETMSG_SNAPSHOT_LOADED  = 83, // int32_t frameNum, uint8_t loaded # joining client checked the snapshot the server sent, it gets the full packetCache if not loaded #
+
 	NETMSG_LAST //max types of netmessages, internal only
 };
 
@@ -135,6 +135,9 @@ std::shared_ptr<const netcode::RawPacket> CNetProtocol::GetData(int frameNum)
 		return ret;
 	if (ret->data[0] == NETMSG_GAMEDATA)
 		return ret;
+	// addressed to this client only, a demo viewer would upload a snapshot
+	if (ret->data[0] == NETMSG_SNAPSHOT_REQUEST)
+		return ret;
 
 	if (demoRecordPtr->IsValid())
 		demoRecordPtr->SaveToDemo(ret->data, ret->length, GetPacketTime(frameNum));
@@ -155,6 +158,7 @@ __FORCE_ALIGN_STACK__
 void CNetProtocol::UpdateLoop()
 {
 	Threading::SetThreadName("heartbeat");
+	Threading::SetAffinity(Threading::GetAffinityPlan().auxCores);
 
 	while (keepUpdating) {
 		Update();
@@ -0,0 +1,86 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "SnapshotData.h"
+
+#include "System/SpringHash.h"
+#include "System/Net/RawPacket.h"
+#include "System/Net/UnpackPacket.h"
+
+
+void CSnapshotData::Expect(int playerNum, int frameNum)
+{
+	*this = {};
+
+	this->playerNum = playerNum;
+	this->frameNum = frameNum;
+}
+
+void CSnapshotData::ExpectAny()
+{
+	*this = {};
+
+	anySource = true;
+}
+
+CSnapshotData::ChunkResult CSnapshotData::AddChunk(std::shared_ptr<const netcode::RawPacket> packet)
+{
+	netcode::UnpackPacket pckt(packet, 3);
+
+	uint8_t chunkPlayerNum;
+	int32_t chunkFrameNum;
+	uint32_t chunkSyncChecksum;
+	uint32_t chunkDataChecksum;
+	uint32_t chunkDataSize;
+	uint32_t chunkDataOffset;
+
+	pckt >> chunkPlayerNum;
+	pckt >> chunkFrameNum;
+	pckt >> chunkSyncChecksum;
+	pckt >> chunkDataChecksum;
+	pckt >> chunkDataSize;
+	pckt >> chunkDataOffset;
+
+	constexpr uint32_t headerSize = 3 + sizeof(chunkPlayerNum) + sizeof(chunkFrameNum) + sizeof(chunkSyncChecksum) + sizeof(chunkDataChecksum) + sizeof(chunkDataSize) + sizeof(chunkDataOffset);
+
+	// the header was read in full, so the remainder can not underflow
+	const uint32_t chunkSize = packet->length - headerSize;
+
+	if (!anySource && (chunkPlayerNum != playerNum || chunkFrameNum != frameNum))
+		return CHUNK_IGNORED;
+	if (chunkDataOffset != data.size())
+		return CHUNK_IGNORED;
+
+	if (data.empty()) {
+		if (chunkDataSize == 0 || chunkDataSize > MAX_DATA_SIZE)
+			return CHUNK_INVALID;
+
+		playerNum = chunkPlayerNum;
+		frameNum = chunkFrameNum;
+		syncChecksum = chunkSyncChecksum;
+		dataChecksum = chunkDataChecksum;
+		dataSize = chunkDataSize;
+		anySource = false;
+	} else if (chunkDataSize != dataSize || chunkSyncChecksum != syncChecksum || chunkDataChecksum != dataChecksum) {
+		return CHUNK_INVALID;
+	}
+
+	if (chunkSize > (dataSize - data.size()))
+		return CHUNK_INVALID;
+
+	std::vector<uint8_t> chunk(chunkSize);
+	pckt >> chunk;
+
+	data.insert(data.end(), chunk.begin(), chunk.end());
+	return CHUNK_ADDED;
+}
+
+bool CSnapshotData::CheckData() const
+{
+	return (IsComplete() && GetChecksum(data) == dataChecksum);
+}
+
+uint32_t CSnapshotData::GetChecksum(const std::vector<uint8_t>& data)
+{
+	// with two arguments LiteHash(const T*, cs0) would only hash the first byte
+	return spring::LiteHash(data.data(), static_cast<uint32_t>(data.size()), 0);
+}
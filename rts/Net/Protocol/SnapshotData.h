@@ -0,0 +1,69 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _SNAPSHOT_DATA_H
+#define _SNAPSHOT_DATA_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace netcode
+{
+	class RawPacket;
+}
+
+/**
+ * @brief Reassembles a rejoin snapshot from its NETMSG_SNAPSHOT_DATA chunks.
+ *
+ * Used by the server for uploads from the client it requested the snapshot
+ * from, and by joining clients for the snapshot the server sends them.
+ */
+class CSnapshotData
+{
+public:
+	/// largest (compressed) snapshot accepted, announced sizes above are invalid
+	static constexpr uint32_t MAX_DATA_SIZE = 256 * 1024 * 1024;
+
+	enum ChunkResult {
+		CHUNK_ADDED,   ///< appended to data
+		CHUNK_IGNORED, ///< belongs to another snapshot, or does not continue this one
+		CHUNK_INVALID, ///< does not fit the announced size or checksums, discard the snapshot
+	};
+
+	/// waits for the snapshot of frameNum uploaded by playerNum
+	void Expect(int playerNum, int frameNum);
+	/// waits for whichever snapshot starts first, as joining clients do
+	void ExpectAny();
+
+	/**
+	 * Appends the chunk carried by packet if it continues this snapshot.
+	 * Size and checksums are taken from the first chunk, later chunks
+	 * announcing different ones are invalid. A default-constructed
+	 * instance ignores all chunks.
+	 * @throws netcode::UnpackPacketException on truncated packets
+	 */
+	ChunkResult AddChunk(std::shared_ptr<const netcode::RawPacket> packet);
+
+	bool IsComplete() const { return (dataSize > 0 && data.size() == dataSize); }
+	bool IsEmpty() const { return data.empty(); }
+	/// true if the complete data hashes to the dataChecksum announced with it
+	bool CheckData() const;
+
+	/// dataChecksum the uploader announces for data
+	static uint32_t GetChecksum(const std::vector<uint8_t>& data);
+
+public:
+	std::vector<uint8_t> data;
+
+	int playerNum = -1;
+	int frameNum = -1;
+
+	uint32_t syncChecksum = 0;
+	uint32_t dataChecksum = 0;
+	uint32_t dataSize = 0;
+
+private:
+	bool anySource = false;
+};
+
+#endif // _SNAPSHOT_DATA_H
@@ -0,0 +1,155 @@
+#include "FrustumCuller.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "Game/CameraHandler.h"
+#include "System/Threading/ThreadPool.h"
+
+#include "System/Misc/TracyDefs.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define FRUSTUM_CULLER_SSE
+	#include <emmintrin.h>
+#endif
+
+namespace {
+	// 6 planes as SoA; disabled planes get a zero normal and +max offset so they always pass
+	struct CullPlanes {
+		alignas(16) std::array<float, CCamera::FRUSTUM_PLANE_CNT> nx;
+		alignas(16) std::array<float, CCamera::FRUSTUM_PLANE_CNT> ny;
+		alignas(16) std::array<float, CCamera::FRUSTUM_PLANE_CNT> nz;
+		alignas(16) std::array<float, CCamera::FRUSTUM_PLANE_CNT> d;
+	};
+
+	CullPlanes GetCullPlanes(const CCamera* cam) {
+		const CCamera::Frustum& frustum = cam->GetFrustum();
+		const uint8_t planesMask = cam->GetInViewPlanesMask();
+
+		CullPlanes cp;
+
+		for (size_t i = 0; i < CCamera::FRUSTUM_PLANE_CNT; i++) {
+			const float4& plane = frustum.planes[i];
+			const bool enabled = ((planesMask & (1 << i)) != 0);
+
+			cp.nx[i] = plane.x * enabled;
+			cp.ny[i] = plane.y * enabled;
+			cp.nz[i] = plane.z * enabled;
+			cp.d [i] = enabled? plane.w: std::numeric_limits<float>::max();
+		}
+
+		return cp;
+	}
+}
+
+
+void CFrustumCuller::Resize(size_t n)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const size_t numWords = (n + WORD_BITS - 1) / WORD_BITS;
+	const size_t numSlots = numWords * WORD_BITS;
+
+	numObjects = n;
+
+	posx.resize(numSlots);
+	posy.resize(numSlots);
+	posz.resize(numSlots);
+	rads.resize(numSlots);
+
+	std::fill(rads.begin() + n, rads.end(), -std::numeric_limits<float>::infinity());
+
+	for (auto& bits: visBits) {
+		bits.assign(numWords, 0);
+	}
+}
+
+void CFrustumCuller::Cull(uint32_t camTypeMask, bool mt)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// words per task; 64 words cover 4096 objects
+	static constexpr int TASK_WORDS = 64;
+
+	std::array<CullPlanes, NUM_CAMERAS> camPlanes;
+	std::array<uint32_t, NUM_CAMERAS> camTypes;
+
+	uint32_t numCams = 0;
+
+	for (uint32_t camType = 0; camType < NUM_CAMERAS; camType++) {
+		if ((camTypeMask & (1 << camType)) == 0) {
+			std::fill(visBits[camType].begin(), visBits[camType].end(), 0);
+			continue;
+		}
+
+		camPlanes[numCams] = GetCullPlanes(CCameraHandler::GetCamera(camType));
+		camTypes[numCams++] = camType;
+	}
+
+	if (numCams == 0)
+		return;
+
+	const int numWords = posx.size() / WORD_BITS;
+	const int numTasks = (numWords + TASK_WORDS - 1) / TASK_WORDS;
+
+	const auto CullWords = [&](int task) {
+		for (int w = task * TASK_WORDS, e = std::min(numWords, w + TASK_WORDS); w < e; w++) {
+			std::array<uint64_t, NUM_CAMERAS> words = {};
+
+		#ifdef FRUSTUM_CULLER_SSE
+			for (size_t i = 0; i < WORD_BITS; i += 4) {
+				const size_t k = w * WORD_BITS + i;
+
+				const __m128 x = _mm_loadu_ps(&posx[k]);
+				const __m128 y = _mm_loadu_ps(&posy[k]);
+				const __m128 z = _mm_loadu_ps(&posz[k]);
+				const __m128 r = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&rads[k]));
+
+				for (uint32_t c = 0; c < numCams; c++) {
+					const CullPlanes& cp = camPlanes[c];
+
+					__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+					for (size_t p = 0; p < CCamera::FRUSTUM_PLANE_CNT; p++) {
+						__m128 dist = _mm_mul_ps(x, _mm_set1_ps(cp.nx[p]));
+						dist = _mm_add_ps(dist, _mm_mul_ps(y, _mm_set1_ps(cp.ny[p])));
+						dist = _mm_add_ps(dist, _mm_mul_ps(z, _mm_set1_ps(cp.nz[p])));
+						dist = _mm_add_ps(dist, _mm_set1_ps(cp.d[p]));
+
+						// same test as Frustum::IntersectSphere, outside iff dist < -radius
+						inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, r));
+					}
+
+					words[c] |= (uint64_t(_mm_movemask_ps(inside)) << i);
+				}
+			}
+		#else
+			for (size_t i = 0; i < WORD_BITS; i++) {
+				const size_t k = w * WORD_BITS + i;
+
+				for (uint32_t c = 0; c < numCams; c++) {
+					const CullPlanes& cp = camPlanes[c];
+
+					bool inside = true;
+
+					for (size_t p = 0; p < CCamera::FRUSTUM_PLANE_CNT; p++) {
+						inside &= ((posx[k] * cp.nx[p] + posy[k] * cp.ny[p] + posz[k] * cp.nz[p] + cp.d[p]) >= -rads[k]);
+					}
+
+					words[c] |= (uint64_t(inside) << i);
+				}
+			}
+		#endif
+
+			for (uint32_t c = 0; c < numCams; c++) {
+				visBits[camTypes[c]][w] = words[c];
+			}
+		}
+	};
+
+	if (mt && numTasks > 1) {
+		for_mt(0, numTasks, CullWords);
+	} else {
+		for (int task = 0; task < numTasks; task++) {
+			CullWords(task);
+		}
+	}
+}
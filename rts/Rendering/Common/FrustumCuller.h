@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Game/Camera.h"
+#include "System/float3.h"
+
+/**
+ * Batched replacement for per-object CCamera::InView(pos, radius) calls.
+ * Owners write one bounding sphere per object into packed arrays, Cull()
+ * tests all of them against the frustum planes of every requested camera
+ * in one (SSE) pass, and the draw-flag updates read the result back from
+ * one visibility bitset per camera. Object indices are whatever the owner
+ * uses, typically the position in its object list for this frame.
+ */
+class CFrustumCuller {
+public:
+	// cameras that get a bitset; the drawers only cull against these
+	static constexpr uint32_t NUM_CAMERAS = CCamera::CAMTYPE_ENVMAP;
+
+	// resizes the sphere arrays and invalidates all bitsets
+	void Resize(size_t numObjects);
+
+	void SetSphere(size_t i, const float3& pos, float radius) {
+		posx[i] = pos.x;
+		posy[i] = pos.y;
+		posz[i] = pos.z;
+		rads[i] = radius;
+	}
+
+	// tests every sphere against the cameras whose bit is set in <camTypeMask>
+	// (1 << CAMTYPE_*); bitsets of other cameras read as all-invisible
+	void Cull(uint32_t camTypeMask, bool mt);
+
+	bool InView(uint32_t camType, size_t i) const {
+		return ((visBits[camType][i >> 6] >> (i & 63)) & 1);
+	}
+
+	const std::vector<uint64_t>& GetVisibilityBits(uint32_t camType) const { return visBits[camType]; }
+	size_t GetNumObjects() const { return numObjects; }
+
+private:
+	// objects per bitset word, also the unit of work of a Cull task
+	static constexpr size_t WORD_BITS = 64;
+
+	size_t numObjects = 0;
+
+	// padded to whole words; padding spheres have -inf radius and never pass
+	std::vector<float> posx;
+	std::vector<float> posy;
+	std::vector<float> posz;
+	std::vector<float> rads;
+
+	std::array<std::vector<uint64_t>, NUM_CAMERAS> visBits;
+};
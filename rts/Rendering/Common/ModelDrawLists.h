@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Rendering/Models/ModelRenderContainer.h"
+#include "System/Threading/ThreadPool.h"
+
+/**
+ * Per-pass copies of the texture bins of a set of ModelRenderContainers that
+ * only hold the objects visible in that pass. Build() walks every bin once and
+ * sorts its objects into all passes, one bin per task, so the draw passes do
+ * not each re-filter the full bins on the render thread. List i of a pass and
+ * model type corresponds to object bin i of that model type's container.
+ *
+ * Lists reference the containers' objects directly; any Add/DelObject on the
+ * containers leaves them stale until the next Build().
+ */
+template<typename TObject, size_t NumPasses>
+class ModelDrawLists {
+public:
+	using Container = ModelRenderContainer<TObject>;
+	using ObjectList = std::vector<TObject*>;
+
+	// <passMaskFunc> returns the bitmask (1 << pass) of all passes an object is drawn in
+	template<typename TPassMaskFunc>
+	void Build(const std::array<Container, MODELTYPE_CNT>& containers, TPassMaskFunc&& passMaskFunc, bool mt) {
+		binIndices.clear();
+
+		for (int modelType = MODELTYPE_3DO; modelType < MODELTYPE_CNT; modelType++) {
+			const Container& container = containers[modelType];
+
+			for (auto& passLists: lists) {
+				// keep the inner vectors of unused bins around for reuse
+				if (passLists[modelType].size() < container.GetNumObjectBins())
+					passLists[modelType].resize(container.GetNumObjectBins());
+			}
+
+			for (uint32_t i = 0, n = container.GetNumObjectBins(); i < n; i++) {
+				binIndices.emplace_back(modelType, i);
+			}
+		}
+
+		const auto buildBin = [&](int k) {
+			const auto [modelType, binIdx] = binIndices[k];
+
+			for (auto& passLists: lists) {
+				passLists[modelType][binIdx].clear();
+			}
+
+			for (TObject* o: containers[modelType].GetObjectBin(binIdx)) {
+				for (uint32_t passMask = passMaskFunc(o); passMask != 0; passMask &= (passMask - 1)) {
+					lists[std::countr_zero(passMask)][modelType][binIdx].push_back(o);
+				}
+			}
+		};
+
+		if (mt) {
+			for_mt(0, binIndices.size(), buildBin);
+		}
+		else {
+			for (size_t k = 0; k < binIndices.size(); k++)
+				buildBin(k);
+		}
+
+		stale = false;
+	}
+
+	void MarkStale() { stale = true; }
+	bool IsStale() const { return stale; }
+
+	const ObjectList& GetList(size_t pass, int modelType, uint32_t binIdx) const { return lists[pass][modelType][binIdx]; }
+
+	size_t GetNumObjects(size_t pass) const {
+		size_t n = 0;
+
+		for (const auto& [modelType, binIdx]: binIndices) {
+			n += lists[pass][modelType][binIdx].size();
+		}
+
+		return n;
+	}
+private:
+	// [pass][modelType][binIdx]
+	std::array<std::array<std::vector<ObjectList>, MODELTYPE_CNT>, NumPasses> lists;
+	// (modelType, binIdx) of all bins at the last Build, i.e. the tasks
+	std::vector<std::pair<int, uint32_t>> binIndices;
+
+	bool stale = true;
+};
@@ -11,11 +11,14 @@
 #include "System/ContainerUtil.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/Threading/ThreadPool.h"
+#include "System/TimeProfiler.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/ShadowHandler.h"
 #include "Rendering/Models/ModelsMemStorage.h"
 #include "Rendering/Models/ModelRenderContainer.h"
 #include "Rendering/Models/3DModel.h"
+#include "Rendering/Common/FrustumCuller.h"
+#include "Rendering/Common/ModelDrawLists.h"
 #include "Rendering/Env/IWater.h"
 #include "Map/ReadMap.h"
 #include "Game/Camera.h"
@@ -34,6 +37,25 @@ public:
 public:
 	bool GetFullRead() const override { return true; }
 	int  GetReadAllyTeam() const override { return AllAccessTeam; }
+public:
+	// passes with a prebuilt per-bin object list, see ModelDrawLists
+	enum DrawListPass {
+		DRAWLIST_OPAQUE,
+		DRAWLIST_OPAQUE_REFLEC,
+		DRAWLIST_OPAQUE_REFRAC,
+		DRAWLIST_ALPHA,
+		DRAWLIST_ALPHA_REFLEC,
+		DRAWLIST_ALPHA_REFRAC,
+		DRAWLIST_SHADOW,
+		DRAWLIST_CNT
+	};
+
+	static DrawListPass GetOpaqueDrawListPass(bool drawReflection, bool drawRefraction) {
+		return drawReflection? DRAWLIST_OPAQUE_REFLEC: (drawRefraction? DRAWLIST_OPAQUE_REFRAC: DRAWLIST_OPAQUE);
+	}
+	static DrawListPass GetAlphaDrawListPass(bool drawReflection, bool drawRefraction) {
+		return drawReflection? DRAWLIST_ALPHA_REFLEC: (drawRefraction? DRAWLIST_ALPHA_REFRAC: DRAWLIST_ALPHA);
+	}
 protected:
 	static constexpr int MT_CHUNK_OR_MIN_CHUNK_SIZE_SMMA = 128;
 	static constexpr int MT_CHUNK_OR_MIN_CHUNK_SIZE_UPDT = 256;
@@ -58,8 +80,17 @@ protected:
 	void DelObject(const T* co, bool del);
 	void UpdateObject(const T* co, bool init);
 protected:
-	void UpdateCommon(T* o);
-	virtual void UpdateObjectDrawFlags(CSolidObject* o) const = 0;
+	// fills frustumCuller with the spheres of unsortedObjects (after their draw
+	// positions were updated) and culls them against the model cameras
+	void CullObjects();
+	// <cullIndex> is the object's index into unsortedObjects, i.e. into frustumCuller
+	void UpdateCommon(T* o, size_t cullIndex);
+	virtual void UpdateObjectDrawFlags(CSolidObject* o, size_t cullIndex) const = 0;
+
+	// sorts all objects into the per-pass draw lists once their draw flags are final
+	void BuildDrawLists() { drawLists.Build(modelRenderers, [this](const T* o) { return GetDrawListPassMask(o); }, mtModelDrawer); }
+	// (1 << DrawListPass) bits of every pass <o> is drawn in; called from worker threads
+	virtual uint32_t GetDrawListPassMask(const T* o) const = 0;
 private:
 	void UpdateObjectSMMA(const T* o);
 	void UpdateObjectUniforms(const T* o);
@@ -67,6 +98,14 @@ public:
 	const std::vector<T*>& GetUnsortedObjects() const { return unsortedObjects; }
 	const ModelRenderContainer<T>& GetModelRenderer(int modelType) const { return modelRenderers[modelType]; }
 
+	// lists are rebuilt here if objects were added or removed after the last Update
+	const ModelDrawLists<T, DRAWLIST_CNT>& GetDrawLists() {
+		if (drawLists.IsStale())
+			BuildDrawLists();
+
+		return drawLists;
+	}
+
 	void ClearPreviousDrawFlags() { for (auto object : unsortedObjects) object->previousDrawFlag = 0; }
 
 	const ScopedMatricesMemAlloc& GetObjectMatricesMemAlloc(const T* o) const {
@@ -78,10 +117,13 @@ private:
 	static constexpr int MMA_SIZE0 = 2 << 16;
 protected:
 	std::array<ModelRenderContainer<T>, MODELTYPE_CNT> modelRenderers;
+	ModelDrawLists<T, DRAWLIST_CNT> drawLists;
 
 	std::vector<T*> unsortedObjects;
 	std::unordered_map<T*, ScopedMatricesMemAlloc> matricesMemAllocs;
 
+	CFrustumCuller frustumCuller;
+
 	bool& mtModelDrawer;
 };
 
@@ -118,6 +160,7 @@ inline void CModelDrawerDataBase<T>::AddObject(const T* co, bool add)
 
 	if (o->model != nullptr) {
 		modelRenderers[MDL_TYPE(o)].AddObject(o);
+		drawLists.MarkStale();
 	}
 
 	if (!add)
@@ -138,6 +181,7 @@ inline void CModelDrawerDataBase<T>::DelObject(const T* co, bool del)
 
 	if (o->model != nullptr) {
 		modelRenderers[MDL_TYPE(o)].DelObject(o);
+		drawLists.MarkStale();
 	}
 
 	if (del && spring::VectorErase(unsortedObjects, o)) {
@@ -158,14 +202,29 @@ template<typename T>
 inline void CModelDrawerDataBase<T>::UpdateObjectSMMA(const T* o)
 {
 	ScopedMatricesMemAlloc& smma = GetObjectMatricesMemAlloc(o);
+	CMatrix44f* mats = smma.GetWritePtr();
+
+	assert(smma.GetNumElems() >= o->localModel.pieces.size() + 1);
+
+	// written matrices are reported as one range per object instead of one by one
+	size_t dirtyBeg = smma.GetNumElems();
+	size_t dirtyEnd = 0;
+
+	const auto MarkWritten = [&dirtyBeg, &dirtyEnd](size_t i) {
+		dirtyBeg = std::min(dirtyBeg, i    );
+		dirtyEnd = std::max(dirtyEnd, i + 1);
+	};
+
+	o->localModel.UpdatePieceMatrices();
 
-	const auto  tmNew = o->GetTransformMatrix();
-	const auto& tmOld = const_cast<const ScopedMatricesMemAlloc&>(smma)[0];
+	const auto tmNew = o->GetTransformMatrix();
 
 	// from one point it doesn't worth the comparison, cause units usually move
-	// but having not updated smma[0] allows for longer solid no-update areas in ModelsUniformsUploader::UpdateDerived()
-	if (tmNew != tmOld)
-		smma[0] = tmNew;
+	// but having not updated mats[0] allows for longer solid no-update areas in MatrixUploader::UpdateDerived()
+	if (tmNew != mats[0]) {
+		mats[0] = tmNew;
+		MarkWritten(0);
+	}
 
 	for (int i = 0; i < o->localModel.pieces.size(); ++i) {
 		const LocalModelPiece& lmp = o->localModel.pieces[i];
@@ -175,18 +234,26 @@ inline void CModelDrawerDataBase<T>::UpdateObjectSMMA(const T* o)
 			continue;
 
 		if unlikely(!lmp.GetScriptVisible()) {
-			smma[i + 1] = CMatrix44f::Zero();
+			mats[i + 1] = CMatrix44f::Zero();
+			MarkWritten(i + 1);
 			continue;
 		}
 
-		smma[i + 1] = lmp.GetModelSpaceMatrix();
+		mats[i + 1] = lmp.GetModelSpaceMatrix();
+		MarkWritten(i + 1);
 	}
+
+	if (dirtyBeg < dirtyEnd)
+		smma.MarkDirty(dirtyBeg, dirtyEnd - dirtyBeg);
 }
 
 template<typename T>
 inline void CModelDrawerDataBase<T>::UpdateObjectUniforms(const T* o)
 {
-	auto& uni = modelsUniformsStorage.GetObjUniformsArray(o);
+	const size_t offset = modelsUniformsStorage.GetObjOffset(o);
+
+	// unchanged uniforms (e.g. of idle buildings) are not re-uploaded
+	ModelUniformData uni = modelsUniformsStorage.GetData()[offset];
 	uni.drawFlag = o->drawFlag;
 
 	if (gu->spectatingFullView || o->IsInLosForAllyTeam(gu->myAllyTeam)) {
@@ -196,14 +263,35 @@ inline void CModelDrawerDataBase<T>::UpdateObjectUniforms(const T* o)
 		uni.maxHealth = o->maxHealth;
 		uni.health = o->health;
 	}
+
+	modelsUniformsStorage.SetObjUniforms(offset, uni);
+}
+
+template<typename T>
+inline void CModelDrawerDataBase<T>::CullObjects()
+{
+	uint32_t camTypeMask = (1 << CCamera::CAMTYPE_PLAYER);
+
+	if (IWater::GetWater()->CanDrawReflectionPass())
+		camTypeMask |= (1 << CCamera::CAMTYPE_UWREFL);
+	if ((shadowHandler.shadowGenBits & CShadowHandler::SHADOWGEN_BIT_MODEL) != 0)
+		camTypeMask |= (1 << CCamera::CAMTYPE_SHADOW);
+
+	frustumCuller.Resize(unsortedObjects.size());
+
+	for (size_t i = 0, n = unsortedObjects.size(); i < n; i++) {
+		frustumCuller.SetSphere(i, unsortedObjects[i]->drawMidPos, unsortedObjects[i]->GetDrawRadius());
+	}
+
+	frustumCuller.Cull(camTypeMask, mtModelDrawer);
 }
 
 template<typename T>
-inline void CModelDrawerDataBase<T>::UpdateCommon(T* o)
+inline void CModelDrawerDataBase<T>::UpdateCommon(T* o, size_t cullIndex)
 {
 	assert(o);
 	o->previousDrawFlag = o->drawFlag;
-	UpdateObjectDrawFlags(o);
+	UpdateObjectDrawFlags(o, cullIndex);
 
 	if (o->alwaysUpdateMat || (o->drawFlag > DrawFlags::SO_NODRAW_FLAG && o->drawFlag < DrawFlags::SO_DRICON_FLAG))
 		UpdateObjectSMMA(o);
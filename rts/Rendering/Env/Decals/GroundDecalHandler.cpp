@@ -1,12 +1,14 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <algorithm>
+#include <array>
 #include <cctype>
 #include <cmath>
 
 #include "GroundDecal.h"
 #include "GroundDecalHandler.h"
 #include "Game/Camera.h"
+#include "Game/CameraHandler.h"
 #include "Game/GameHelper.h"
 #include "Game/GameSetup.h"
 #include "Game/GlobalUnsynced.h"
@@ -90,6 +92,15 @@ CR_REG_METADATA(CGroundDecalHandler, (
 
 	CR_MEMBER(decalsUpdateList),
 
+	CR_MEMBER(expiryBuckets),
+	CR_MEMBER(idToExpiryBucket),
+	CR_MEMBER(lastExpiredBucket),
+	CR_MEMBER(freeSlots),
+
+	CR_MEMBER_UN(decalGrid),
+	CR_MEMBER_UN(gridUpdateIds),
+	CR_MEMBER_UN(visibleSlots),
+
 	CR_MEMBER(nextId),
 	CR_MEMBER(freeIds),
 
@@ -133,11 +144,22 @@ CGroundDecalHandler::CGroundDecalHandler()
 	decals.reserve(decalLevel * 16384);
 	decalsUpdateList.Reserve(decals.capacity());
 
+	decalGrid.Init(mapDims.mapx * SQUARE_SIZE, mapDims.mapy * SQUARE_SIZE);
+
 	nextId = 0;
 }
 
 void CGroundDecalHandler::PostLoad()
 {
+	decalGrid.Init(mapDims.mapx * SQUARE_SIZE, mapDims.mapy * SQUARE_SIZE);
+
+	for (const auto& decal: decals) {
+		if (!decal.IsValid())
+			continue;
+
+		decalGrid.Update(decal.info.id, decal);
+	}
+
 	decalsUpdateList.SetNeedUpdateAll();
 }
 
@@ -361,6 +383,59 @@ uint32_t CGroundDecalHandler::GetNextId()
 	return 0;
 }
 
+size_t CGroundDecalHandler::EmplaceDecal(GroundDecal&& decal)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	size_t pos = decals.size();
+
+	// refill the slot of an expired decal first, the vector only grows if there is none
+	if (!freeSlots.empty()) {
+		pos = freeSlots.back(); freeSlots.pop_back();
+
+		decals[pos] = std::move(decal);
+		decalsUpdateList.SetUpdate(pos);
+	}
+	else {
+		decals.emplace_back(std::move(decal));
+		decalsUpdateList.EmplaceBackUpdate();
+	}
+
+	const GroundDecal& newDecal = decals[pos];
+
+	idToPos[newDecal.info.id] = pos;
+	decalGrid.Update(newDecal.info.id, newDecal);
+	ScheduleExpiry(newDecal);
+
+	return pos;
+}
+
+void CGroundDecalHandler::ScheduleExpiry(const GroundDecal& decal)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const uint32_t id = decal.info.id; //can't use bitfield directly below
+	int expirationFrame = 0;
+
+	if (decal.IsValid() && decal.alpha > 0.0f) {
+		// Lua decals only go away through DeleteLuaDecal, plates once their owner is gone
+		if (decal.info.type == static_cast<uint8_t>(GroundDecal::Type::DECAL_LUA) || decal.alphaFalloff <= 0.0f) {
+			idToExpiryBucket.erase(id);
+			return;
+		}
+
+		expirationFrame = static_cast<int>(decal.createFrameMax + decal.alpha / decal.alphaFalloff);
+	}
+
+	// already (or about to be) expired decals go into the next bucket to be processed
+	const int bucket = std::max(expirationFrame / EXPIRY_BUCKET_FRAMES, lastExpiredBucket + 1);
+
+	// decals are rescheduled on every change (and Lua access), queue each one once
+	if (const auto it = idToExpiryBucket.find(id); it != idToExpiryBucket.end() && it->second == bucket)
+		return;
+
+	idToExpiryBucket[id] = bucket;
+	expiryBuckets[bucket].push_back(id);
+}
+
 void CGroundDecalHandler::BindVertexAtrribs()
 {
 	for (int i = 0; i <= 8; ++i) {
@@ -659,7 +734,7 @@ void CGroundDecalHandler::AddExplosion(AddExplosionInfo&& ei)
 		cmAlphaMult = static_cast<float>(vi.scarGlowColorMap->GetMapSize());
 	}
 
-	const auto& decal = decals.emplace_back(GroundDecal{
+	const auto& decal = decals[EmplaceDecal(GroundDecal{
 		.refHeight = groundHeight,
 		.minHeight = -ei.maxHeightDiff,
 		.maxHeight =  ei.maxHeightDiff,
@@ -687,15 +762,12 @@ void CGroundDecalHandler::AddExplosion(AddExplosionInfo&& ei)
 		.info = GroundDecal::TypeID{ .type = static_cast<uint8_t>(GroundDecal::Type::DECAL_EXPLOSION), .id = GetNextId() },
 		.tintColor = SColor{vi.scarColorTint},
 		.glowColorMap = std::move(glowColorMap)
-	});
+	})];
 
 	if (vi.scarGlowColorMap && !vi.scarGlowColorMap->Empty()) {
 		auto idcs = vi.scarGlowColorMap->GetIndices(0.0f);
 		idToCmInfo[decal.info.id] = std::make_tuple(vi.scarGlowColorMap, idcs);
 	}
-
-	idToPos[decal.info.id] = decals.size() - 1;
-	decalsUpdateList.EmplaceBackUpdate();
 }
 
 void CGroundDecalHandler::ReloadTextures()
@@ -839,7 +911,7 @@ void CGroundDecalHandler::Draw()
 		decalShader->SetUniformMatrix4x4("shadowMatrix", false, shadowHandler.GetShadowMatrixRaw());
 
 	vao.Bind();
-	glDrawArraysInstanced(GL_TRIANGLES, 0, 36, decals.size());
+	DrawVisibleDecals();
 	vao.Unbind();
 
 	decalShader->Disable();
@@ -847,6 +919,57 @@ void CGroundDecalHandler::Draw()
 	UnbindTextures();
 }
 
+void CGroundDecalHandler::DrawVisibleDecals()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// instances closer than this are drawn along with the (culled in the shader) ones in between
+	static constexpr uint32_t MAX_RUN_GAP = 32;
+	static constexpr size_t MAX_RUNS = 256;
+
+	const size_t numDecals = decals.size();
+	const size_t numVisible = decalGrid.GetNumVisible();
+
+	if (numVisible == 0)
+		return;
+
+	// most of the map is in view, skip the gathering
+	if (!GLEW_ARB_base_instance || numVisible * 4 >= numDecals * 3) {
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 36, numDecals);
+		return;
+	}
+
+	visibleSlots.clear();
+	decalGrid.ForEachVisible([this](uint32_t id) {
+		if (const auto it = idToPos.find(id); it != idToPos.end())
+			visibleSlots.push_back(static_cast<uint32_t>(it->second));
+	});
+
+	std::sort(visibleSlots.begin(), visibleSlots.end());
+
+	// [beg, end) instance runs
+	std::array<std::pair<uint32_t, uint32_t>, MAX_RUNS> runs;
+	size_t numRuns = 0;
+
+	for (const uint32_t slot : visibleSlots) {
+		if (numRuns > 0 && slot <= runs[numRuns - 1].second + MAX_RUN_GAP) {
+			runs[numRuns - 1].second = slot + 1;
+			continue;
+		}
+
+		// too scattered, a single draw is cheaper than this many
+		if (numRuns == MAX_RUNS) {
+			glDrawArraysInstanced(GL_TRIANGLES, 0, 36, numDecals);
+			return;
+		}
+
+		runs[numRuns++] = { slot, slot + 1 };
+	}
+
+	for (size_t r = 0; r < numRuns; ++r) {
+		glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, 36, runs[r].second - runs[r].first, runs[r].first);
+	}
+}
+
 void CGroundDecalHandler::AddSolidObject(const CSolidObject* object) { MoveSolidObject(object, object->pos); }
 void CGroundDecalHandler::MoveSolidObject(const CSolidObject* object, const float3& pos)
 {
@@ -887,10 +1010,11 @@ void CGroundDecalHandler::MoveSolidObject(const CSolidObject* object, const floa
 		decal.posBL = posBL;
 		decal.height = height;
 		decalsUpdateList.SetUpdate(doIt->second);
+		decalGrid.Update(decal.info.id, decal);
 		return;
 	}
 
-	const auto& decal = decals.emplace_back(GroundDecal{
+	const size_t decalPos = EmplaceDecal(GroundDecal{
 		.refHeight = 0.0f,
 		.minHeight = 0.0f,
 		.maxHeight = 0.0f,
@@ -920,9 +1044,7 @@ void CGroundDecalHandler::MoveSolidObject(const CSolidObject* object, const floa
 		.glowColorMap = { SColor{0.0f, 0.0f, 0.0f, 0.0f}, SColor{0.0f, 0.0f, 0.0f, 0.0f} }
 	});
 
-	decalsUpdateList.EmplaceBackUpdate();
-	idToPos[decal.info.id] = decals.size() - 1;
-	decalOwners[object] = decals.size() - 1;
+	decalOwners[object] = decalPos;
 }
 
 void CGroundDecalHandler::RemoveSolidObject(const CSolidObject* object, const GhostSolidObject* gb)
@@ -959,6 +1081,7 @@ void CGroundDecalHandler::RemoveSolidObject(const CSolidObject* object, const Gh
 	decayingDecal.createFrameMax = createFrame;
 
 	decalsUpdateList.SetUpdate(pos);
+	ScheduleExpiry(decayingDecal);
 }
 
 /**
@@ -984,6 +1107,7 @@ void CGroundDecalHandler::GhostDestroyed(const GhostSolidObject* gb) {
 	decal.alpha = 0.0f;
 	decalsUpdateList.SetUpdate(doIt->second);
 	decalOwners.erase(doIt);
+	ScheduleExpiry(decal);
 }
 
 uint32_t CGroundDecalHandler::CreateLuaDecal()
@@ -991,7 +1115,7 @@ uint32_t CGroundDecalHandler::CreateLuaDecal()
 	RECOIL_DETAILED_TRACY_ZONE;
 	const auto createFrame = static_cast<float>(std::max(gs->frameNum, 0));
 
-	const auto& decal = decals.emplace_back(GroundDecal{
+	const auto& decal = decals[EmplaceDecal(GroundDecal{
 		.refHeight = 0.0f,
 		.minHeight = 0.0f,
 		.maxHeight = 0.0f,
@@ -1019,9 +1143,7 @@ uint32_t CGroundDecalHandler::CreateLuaDecal()
 		.info = GroundDecal::TypeID{.type = static_cast<uint8_t>(GroundDecal::Type::DECAL_LUA), .id = GetNextId() },
 		.tintColor = SColor{0.5f, 0.5f, 0.5f, 0.5f},
 		.glowColorMap = { SColor{0.0f, 0.0f, 0.0f, 0.0f}, SColor{0.0f, 0.0f, 0.0f, 0.0f} }
-	});
-	decalsUpdateList.EmplaceBackUpdate();
-	idToPos[decal.info.id] = decals.size() - 1;
+	})];
 
 	return decal.info.id;
 }
@@ -1042,6 +1164,7 @@ bool CGroundDecalHandler::DeleteLuaDecal(uint32_t id)
 
 	decal.MarkInvalid();
 	decalsUpdateList.SetUpdate(it->second);
+	ScheduleExpiry(decal);
 
 	return true;
 }
@@ -1057,7 +1180,9 @@ GroundDecal* CGroundDecalHandler::GetDecalById(uint32_t id)
 	if (!decal.IsValid())
 		return nullptr;
 
+	// the caller may move the decal or change its lifetime
 	decalsUpdateList.SetUpdate(it->second);
+	gridUpdateIds.push_back(id);
 	return &decal;
 }
 
@@ -1236,7 +1361,7 @@ void CGroundDecalHandler::AddTrack(const CUnit* unit, const float3& newPos, bool
 
 		const float alphaDecay = 1.0f / trackLifeTime;
 
-		const auto& decal = decals.emplace_back(GroundDecal{
+		const size_t pos = EmplaceDecal(GroundDecal{
 			.refHeight = 0.0f,
 			.minHeight = 0.0f,
 			.maxHeight = 0.0f,
@@ -1268,9 +1393,7 @@ void CGroundDecalHandler::AddTrack(const CUnit* unit, const float3& newPos, bool
 
 		mm = {};
 
-		decalOwners[unit] = decals.size() - 1;
-		idToPos[decal.info.id] = decals.size() - 1;
-		decalsUpdateList.EmplaceBackUpdate();
+		decalOwners[unit] = pos;
 
 		return;
 	}
@@ -1305,8 +1428,15 @@ void CGroundDecalHandler::AddTrack(const CUnit* unit, const float3& newPos, bool
 	if (dirN.Dot(dirN) < 0.25f)
 		return;
 
+	// distance of the current segment's end from the line the segment would have if it were extended to decalPos2,
+	// small enough and the stretched segment still covers the path the unit took so far
+	const float2 dirE = (decalPos2 - posL).SafeNormalize();
+	const float2 relR = posR - posL;
+	const float endDeviation = math::fabs(dirE.x * relR.y - dirE.y * relR.x);
+	const bool extendable = (dirO.Dot(dirN) > 0.0f && endDeviation <= decalDef.trackDecalWidth * TRACK_MERGE_DEVIATION);
+
 	// the old decal had zero len (was a new track decal) or similar dir and the unit updir is same-ish as before
-	if ((dirO.Dot(dirO) == 0.0f || dirO.Dot(dirN) >= 0.9999f) && oldDecal.forcedNormal.dot(unit->updir) >= 0.99f) {
+	if ((dirO.Dot(dirO) == 0.0f || extendable) && oldDecal.forcedNormal.dot(unit->updir) >= 0.99f) {
 		oldDecal.posTR = decalPos2 - wc;
 		oldDecal.posBR = decalPos2 + wc;
 		oldDecal.createFrameMax = createFrame;
@@ -1316,11 +1446,12 @@ void CGroundDecalHandler::AddTrack(const CUnit* unit, const float3& newPos, bool
 		oldDecal.height = argmax(mm.max - midPointHeight, midPointHeight - mm.min) + 25.0f;
 
 		decalsUpdateList.SetUpdate(doIt->second);
+		decalGrid.Update(oldDecal.info.id, oldDecal);
 		return;
 	}
 
 	// new decal, starting where the previous ended
-	auto& newDecal = decals.emplace_back(GroundDecal{
+	const size_t segmentPos = EmplaceDecal(GroundDecal{
 		.refHeight = 0.0f,
 		.minHeight = 0.0f,
 		.maxHeight = 0.0f,
@@ -1350,54 +1481,112 @@ void CGroundDecalHandler::AddTrack(const CUnit* unit, const float3& newPos, bool
 		.glowColorMap = { SColor{0.0f, 0.0f, 0.0f, 0.0f}, SColor{0.0f, 0.0f, 0.0f, 0.0f} }
 	});
 
+	auto& newDecal = decals[segmentPos];
+
 	const float2 midPointDist = (newDecal.posTL + newDecal.posTR + newDecal.posBR + newDecal.posBL) * 0.25f;
 	const float midPointHeight = CGround::GetHeightReal(midPointDist.x, midPointDist.y, false);
 	newDecal.height = argmax(newDecal.height, mm.max - midPointHeight, midPointHeight - mm.min, 25.0f);
+	decalGrid.Update(newDecal.info.id, newDecal);
 	mm = {};
 
 	// replace the old entry
-	decalOwners[unit] = decals.size() - 1;
-
-	idToPos[newDecal.info.id], decals.size() - 1;
-	decalsUpdateList.EmplaceBackUpdate();
+	decalOwners[unit] = segmentPos;
 }
 
 void CGroundDecalHandler::CompactDecalsVector(int frameNum)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	if (frameNum % 300 != 0)
-		return;
+	const auto IsExpired = [frameNum](const GroundDecal& decal) {
+		if (!decal.IsValid())
+			return true;
 
-	if (decals.empty())
-		return;
+		// Lua items are not considered expired
+		if (decal.info.type == static_cast<uint8_t>(GroundDecal::Type::DECAL_LUA))
+			return false;
 
-	// only bother with the following code, if number of items is big enough
-	if (decals.size() < decals.capacity() >> 6)
-		return;
+		const auto targetExpirationFrame = static_cast<int>(decal.alpha / std::max(decal.alphaFalloff, 1e-6f));
+		return (frameNum - decal.createFrameMax > targetExpirationFrame);
+	};
 
-	size_t numToDelete = 0;
-	for (auto& decal : decals) {
-		if (!decal.IsValid()) {
-			numToDelete++;
+	size_t numRemoved = 0;
+
+	// only visit the decals that were due to expire in the buckets that are over by now,
+	// the ones whose lifetime got extended in the meantime (e.g. tracks) are moved ahead
+	for (int bucket = lastExpiredBucket + 1; (bucket + 1) * EXPIRY_BUCKET_FRAMES < frameNum; bucket++) {
+		lastExpiredBucket = bucket;
+
+		const auto ebIt = expiryBuckets.find(bucket);
+		if (ebIt == expiryBuckets.end())
 			continue;
-		}
-		const auto targetExpirationFrame = static_cast<int>(decal.alpha / std::max(decal.alphaFalloff, 1e-6f));
-		if (decal.info.type != static_cast<uint8_t>(GroundDecal::Type::DECAL_LUA) && frameNum - decal.createFrameMax > targetExpirationFrame) {
+
+		const std::vector<uint32_t> bucketIds = std::move(ebIt->second);
+		expiryBuckets.erase(ebIt);
+
+		for (const uint32_t id : bucketIds) {
+			// moved to a later bucket, or removed and the id might have been reused by now
+			const auto ebIdIt = idToExpiryBucket.find(id);
+			if (ebIdIt == idToExpiryBucket.end() || ebIdIt->second != bucket)
+				continue;
+
+			idToExpiryBucket.erase(ebIdIt);
+
+			const auto ipIt = idToPos.find(id);
+			if (ipIt == idToPos.end())
+				continue;
+
+			const size_t pos = ipIt->second;
+			GroundDecal& decal = decals[pos];
+
+			if (!IsExpired(decal)) {
+				ScheduleExpiry(decal);
+				continue;
+			}
+
 			decal.MarkInvalid();
-			numToDelete++;
+			decalsUpdateList.SetUpdate(pos);
+
+			decalGrid.Remove(id);
+			idToPos.erase(ipIt);
+
+			if (auto it = idToCmInfo.find(id); it != idToCmInfo.end())
+				idToCmInfo.erase(it);
+
+			freeIds.push_back(id);
+			freeSlots.push_back(pos);
+			numRemoved++;
 		}
 	}
 
-	if (numToDelete == 0)
+	if (numRemoved == 0)
 		return;
 
-	// resort if number of expired items > 25.0%
+	// remove owners of expired items before their slots get reused
+	for (auto it = decalOwners.begin(); it != decalOwners.end(); ) {
+		if (!decals.at(it->second).IsValid()) {
+			it = decalOwners.erase(it);
+			continue;
+		}
+
+		++it;
+	}
+
+	// only bother with the following code, if number of items is big enough
+	if (decals.size() < decals.capacity() >> 6)
+		return;
+
+	// shrink the vector if number of free slots > 25.0%
 	static constexpr float RESORT_THRESHOLD = 1.0f / 4.0f;
-	if (static_cast<float>(decals.size()) / static_cast<float>(numToDelete) <= RESORT_THRESHOLD)
+	if (static_cast<float>(freeSlots.size()) <= static_cast<float>(decals.size()) * RESORT_THRESHOLD)
 		return;
 
+	CompactDecalsVectorFull();
+}
+
+void CGroundDecalHandler::CompactDecalsVectorFull()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
 #if 0
-	LOG("DH:CompactDecalsVector[1](fn=%d) Decals.size()=%u", frameNum, static_cast<uint32_t>(decals.size()));
+	LOG("DH:CompactDecalsVector[1](fn=%d) Decals.size()=%u", gs->frameNum, static_cast<uint32_t>(decals.size()));
 	for (int cnt = 0; const auto & [owner, offset] : decalOwners) {
 		const void* ptr = std::holds_alternative<const CSolidObject*>(owner) ? static_cast<const void*>(std::get<const CSolidObject*>(owner)) : nullptr;
 		int id = (ptr != nullptr) ? std::get<const CSolidObject*>(owner)->id : -1;
@@ -1411,12 +1600,35 @@ void CGroundDecalHandler::CompactDecalsVector(int frameNum)
 	}
 #endif
 
+	// invalid items that are still waiting for their expiry bucket (deleted Lua decals)
+	// are released here, the rest are free slots that were released already
+	for (size_t i = 0; i < decals.size(); ++i) {
+		const auto& decal = decals[i];
+
+		if (decal.IsValid())
+			continue;
+
+		const uint32_t id = decal.info.id; //can't use bitfield directly below
+		const auto ipIt = idToPos.find(id);
+
+		if (ipIt == idToPos.end() || ipIt->second != i)
+			continue;
+
+		decalGrid.Remove(id);
+		idToPos.erase(ipIt);
+		idToExpiryBucket.erase(id);
+
+		if (auto it = idToCmInfo.find(id); it != idToCmInfo.end())
+			idToCmInfo.erase(it);
+
+		freeIds.push_back(id);
+	}
+
 	// temporary store the id --> DecalOwner relationship,
 	// for the convinience to restore decalOwners correctness,
 	// after the compaction is complete
 	spring::unordered_map<uint32_t, DecalOwner> tmpOwnerToId;
 
-	// Remove owners of expired items
 	for (const auto& [owner, pos] : decalOwners) {
 		if (const auto& decal = decals.at(pos); decal.IsValid()) {
 			const uint32_t id = decal.info.id; //can't use bitfield directly below
@@ -1428,23 +1640,19 @@ void CGroundDecalHandler::CompactDecalsVector(int frameNum)
 	decalOwners.clear();
 
 	// group all expired items towards the end of the vector
-	// Lua items are not considered expired
 	const auto expIt = std::stable_partition(decals.begin(), decals.end(), [](const GroundDecal& decal) {
 		return decal.IsValid();
 	});
 
-	// remove expired items from idToCmInfo map
-	// and push expired ids to the freeIds vector
-	for (auto decalIt = expIt; decalIt != decals.end(); ++decalIt) {
-		freeIds.push_back(decalIt->info.id);
-
-		if (auto it = idToCmInfo.find(decalIt->info.id); it != idToCmInfo.end())
-			idToCmInfo.erase(it);
-	}
+	// keep the decals of a grid cell next to each other, so drawing the visible ones takes few instance runs
+	std::stable_sort(decals.begin(), expIt, [this](const GroundDecal& a, const GroundDecal& b) {
+		return (decalGrid.GetCell(a.info.id) < decalGrid.GetCell(b.info.id));
+	});
 
 	// remove expired decals
-	decals.resize(decals.size() - numToDelete);
+	decals.erase(expIt, decals.end());
 	decalsUpdateList.Resize(decals.size());
+	freeSlots.clear();
 
 	idToPos.clear();
 	for (size_t i = 0; i < decals.size(); ++i) {
@@ -1464,7 +1672,7 @@ void CGroundDecalHandler::CompactDecalsVector(int frameNum)
 
 
 #if 0
-	LOG("DH:CompactDecalsVector[2](fn=%d) Decals.size()=%u", frameNum, static_cast<uint32_t>(decals.size()));
+	LOG("DH:CompactDecalsVector[2](fn=%d) Decals.size()=%u", gs->frameNum, static_cast<uint32_t>(decals.size()));
 	for (int cnt = 0; const auto & [owner, offset] : decalOwners) {
 		const void* ptr = std::holds_alternative<const CSolidObject*>(owner) ? static_cast<const void*>(std::get<const CSolidObject*>(owner)) : nullptr;
 		int id = (ptr != nullptr) ? std::get<const CSolidObject*>(owner)->id : -1;
@@ -1482,12 +1690,38 @@ void CGroundDecalHandler::CompactDecalsVector(int frameNum)
 void CGroundDecalHandler::UpdateDecalsVisibility()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	if (!gridUpdateIds.empty()) {
+		std::sort(gridUpdateIds.begin(), gridUpdateIds.end());
+		gridUpdateIds.erase(std::unique(gridUpdateIds.begin(), gridUpdateIds.end()), gridUpdateIds.end());
+
+		for (const uint32_t id : gridUpdateIds) {
+			const auto it = idToPos.find(id);
+			if (it == idToPos.end())
+				continue;
+
+			const auto& decal = decals[it->second];
+			if (!decal.IsValid())
+				continue;
+
+			decalGrid.Update(id, decal);
+			ScheduleExpiry(decal);
+		}
+
+		gridUpdateIds.clear();
+	}
+
+	decalGrid.UpdateVisibility(CCameraHandler::GetActiveCamera());
+
 	for (const auto& [owner, pos] : decalOwners) {
 		auto& decal = decals.at(pos);
 
 		if (decal.info.type != static_cast<uint8_t>(GroundDecal::Type::DECAL_PLATE))
 			continue;
 
+		// off-screen ones are brought up to date once they come into view, before being drawn
+		if (!decalGrid.IsVisible(decal.info.id))
+			continue;
+
 		if (std::holds_alternative<const CSolidObject*>(owner)) {
 			const auto* so = std::get<const CSolidObject*>(owner);
 			float wantedMult = 1.0f;
@@ -1530,6 +1764,9 @@ void CGroundDecalHandler::UpdateDecalsVisibility()
 
 	const float curAdjustedFrame = std::max(gs->frameNum, 0) + globalRendering->timeOffset;
 	for (auto& [id, info] : idToCmInfo) {
+		if (!decalGrid.IsVisible(id))
+			continue;
+
 		auto it = idToPos.find(id);
 		if (it == idToPos.end()) {
 			assert(false);
@@ -1674,6 +1911,13 @@ void CGroundDecalHandler::UnitLoaded(const CUnit* unit, const CUnit* transport)
 void CGroundDecalHandler::UnitUnloaded(const CUnit* unit, const CUnit* transport) { AddSolidObject(unit); }
 
 void CGroundDecalHandler::UnitMoved(const CUnit* unit) { AddTrack(unit, unit->pos); }
+void CGroundDecalHandler::UnitMovedBatch(std::span<const CUnit* const> units)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	for (const CUnit* unit: units) {
+		AddTrack(unit, unit->pos);
+	}
+}
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -1734,3 +1978,123 @@ std::pair<size_t, size_t> CGroundDecalHandler::DecalUpdateList::GetOffsetAndSize
 		std::distance(it.first          , it.second)
 	);
 }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void CGroundDecalHandler::DecalGrid::Init(int sizeX, int sizeZ)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	numCellsX = std::max((sizeX + CELL_SIZE - 1) / CELL_SIZE, 1);
+	numCellsZ = std::max((sizeZ + CELL_SIZE - 1) / CELL_SIZE, 1);
+
+	cells.clear();
+	cells.resize(numCellsX * numCellsZ);
+	cellVis.assign(numCellsX * numCellsZ, 0);
+
+	entries.clear();
+	visCells.clear();
+	numVisible = 0;
+}
+
+void CGroundDecalHandler::DecalGrid::Update(uint32_t id, const GroundDecal& decal)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// bounding circle, decals are rotated around the center of their corners in the shader
+	const float2 midPoint = (decal.posTL + decal.posTR + decal.posBR + decal.posBL) * 0.25f;
+	const float radius = math::sqrt(argmax(
+		midPoint.DistanceSq(decal.posTL),
+		midPoint.DistanceSq(decal.posTR),
+		midPoint.DistanceSq(decal.posBR),
+		midPoint.DistanceSq(decal.posBL)
+	));
+
+	const int cx = std::clamp(static_cast<int>(midPoint.x / CELL_SIZE), 0, numCellsX - 1);
+	const int cz = std::clamp(static_cast<int>(midPoint.y / CELL_SIZE), 0, numCellsZ - 1);
+	const uint32_t cellIdx = cz * numCellsX + cx;
+
+	if (id >= entries.size())
+		entries.resize(id + 1);
+
+	if (entries[id].cell != cellIdx) {
+		Remove(id);
+
+		entries[id].cell = cellIdx;
+		entries[id].slot = static_cast<uint32_t>(cells[cellIdx].ids.size());
+		cells[cellIdx].ids.push_back(id);
+	}
+
+	// cells only grow until they run empty, decals mostly stay where they were put
+	Cell& cell = cells[cellIdx];
+
+	const float overhang = argmax(
+		(cx * CELL_SIZE) - (midPoint.x - radius), (midPoint.x + radius) - ((cx + 1) * CELL_SIZE),
+		(cz * CELL_SIZE) - (midPoint.y - radius), (midPoint.y + radius) - ((cz + 1) * CELL_SIZE),
+		0.0f
+	);
+
+	cell.maxOverhang = std::max(cell.maxOverhang, overhang);
+	cell.maxHeight = std::max(cell.maxHeight, math::fabs(decal.height));
+}
+
+void CGroundDecalHandler::DecalGrid::Remove(uint32_t id)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (id >= entries.size() || entries[id].cell == NO_CELL)
+		return;
+
+	Entry& entry = entries[id];
+	Cell& cell = cells[entry.cell];
+
+	const uint32_t lastId = cell.ids.back();
+
+	cell.ids[entry.slot] = lastId;
+	entries[lastId].slot = entry.slot;
+	cell.ids.pop_back();
+
+	if (cell.ids.empty()) {
+		cell.maxOverhang = 0.0f;
+		cell.maxHeight = 0.0f;
+	}
+
+	entry = {};
+}
+
+void CGroundDecalHandler::DecalGrid::UpdateVisibility(const CCamera* cam)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const float minHeight = readMap->GetCurrMinHeight();
+	const float maxHeight = readMap->GetCurrMaxHeight();
+
+	visCells.clear();
+	numVisible = 0;
+
+	for (int cz = 0; cz < numCellsZ; ++cz) {
+		for (int cx = 0; cx < numCellsX; ++cx) {
+			const uint32_t cellIdx = cz * numCellsX + cx;
+			const Cell& cell = cells[cellIdx];
+
+			cellVis[cellIdx] = 0;
+
+			if (cell.ids.empty())
+				continue;
+
+			const float3 mins = {
+				 cx      * CELL_SIZE - cell.maxOverhang,
+				minHeight            - cell.maxHeight,
+				 cz      * CELL_SIZE - cell.maxOverhang
+			};
+			const float3 maxs = {
+				(cx + 1) * CELL_SIZE + cell.maxOverhang,
+				maxHeight            + cell.maxHeight,
+				(cz + 1) * CELL_SIZE + cell.maxOverhang
+			};
+
+			if (!cam->InView(mins, maxs))
+				continue;
+
+			cellVis[cellIdx] = 1;
+			visCells.push_back(cellIdx);
+			numVisible += cell.ids.size();
+		}
+	}
+}
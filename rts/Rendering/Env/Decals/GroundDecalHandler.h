@@ -27,6 +27,7 @@ class CTextureAtlas;
 class CSMFGroundDrawer;
 class GhostSolidObject;
 class CColorMap;
+class CCamera;
 
 namespace Shader {
 	struct IProgramObject;
@@ -67,6 +68,62 @@ public:
 		std::vector<bool> updateList;
 		bool changed;
 	};
+
+	/**
+	 * Loose uniform grid over decal ids. Every decal lives in the cell that
+	 * contains the center of its bounding circle, each cell remembers how far
+	 * its decals reach beyond its bounds, so a visibility query only has to
+	 * test the (few hundred) expanded cell boxes against the camera frustum.
+	 */
+	class DecalGrid {
+	public:
+		static constexpr int CELL_SIZE = 64 * SQUARE_SIZE;
+		static constexpr uint32_t NO_CELL = std::numeric_limits<uint32_t>::max();
+	public:
+		void Init(int sizeX, int sizeZ);
+
+		// inserts the decal or moves it to the cell its current corners map to
+		void Update(uint32_t id, const GroundDecal& decal);
+		void Remove(uint32_t id);
+
+		void UpdateVisibility(const CCamera* cam);
+
+		bool IsVisible(uint32_t id) const {
+			return (id < entries.size() && entries[id].cell != NO_CELL && cellVis[entries[id].cell]);
+		}
+
+		template<typename F>
+		void ForEachVisible(F&& f) const {
+			for (const uint32_t cellIdx: visCells) {
+				for (const uint32_t id: cells[cellIdx].ids) {
+					f(id);
+				}
+			}
+		}
+
+		uint32_t GetCell(uint32_t id) const { return (id < entries.size())? entries[id].cell: NO_CELL; }
+		size_t GetNumVisible() const { return numVisible; }
+	private:
+		struct Cell {
+			std::vector<uint32_t> ids;
+			// how far decals reach out of the cell rectangle (xz) and above/below ground (y)
+			float maxOverhang = 0.0f;
+			float maxHeight = 0.0f;
+		};
+		struct Entry {
+			uint32_t cell = NO_CELL;
+			uint32_t slot = 0;
+		};
+
+		std::vector<Cell> cells;
+		std::vector<Entry> entries; // indexed by decal id
+		std::vector<uint32_t> visCells;
+		std::vector<uint8_t> cellVis;
+
+		int numCellsX = 0;
+		int numCellsZ = 0;
+		size_t numVisible = 0;
+	};
 public:
 	CGroundDecalHandler();
 	~CGroundDecalHandler() override;
@@ -102,6 +159,9 @@ public:
 			|| (eventName == "SunChanged")
 			|| (eventName == "ViewResize");
 	}
+	bool WantsBatchedEvent(const std::string& eventName) const override {
+		return (eventName == "UnitMoved");
+	}
 
 	void ConfigNotify(const std::string& key, const std::string& value);
 
@@ -114,6 +174,7 @@ public:
 	void RenderFeatureDestroyed(const CFeature* feature) override;
 	void FeatureMoved(const CFeature* feature, const float3& oldpos) override;
 	void UnitMoved(const CUnit* unit) override;
+	void UnitMovedBatch(std::span<const CUnit* const> units) override;
 	void UnitLoaded(const CUnit* unit, const CUnit* transport) override;
 	void UnitUnloaded(const CUnit* unit, const CUnit* transport) override;
 
@@ -164,9 +225,14 @@ private:
 
 	void RemoveSolidObject(const CSolidObject* object, const GhostSolidObject* gb);
 
+	size_t EmplaceDecal(GroundDecal&& decal);
+	void ScheduleExpiry(const GroundDecal& decal);
+
 	void CompactDecalsVector(int frameNum);
+	void CompactDecalsVectorFull();
 
 	void UpdateDecalsVisibility();
+	void DrawVisibleDecals();
 
 	void AddBuildingDecalTextures();
 	void AddTexturesFromTable();
@@ -199,6 +265,19 @@ private:
 
 	DecalUpdateList decalsUpdateList;
 
+	// decal ids by the EXPIRY_BUCKET_FRAMES-long frame bucket in which they are expected to expire
+	spring::unordered_map<int, std::vector<uint32_t>> expiryBuckets;
+	// the bucket each decal id is queued in, its entries in other buckets are stale
+	spring::unordered_map<uint32_t, int> idToExpiryBucket;
+	int lastExpiredBucket = -1;
+
+	// slots of removed decals, refilled by EmplaceDecal before the vector grows
+	std::vector<uint32_t> freeSlots;
+
+	DecalGrid decalGrid;
+	std::vector<uint32_t> gridUpdateIds; // decals Lua may have moved since the last draw
+	std::vector<uint32_t> visibleSlots;
+
 	uint32_t nextId;
 	std::vector<uint32_t> freeIds;
 
@@ -211,4 +290,7 @@ private:
 	ScopedDepthBufferCopy sdbc;
 
 	static constexpr uint32_t TRACKS_UPDATE_RATE = 4u;
+	// how far (relative to the track width) a track may bend before a new segment is started
+	static constexpr float TRACK_MERGE_DEVIATION = 0.05f;
+	static constexpr int EXPIRY_BUCKET_FRAMES = 4 * GAME_SPEED;
 };
\ No newline at end of file
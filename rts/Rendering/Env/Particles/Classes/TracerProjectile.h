@@ -20,6 +20,8 @@ public:
 
 	void Draw() override;
 	void Update() override;
+	// issues its own draw call
+	bool CanDrawConcurrently() const override { return false; }
 	void Init(const CUnit* owner, const float3& offset) override;
 
 	int GetProjectilesCount() const override;
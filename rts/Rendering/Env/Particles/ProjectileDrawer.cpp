@@ -37,22 +37,24 @@
 #include "System/EventHandler.h"
 #include "System/Exceptions.h"
 #include "System/Log/ILog.h"
+#include "System/RadixSort.hpp"
 #include "System/SafeUtil.h"
 #include "System/StringUtil.h"
 #include "System/ScopedResource.h"
+#include "System/TimeProfiler.h"
 
 #include "System/Misc/TracyDefs.h"
 
 CONFIG(int, SoftParticles).defaultValue(1).safemodeValue(0).description("Soften up CEG particles on clipping edges");
 
-static uint32_t sortCamType = 0;
-static bool CProjectileDrawOrderSortingPredicate(const CProjectile* p1, const CProjectile* p2) noexcept {
-	return std::forward_as_tuple(p2->drawOrder, p1->GetSortDist(sortCamType), p1) > std::forward_as_tuple(p1->drawOrder, p2->GetSortDist(sortCamType), p2);
-}
+// far-to-near within ascending drawOrder; the lowest byte of the distance is
+// dropped, which is far below any visible difference and saves a radix pass
+static uint64_t ParticleSortKey(const CProjectile* p, uint32_t camType, bool useDrawOrder) {
+	const uint32_t distKey = ~spring::FloatToOrderedKey(p->GetSortDist(camType)) & ~0xFFu;
+	const uint32_t ordrKey = spring::IntToOrderedKey(p->drawOrder * useDrawOrder);
 
-static bool CProjectileSortingPredicate(const CProjectile* p1, const CProjectile* p2) noexcept {
-	return std::forward_as_tuple(p1->GetSortDist(sortCamType), p1) > std::forward_as_tuple(p2->GetSortDist(sortCamType), p2);
-};
+	return ((uint64_t(ordrKey) << 32) | distKey);
+}
 
 CProjectileDrawer* projectileDrawer = nullptr;
 
@@ -372,16 +374,38 @@ void CProjectileDrawer::Kill() {
 void CProjectileDrawer::UpdateDrawFlags()
 {
 	ZoneScopedN("ProjectileDrawer::UpdateDrawFlags");
+
+	uint32_t camTypeMask = (1 << CCamera::CAMTYPE_PLAYER);
+
+	if (IWater::GetWater()->CanDrawReflectionPass())
+		camTypeMask |= (1 << CCamera::CAMTYPE_UWREFL);
+	if ((shadowHandler.shadowGenBits & CShadowHandler::SHADOWGEN_BIT_PROJ) != 0)
+		camTypeMask |= (1 << CCamera::CAMTYPE_SHADOW);
+
 	for (auto& rp : renderProjectiles) {
 		if (rp.empty())
 			continue;
 
 		auto hasModel = (&rp == &renderProjectiles[true]);
-		for_mt(0, rp.size(), [&rp, hasModel](int i) {
+		auto& culler = renderProjectileCullers[hasModel];
+
+		culler.Resize(rp.size());
+
+		for_mt(0, rp.size(), [&rp, &culler](int i) {
 			CProjectile* p = rp[i];
-			assert((p->model != nullptr) == hasModel);
 
 			p->drawPos = p->GetDrawPos(globalRendering->timeOffset);
+			culler.SetSphere(i, p->drawPos, p->GetDrawRadius());
+		});
+
+		{
+			SCOPED_TIMER("Update::WorldDrawer::Cull::Projectiles");
+			culler.Cull(camTypeMask, true);
+		}
+
+		for_mt(0, rp.size(), [&rp, &culler, hasModel, camTypeMask](int i) {
+			CProjectile* p = rp[i];
+			assert((p->model != nullptr) == hasModel);
 
 			p->previousDrawFlag = p->drawFlag;
 			p->ResetDrawFlag();
@@ -392,18 +416,16 @@ void CProjectileDrawer::UpdateDrawFlags()
 			p->SetDrawFlag(DrawFlags::SO_DRICON_FLAG); //reuse as a minimap draw indication
 
 			for (uint32_t camType = CCamera::CAMTYPE_PLAYER; camType < CCamera::CAMTYPE_ENVMAP; ++camType) {
-				if (camType == CCamera::CAMTYPE_UWREFL && !IWater::GetWater()->CanDrawReflectionPass())
+				if ((camTypeMask & (1 << camType)) == 0)
 					continue;
 
 				if (camType == CCamera::CAMTYPE_SHADOW && !p->castShadow)
 					continue;
 
-				if (camType == CCamera::CAMTYPE_SHADOW && ((shadowHandler.shadowGenBits & CShadowHandler::SHADOWGEN_BIT_PROJ) == 0))
+				if (!culler.InView(camType, i))
 					continue;
 
 				const CCamera* cam = CCameraHandler::GetCamera(camType);
-				if (!cam->InView(p->drawPos, p->GetDrawRadius()))
-					continue;
 
 				p->SetSortDist(camType, cam->ProjectedDistance(p->drawPos));
 
@@ -432,6 +454,27 @@ void CProjectileDrawer::UpdateDrawFlags()
 			}
 		});
 	}
+
+	{
+		SCOPED_TIMER("Update::WorldDrawer::DrawLists::Projectiles");
+		BuildModelDrawLists();
+	}
+}
+
+void CProjectileDrawer::BuildModelDrawLists()
+{
+	ZoneScopedN("ProjectileDrawer::BuildModelDrawLists");
+
+	modelDrawLists.Build(modelRenderers, [](const CProjectile* p) {
+		uint32_t passMask = 0;
+
+		passMask |= (ShouldDrawProjectile(p, DrawFlags::SO_OPAQUE_FLAG) << MODEL_DRAWLIST_OPAQUE);
+		passMask |= (ShouldDrawProjectile(p, DrawFlags::SO_REFLEC_FLAG) << MODEL_DRAWLIST_REFLEC);
+		passMask |= (ShouldDrawProjectile(p, DrawFlags::SO_REFRAC_FLAG) << MODEL_DRAWLIST_REFRAC);
+		passMask |= (ShouldDrawProjectile(p, DrawFlags::SO_SHOPAQ_FLAG) << MODEL_DRAWLIST_SHADOW);
+
+		return passMask;
+	}, true);
 }
 
 bool CProjectileDrawer::CheckSoftenExt()
@@ -698,10 +741,12 @@ void CProjectileDrawer::DrawOpaque(bool drawReflection, bool drawRefraction)
 		DepthMask(GL_TRUE)
 	);
 
-	const uint8_t thisPassMask =
-		(1 - (drawReflection || drawRefraction)) * DrawFlags::SO_OPAQUE_FLAG +
-		(drawReflection * DrawFlags::SO_REFLEC_FLAG) +
-		(drawRefraction * DrawFlags::SO_REFRAC_FLAG);
+	const ModelDrawListPass drawListPass =
+		drawReflection? MODEL_DRAWLIST_REFLEC:
+		drawRefraction? MODEL_DRAWLIST_REFRAC:
+		MODEL_DRAWLIST_OPAQUE;
+
+	const auto& drawLists = GetModelDrawLists();
 
 	ISky::GetSky()->SetupFog();
 	ScopedModelDrawerImpl<CUnitDrawer> legacy(true, false);
@@ -713,15 +758,14 @@ void CProjectileDrawer::DrawOpaque(bool drawReflection, bool drawRefraction)
 		const auto& mdlRenderer = modelRenderers[modelType];
 
 		for (uint32_t i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
-			if (mdlRenderer.GetObjectBin(i).empty())
+			const auto& drawList = drawLists.GetList(drawListPass, modelType, i);
+
+			if (drawList.empty())
 				continue;
 
 			CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
 
-			for (CProjectile* p : mdlRenderer.GetObjectBin(i)) {
-				if (!ShouldDrawProjectile(p, thisPassMask))
-					continue;
-
+			for (CProjectile* p : drawList) {
 				DrawProjectileModel(p);
 			}
 
@@ -765,28 +809,18 @@ void CProjectileDrawer::DrawAlpha(AlphaWaterRenderingStage awrs, bool drawReflec
 		}
 	}
 
-	// set static variable to facilite sorting
-	sortCamType = camera->GetCamType();
-
 	{
 		ZoneScopedN("ProjectileDrawer::DrawAlpha(SO)");
-		if (wantDrawOrder)
-			std::sort(drawParticles[true].begin(), drawParticles[true].end(), CProjectileDrawOrderSortingPredicate);
-		else
-			std::sort(drawParticles[true].begin(), drawParticles[true].end(), CProjectileSortingPredicate);
+		SortParticles(drawParticles[true], camera);
 	}
 
 	{
 		ZoneScopedN("ProjectileDrawer::DrawAlpha(DS)");
-		for (auto p : drawParticles[ true]) {
-			p->Draw();
-		}
+		DrawParticles(drawParticles[ true]);
 	}
 	{
 		ZoneScopedN("ProjectileDrawer::DrawAlpha(DU)");
-		for (auto p : drawParticles[false]) {
-			p->Draw();
-		}
+		DrawParticles(drawParticles[false]);
 	}
 
 	{
@@ -847,11 +881,165 @@ void CProjectileDrawer::DrawAlpha(AlphaWaterRenderingStage awrs, bool drawReflec
 	}
 }
 
+void CProjectileDrawer::SortParticles(std::vector<CProjectile*>& particles, const CCamera* cam)
+{
+	// camera moves below which last frame's order is tried as a starting point
+	static constexpr float INCR_SORT_MAX_CAM_DIST = 8.0f;
+	static constexpr float INCR_SORT_MIN_CAM_DOT = 0.999f;
+	// average insertion-sort moves per particle before falling back to a full sort
+	static constexpr size_t INCR_SORT_MAX_MOVES = 4;
+	// fewer particles than this are keyed and radix-sorted on a single thread
+	static constexpr size_t MIN_PARALLEL_SORT_PARTICLES = 8192;
+
+	const uint32_t camType = cam->GetCamType();
+	const size_t numParticles = particles.size();
+	const int numChunks = (numParticles >= MIN_PARALLEL_SORT_PARTICLES)? ThreadPool::GetNumThreads(): 1;
+
+	const auto ParallelFor = [](int n, auto&& f) { for_mt(0, n, f); };
+	const auto EntryKey = [](const ParticleSortEntry& e) { return e.key; };
+
+	assert(camType < particleSortStates.size());
+	ParticleSortState& state = particleSortStates[camType];
+
+	const bool camMovedLittle =
+		(state.stamp != 0) &&
+		(cam->GetPos().SqDistance(state.camPos) < Square(INCR_SORT_MAX_CAM_DIST)) &&
+		(cam->GetDir().dot(state.camDir) > INCR_SORT_MIN_CAM_DOT);
+
+	particleSortEntries.resize(numParticles);
+
+	bool sorted = false;
+
+	if (camMovedLittle) {
+		ZoneScopedN("ProjectileDrawer::SortParticles(incr)");
+
+		// survivors of the previous sort go back into their old order, new
+		// particles fill the array from the back; then fix up whatever moved
+		particleSortSlots.assign(state.numRanked, nullptr);
+
+		size_t numNew = 0;
+		size_t numEntries = 0;
+
+		for (CProjectile* p : particles) {
+			if (p->sortRankStamp[camType] == state.stamp && p->sortRank[camType] < state.numRanked) {
+				particleSortSlots[p->sortRank[camType]] = p;
+				continue;
+			}
+
+			particleSortEntries[numParticles - (++numNew)] = { ParticleSortKey(p, camType, wantDrawOrder), p };
+		}
+
+		for (CProjectile* p : particleSortSlots) {
+			if (p == nullptr)
+				continue;
+
+			particleSortEntries[numEntries++] = { ParticleSortKey(p, camType, wantDrawOrder), p };
+		}
+
+		assert((numEntries + numNew) == numParticles);
+		sorted = spring::InsertionSortBounded(particleSortEntries.data(), numParticles, numParticles * INCR_SORT_MAX_MOVES, EntryKey);
+	} else {
+		for_mt_chunk(0, numParticles, [&](const int i) {
+			particleSortEntries[i] = { ParticleSortKey(particles[i], camType, wantDrawOrder), particles[i] };
+		});
+	}
+
+	if (!sorted) {
+		ZoneScopedN("ProjectileDrawer::SortParticles(radix)");
+		spring::RadixSort(particleSortEntries, particleSortScratch, EntryKey, numChunks, ParallelFor);
+	}
+
+	// stamp 0 marks projectiles that were never ranked
+	state.stamp = std::max(++particleSortStamp, 1u);
+	state.numRanked = numParticles;
+	state.camPos = cam->GetPos();
+	state.camDir = cam->GetDir();
+
+	for_mt_chunk(0, numParticles, [&](const int i) {
+		CProjectile* p = particleSortEntries[i].p;
+
+		p->sortRank[camType] = i;
+		p->sortRankStamp[camType] = state.stamp;
+
+		particles[i] = p;
+	});
+}
+
+void CProjectileDrawer::DrawParticles(const std::vector<CProjectile*>& particles)
+{
+	// fewer particles per segment than this are not worth a task
+	static constexpr size_t MIN_SEGMENT_PARTICLES = 512;
+
+	const size_t numParticles = particles.size();
+	const size_t numSegments = std::min(numParticles / MIN_SEGMENT_PARTICLES, static_cast<size_t>(ThreadPool::GetNumThreads() * 4));
+
+	if (numSegments <= 1) {
+		for (CProjectile* p : particles) {
+			p->Draw();
+		}
+
+		return;
+	}
+
+	if (particleSegments.size() < numSegments)
+		particleSegments.resize(numSegments);
+
+	// every segment emits a contiguous run of particles into its own vertex
+	// list, so concatenating the segments keeps the (sorted) particle order
+	for_mt(0, numSegments, [&](const int i) {
+		ParticleSegment& segment = particleSegments[i];
+
+		segment.quadVerts.clear();
+		segment.serialParticles.clear();
+
+		CExpGenSpawnable::SetThreadEffectsQuadSink(&segment.quadVerts);
+
+		for (size_t j = (i * numParticles) / numSegments, n = ((i + 1) * numParticles) / numSegments; j < n; j++) {
+			CProjectile* p = particles[j];
+
+			if (!p->CanDrawConcurrently()) {
+				segment.serialParticles.push_back(p);
+				continue;
+			}
+
+			p->Draw();
+		}
+
+		CExpGenSpawnable::SetThreadEffectsQuadSink(nullptr);
+	});
+
+	size_t numQuads = 0;
+
+	for (size_t i = 0; i < numSegments; i++) {
+		particleSegments[i].quadOffset = numQuads;
+		numQuads += particleSegments[i].quadVerts.size() / 4;
+	}
+
+	auto& rb = CExpGenSpawnable::GetPrimaryRenderBuffer();
+	const auto range = rb.AddQuadTrianglesUninit(numQuads);
+
+	for_mt(0, numSegments, [&](const int i) {
+		const ParticleSegment& segment = particleSegments[i];
+
+		std::copy(segment.quadVerts.begin(), segment.quadVerts.end(), range.verts + segment.quadOffset * 4);
+		rb.MakeQuadTrianglesIndices(range.indcs + segment.quadOffset * 6, range.baseVertex + segment.quadOffset * 4, segment.quadVerts.size() / 4);
+	});
+
+	// these never write to the primary buffer, emitting them last keeps its order
+	for (size_t i = 0; i < numSegments; i++) {
+		for (CProjectile* p : particleSegments[i].serialParticles) {
+			p->Draw();
+		}
+	}
+}
+
 void CProjectileDrawer::DrawShadowOpaque()
 {
 	ZoneScopedN("ProjectileDrawer::DrawShadowOpaque");
 	Shader::IProgramObject* po = shadowHandler.GetShadowGenProg(CShadowHandler::SHADOWGEN_PROGRAM_PROJECTILE);
 
+	const auto& drawLists = GetModelDrawLists();
+
 	po->Enable();
 
 	for (int modelType = MODELTYPE_3DO; modelType < MODELTYPE_CNT; modelType++) {
@@ -860,15 +1048,14 @@ void CProjectileDrawer::DrawShadowOpaque()
 		const auto& mdlRenderer = modelRenderers[modelType];
 
 		for (uint32_t i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
-			if (mdlRenderer.GetObjectBin(i).empty())
+			const auto& drawList = drawLists.GetList(MODEL_DRAWLIST_SHADOW, modelType, i);
+
+			if (drawList.empty())
 				continue;
 
 			CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
 
-			for (CProjectile* p : mdlRenderer.GetObjectBin(i)) {
-				if (!ShouldDrawProjectile(p, DrawFlags::SO_SHOPAQ_FLAG))
-					continue;
-
+			for (CProjectile* p : drawList) {
 				DrawProjectileModel(p);
 			}
 
@@ -1215,8 +1402,18 @@ void CProjectileDrawer::RenderProjectileCreated(const CProjectile* p)
 	const_cast<CProjectile*>(p)->SetRenderIndex(rp.size());
 	rp.push_back(const_cast<CProjectile*>(p));
 
-	if (p->model != nullptr)
+	if (p->model != nullptr) {
 		modelRenderers[MDL_TYPE(p)].AddObject(p);
+		modelDrawLists.MarkStale();
+	}
+}
+
+void CProjectileDrawer::RenderProjectileCreatedBatch(std::span<const CProjectile* const> projectiles)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	for (const CProjectile* p: projectiles) {
+		RenderProjectileCreated(p);
+	}
 }
 
 void CProjectileDrawer::RenderProjectileDestroyed(const CProjectile* p)
@@ -1233,7 +1430,9 @@ void CProjectileDrawer::RenderProjectileDestroyed(const CProjectile* p)
 	rp[ri]->SetRenderIndex(ri);
 	rp.pop_back();
 
-	if (p->model != nullptr)
+	if (p->model != nullptr) {
 		modelRenderers[MDL_TYPE(p)].DelObject(p);
+		modelDrawLists.MarkStale();
+	}
 }
 
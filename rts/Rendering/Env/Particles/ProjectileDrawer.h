@@ -8,15 +8,19 @@
 #include "Sim/Projectiles/Projectile.h"
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GL/FBO.h"
+#include "Rendering/GL/VertexArrayTypes.h"
 #include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/Shaders/Shader.h"
 #include "Rendering/Models/3DModel.h"
 #include "Rendering/Models/ModelRenderContainer.h"
 #include "Rendering/DepthBufferCopy.h"
+#include "Rendering/Common/FrustumCuller.h"
+#include "Rendering/Common/ModelDrawLists.h"
 #include "System/EventClient.h"
 #include "System/UnorderedSet.hpp"
 
 class CSolidObject;
+class CCamera;
 class CTextureAtlas;
 struct AtlasedTexture;
 class CGroundFlash;
@@ -61,10 +65,14 @@ public:
 			(eventName == "RenderProjectileCreated") ||
 			(eventName == "RenderProjectileDestroyed");
 	}
+	bool WantsBatchedEvent(const std::string& eventName) const {
+		return (eventName == "RenderProjectileCreated");
+	}
 	bool GetFullRead() const { return true; }
 	int GetReadAllyTeam() const { return AllAccessTeam; }
 
 	void RenderProjectileCreated(const CProjectile* projectile);
+	void RenderProjectileCreatedBatch(std::span<const CProjectile* const> projectiles);
 	void RenderProjectileDestroyed(const CProjectile* projectile);
 
 	unsigned int NumSmokeTextures() const { return (smokeTextures.size()); }
@@ -139,6 +147,15 @@ private:
 	void DrawProjectiles(int modelType, bool drawReflection, bool drawRefraction);
 	void DrawProjectilesShadow(int modelType);
 	void DrawFlyingPieces(int modelType) const;
+	void BuildModelDrawLists();
+	const auto& GetModelDrawLists() {
+		if (modelDrawLists.IsStale())
+			BuildModelDrawLists();
+
+		return modelDrawLists;
+	}
+	void SortParticles(std::vector<CProjectile*>& particles, const CCamera* cam);
+	void DrawParticles(const std::vector<CProjectile*>& particles);
 
 	static void DrawProjectileModel(const CProjectile* projectile);
 
@@ -166,13 +183,55 @@ private:
 
 	/// projectiles container {modelless, model}
 	std::array<std::vector<CProjectile*>, 2> renderProjectiles;
+	/// per-camera visibility of renderProjectiles, rebuilt by UpdateDrawFlags
+	std::array<CFrustumCuller, 2> renderProjectileCullers;
 
 	/// projectiles with a model, binned by model type and textures
 	std::array<ModelRenderContainer<CProjectile>, MODELTYPE_CNT> modelRenderers;
 
+	enum ModelDrawListPass {
+		MODEL_DRAWLIST_OPAQUE,
+		MODEL_DRAWLIST_REFLEC,
+		MODEL_DRAWLIST_REFRAC,
+		MODEL_DRAWLIST_SHADOW,
+		MODEL_DRAWLIST_CNT
+	};
+
+	/// modelRenderers bins filtered per pass by draw flag, rebuilt by UpdateDrawFlags
+	ModelDrawLists<CProjectile, MODEL_DRAWLIST_CNT> modelDrawLists;
+
 	/// used to render particle effects in back-to-front order. {unsorted, sorted}
 	std::array<std::vector<CProjectile*>, 2> drawParticles;
 
+	struct ParticleSortEntry {
+		uint64_t key;
+		CProjectile* p;
+	};
+	struct ParticleSortState {
+		float3 camPos;
+		float3 camDir;
+
+		uint32_t stamp = 0;
+		size_t numRanked = 0;
+	};
+
+	/// key arrays for SortParticles and the outcome of its last sort per camera type
+	std::vector<ParticleSortEntry> particleSortEntries;
+	std::vector<ParticleSortEntry> particleSortScratch;
+	std::vector<CProjectile*> particleSortSlots;
+	std::array<ParticleSortState, 3> particleSortStates;
+
+	uint32_t particleSortStamp = 0;
+
+	struct ParticleSegment {
+		std::vector<VA_TYPE_PROJ> quadVerts;
+		std::vector<CProjectile*> serialParticles;
+		size_t quadOffset = 0;
+	};
+
+	/// per-task output of DrawParticles, kept to reuse their capacity
+	std::vector<ParticleSegment> particleSegments;
+
 	bool drawSorted = true;
 
 	std::array<Shader::IProgramObject*, 2> fxShaders = { nullptr };
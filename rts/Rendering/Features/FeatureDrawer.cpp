@@ -49,7 +49,7 @@ void CFeatureDrawer::InitStatic()
 	SelectImplementation();
 }
 
-bool CFeatureDrawer::ShouldDrawOpaqueFeature(CFeature* f, uint8_t thisPassMask)
+bool CFeatureDrawer::IsOpaqueFeatureCandidate(const CFeature* f, uint8_t thisPassMask)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	assert(f);
@@ -70,6 +70,12 @@ bool CFeatureDrawer::ShouldDrawOpaqueFeature(CFeature* f, uint8_t thisPassMask)
 	if (thisPassMask == DrawFlags::SO_OPAQUE_FLAG && !f->HasDrawFlag(DrawFlags::SO_OPAQUE_FLAG))
 		return false;
 
+	return true;
+}
+
+bool CFeatureDrawer::ShouldDrawOpaqueFeature(CFeature* f, uint8_t thisPassMask)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
 	if (LuaObjectDrawer::AddOpaqueMaterialObject(f, LUAOBJ_FEATURE))
 		return false;
 
@@ -79,7 +85,7 @@ bool CFeatureDrawer::ShouldDrawOpaqueFeature(CFeature* f, uint8_t thisPassMask)
 	return true;
 }
 
-bool CFeatureDrawer::ShouldDrawAlphaFeature(CFeature* f, uint8_t thisPassMask)
+bool CFeatureDrawer::IsAlphaFeatureCandidate(const CFeature* f, uint8_t thisPassMask)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	assert(f);
@@ -100,6 +106,12 @@ bool CFeatureDrawer::ShouldDrawAlphaFeature(CFeature* f, uint8_t thisPassMask)
 	if (thisPassMask == DrawFlags::SO_ALPHAF_FLAG && !f->HasDrawFlag(DrawFlags::SO_ALPHAF_FLAG))
 		return false;
 
+	return true;
+}
+
+bool CFeatureDrawer::ShouldDrawAlphaFeature(CFeature* f, uint8_t thisPassMask)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
 	if (LuaObjectDrawer::AddAlphaMaterialObject(f, LUAOBJ_FEATURE))
 		return false;
 
@@ -109,16 +121,19 @@ bool CFeatureDrawer::ShouldDrawAlphaFeature(CFeature* f, uint8_t thisPassMask)
 	return true;
 }
 
-bool CFeatureDrawer::ShouldDrawFeatureShadow(CFeature* f)
+bool CFeatureDrawer::IsFeatureShadowCandidate(const CFeature* f)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	assert(f);
 	assert(f->model);
 
-	static constexpr uint8_t thisPassMask = DrawFlags::SO_SHOPAQ_FLAG;
+	return (f->HasDrawFlag(DrawFlags::SO_SHOPAQ_FLAG));
+}
 
-	if (!f->HasDrawFlag(DrawFlags::SO_SHOPAQ_FLAG))
-		return false;
+bool CFeatureDrawer::ShouldDrawFeatureShadow(CFeature* f)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	static constexpr uint8_t thisPassMask = DrawFlags::SO_SHOPAQ_FLAG;
 
 	if (LuaObjectDrawer::AddShadowMaterialObject(f, LUAOBJ_FEATURE))
 		return false;
@@ -202,9 +217,13 @@ void CFeatureDrawerLegacy::DrawObjectsShadow(int modelType) const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	const auto& mdlRenderer = modelDrawerData->GetModelRenderer(modelType);
+	const auto& drawLists = modelDrawerData->GetDrawLists();
+	const auto drawListPass = CModelDrawerDataConcept::DRAWLIST_SHADOW;
 
 	for (uint32_t i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
-		if (mdlRenderer.GetObjectBin(i).empty())
+		const auto& drawList = drawLists.GetList(drawListPass, modelType, i);
+
+		if (drawList.empty())
 			continue;
 
 		// only need to bind the atlas once for 3DO's, but KISS
@@ -214,7 +233,7 @@ void CFeatureDrawerLegacy::DrawObjectsShadow(int modelType) const
 		const auto* texMat = textureHandlerS3O.GetTexture(mdlRenderer.GetObjectBinKey(i));
 		CModelDrawerHelper::modelDrawerHelpers[modelType]->BindShadowTex(texMat);
 
-		for (auto* o : mdlRenderer.GetObjectBin(i)) {
+		for (auto* o : drawList) {
 			DrawFeatureShadow(o);
 		}
 
@@ -231,14 +250,18 @@ void CFeatureDrawerLegacy::DrawOpaqueObjects(int modelType, bool drawReflection,
 		(drawRefraction * DrawFlags::SO_REFRAC_FLAG);
 
 	const auto& mdlRenderer = modelDrawerData->GetModelRenderer(modelType);
+	const auto& drawLists = modelDrawerData->GetDrawLists();
+	const auto drawListPass = CModelDrawerDataConcept::GetOpaqueDrawListPass(drawReflection, drawRefraction);
 
 	for (uint32_t i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
-		if (mdlRenderer.GetObjectBin(i).empty())
+		const auto& drawList = drawLists.GetList(drawListPass, modelType, i);
+
+		if (drawList.empty())
 			continue;
 
 		CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
 
-		for (auto* o : mdlRenderer.GetObjectBin(i)) {
+		for (auto* o : drawList) {
 			DrawOpaqueFeature(o, thisPassMask);
 		}
 	}
@@ -253,14 +276,18 @@ void CFeatureDrawerLegacy::DrawAlphaObjects(int modelType, bool drawReflection,
 		(drawRefraction * DrawFlags::SO_REFRAC_FLAG);
 
 	const auto& mdlRenderer = modelDrawerData->GetModelRenderer(modelType);
+	const auto& drawLists = modelDrawerData->GetDrawLists();
+	const auto drawListPass = CModelDrawerDataConcept::GetAlphaDrawListPass(drawReflection, drawRefraction);
 
 	for (uint32_t i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
-		if (mdlRenderer.GetObjectBin(i).empty())
+		const auto& drawList = drawLists.GetList(drawListPass, modelType, i);
+
+		if (drawList.empty())
 			continue;
 
 		CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
 
-		for (auto* o : mdlRenderer.GetObjectBin(i)) {
+		for (auto* o : drawList) {
 			DrawAlphaFeature(o, thisPassMask);
 		}
 	}
@@ -307,20 +334,22 @@ void CFeatureDrawerGL4::DrawObjectsShadow(int modelType) const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	const auto& mdlRenderer = modelDrawerData->GetModelRenderer(modelType);
+	const auto& drawLists = modelDrawerData->GetDrawLists();
+	const auto drawListPass = CModelDrawerDataConcept::DRAWLIST_SHADOW;
 
 	auto& smv = S3DModelVAO::GetInstance();
 	smv.Bind();
 
 	for (uint32_t i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
-		if (mdlRenderer.GetObjectBin(i).empty())
+		const auto& drawList = drawLists.GetList(drawListPass, modelType, i);
+
+		if (drawList.empty())
 			continue;
 
 		const auto* texMat = textureHandlerS3O.GetTexture(mdlRenderer.GetObjectBinKey(i));
 		CModelDrawerHelper::modelDrawerHelpers[modelType]->BindShadowTex(texMat);
 
-		const auto& bin = mdlRenderer.GetObjectBin(i);
-
-		for (auto* o : bin) {
+		for (auto* o : drawList) {
 			if (!ShouldDrawFeatureShadow(o))
 				continue;
 
@@ -344,6 +373,8 @@ void CFeatureDrawerGL4::DrawOpaqueObjects(int modelType, bool drawReflection, bo
 		(drawRefraction * DrawFlags::SO_REFRAC_FLAG);
 
 	const auto& mdlRenderer = modelDrawerData->GetModelRenderer(modelType);
+	const auto& drawLists = modelDrawerData->GetDrawLists();
+	const auto drawListPass = CModelDrawerDataConcept::GetOpaqueDrawListPass(drawReflection, drawRefraction);
 
 	SetTeamColor(0, 1.0f);
 	modelDrawerState->SetColorMultiplier();
@@ -352,12 +383,14 @@ void CFeatureDrawerGL4::DrawOpaqueObjects(int modelType, bool drawReflection, bo
 	smv.Bind();
 
 	for (unsigned int i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
-		if (mdlRenderer.GetObjectBin(i).empty())
+		const auto& drawList = drawLists.GetList(drawListPass, modelType, i);
+
+		if (drawList.empty())
 			continue;
 
 		CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
 
-		for (auto* o : mdlRenderer.GetObjectBin(i)) {
+		for (auto* o : drawList) {
 			if (!ShouldDrawOpaqueFeature(o, thisPassMask))
 				continue;
 
@@ -378,6 +411,8 @@ void CFeatureDrawerGL4::DrawAlphaObjects(int modelType, bool drawReflection, boo
 		(drawRefraction * DrawFlags::SO_REFRAC_FLAG);
 
 	const auto& mdlRenderer = modelDrawerData->GetModelRenderer(modelType);
+	const auto& drawLists = modelDrawerData->GetDrawLists();
+	const auto drawListPass = CModelDrawerDataConcept::GetAlphaDrawListPass(drawReflection, drawRefraction);
 
 	auto& smv = S3DModelVAO::GetInstance();
 	smv.Bind();
@@ -387,14 +422,14 @@ void CFeatureDrawerGL4::DrawAlphaObjects(int modelType, bool drawReflection, boo
 
 	//main cloaked alpha pass
 	for (uint32_t i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
-		if (mdlRenderer.GetObjectBin(i).empty())
+		const auto& drawList = drawLists.GetList(drawListPass, modelType, i);
+
+		if (drawList.empty())
 			continue;
 
 		CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
 
-		const auto& bin = mdlRenderer.GetObjectBin(i);
-
-		for (auto* o : bin) {
+		for (auto* o : drawList) {
 			if (!ShouldDrawAlphaFeature(o, thisPassMask))
 				continue;
 
@@ -36,7 +36,13 @@ public:
 	static void ClearPreviousDrawFlags() { modelDrawerData->ClearPreviousDrawFlags(); }
 public:
 	virtual void DrawFeatureModel(const CFeature* feature, bool noLuaCall) const = 0;
+public:
+	// draw-list membership tests, thread-safe; see CModelDrawerDataBase::BuildDrawLists
+	static bool IsOpaqueFeatureCandidate(const CFeature* f, uint8_t thisPassMask);
+	static bool IsAlphaFeatureCandidate(const CFeature* f, uint8_t thisPassMask);
+	static bool IsFeatureShadowCandidate(const CFeature* f);
 protected:
+	// remaining render-thread tests (Lua material binning, engineDrawMask) for draw-list entries
 	static bool ShouldDrawOpaqueFeature(CFeature* f, uint8_t thisPassMask);
 	static bool ShouldDrawAlphaFeature(CFeature* f, uint8_t thisPassMask);
 	static bool ShouldDrawFeatureShadow(CFeature* f);
@@ -10,6 +10,7 @@
 #include "Rendering/LuaObjectDrawer.h"
 #include "Rendering/ShadowHandler.h"
 #include "Rendering/Common/ModelDrawerHelpers.h"
+#include "Rendering/Features/FeatureDrawer.h"
 
 #include "System/Misc/TracyDefs.h"
 
@@ -98,17 +99,53 @@ void CFeatureDrawerData::Update()
 	RECOIL_DETAILED_TRACY_ZONE;
 	if (mtModelDrawer) {
 		for_mt_chunk(0, unsortedObjects.size(), [this](const int k) {
-			CFeature* f = unsortedObjects[k];
-			UpdateDrawPos(f);
-			UpdateCommon(f);
+			UpdateDrawPos(unsortedObjects[k]);
 		}, CModelDrawerDataConcept::MT_CHUNK_OR_MIN_CHUNK_SIZE_UPDT);
 	}
 	else {
 		for (CFeature* f : unsortedObjects) {
 			UpdateDrawPos(f);
-			UpdateCommon(f);
 		}
 	}
+
+	{
+		SCOPED_TIMER("Update::WorldDrawer::Cull::Features");
+		CullObjects();
+	}
+
+	if (mtModelDrawer) {
+		for_mt_chunk(0, unsortedObjects.size(), [this](const int k) {
+			UpdateCommon(unsortedObjects[k], k);
+		}, CModelDrawerDataConcept::MT_CHUNK_OR_MIN_CHUNK_SIZE_UPDT);
+	}
+	else {
+		for (size_t k = 0; k < unsortedObjects.size(); k++) {
+			UpdateCommon(unsortedObjects[k], k);
+		}
+	}
+
+	{
+		SCOPED_TIMER("Update::WorldDrawer::DrawLists::Features");
+		BuildDrawLists();
+	}
+}
+
+uint32_t CFeatureDrawerData::GetDrawListPassMask(const CFeature* f) const
+{
+	if (f->drawFlag == 0)
+		return 0;
+
+	uint32_t passMask = 0;
+
+	passMask |= (CFeatureDrawer::IsOpaqueFeatureCandidate(f, DrawFlags::SO_OPAQUE_FLAG) << DRAWLIST_OPAQUE       );
+	passMask |= (CFeatureDrawer::IsOpaqueFeatureCandidate(f, DrawFlags::SO_REFLEC_FLAG) << DRAWLIST_OPAQUE_REFLEC);
+	passMask |= (CFeatureDrawer::IsOpaqueFeatureCandidate(f, DrawFlags::SO_REFRAC_FLAG) << DRAWLIST_OPAQUE_REFRAC);
+	passMask |= (CFeatureDrawer::IsAlphaFeatureCandidate (f, DrawFlags::SO_ALPHAF_FLAG) << DRAWLIST_ALPHA        );
+	passMask |= (CFeatureDrawer::IsAlphaFeatureCandidate (f, DrawFlags::SO_REFLEC_FLAG) << DRAWLIST_ALPHA_REFLEC );
+	passMask |= (CFeatureDrawer::IsAlphaFeatureCandidate (f, DrawFlags::SO_REFRAC_FLAG) << DRAWLIST_ALPHA_REFRAC );
+	passMask |= (CFeatureDrawer::IsFeatureShadowCandidate(f                           ) << DRAWLIST_SHADOW       );
+
+	return passMask;
 }
 
 bool CFeatureDrawerData::IsAlpha(const CFeature* co) const
@@ -117,7 +154,7 @@ bool CFeatureDrawerData::IsAlpha(const CFeature* co) const
 	return (co->drawAlpha < 1.0f);
 }
 
-void CFeatureDrawerData::UpdateObjectDrawFlags(CSolidObject* o) const
+void CFeatureDrawerData::UpdateObjectDrawFlags(CSolidObject* o, size_t cullIndex) const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	CFeature* f = static_cast<CFeature*>(o);
@@ -141,7 +178,7 @@ void CFeatureDrawerData::UpdateObjectDrawFlags(CSolidObject* o) const
 		if (!f->IsInLosForAllyTeam(gu->myAllyTeam) && !gu->spectatingFullView)
 			continue;
 
-		if (!cam->InView(f->drawMidPos, f->GetDrawRadius()))
+		if (!frustumCuller.InView(camType, cullIndex))
 			continue;
 
 		switch (camType)
@@ -27,7 +27,8 @@ public:
 	void Update() override;
 	bool IsAlpha(const CFeature* co) const override;
 protected:
-	void UpdateObjectDrawFlags(CSolidObject* o) const override;
+	void UpdateObjectDrawFlags(CSolidObject* o, size_t cullIndex) const override;
+	uint32_t GetDrawListPassMask(const CFeature* f) const override;
 private:
 	static void UpdateDrawPos(CFeature* f);
 public:
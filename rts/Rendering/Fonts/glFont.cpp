@@ -180,6 +180,11 @@ CglFont::CglFont(const std::string& fontFile, int size, int _outlineWidth, float
 		[f = this](const std::string& str) { HeightCache hc; hc.height = f->GetTextHeight_(toustring(str), &hc.descender, &hc.numLines); return hc; },
 		[](const std::string& str, const auto& cache) {}, //don't save anything
 	}
+	, glyphRuns {
+		1 << 10,
+		[f = this](const std::string& str) { return f->LayoutGlyphRun(toustring(str)); },
+		[](const std::string& str, const auto& cache) {}, //don't save anything
+	}
 {
 	textColor    = white;
 	outlineColor = darkOutline;
@@ -208,10 +213,12 @@ void CglFont::SetOutlineColor(const float4* color) {}
 void CglFont::SetColors(const float4* textColor, const float4* outlineColor) {}
 
 float CglFont::GetCharacterWidth(const char32_t c) { return 1.0f; }
-bool CglFont::SkipColorCodesAndNewLines(const spring::u8string& text, int& curIndex, int& numLines)
+bool CglFont::SkipColorCodesAndNewLines(const spring::u8string& text, int& curIndex, int& numLines, GlyphRun& glyphRun)
 {
 	return true;
 }
+std::shared_ptr<const CglFont::GlyphRun> CglFont::LayoutGlyphRun(const spring::u8string& ustr) { return std::make_shared<GlyphRun>(); }
+void CglFont::ApplyColorChange(const ColorChange& colorChange) {}
 void CglFont::ScanForWantedGlyphs(const spring::u8string& str) {}
 float CglFont::GetTextWidth_(const spring::u8string& text) { return (text.size() * 1.0f); }
 float CglFont::GetTextHeight_(const spring::u8string& text, float* descender, int* numLines) { return 1.0f; }
@@ -247,9 +254,12 @@ static inline int SkipColorCodes(const spring::u8string& text, int idx)
 }
 
 
-bool CglFont::SkipColorCodesAndNewLines(const spring::u8string& text, int& curIndex, int& numLines)
+// in-text color changes are recorded into the run, ApplyColorChange executes them on draw
+bool CglFont::SkipColorCodesAndNewLines(const spring::u8string& text, int& curIndex, int& numLines, GlyphRun& glyphRun)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	const uint32_t quadIdx = static_cast<uint32_t>(glyphRun.quads.size());
+
 	int idx = curIndex;
 	int nls = 0;
 
@@ -259,10 +269,7 @@ bool CglFont::SkipColorCodesAndNewLines(const spring::u8string& text, int& curIn
 			case CglFont::ColorCodeIndicator: {
 				if ((idx += 3 + 1) < end) {
 					const float4 newTextColor = { text[idx - 3] / 255.0f, text[idx - 2] / 255.0f, text[idx - 1] / 255.0f, 1.0f };
-					if (autoOutlineColor)
-						SetColors(&newTextColor, nullptr);
-					else
-						SetTextColor(&newTextColor);
+					glyphRun.colorChanges.push_back({quadIdx, ColorChange::COLOR_TEXT, newTextColor, {}});
 				}
 			} break;
 			case CglFont::ColorCodeIndicatorEx: {
@@ -270,13 +277,13 @@ bool CglFont::SkipColorCodesAndNewLines(const spring::u8string& text, int& curIn
 					const float4 newTextColor = { text[idx - 8] / 255.0f, text[idx - 7] / 255.0f, text[idx - 6] / 255.0f, text[idx - 5] / 255.0f };
 					const float4 newOutlColor = { text[idx - 4] / 255.0f, text[idx - 3] / 255.0f, text[idx - 2] / 255.0f, text[idx - 1] / 255.0f };
 					// ignore autoOutline here
-					SetColors(&newTextColor, &newOutlColor);
+					glyphRun.colorChanges.push_back({quadIdx, ColorChange::COLOR_TEXT_OUTLINE, newTextColor, newOutlColor});
 				}
 			} break;
 
 			case CglFont::ColorResetIndicator: {
 				idx += 1;
-				SetColors(&baseTextColor, &baseOutlineColor);
+				glyphRun.colorChanges.push_back({quadIdx, ColorChange::COLOR_RESET, {}, {}});
 			} break;
 
 			case 0x0D: {
@@ -600,6 +607,24 @@ void CglFont::SetColors(const float4* _textColor, const float4* _outlineColor)
 	SetOutlineColor(_outlineColor);
 }
 
+void CglFont::ApplyColorChange(const ColorChange& colorChange)
+{
+	switch (colorChange.type) {
+		case ColorChange::COLOR_TEXT: {
+			if (autoOutlineColor)
+				SetColors(&colorChange.textColor, nullptr);
+			else
+				SetTextColor(&colorChange.textColor);
+		} break;
+		case ColorChange::COLOR_TEXT_OUTLINE: {
+			SetColors(&colorChange.textColor, &colorChange.outlineColor);
+		} break;
+		case ColorChange::COLOR_RESET: {
+			SetColors(&baseTextColor, &baseOutlineColor);
+		} break;
+	}
+}
+
 const float4* CglFont::ChooseOutlineColor(const float4& textColor)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -672,16 +697,17 @@ void CglFont::DrawWorldBuffered()
 	glPopMatrix();
 }
 
-template<int shiftXC, int shiftYC, bool outline>
-void CglFont::RenderStringImpl(float x, float y, float scaleX, float scaleY, const std::string& str)
+std::shared_ptr<const CglFont::GlyphRun> CglFont::LayoutGlyphRun(const spring::u8string& ustr)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	const spring::u8string& ustr = toustring(str);
+	const spring_time layoutStartTime = spring_gettime();
 
 	ScanForWantedGlyphs(ustr);
 
-	const float startx = x;
-	const float lineHeight_ = scaleY * GetLineHeight();
+	auto glyphRun = std::make_shared<GlyphRun>();
+
+	float x = 0.0f;
+	float y = 0.0f;
 
 	char32_t curGlyphIdx = 0;
 	char32_t prvGlyphIdx = 0;
@@ -689,62 +715,87 @@ void CglFont::RenderStringImpl(float x, float y, float scaleX, float scaleY, con
 	int currentPos = 0;
 	int skippedLines = 0;
 
-	constexpr float texScaleX = 1.0f;
-	constexpr float texScaleY = 1.0f;
-
 	// check for end-of-string
-	while (!SkipColorCodesAndNewLines(ustr, currentPos, skippedLines)) {
+	while (!SkipColorCodesAndNewLines(ustr, currentPos, skippedLines, *glyphRun)) {
 		curGlyphIdx = utf8::GetNextChar(ustr, currentPos);
 
-		const GlyphInfo* curGlyphPtr = &GetGlyph(curGlyphIdx);
-		assert(curGlyphPtr != &CFontTexture::dummyGlyph);
-		const GlyphInfo* prvGlyphPtr = nullptr;
+		// glyph data is copied into the run, GlyphInfo references do not outlive rehashing
+		const GlyphInfo& curGlyph = GetGlyph(curGlyphIdx);
+		assert(&curGlyph != &CFontTexture::dummyGlyph);
 
 		if (skippedLines > 0) {
-			x = startx;
-			y -= (skippedLines * lineHeight_);
+			x = 0.0f;
+			y -= (skippedLines * GetLineHeight());
 		}
 		else if (prvGlyphIdx != 0) {
-			prvGlyphPtr = &GetGlyph(prvGlyphIdx);
-			assert(prvGlyphPtr != &CFontTexture::dummyGlyph);
-			x += (scaleX * GetKerning(*prvGlyphPtr, *curGlyphPtr));
+			const GlyphInfo& prvGlyph = GetGlyph(prvGlyphIdx);
+			assert(&prvGlyph != &CFontTexture::dummyGlyph);
+			x += GetKerning(prvGlyph, curGlyph);
 		}
 
-		prvGlyphPtr = curGlyphPtr;
 		prvGlyphIdx = curGlyphIdx;
 
+		const auto& tc = curGlyph.texCord;
+		const auto& stc = curGlyph.shadowTexCord;
 
-		const auto& tc = prvGlyphPtr->texCord;
-		const float dx0 = (scaleX * prvGlyphPtr->size.x0()) + x;
-		const float dy0 = (scaleY * prvGlyphPtr->size.y0()) + y;
-		const float dx1 = (scaleX * prvGlyphPtr->size.x1()) + x;
-		const float dy1 = (scaleY * prvGlyphPtr->size.y1()) + y;
-		const float tx0 = tc.x0() * texScaleX;
-		const float ty0 = tc.y0() * texScaleY;
-		const float tx1 = tc.x1() * texScaleX;
-		const float ty1 = tc.y1() * texScaleY;
+		glyphRun->quads.push_back({
+			{curGlyph.size.x0() + x, curGlyph.size.y0() + y, curGlyph.size.x1() + x, curGlyph.size.y1() + y},
+			{tc.x0(), tc.y0(), tc.x1(), tc.y1()},
+			{stc.x0(), stc.y0(), stc.x1(), stc.y1()},
+		});
+	}
 
+	layoutCacheStats.numLayouts += 1;
+	layoutCacheStats.layoutTime += (spring_gettime() - layoutStartTime);
 
-		if constexpr (shiftXC > 0 || shiftYC > 0 || outline) {
-			const auto& stc = prvGlyphPtr->shadowTexCord;
-			const float stx0 = stc.x0() * texScaleX;
-			const float sty0 = stc.y0() * texScaleY;
-			const float stx1 = stc.x1() * texScaleX;
-			const float sty1 = stc.y1() * texScaleY;
-
-			float shiftX = 0.0f;
-			float shiftY = 0.0f;
-			if constexpr (shiftXC > 0 || shiftYC > 0) {
-				shiftX = scaleX * static_cast<float>(shiftXC) / 100.0f;
-				shiftY = scaleY * static_cast<float>(shiftYC) / 100.0f;
-			}
+	return glyphRun;
+}
 
-			float ssX = 0.0f;
-			float ssY = 0.0f;
-			if constexpr (outline) {
-				ssX = (scaleX / fontSize) * GetOutlineWidth();
-				ssY = (scaleY / fontSize) * GetOutlineWidth();
-			}
+template<int shiftXC, int shiftYC, bool outline>
+void CglFont::RenderStringImpl(float x, float y, float scaleX, float scaleY, const std::string& str)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// layout is cached per string in font units; position and scale are applied here
+	const std::shared_ptr<const GlyphRun> glyphRun = GetGlyphRun(str);
+
+	float shiftX = 0.0f;
+	float shiftY = 0.0f;
+	if constexpr (shiftXC > 0 || shiftYC > 0) {
+		shiftX = scaleX * static_cast<float>(shiftXC) / 100.0f;
+		shiftY = scaleY * static_cast<float>(shiftYC) / 100.0f;
+	}
+
+	float ssX = 0.0f;
+	float ssY = 0.0f;
+	if constexpr (outline) {
+		ssX = (scaleX / fontSize) * GetOutlineWidth();
+		ssY = (scaleY / fontSize) * GetOutlineWidth();
+	}
+
+	auto colorChangeIt = glyphRun->colorChanges.cbegin();
+
+	for (size_t i = 0, n = glyphRun->quads.size(); i < n; i++) {
+		for (; colorChangeIt != glyphRun->colorChanges.cend() && colorChangeIt->quadIdx <= i; ++colorChangeIt) {
+			ApplyColorChange(*colorChangeIt);
+		}
+
+		const GlyphQuad& quad = glyphRun->quads[i];
+
+		const float dx0 = (scaleX * quad.pos.x) + x;
+		const float dy0 = (scaleY * quad.pos.y) + y;
+		const float dx1 = (scaleX * quad.pos.z) + x;
+		const float dy1 = (scaleY * quad.pos.w) + y;
+		const float tx0 = quad.texCoords.x;
+		const float ty0 = quad.texCoords.y;
+		const float tx1 = quad.texCoords.z;
+		const float ty1 = quad.texCoords.w;
+
+
+		if constexpr (shiftXC > 0 || shiftYC > 0 || outline) {
+			const float stx0 = quad.shadowTexCoords.x;
+			const float sty0 = quad.shadowTexCoords.y;
+			const float stx1 = quad.shadowTexCoords.z;
+			const float sty1 = quad.shadowTexCoords.w;
 
 			fontRenderer->AddQuadTrianglesOB(
 				{ {dx0 + shiftX - ssX, dy0 - shiftY + ssY, textDepth.y},  stx0, sty0,  (&outlineColor.x) },
@@ -761,6 +812,11 @@ void CglFont::RenderStringImpl(float x, float y, float scaleX, float scaleY, con
 			{ {dx0, dy1, textDepth.x},  tx0, ty1,  (&textColor.x) }
 		);
 	}
+
+	// trailing color codes still leave their state behind
+	for (; colorChangeIt != glyphRun->colorChanges.cend(); ++colorChangeIt) {
+		ApplyColorChange(*colorChangeIt);
+	}
 }
 
 void CglFont::glWorldPrint(const float3& p, const float size, const std::string& str, int options)
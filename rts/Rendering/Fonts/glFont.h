@@ -5,6 +5,7 @@
 #include <string>
 #include <deque>
 #include <memory>
+#include <vector>
 
 #include "TextWrap.h"
 #include "ustring.h"
@@ -12,6 +13,7 @@
 #include "Rendering/GL/RenderBuffers.h"
 #include "System/float4.h"
 #include "System/Color.h"
+#include "System/Misc/SpringTime.h"
 #include "lru/LruClockCache.h"
 
 #undef GetCharWidth // winapi.h
@@ -107,6 +109,14 @@ public:
 
 	void GetStats(std::array<size_t, 8>& stats) const;
 
+	struct LayoutCacheStats {
+		size_t numLookups = 0;
+		size_t numLayouts = 0; // cache misses
+		spring_time layoutTime;
+	};
+
+	const LayoutCacheStats& GetLayoutCacheStats() const { return layoutCacheStats; }
+
 	static constexpr char8_t ColorCodeIndicator   = 0xFF;
 	static constexpr char8_t ColorCodeIndicatorEx = 0xFE;
 	static constexpr char8_t ColorResetIndicator  = 0x08; // =: '\\b'
@@ -125,10 +135,43 @@ private:
 	void RenderStringShadow(float x, float y, float scaleX, float scaleY, const std::string& str) {
 		RenderStringImpl<10, 10, true >(x, y, scaleX, scaleY, str);
 	}
+private:
+	// one glyph of a laid out string, in font units relative to the pen start
+	// so the same run can be drawn at any position and scale
+	struct GlyphQuad {
+		float4 pos; // x0,y0,x1,y1
+		float4 texCoords;
+		float4 shadowTexCoords;
+	};
+	struct ColorChange {
+		enum Type: uint8_t {
+			COLOR_TEXT,
+			COLOR_TEXT_OUTLINE,
+			COLOR_RESET,
+		};
+
+		uint32_t quadIdx; // applied before this quad is emitted
+		Type type;
+		float4 textColor;
+		float4 outlineColor;
+	};
+	struct GlyphRun {
+		std::vector<GlyphQuad> quads;
+		std::vector<ColorChange> colorChanges;
+	};
+
+	std::shared_ptr<const GlyphRun> GetGlyphRun(const std::string& str) {
+		layoutCacheStats.numLookups += 1;
+		return glyphRuns.Get(str);
+	}
+	std::shared_ptr<const GlyphRun> LayoutGlyphRun(const spring::u8string& ustr);
+	void ApplyColorChange(const ColorChange& colorChange);
+
 	bool SkipColorCodesAndNewLines(
 		const spring::u8string& text,
 		int& curIndex,
-		int& numLines
+		int& numLines,
+		GlyphRun& glyphRun
 	);
 private:
 	void ScanForWantedGlyphs(const spring::u8string& str);
@@ -161,6 +204,9 @@ private:
 
 	spring::LRUClockCache<std::string, float> stringWidth;
 	spring::LRUClockCache<std::string, HeightCache> stringHeight;
+	spring::LRUClockCache<std::string, std::shared_ptr<const GlyphRun>> glyphRuns;
+
+	LayoutCacheStats layoutCacheStats;
 
 	CMatrix44f viewMatrix;
 	CMatrix44f projMatrix;
@@ -569,6 +569,43 @@ public:
 	void MakeQuadsLines(VertType&& tl, VertType&& tr, VertType&& br, VertType&& bl, int xDiv, int yDiv) { MakeQuadsLinesImpl(tl, tr, br, bl, xDiv, yDiv); }
 	void MakeQuadsLines(const VertType& tl, const VertType& tr, const VertType& br, const VertType& bl, int xDiv, int yDiv) { MakeQuadsLinesImpl(std::move(tl), std::move(tr), std::move(br), std::move(bl), xDiv, yDiv); }
 
+	struct QuadTrianglesRange {
+		VertType* verts;
+		IndcType* indcs;
+		IndcType baseVertex;
+	};
+
+	// grows the buffer by <numQuads> quads at once, leaving their contents for
+	// the caller to fill: 4 vertices per quad in AddQuadTriangles order, and
+	// the indices via MakeQuadTrianglesIndices; disjoint quads of the range
+	// may be written from different threads until the buffer grows again
+	QuadTrianglesRange AddQuadTrianglesUninit(size_t numQuads) {
+		assert(!readOnly);
+
+		const size_t vertOffset = verts.size();
+		const size_t indcOffset = indcs.size();
+
+		verts.resize(vertOffset + numQuads * 4);
+		indcs.resize(indcOffset + numQuads * 6);
+
+		return { verts.data() + vertOffset, indcs.data() + indcOffset, static_cast<IndcType>(vertOffset) };
+	}
+
+	// same triangulation as AddQuadTrianglesImpl
+	static void MakeQuadTrianglesIndices(IndcType* indices, IndcType baseVertex, size_t numQuads) {
+		for (size_t i = 0; i < numQuads; i++) {
+			const IndcType baseIndex = static_cast<IndcType>(baseVertex + i * 4);
+
+			*(indices++) = baseIndex + 3;
+			*(indices++) = baseIndex + 0;
+			*(indices++) = baseIndex + 1;
+
+			*(indices++) = baseIndex + 3;
+			*(indices++) = baseIndex + 1;
+			*(indices++) = baseIndex + 2;
+		}
+	}
+
 	void UploadVBO();
 	void UploadEBO();
 
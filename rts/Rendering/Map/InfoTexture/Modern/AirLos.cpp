@@ -15,6 +15,7 @@
 CAirLosTexture::CAirLosTexture()
 : CPboInfoTexture("airlos")
 , uploadTex(0)
+, airLosSerial(CLosMap::DIRTY_SERIAL_NONE)
 {
 	texSize = losHandler->airLos.size;
 	texChannels = 1;
@@ -101,23 +102,35 @@ CAirLosTexture::~CAirLosTexture()
 void CAirLosTexture::UpdateCPU()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	const CLosMap& airLosMap = losHandler->airLos.losMaps[gu->myAllyTeam];
+	const bool globalLOS = losHandler->GetGlobalLOS(gu->myAllyTeam);
+
+	// already filled, nothing changes until the view does
+	if (globalLOS && airLosSerial != CLosMap::DIRTY_SERIAL_NONE)
+		return;
+
+	const SRectangle rect = AlignUploadRect(airLosMap.GetDirtyRect(airLosSerial));
+
+	if (rect.Empty())
+		return;
+
 	infoTexPBO.Bind();
-	auto infoTexMem = reinterpret_cast<unsigned char*>(infoTexPBO.MapBuffer());
+	auto infoTexMem = reinterpret_cast<unsigned char*>(infoTexPBO.MapBuffer(0, rect.GetArea()));
 
-	if (!losHandler->GetGlobalLOS(gu->myAllyTeam)) {
-		const unsigned short* myAirLos = &losHandler->airLos.losMaps[gu->myAllyTeam].front();
-		for (int y = 0; y < texSize.y; ++y) {
-			for (int x = 0; x < texSize.x; ++x) {
-				infoTexMem[y * texSize.x + x] = (myAirLos[y * texSize.x + x] != 0) ? 255 : 0;
+	if (!globalLOS) {
+		const unsigned short* myAirLos = &airLosMap.front();
+		for (int y = rect.y1; y < rect.y2; ++y) {
+			for (int x = rect.x1; x < rect.x2; ++x) {
+				*(infoTexMem++) = (myAirLos[y * texSize.x + x] != 0) ? 255 : 0;
 			}
 		}
 	} else {
-		memset(infoTexMem, 255, texSize.x * texSize.y);
+		memset(infoTexMem, 255, rect.GetArea());
 	}
 
 	infoTexPBO.UnmapBuffer();
 	glBindTexture(GL_TEXTURE_2D, texture);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texSize.x, texSize.y, GL_RED, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr());
+	glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x1, rect.y1, rect.GetWidth(), rect.GetHeight(), GL_RED, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr());
 	glGenerateMipmap(GL_TEXTURE_2D);
 	infoTexPBO.Invalidate();
 	infoTexPBO.Unbind();
@@ -127,10 +140,21 @@ void CAirLosTexture::UpdateCPU()
 void CAirLosTexture::Update()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	if (LosViewChanged())
+		airLosSerial = CLosMap::DIRTY_SERIAL_NONE;
+
 	if (!fbo.IsValid() || !shader->IsValid() || uploadTex == 0)
 		return UpdateCPU();
 
+	const CLosMap& airLosMap = losHandler->airLos.losMaps[gu->myAllyTeam];
+
 	if (losHandler->GetGlobalLOS(gu->myAllyTeam)) {
+		// already cleared, nothing changes until the view does
+		if (airLosSerial != CLosMap::DIRTY_SERIAL_NONE)
+			return;
+
+		airLosMap.GetDirtyRect(airLosSerial);
+
 		fbo.Bind();
 		glViewport(0, 0, texSize.x, texSize.y);
 		glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
@@ -143,17 +167,22 @@ void CAirLosTexture::Update()
 		return;
 	}
 
+	// only the squares changed since the last update are uploaded and post-processed
+	const SRectangle rect = AlignUploadRect(airLosMap.GetDirtyRect(airLosSerial));
+
+	if (rect.Empty())
+		return;
+
 	infoTexPBO.Bind();
-	auto infoTexMem = reinterpret_cast<unsigned char*>(infoTexPBO.MapBuffer());
-	const unsigned short* myAirLos = &losHandler->airLos.losMaps[gu->myAllyTeam].front();
-	memcpy(infoTexMem, myAirLos, texSize.x * texSize.y * texChannels * sizeof(short));
+	auto infoTexMem = reinterpret_cast<unsigned short*>(infoTexPBO.MapBuffer(0, rect.GetArea() * texChannels * sizeof(short)));
+	CopyRect(infoTexMem, &airLosMap.front(), texSize.x, rect);
 	infoTexPBO.UnmapBuffer();
 
 	//Trick: Upload the ushort as 2 ubytes, and then check both for `!=0` in the shader.
 	// Faster than doing it on the CPU! And uploading it as shorts would be slow, cause the GPU
 	// has no native support for them and so the transformation would happen on the CPU, too.
 	glBindTexture(GL_TEXTURE_2D, uploadTex);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texSize.x, texSize.y, GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr());
+	glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x1, rect.y1, rect.GetWidth(), rect.GetHeight(), GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr());
 	infoTexPBO.Invalidate();
 	infoTexPBO.Unbind();
 
@@ -162,12 +191,7 @@ void CAirLosTexture::Update()
 	glViewport(0, 0, texSize.x, texSize.y);
 	shader->Enable();
 	glDisable(GL_BLEND);
-	glBegin(GL_QUADS);
-		glVertex2f(-1.f, -1.f);
-		glVertex2f(-1.f, +1.f);
-		glVertex2f(+1.f, +1.f);
-		glVertex2f(+1.f, -1.f);
-	glEnd();
+	DrawRectQuad(rect);
 	shader->Disable();
 	globalRendering->LoadViewport();
 	FBO::Unbind();
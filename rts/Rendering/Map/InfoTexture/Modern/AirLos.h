@@ -29,6 +29,9 @@ private:
 	FBO fbo;
 	GLuint uploadTex;
 	Shader::IProgramObject* shader;
+
+	// last update of the air-LOS map reflected by the texture
+	uint32_t airLosSerial;
 };
 
 #endif // _AIRLOS_TEXTURE_H
@@ -29,6 +29,9 @@ private:
 	FBO fbo;
 	GLuint uploadTex;
 	Shader::IProgramObject* shader;
+
+	// last update of the LOS map reflected by the texture
+	uint32_t losSerial;
 };
 
 #endif // _LOS_TEXTURE_H
@@ -11,7 +11,7 @@
 CMetalTexture::CMetalTexture()
 : CPboInfoTexture("metal")
 , CEventClient("[CMetalTexture]", 271990, false)
-, metalMapChanged(true)
+, dirtyRect(0, 0, mapDims.hmapx, mapDims.hmapy)
 {
 	eventHandler.AddClient(this);
 	texSize = int2(mapDims.hmapx, mapDims.hmapy);
@@ -31,22 +31,25 @@ void CMetalTexture::Update()
 	#include "System/Misc/TracyDefs.h"
 	assert(metalMap.GetSizeX() == texSize.x && metalMap.GetSizeZ() == texSize.y);
 
+	// SetMetalAmount touches single squares, only their bounding rectangle is uploaded
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, texSize.x);
 	glBindTexture(GL_TEXTURE_2D, texture);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texSize.x, texSize.y, GL_RED, GL_UNSIGNED_BYTE, metalMap.GetDistributionMap());
+	glTexSubImage2D(GL_TEXTURE_2D, 0, dirtyRect.x1, dirtyRect.y1, dirtyRect.GetWidth(), dirtyRect.GetHeight(), GL_RED, GL_UNSIGNED_BYTE, metalMap.GetDistributionMap() + dirtyRect.y1 * texSize.x + dirtyRect.x1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 
-	metalMapChanged = false;
+	dirtyRect = {};
 }
 
 
 void CMetalTexture::MetalMapChanged(const int x, const int z)
 {
 	#include "System/Misc/TracyDefs.h"
-	metalMapChanged = true;
+	dirtyRect.Merge(SRectangle(x, z, x + 1, z + 1));
 }
 
 
 bool CMetalTexture::IsUpdateNeeded()
 {
 	#include "System/Misc/TracyDefs.h"
-	return metalMapChanged;
+	return !dirtyRect.Empty();
 }
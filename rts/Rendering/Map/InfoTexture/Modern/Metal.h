@@ -5,6 +5,7 @@
 
 #include "PboInfoTexture.h"
 #include "System/EventHandler.h"
+#include "System/Rectangle.h"
 
 
 class CMetalTexture : public CPboInfoTexture, public CEventClient
@@ -27,7 +28,8 @@ public:
 	bool IsUpdateNeeded() override;
 
 private:
-	bool metalMapChanged;
+	// texels changed since the last upload
+	SRectangle dirtyRect;
 };
 
 #endif // _METAL_TEXTURE_H
@@ -1,6 +1,8 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "PboInfoTexture.h"
+#include "Game/GlobalUnsynced.h"
+#include "Sim/Misc/LosHandler.h"
 
 
 CPboInfoTexture::CPboInfoTexture(const std::string& _name)
@@ -15,3 +17,59 @@ CPboInfoTexture::~CPboInfoTexture()
 {
 	glDeleteTextures(1, &texture);
 }
+
+
+bool CPboInfoTexture::LosViewChanged()
+{
+	const bool globalLOS = losHandler->GetGlobalLOS(gu->myAllyTeam);
+
+	if (losViewAllyTeam == gu->myAllyTeam && losViewGlobal == globalLOS)
+		return false;
+
+	losViewAllyTeam = gu->myAllyTeam;
+	losViewGlobal = globalLOS;
+	return true;
+}
+
+
+SRectangle CPboInfoTexture::ToTexRect(const SRectangle& rect, int2 srcSize) const
+{
+	if (rect.Empty())
+		return rect;
+
+	SRectangle texRect(
+		(rect.x1 * texSize.x) / srcSize.x - 1,
+		(rect.y1 * texSize.y) / srcSize.y - 1,
+		(rect.x2 * texSize.x + srcSize.x - 1) / srcSize.x + 1,
+		(rect.y2 * texSize.y + srcSize.y - 1) / srcSize.y + 1
+	);
+
+	texRect.ClampIn(SRectangle(0, 0, texSize.x, texSize.y));
+	return texRect;
+}
+
+
+SRectangle CPboInfoTexture::AlignUploadRect(const SRectangle& rect) const
+{
+	if (rect.Empty())
+		return rect;
+
+	SRectangle texRect(rect.x1 & ~3, rect.y1, (rect.x2 + 3) & ~3, rect.y2);
+
+	texRect.ClampIn(SRectangle(0, 0, texSize.x, texSize.y));
+	return texRect;
+}
+
+
+void CPboInfoTexture::DrawRectQuad(const SRectangle& rect) const
+{
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(rect.x1, rect.y1, rect.GetWidth(), rect.GetHeight());
+	glBegin(GL_QUADS);
+		glVertex2f(-1.f, -1.f);
+		glVertex2f(-1.f, +1.f);
+		glVertex2f(+1.f, +1.f);
+		glVertex2f(+1.f, -1.f);
+	glEnd();
+	glDisable(GL_SCISSOR_TEST);
+}
@@ -3,8 +3,11 @@
 #ifndef _PBO_INFO_TEXTURE_H
 #define _PBO_INFO_TEXTURE_H
 
+#include <cstring>
+
 #include "Rendering/Map/InfoTexture/InfoTexture.h"
 #include "Rendering/GL/PBO.h"
+#include "System/Rectangle.h"
 
 
 
@@ -19,8 +22,36 @@ public:
 	virtual void Update() = 0;
 	virtual bool IsUpdateNeeded() = 0;
 
+protected:
+	// true if the viewed allyteam or its global LOS state changed since the
+	// previous call, dirty-rectangle serials kept for the old view are stale
+	bool LosViewChanged();
+
+	// maps <rect> on a grid of <srcSize> cells onto texels, rounded outwards by
+	// one texel for the linear filtering of the source texture
+	SRectangle ToTexRect(const SRectangle& rect, int2 srcSize) const;
+
+	// widens <rect> to whole 4-texel groups, so tightly packed uploads of it
+	// keep the default GL_UNPACK_ALIGNMENT like the full-width ones did
+	SRectangle AlignUploadRect(const SRectangle& rect) const;
+
+	// fullscreen quad for the post-processing passes, restricted to <rect>
+	void DrawRectQuad(const SRectangle& rect) const;
+
+	// copies the <rect> part of a row-major array <srcSizeX> elements wide to <dst>, rows tightly packed
+	template<typename T>
+	static void CopyRect(T* dst, const T* src, int srcSizeX, const SRectangle& rect) {
+		for (int y = rect.y1; y < rect.y2; ++y) {
+			std::memcpy(dst, src + y * srcSizeX + rect.x1, rect.GetWidth() * sizeof(T));
+			dst += rect.GetWidth();
+		}
+	}
+
 protected:
 	PBO infoTexPBO;
+
+	int losViewAllyTeam = -1;
+	bool losViewGlobal = false;
 };
 
 #endif // _PBO_INFO_TEXTURE_H
@@ -19,6 +19,9 @@ CRadarTexture::CRadarTexture()
 : CPboInfoTexture("radar")
 , uploadTexRadar(0)
 , uploadTexJammer(0)
+, radarSerial(CLosMap::DIRTY_SERIAL_NONE)
+, jammerSerial(CLosMap::DIRTY_SERIAL_NONE)
+, losSerial(CLosMap::DIRTY_SERIAL_NONE)
 {
 	texSize = losHandler->radar.size;
 	texChannels = 2;
@@ -123,39 +126,71 @@ CRadarTexture::~CRadarTexture()
 }
 
 
+SRectangle CRadarTexture::GetDirtyRect()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const int jammerAllyTeam = modInfo.separateJammers ? gu->myAllyTeam : 0;
+
+	SRectangle rect = losHandler->radar.losMaps[gu->myAllyTeam].GetDirtyRect(radarSerial);
+	rect.Merge(losHandler->jammer.losMaps[jammerAllyTeam].GetDirtyRect(jammerSerial));
+
+	// jammer coverage is masked by los, so changed los squares count as well
+	const SRectangle losRect = ToTexRect(losHandler->los.losMaps[gu->myAllyTeam].GetDirtyRect(losSerial), losHandler->los.size);
+	rect.Merge(prevLosRect);
+	rect.Merge(losRect);
+	prevLosRect = losRect;
+
+	return AlignUploadRect(rect);
+}
+
+
 void CRadarTexture::UpdateCPU()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	const bool globalLOS = losHandler->GetGlobalLOS(gu->myAllyTeam);
+
+	// already filled, nothing changes until the view does
+	if (globalLOS && radarSerial != CLosMap::DIRTY_SERIAL_NONE)
+		return;
+
+	SRectangle rect;
+
+	if (globalLOS) {
+		rect = AlignUploadRect(losHandler->radar.losMaps[gu->myAllyTeam].GetDirtyRect(radarSerial));
+	} else {
+		rect = GetDirtyRect();
+	}
+
+	if (rect.Empty())
+		return;
+
 	infoTexPBO.Bind();
-	auto infoTexMem = reinterpret_cast<unsigned char*>(infoTexPBO.MapBuffer());
+	auto infoTexMem = reinterpret_cast<unsigned char*>(infoTexPBO.MapBuffer(0, rect.GetArea() * texChannels));
 
-	if (!losHandler->GetGlobalLOS(gu->myAllyTeam)) {
+	if (!globalLOS) {
 		const int jammerAllyTeam = modInfo.separateJammers ? gu->myAllyTeam : 0;
 
 		const unsigned short* myLos = &losHandler->los.losMaps[gu->myAllyTeam].front();
 
 		const unsigned short* myRadar  = &losHandler->radar.losMaps[gu->myAllyTeam].front();
 		const unsigned short* myJammer = &losHandler->jammer.losMaps[jammerAllyTeam].front();
-		for (int y = 0; y < texSize.y; ++y) {
-			for (int x = 0; x < texSize.x; ++x) {
+		for (int y = rect.y1; y < rect.y2; ++y) {
+			for (int x = rect.x1; x < rect.x2; ++x) {
 				const int idx = y * texSize.x + x;
-				infoTexMem[idx * 2 + 0] = ( myRadar[idx] != 0) ? 255 : 0;
-				infoTexMem[idx * 2 + 1] = (myJammer[idx] != 0 && myLos[idx] != 0) ? 255 : 0;
+				*(infoTexMem++) = ( myRadar[idx] != 0) ? 255 : 0;
+				*(infoTexMem++) = (myJammer[idx] != 0 && myLos[idx] != 0) ? 255 : 0;
 			}
 		}
 	} else {
-		for (int y = 0; y < texSize.y; ++y) {
-			for (int x = 0; x < texSize.x; ++x) {
-				const int idx = y * texSize.x + x;
-				infoTexMem[idx * 2 + 0] = 255;
-				infoTexMem[idx * 2 + 1] = 0;
-			}
+		for (int i = 0, n = rect.GetArea(); i < n; ++i) {
+			*(infoTexMem++) = 255;
+			*(infoTexMem++) = 0;
 		}
 	}
 
 	infoTexPBO.UnmapBuffer();
 	glBindTexture(GL_TEXTURE_2D, texture);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texSize.x, texSize.y, GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr());
+	glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x1, rect.y1, rect.GetWidth(), rect.GetHeight(), GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr());
 	infoTexPBO.Invalidate();
 	infoTexPBO.Unbind();
 }
@@ -164,10 +199,23 @@ void CRadarTexture::UpdateCPU()
 void CRadarTexture::Update()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	if (LosViewChanged()) {
+		radarSerial = CLosMap::DIRTY_SERIAL_NONE;
+		jammerSerial = CLosMap::DIRTY_SERIAL_NONE;
+		losSerial = CLosMap::DIRTY_SERIAL_NONE;
+		prevLosRect = {};
+	}
+
 	if (!fbo.IsValid() || !shader->IsValid() || uploadTexRadar == 0 || uploadTexJammer == 0)
 		return UpdateCPU();
 
 	if (losHandler->GetGlobalLOS(gu->myAllyTeam)) {
+		// already cleared, nothing changes until the view does
+		if (radarSerial != CLosMap::DIRTY_SERIAL_NONE)
+			return;
+
+		losHandler->radar.losMaps[gu->myAllyTeam].GetDirtyRect(radarSerial);
+
 		fbo.Bind();
 		glViewport(0, 0, texSize.x, texSize.y);
 		glClearColor(1.0f, 0.0f, 0.0f, 0.0f);
@@ -180,16 +228,20 @@ void CRadarTexture::Update()
 		return;
 	}
 
+	// only the squares changed since the last update are uploaded and post-processed
+	const SRectangle rect = GetDirtyRect();
+
+	if (rect.Empty())
+		return;
+
 	const int jammerAllyTeam = modInfo.separateJammers ? gu->myAllyTeam : 0;
 
 	infoTexPBO.Bind();
-	const size_t arraySize = texSize.x * texSize.y * sizeof(unsigned short);
-	auto infoTexMem = reinterpret_cast<unsigned char*>(infoTexPBO.MapBuffer());
-	const unsigned short* myRadar  = &losHandler->radar.losMaps[gu->myAllyTeam].front();
-	const unsigned short* myJammer = &losHandler->jammer.losMaps[jammerAllyTeam].front();
-	memcpy(infoTexMem,  myRadar, arraySize);
-	infoTexMem += arraySize;
-	memcpy(infoTexMem, myJammer, arraySize);
+	const size_t arraySize = rect.GetArea() * sizeof(unsigned short);
+	auto infoTexMem = reinterpret_cast<unsigned short*>(infoTexPBO.MapBuffer(0, arraySize * 2));
+	CopyRect(infoTexMem, &losHandler->radar.losMaps[gu->myAllyTeam].front(), texSize.x, rect);
+	infoTexMem += rect.GetArea();
+	CopyRect(infoTexMem, &losHandler->jammer.losMaps[jammerAllyTeam].front(), texSize.x, rect);
 	infoTexPBO.UnmapBuffer();
 
 	//Trick: Upload the ushort as 2 ubytes, and then check both for `!=0` in the shader.
@@ -198,10 +250,10 @@ void CRadarTexture::Update()
 	glActiveTexture(GL_TEXTURE1);
 	glEnable(GL_TEXTURE_2D);
 	glBindTexture(GL_TEXTURE_2D, uploadTexRadar);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texSize.x, texSize.y, GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr());
+	glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x1, rect.y1, rect.GetWidth(), rect.GetHeight(), GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr());
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, uploadTexJammer);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texSize.x, texSize.y, GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr(arraySize));
+	glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x1, rect.y1, rect.GetWidth(), rect.GetHeight(), GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr(arraySize));
 	infoTexPBO.Invalidate();
 	infoTexPBO.Unbind();
 
@@ -213,12 +265,7 @@ void CRadarTexture::Update()
 	glActiveTexture(GL_TEXTURE2);
 	glEnable(GL_TEXTURE_2D);
 	glBindTexture(GL_TEXTURE_2D, infoTextureHandler->GetInfoTexture("los")->GetTexture());
-	glBegin(GL_QUADS);
-		glVertex2f(-1.f, -1.f);
-		glVertex2f(-1.f, +1.f);
-		glVertex2f(+1.f, +1.f);
-		glVertex2f(+1.f, -1.f);
-	glEnd();
+	DrawRectQuad(rect);
 	shader->Disable();
 	globalRendering->LoadViewport();
 	FBO::Unbind();
@@ -24,6 +24,8 @@ public:
 	bool IsUpdateNeeded() override { return true; }
 
 private:
+	// union of the radar, jammer and los changes since the last update, in texels
+	SRectangle GetDirtyRect();
 	void UpdateCPU();
 
 private:
@@ -31,6 +33,14 @@ private:
 	GLuint uploadTexRadar;
 	GLuint uploadTexJammer;
 	Shader::IProgramObject* shader;
+
+	uint32_t radarSerial;
+	uint32_t jammerSerial;
+	uint32_t losSerial;
+
+	// los texels changed by the previous update, the los texture might
+	// only have been refreshed after this one was post-processed
+	SRectangle prevLosRect;
 };
 
 #endif // _RADAR_TEXTURE_H
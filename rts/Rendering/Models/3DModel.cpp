@@ -49,7 +49,11 @@ CR_REG_METADATA(LocalModel, (
 
 	CR_MEMBER(boundingVolume),
 	CR_IGNORED(luaMaterialData),
-	CR_MEMBER(needsBoundariesRecalc)
+	CR_MEMBER(needsBoundariesRecalc),
+
+	// rebuilt by SetModel on PostLoad
+	CR_IGNORED(dirtyPieces),
+	CR_IGNORED(pieceOrder)
 ))
 
 
@@ -330,7 +334,8 @@ void LocalModel::SetModel(const S3DModel* model, bool initialize)
 			pieces[n].original = omp;
 		}
 
-		pieces[0].UpdateChildMatricesRec(true);
+		UpdatePieceOrder();
+		UpdatePieceMatrices(true);
 		UpdateBoundingVolume();
 		return;
 	}
@@ -345,12 +350,90 @@ void LocalModel::SetModel(const S3DModel* model, bool initialize)
 	// must recursively update matrices here too: for features
 	// LocalModel::Update is never called, but they might have
 	// baked piece rotations (in the case of .dae)
-	pieces[0].UpdateChildMatricesRec(false);
+	UpdatePieceMatrices();
 	UpdateBoundingVolume();
 
 	assert(pieces.size() == model->numPieces);
 }
 
+void LocalModel::UpdatePieceMatrices(bool force) const
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!dirtyPieces && !force)
+		return;
+
+	dirtyPieces = false;
+
+	// a dirty piece implies dirty descendants (see LocalModelPiece::SetDirty),
+	// so visiting parents first is all it takes to skip the recursion
+	if (pieceOrder.empty()) {
+		for (const LocalModelPiece& lmp: pieces) {
+			if (lmp.IsDirty() || force)
+				lmp.UpdateMatrices(force);
+		}
+
+		return;
+	}
+
+	for (const uint32_t pieceIdx: pieceOrder) {
+		const LocalModelPiece& lmp = pieces[pieceIdx];
+
+		if (lmp.IsDirty() || force)
+			lmp.UpdateMatrices(force);
+	}
+}
+
+void LocalModel::UpdatePieceOrder()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	pieceOrder.clear();
+
+	// creation order already puts parents first unless pieces were re-parented
+	const auto parentFirst = [](const LocalModelPiece& lmp) {
+		return (lmp.parent == nullptr || lmp.parent->GetLModelPieceIndex() < lmp.GetLModelPieceIndex());
+	};
+
+	if (std::all_of(pieces.begin(), pieces.end(), parentFirst))
+		return;
+
+	std::vector<const LocalModelPiece*> stack = { &pieces[0] };
+
+	pieceOrder.reserve(pieces.size());
+
+	while (!stack.empty()) {
+		const LocalModelPiece* lmp = stack.back();
+
+		stack.pop_back();
+		pieceOrder.push_back(lmp->GetLModelPieceIndex());
+
+		for (const LocalModelPiece* child: lmp->children) {
+			stack.push_back(child);
+		}
+	}
+
+	assert(pieceOrder.size() == pieces.size());
+}
+
+bool LocalModel::SetPieceParent(LocalModelPiece* child, LocalModelPiece* parent)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(child->parent != nullptr);
+
+	for (const LocalModelPiece* p = parent; p != nullptr; p = p->parent) {
+		if (p == child)
+			return false;
+	}
+
+	child->parent->RemoveChild(child);
+	child->SetParent(parent);
+	parent->AddChild(child);
+	child->SetDirty();
+
+	UpdatePieceOrder();
+	SetBoundariesNeedsRecalc();
+	return true;
+}
+
 LocalModelPiece* LocalModel::CreateLocalModelPieces(const S3DModelPiece* mpParent)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -457,6 +540,9 @@ void LocalModelPiece::SetDirty() {
 	dirty = true;
 	SetGetCustomDirty(true);
 
+	if (localModel != nullptr)
+		localModel->SetPiecesDirty();
+
 	for (LocalModelPiece* child: children) {
 		if (child->dirty)
 			continue;
@@ -485,38 +571,27 @@ void LocalModelPiece::SetPosOrRot(const float3& src, float3& dst) {
 }
 
 
-void LocalModelPiece::UpdateChildMatricesRec(bool updateChildMatrices) const
+void LocalModelPiece::UpdateParentMatricesRec() const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	if (parent != nullptr && parent->dirty)
+		parent->UpdateParentMatricesRec();
+
+	UpdateMatrices(true);
+}
+
+void LocalModelPiece::UpdateMatrices(bool updateModelSpaceMat) const
+{
 	if (dirty) {
 		dirty = false;
-		updateChildMatrices = true;
+		updateModelSpaceMat = true;
 
 		pieceSpaceMat = CalcPieceSpaceMatrix(pos, rot, original->scales);
 	}
 
-	if (updateChildMatrices) {
-		modelSpaceMat = pieceSpaceMat;
-
-		if (parent != nullptr) {
-			modelSpaceMat >>= parent->modelSpaceMat;
-		}
-	}
-
-	for (auto& child : children) {
-		child->UpdateChildMatricesRec(updateChildMatrices);
-	}
-}
-
-void LocalModelPiece::UpdateParentMatricesRec() const
-{
-	RECOIL_DETAILED_TRACY_ZONE;
-	if (parent != nullptr && parent->dirty)
-		parent->UpdateParentMatricesRec();
-
-	dirty = false;
+	if (!updateModelSpaceMat)
+		return;
 
-	pieceSpaceMat = CalcPieceSpaceMatrix(pos, rot, original->scales);
 	modelSpaceMat = pieceSpaceMat;
 
 	if (parent != nullptr)
@@ -469,8 +469,9 @@ struct LocalModelPiece
 
 
 	// on-demand functions
-	void UpdateChildMatricesRec(bool updateChildMatrices) const;
 	void UpdateParentMatricesRec() const;
+	// recomputes this piece's matrices, the parent's must already be current
+	void UpdateMatrices(bool updateModelSpaceMat) const;
 
 	CMatrix44f CalcPieceSpaceMatrixRaw(const float3& p, const float3& r, const float3& s) const { return (original->ComposeTransform(p, r, s)); }
 	CMatrix44f CalcPieceSpaceMatrix(const float3& p, const float3& r, const float3& s) const {
@@ -518,6 +519,8 @@ struct LocalModelPiece
 
 	bool GetScriptVisible() const { return scriptSetVisible; }
 	void SetScriptVisible(bool b) { scriptSetVisible = b; SetGetCustomDirty(true); }
+
+	bool IsDirty() const { return dirty; }
 private:
 	float3 pos; // translation relative to parent LMP, *INITIALLY* equal to original->offset
 	float3 rot; // orientation relative to parent LMP, in radians (updated by scripts)
@@ -590,6 +593,19 @@ struct LocalModel
 	void SetLODCount(unsigned int lodCount);
 	void UpdateBoundingVolume();
 
+	/**
+	 * Brings the matrices of all dirty pieces up to date in one pass over
+	 * the pieces in parent-before-child order, instead of the recursive
+	 * per-piece evaluation done on demand by GetModelSpaceMatrix. Cheap
+	 * no-op if no piece moved since the last call; independent models may
+	 * be updated concurrently. <force> recomputes every model-space matrix.
+	 */
+	void UpdatePieceMatrices(bool force = false) const;
+	void SetPiecesDirty() const { dirtyPieces = true; }
+
+	// re-parents <child>, fails if that would create a cycle
+	bool SetPieceParent(LocalModelPiece* child, LocalModelPiece* parent);
+
 	void GetBoundingBoxVerts(std::vector<float3>& verts) const {
 		verts.resize(8 + 2); GetBoundingBoxVerts(&verts[0]);
 	}
@@ -617,6 +633,7 @@ struct LocalModel
 	bool GetBoundariesNeedsRecalc() const { return needsBoundariesRecalc; }
 private:
 	LocalModelPiece* CreateLocalModelPieces(const S3DModelPiece* mpParent);
+	void UpdatePieceOrder();
 
 	void DrawPieces() const;
 	void DrawPiecesLOD(unsigned int lod) const;
@@ -632,6 +649,13 @@ private:
 	LuaObjectMaterialData luaMaterialData;
 
 	bool needsBoundariesRecalc = true;
+
+	// set when any piece was marked dirty since the last UpdatePieceMatrices
+	mutable bool dirtyPieces = true;
+
+	// parent-before-child evaluation order of <pieces>; empty while that is
+	// the creation (depth-first) order, i.e. until a piece gets re-parented
+	std::vector<uint32_t> pieceOrder;
 };
 
 #endif /* _3DMODEL_H */
@@ -23,6 +23,7 @@
 #include "System/Threading/ThreadPool.h"
 #include "System/ContainerUtil.h"
 #include "System/LoadLock.h"
+#include "System/MemAccounting.h"
 #include "lib/assimp/include/assimp/Importer.hpp"
 
 #include "System/Misc/TracyDefs.h"
@@ -34,6 +35,8 @@ static C3DOParser g3DOParser;
 static CS3OParser gS3OParser;
 static CAssParser gAssParser;
 
+static const MemAccounting::TagId modelsMemTag = MemAccounting::RegisterTag("Models");
+
 
 static bool CheckAssimpWhitelist(const char* aiExt) {
 	constexpr std::array<const char*, 5> whitelist = {
@@ -357,6 +360,9 @@ void CModelLoader::FillModel(
 	const std::string& name,
 	const std::string& path
 ) {
+	// attributes parser allocations when heap sampling is enabled
+	MemAccounting::ScopedTag memTag(modelsMemTag);
+
 	ParseModel(model, name, path);
 
 	assert(model.numPieces != 0);
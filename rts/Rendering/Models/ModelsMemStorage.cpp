@@ -1,4 +1,7 @@
 #include "ModelsMemStorage.h"
+
+#include <cstring>
+
 #include "Sim/Objects/WorldObject.h"
 
 #include "System/Misc/TracyDefs.h"
@@ -18,6 +21,7 @@ size_t ModelsUniformsStorage::AddObjects(const CWorldObject* o)
 	RECOIL_DETAILED_TRACY_ZONE;
 	const size_t idx = storage.Add(ModelUniformData());
 	objectsMap[const_cast<CWorldObject*>(o)] = idx;
+	dirtyRanges.Add(idx, idx + 1);
 	return idx;
 }
 
@@ -46,12 +50,27 @@ ModelUniformData& ModelsUniformsStorage::GetObjUniformsArray(const CWorldObject*
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	size_t offset = GetObjOffset(o);
+
+	// the caller may write anything through the reference
+	dirtyRanges.Add(offset, offset + 1);
 	return storage[offset];
 }
 
+void ModelsUniformsStorage::SetObjUniforms(size_t offset, const ModelUniformData& uni)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	ModelUniformData& cur = storage[offset];
+
+	if (std::memcmp(&cur, &uni, sizeof(ModelUniformData)) == 0)
+		return;
+
+	cur = uni;
+	dirtyRanges.Add(offset, offset + 1);
+}
+
 void MatricesMemStorage::SetAllDirty()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	assert(Threading::IsMainThread());
-	std::fill(dirtyMap.begin(), dirtyMap.end(), BUFFERING);
+	dirtyRanges.AddAll(GetSize());
 }
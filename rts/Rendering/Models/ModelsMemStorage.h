@@ -6,6 +6,7 @@
 
 #include "ModelsMemStorageDefs.h"
 #include "ModelsLock.h"
+#include "System/DirtyRangeTracker.h"
 #include "System/Matrix44f.h"
 #include "System/MemPoolTypes.h"
 #include "System/FreeListMap.h"
@@ -17,25 +18,28 @@ class MatricesMemStorage : public StablePosAllocator<CMatrix44f> {
 public:
 	explicit MatricesMemStorage()
 		: StablePosAllocator<CMatrix44f>(INIT_NUM_ELEMS)
-		, dirtyMap(INIT_NUM_ELEMS, BUFFERING)
-	{}
+	{
+		SetMemTag("Models");
+	}
 	void Reset() override {
 		assert(Threading::IsMainThread());
 		StablePosAllocator<CMatrix44f>::Reset();
-		dirtyMap.resize(GetSize(), BUFFERING);
+		dirtyRanges.Clear();
+		dirtyRanges.AddAll(GetSize());
 	}
 
 	size_t Allocate(size_t numElems) override {
 		auto lock = CModelsLock::GetScopedLock();
 		size_t res = StablePosAllocator<CMatrix44f>::Allocate(numElems);
-		dirtyMap.resize(GetSize(), BUFFERING);
+
+		if (res != INVALID_INDEX)
+			dirtyRanges.Add(res, res + numElems);
 
 		return res;
 	}
 	void Free(size_t firstElem, size_t numElems, const CMatrix44f* T0 = nullptr) override {
 		auto lock = CModelsLock::GetScopedLock();
 		StablePosAllocator<CMatrix44f>::Free(firstElem, numElems, T0);
-		dirtyMap.resize(GetSize(), BUFFERING);
 	}
 
 	const CMatrix44f& operator[](std::size_t idx) const override
@@ -48,24 +52,26 @@ public:
 		auto lock = CModelsLock::GetScopedLock();
 		return StablePosAllocator<CMatrix44f>::operator[](idx);
 	}
-private:
-	std::vector<uint8_t> dirtyMap;
-public:
-	const decltype(dirtyMap)& GetDirtyMap() const
-	{
-		return dirtyMap;
-	}
-	decltype(dirtyMap)& GetDirtyMap()
-	{
-		return dirtyMap;
+
+	// direct access for bulk writers, which must report what they wrote via MarkDirty
+	CMatrix44f* GetWritePtr(std::size_t idx) { return &(GetData()[idx]); }
+
+	// [firstElem, firstElem + numElems) has to be re-uploaded; callable from pool threads
+	void MarkDirty(size_t firstElem, size_t numElems) {
+		auto lock = CModelsLock::GetScopedLock();
+		dirtyRanges.Add(firstElem, firstElem + numElems);
 	}
 
+	spring::DirtyRangeTracker& GetDirtyRanges() { return dirtyRanges; }
+
 	void SetAllDirty();
 public:
 	//need to update buffer with matrices BUFFERING times, because the actual buffer is made of BUFFERING number of parts
 	static constexpr uint8_t BUFFERING = 3u;
 private:
 	static constexpr int INIT_NUM_ELEMS = 1 << 16u;
+
+	spring::DirtyRangeTracker dirtyRanges;
 };
 
 extern MatricesMemStorage matricesMemStorage;
@@ -119,9 +125,21 @@ public:
 		assert(firstElem != MatricesMemStorage::INVALID_INDEX);
 		assert(offset >= 0 && offset < numElems);
 
-		matricesMemStorage.GetDirtyMap().at(firstElem + offset) = MatricesMemStorage::BUFFERING;
+		matricesMemStorage.MarkDirty(firstElem + offset, 1);
 		return matricesMemStorage[firstElem + offset];
 	}
+
+	// raw access to the whole allocation for writers updating many matrices at
+	// once; they have to call MarkDirty for the sub-range they actually wrote
+	CMatrix44f* GetWritePtr() {
+		assert(firstElem != MatricesMemStorage::INVALID_INDEX);
+		return matricesMemStorage.GetWritePtr(firstElem);
+	}
+	void MarkDirty(std::size_t offset, std::size_t count) {
+		assert(offset + count <= numElems);
+		matricesMemStorage.MarkDirty(firstElem + offset, count);
+	}
+	std::size_t GetNumElems() const { return numElems; }
 public:
 	static const ScopedMatricesMemAlloc& Dummy() {
 		static ScopedMatricesMemAlloc dummy;
@@ -155,8 +173,13 @@ public:
 	size_t GetObjOffset(const S3DModel* o) { return INVALID_INDEX; }
 	ModelUniformData& GetObjUniformsArray(const S3DModel* o) { return dummy; }
 
+	// copies <uni> into slot <offset> and flags it for upload only if it differs
+	void SetObjUniforms(size_t offset, const ModelUniformData& uni);
+
 	size_t Size() const { return storage.GetData().size(); }
 	const std::vector<ModelUniformData>& GetData() const { return storage.GetData(); }
+
+	spring::DirtyRangeTracker& GetDirtyRanges() { return dirtyRanges; }
 public:
 	static constexpr size_t INVALID_INDEX = 0;
 private:
@@ -164,6 +187,8 @@ private:
 
 	std::unordered_map<CWorldObject*, size_t> objectsMap;
 	spring::FreeListMap<ModelUniformData> storage;
+
+	spring::DirtyRangeTracker dirtyRanges;
 };
 
 extern ModelsUniformsStorage modelsUniformsStorage;
@@ -5,6 +5,7 @@
 
 #include "System/float4.h"
 #include "System/Matrix44f.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
 #include "System/SpringMath.h"
 #include "System/TimeProfiler.h"
@@ -29,11 +30,27 @@
 #include "Sim/Misc/GlobalSynced.h"
 #include "Game/GlobalUnsynced.h"
 
+CONFIG(bool, PersistentModelBuffers)
+	.defaultValue(true)
+	.description("Upload model piece matrices and per-object model uniforms through persistently mapped ring buffers when supported, otherwise via glBufferSubData.");
+
+static const char* const matrixUploadBytesPlot = "MatrixUploader::UploadBytes";
+static const char* const matrixUploadRangesPlot = "MatrixUploader::UploadRanges";
+static const char* const uniformsUploadBytesPlot = "ModelsUniformsUploader::UploadBytes";
+static const char* const uniformsUploadRangesPlot = "ModelsUniformsUploader::UploadRanges";
+
+static IStreamBufferConcept::Types GetModelBufferType()
+{
+	if (globalRendering->supportPersistentMapping && configHandler->GetBool("PersistentModelBuffers"))
+		return IStreamBufferConcept::Types::SB_PERSISTENTMAP;
+
+	return IStreamBufferConcept::Types::SB_BUFFERSUBDATA;
+}
 
 ////////////////////////////////////////////////////////////////////
 
 template<typename T, typename Derived>
-void TypedStorageBufferUploader<T, Derived>::InitImpl(uint32_t bindingIdx_, uint32_t elemCount0_, uint32_t elemCountIncr_, uint8_t type, bool coherent, uint32_t numBuffers)
+void TypedStorageBufferUploader<T, Derived>::InitImpl(uint32_t bindingIdx_, uint32_t elemCount0_, uint32_t elemCountIncr_, uint8_t type, bool coherent, uint32_t numBuffers_)
 {
 	if (!globalRendering->haveGL4)
 		return;
@@ -41,6 +58,7 @@ void TypedStorageBufferUploader<T, Derived>::InitImpl(uint32_t bindingIdx_, uint
 	bindingIdx = bindingIdx_;
 	elemCount0 = elemCount0_;
 	elemCountIncr = elemCountIncr_;
+	numBuffers = numBuffers_;
 
 	assert(bindingIdx < -1u);
 
@@ -51,7 +69,7 @@ void TypedStorageBufferUploader<T, Derived>::InitImpl(uint32_t bindingIdx_, uint
 	p.type = static_cast<IStreamBufferConcept::Types>(type);
 	p.resizeAble = true;
 	p.coherent = coherent;
-	p.numBuffers = numBuffers;
+	p.numBuffers = numBuffers_;
 	p.optimizeForStreaming = true;
 
 	ssbo = IStreamBuffer<T>::CreateInstance(p);
@@ -74,6 +92,67 @@ inline uint32_t TypedStorageBufferUploader<T, Derived>::GetElemsCount() const
 	return ssbo->GetByteSize() / sizeof(T);
 }
 
+template<typename T, typename Derived>
+void TypedStorageBufferUploader<T, Derived>::CheckPersistentMapping(uint32_t numElems)
+{
+	if (ssbo->GetBufferImplementation() != IStreamBufferConcept::Types::SB_PERSISTENTMAP || ssbo->IsValid())
+		return;
+
+	// some potatoe driver overestimated its support for SB_PERSISTENTMAP
+	// Redo with good old SB_BUFFERSUBDATA
+	LOG_L(L_ERROR, "[%s::%s] OpenGL reported persistent mapping to be available, but mapping of buffer of %u size failed. Falling back.", className, __func__, uint32_t(numElems * sizeof(T)));
+	KillImpl();
+	InitImpl(bindingIdx, numElems, elemCountIncr, IStreamBufferConcept::Types::SB_BUFFERSUBDATA, true, numBuffers);
+}
+
+template<typename T, typename Derived>
+void TypedStorageBufferUploader<T, Derived>::UploadDirtyRanges(
+	const T* clientPtr,
+	uint32_t storageElemCount,
+	spring::DirtyRangeTracker& dirtyRanges,
+	const char* bytesPlotName,
+	const char* rangesPlotName
+) {
+	uint32_t numParts = 1;
+	uint32_t maxGap = MAX_UPLOAD_GAP_BYTES / sizeof(T);
+	uint32_t maxBatch = MAX_UPLOAD_BATCH_BYTES / sizeof(T);
+
+	switch (ssbo->GetBufferImplementation()) {
+		// a different part of the buffer is written every frame, each has to catch up on
+		// what changed while the other parts were current
+		case IStreamBufferConcept::Types::SB_MAPANDSYNC:
+		case IStreamBufferConcept::Types::SB_PERSISTENTMAP:
+		case IStreamBufferConcept::Types::SB_PINNEDMEMAMD: {
+			numParts = std::min(numBuffers, spring::DirtyRangeTracker::MAX_PARTS);
+		} break;
+		// uploads everything up to the end of the mapped range anyway
+		case IStreamBufferConcept::Types::SB_BUFFERDATA: {
+			maxGap = storageElemCount;
+			maxBatch = std::max(storageElemCount, 1u);
+		} break;
+		default: {} break;
+	}
+
+	const auto& batches = dirtyRanges.Collect(storageElemCount, numParts, maxGap, maxBatch);
+
+	lastUploadBytes = 0;
+	lastUploadRanges = batches.size();
+
+	for (const auto& batch: batches) {
+		T* mappedPtr = ssbo->Map(clientPtr, batch.beg, batch.Size());
+
+		if (!ssbo->HasClientPtr())
+			memcpy(mappedPtr, clientPtr + batch.beg, batch.Size() * sizeof(T));
+
+		ssbo->Unmap();
+
+		lastUploadBytes += batch.Size() * sizeof(T);
+	}
+
+	TracyPlot(bytesPlotName, static_cast<int64_t>(lastUploadBytes));
+	TracyPlot(rangesPlotName, static_cast<int64_t>(lastUploadRanges));
+}
+
 template<typename T, typename Derived>
 std::size_t TypedStorageBufferUploader<T, Derived>::GetUnitDefElemOffset(int32_t unitDefID) const
 {
@@ -109,18 +188,12 @@ void MatrixUploader::InitDerived()
 	if (!globalRendering->haveGL4)
 		return;
 
-	const auto sbType = globalRendering->supportPersistentMapping
-		? IStreamBufferConcept::Types::SB_PERSISTENTMAP
-		: IStreamBufferConcept::Types::SB_BUFFERSUBDATA;
-
-	InitImpl(MATRIX_SSBO_BINDING_IDX, ELEM_COUNT0, ELEM_COUNTI, sbType, true, MatricesMemStorage::BUFFERING);
-	if (ssbo->GetBufferImplementation() == IStreamBufferConcept::Types::SB_PERSISTENTMAP && !ssbo->IsValid()) {
-		// some potatoe driver overestimated its support for SB_PERSISTENTMAP
-		// Redo with good old SB_BUFFERSUBDATA
-		LOG_L(L_ERROR, "[MatrixUploader::%s] OpenGL reported persistent mapping to be available, but initial mapping of buffer failed. Falling back.", __func__);
-		KillImpl();
-		InitImpl(MATRIX_SSBO_BINDING_IDX, ELEM_COUNT0, ELEM_COUNTI, IStreamBufferConcept::Types::SB_BUFFERSUBDATA, true, MatricesMemStorage::BUFFERING);
-	}
+	TracyPlotConfig(matrixUploadBytesPlot, tracy::PlotFormatType::Memory, true, false, 0);
+
+	InitImpl(MATRIX_SSBO_BINDING_IDX, ELEM_COUNT0, ELEM_COUNTI, GetModelBufferType(), true, MatricesMemStorage::BUFFERING);
+	CheckPersistentMapping(ELEM_COUNT0);
+
+	matricesMemStorage.SetAllDirty();
 }
 
 void MatrixUploader::KillDerived()
@@ -148,55 +221,14 @@ void MatrixUploader::UpdateDerived()
 		const uint32_t newElemCount = AlignUp(storageElemCount, elemCountIncr);
 		LOG_L(L_DEBUG, "[%s::%s] sizing SSBO %s. New elements count = %u, elemCount = %u, storageElemCount = %u", className, __func__, "up", newElemCount, elemCount, storageElemCount);
 		ssbo->Resize(newElemCount);
-
-		if (ssbo->GetBufferImplementation() == IStreamBufferConcept::Types::SB_PERSISTENTMAP && !ssbo->IsValid()) {
-			LOG_L(L_ERROR, "[MatrixUploader::%s] OpenGL reported persistent mapping to be available, but mapping of buffer of %u size failed. Falling back.", __func__, uint32_t(newElemCount * sizeof(CMatrix44f)));
-			KillImpl();
-			InitImpl(MATRIX_SSBO_BINDING_IDX, newElemCount, ELEM_COUNTI, IStreamBufferConcept::Types::SB_BUFFERSUBDATA, true, MatricesMemStorage::BUFFERING);
-		}
+		CheckPersistentMapping(newElemCount);
 
 		matricesMemStorage.SetAllDirty(); //Resize doesn't copy the data
 	}
 
 	//update on the GPU
-	const CMatrix44f* clientPtr = matricesMemStorage.GetData().data();
-
-	constexpr bool ENABLE_UPLOAD_OPTIMIZATION = true;
-	if (ssbo->GetBufferImplementation() == IStreamBufferConcept::Types::SB_PERSISTENTMAP && ENABLE_UPLOAD_OPTIMIZATION) {
-		const auto stt = matricesMemStorage.GetDirtyMap().begin();
-		const auto fin = matricesMemStorage.GetDirtyMap().end();
-
-		auto beg = matricesMemStorage.GetDirtyMap().begin();
-		auto end = matricesMemStorage.GetDirtyMap().begin();
-
-		static const auto dirtyPred = [](uint8_t m) -> bool { return m > 0u; };
-		while (beg != fin) {
-			beg = std::find_if    (beg, fin, dirtyPred);
-			end = std::find_if_not(beg, fin, dirtyPred);
-
-			if (beg != fin) {
-				const uint32_t offs = static_cast<uint32_t>(std::distance(stt, beg));
-				const uint32_t size = static_cast<uint32_t>(std::distance(beg, end));
-
-				CMatrix44f* mappedPtr = ssbo->Map(clientPtr, offs, size);
-				memcpy(mappedPtr, clientPtr + offs, size * sizeof(CMatrix44f));
-				ssbo->Unmap();
+	UploadDirtyRanges(matricesMemStorage.GetData().data(), storageElemCount, matricesMemStorage.GetDirtyRanges(), matrixUploadBytesPlot, matrixUploadRangesPlot);
 
-				std::transform(beg, end, beg, [](uint8_t v) { return (v - 1); }); //make it less dirty
-			}
-
-			beg = end; //rewind
-		}
-	}
-	else {
-		const CMatrix44f* clientPtr = matricesMemStorage.GetData().data();
-		CMatrix44f* mappedPtr = ssbo->Map(clientPtr, 0, storageElemCount);
-
-		if (!ssbo->HasClientPtr())
-			memcpy(mappedPtr, clientPtr, storageElemCount * sizeof(CMatrix44f));
-
-		ssbo->Unmap();
-	}
 	ssbo->BindBufferRange(bindingIdx);
 	ssbo->SwapBuffer();
 }
@@ -292,7 +324,12 @@ void ModelsUniformsUploader::InitDerived()
 	if (!globalRendering->haveGL4)
 		return;
 
-	InitImpl(MATUNI_SSBO_BINDING_IDX, ELEM_COUNT0, ELEM_COUNTI, IStreamBufferConcept::Types::SB_BUFFERSUBDATA, true, 3);
+	TracyPlotConfig(uniformsUploadBytesPlot, tracy::PlotFormatType::Memory, true, false, 0);
+
+	InitImpl(MATUNI_SSBO_BINDING_IDX, ELEM_COUNT0, ELEM_COUNTI, GetModelBufferType(), true, 3);
+	CheckPersistentMapping(ELEM_COUNT0);
+
+	modelsUniformsStorage.GetDirtyRanges().AddAll(modelsUniformsStorage.Size());
 }
 
 void ModelsUniformsUploader::KillDerived()
@@ -318,16 +355,14 @@ void ModelsUniformsUploader::UpdateDerived()
 		const uint32_t newElemCount = AlignUp(storageElemCount, elemCountIncr);
 		LOG_L(L_DEBUG, "[%s::%s] sizing SSBO %s. New elements count = %u, elemCount = %u, storageElemCount = %u", className, __func__, "up", newElemCount, elemCount, storageElemCount);
 		ssbo->Resize(newElemCount);
+		CheckPersistentMapping(newElemCount);
+
+		modelsUniformsStorage.GetDirtyRanges().AddAll(storageElemCount); //Resize doesn't copy the data
 	}
 
 	//update on the GPU
-	const ModelUniformData* clientPtr = modelsUniformsStorage.GetData().data();
-	ModelUniformData* mappedPtr = ssbo->Map(clientPtr, 0, storageElemCount);
-
-	if (!ssbo->HasClientPtr())
-		memcpy(mappedPtr, clientPtr, storageElemCount * sizeof(ModelUniformData));
+	UploadDirtyRanges(modelsUniformsStorage.GetData().data(), storageElemCount, modelsUniformsStorage.GetDirtyRanges(), uniformsUploadBytesPlot, uniformsUploadRangesPlot);
 
-	ssbo->Unmap();
 	ssbo->BindBufferRange(bindingIdx);
 	ssbo->SwapBuffer();
 }
@@ -7,6 +7,7 @@
 #include <functional>
 #include <memory>
 
+#include "System/DirtyRangeTracker.h"
 #include "System/Matrix44f.h"
 #include "System/SpringMath.h"
 #include "System/TypeToStr.h"
@@ -60,10 +61,27 @@ protected:
 	virtual std::size_t GetElemOffsetImpl(const CProjectile* p) const = 0;
 
 	uint32_t GetElemsCount() const;
+
+	// recreates the SSBO with glBufferSubData uploads if a persistent mapping could not be established
+	void CheckPersistentMapping(uint32_t numElems);
+
+	// copies the dirty ranges of the client-side storage into the part of the SSBO written this frame
+	void UploadDirtyRanges(const T* clientPtr, uint32_t storageElemCount, spring::DirtyRangeTracker& dirtyRanges, const char* bytesPlotName, const char* rangesPlotName);
+public:
+	uint32_t GetLastUploadBytes() const { return lastUploadBytes; }
+	uint32_t GetLastUploadRanges() const { return lastUploadRanges; }
 protected:
+	// bridge small clean gaps rather than issue another upload, and cap the size of each upload
+	static constexpr uint32_t MAX_UPLOAD_GAP_BYTES = 1 << 10;
+	static constexpr uint32_t MAX_UPLOAD_BATCH_BYTES = 1 << 18;
+
 	uint32_t bindingIdx = -1u;
 	uint32_t elemCount0 = 0;
 	uint32_t elemCountIncr = 0;
+	uint32_t numBuffers = 0;
+
+	uint32_t lastUploadBytes = 0;
+	uint32_t lastUploadRanges = 0;
 	static constexpr const char* className = spring::TypeToCStr<Derived>();
 
 	std::unique_ptr<IStreamBuffer<T>> ssbo;
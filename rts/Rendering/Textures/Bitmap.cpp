@@ -21,6 +21,7 @@
 #include "System/ContainerUtil.h"
 #include "System/SafeUtil.h"
 #include "System/Log/ILog.h"
+#include "System/MemAccounting.h"
 #include "System/SpringMem.h"
 #include "System/SpringMath.h"
 #include "System/StringUtil.h"
@@ -85,6 +86,8 @@ protected:
 	size_t numFrees = 0;
 	size_t freeSize = 0;
 
+	MemAccounting::Tag memTag = MemAccounting::Tag("Bitmaps");
+
 	// libIL is not thread-safe, neither are {Alloc,Free}
 	spring::mutex bmpMutex;
 };
@@ -162,6 +165,7 @@ public:
 
 		numAllocs += 1;
 		allocSize += size;
+		memTag.Alloc(size);
 
 		return mem;
 	}
@@ -196,6 +200,7 @@ public:
 		numFrees += 1;
 		freeSize += size;
 		allocSize -= size;
+		memTag.Free(size);
 
 		// most bitmaps are transient, so keep the list short
 		// longer-lived textures should be allocated ASAP s.t.
@@ -320,6 +325,7 @@ public:
 
 		numAllocs += 1;
 		allocSize += size;
+		memTag.Alloc(size);
 
 		return static_cast<uint8_t*>(spring::AllocateAlignedMemory(size, sizeof(uint64_t)));
 	}
@@ -331,6 +337,7 @@ public:
 		numFrees += 1;
 		freeSize += size;
 		allocSize -= size;
+		memTag.Free(size);
 
 		spring::FreeAlignedMemory(mem);
 	}
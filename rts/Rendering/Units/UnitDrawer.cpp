@@ -137,7 +137,7 @@ void CUnitDrawer::InitStatic()
 	SelectImplementation();
 }
 
-bool CUnitDrawer::ShouldDrawOpaqueUnit(CUnit* u, uint8_t thisPassMask)
+bool CUnitDrawer::IsOpaqueUnitCandidate(const CUnit* u, uint8_t thisPassMask)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	if (u == ((thisPassMask == DrawFlags::SO_REFLEC_FLAG) ? nullptr : (gu->GetMyPlayer())->fpsController.GetControllee()))
@@ -164,6 +164,12 @@ bool CUnitDrawer::ShouldDrawOpaqueUnit(CUnit* u, uint8_t thisPassMask)
 	if (thisPassMask == DrawFlags::SO_OPAQUE_FLAG && !u->HasDrawFlag(DrawFlags::SO_OPAQUE_FLAG))
 		return false;
 
+	return true;
+}
+
+bool CUnitDrawer::ShouldDrawOpaqueUnit(CUnit* u, uint8_t thisPassMask)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
 	if (LuaObjectDrawer::AddOpaqueMaterialObject(u, LUAOBJ_UNIT))
 		return false;
 
@@ -173,7 +179,7 @@ bool CUnitDrawer::ShouldDrawOpaqueUnit(CUnit* u, uint8_t thisPassMask)
 	return true;
 }
 
-bool CUnitDrawer::ShouldDrawAlphaUnit(CUnit* u, uint8_t thisPassMask)
+bool CUnitDrawer::IsAlphaUnitCandidate(const CUnit* u, uint8_t thisPassMask)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	assert(u);
@@ -197,6 +203,12 @@ bool CUnitDrawer::ShouldDrawAlphaUnit(CUnit* u, uint8_t thisPassMask)
 	if (thisPassMask == DrawFlags::SO_ALPHAF_FLAG && !u->HasDrawFlag(DrawFlags::SO_ALPHAF_FLAG))
 		return false;
 
+	return true;
+}
+
+bool CUnitDrawer::ShouldDrawAlphaUnit(CUnit* u, uint8_t thisPassMask)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
 	if (LuaObjectDrawer::AddAlphaMaterialObject(u, LUAOBJ_UNIT))
 		return false;
 
@@ -206,16 +218,19 @@ bool CUnitDrawer::ShouldDrawAlphaUnit(CUnit* u, uint8_t thisPassMask)
 	return true;
 }
 
-bool CUnitDrawer::ShouldDrawUnitShadow(CUnit* u)
+bool CUnitDrawer::IsUnitShadowCandidate(const CUnit* u)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	assert(u);
 	assert(u->model);
 
-	static constexpr uint8_t thisPassMask = DrawFlags::SO_SHOPAQ_FLAG;
+	return (u->HasDrawFlag(DrawFlags::SO_SHOPAQ_FLAG));
+}
 
-	if (!u->HasDrawFlag(DrawFlags::SO_SHOPAQ_FLAG))
-		return false;
+bool CUnitDrawer::ShouldDrawUnitShadow(CUnit* u)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	static constexpr uint8_t thisPassMask = DrawFlags::SO_SHOPAQ_FLAG;
 
 	if (LuaObjectDrawer::AddShadowMaterialObject(u, LUAOBJ_UNIT))
 		return false;
@@ -583,13 +598,17 @@ void CUnitDrawerLegacy::DrawObjectsShadow(int modelType) const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	const auto& mdlRenderer = modelDrawerData->GetModelRenderer(modelType);
+	const auto& drawLists = modelDrawerData->GetDrawLists();
+	const auto drawListPass = CModelDrawerDataConcept::DRAWLIST_SHADOW;
 
 	for (uint32_t i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
-		if (mdlRenderer.GetObjectBin(i).empty())
+		const auto& drawList = drawLists.GetList(drawListPass, modelType, i);
+
+		if (drawList.empty())
 			continue;
 
 		CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
-		for (auto* o : mdlRenderer.GetObjectBin(i)) {
+		for (auto* o : drawList) {
 			DrawUnitShadow(o);
 		}
 
@@ -606,14 +625,18 @@ void CUnitDrawerLegacy::DrawOpaqueObjects(int modelType, bool drawReflection, bo
 		(drawRefraction * DrawFlags::SO_REFRAC_FLAG);
 
 	const auto& mdlRenderer = modelDrawerData->GetModelRenderer(modelType);
+	const auto& drawLists = modelDrawerData->GetDrawLists();
+	const auto drawListPass = CModelDrawerDataConcept::GetOpaqueDrawListPass(drawReflection, drawRefraction);
 
 	for (uint32_t i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
-		if (mdlRenderer.GetObjectBin(i).empty())
+		const auto& drawList = drawLists.GetList(drawListPass, modelType, i);
+
+		if (drawList.empty())
 			continue;
 
 		CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
 
-		for (auto* o : mdlRenderer.GetObjectBin(i)) {
+		for (auto* o : drawList) {
 			DrawOpaqueUnit(o, thisPassMask);
 		}
 	}
@@ -628,14 +651,18 @@ void CUnitDrawerLegacy::DrawAlphaObjects(int modelType, bool drawReflection, boo
 		(drawRefraction * DrawFlags::SO_REFRAC_FLAG);
 
 	const auto& mdlRenderer = modelDrawerData->GetModelRenderer(modelType);
+	const auto& drawLists = modelDrawerData->GetDrawLists();
+	const auto drawListPass = CModelDrawerDataConcept::GetAlphaDrawListPass(drawReflection, drawRefraction);
 
 	for (uint32_t i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
-		if (mdlRenderer.GetObjectBin(i).empty())
+		const auto& drawList = drawLists.GetList(drawListPass, modelType, i);
+
+		if (drawList.empty())
 			continue;
 
 		CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
 
-		for (auto* o : mdlRenderer.GetObjectBin(i)) {
+		for (auto* o : drawList) {
 			DrawAlphaUnit(o, modelType, thisPassMask, false);
 		}
 	}
@@ -1435,21 +1462,23 @@ void CUnitDrawerGL4::DrawObjectsShadow(int modelType) const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	const auto& mdlRenderer = modelDrawerData->GetModelRenderer(modelType);
+	const auto& drawLists = modelDrawerData->GetDrawLists();
+	const auto drawListPass = CModelDrawerDataConcept::DRAWLIST_SHADOW;
 
 	auto& smv = S3DModelVAO::GetInstance();
 	smv.Bind();
 
 	for (uint32_t i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
-		if (mdlRenderer.GetObjectBin(i).empty())
+		const auto& drawList = drawLists.GetList(drawListPass, modelType, i);
+
+		if (drawList.empty())
 			continue;
 
 		CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
-		const auto& bin = mdlRenderer.GetObjectBin(i);
-
 		static vector<const ObjType*> beingBuilt;
 		beingBuilt.clear();
 
-		for (auto* o : bin) {
+		for (auto* o : drawList) {
 			if (!ShouldDrawUnitShadow(o))
 				continue;
 
@@ -1482,6 +1511,8 @@ void CUnitDrawerGL4::DrawOpaqueObjects(int modelType, bool drawReflection, bool
 		(drawRefraction * DrawFlags::SO_REFRAC_FLAG);
 
 	const auto& mdlRenderer = modelDrawerData->GetModelRenderer(modelType);
+	const auto& drawLists = modelDrawerData->GetDrawLists();
+	const auto drawListPass = CModelDrawerDataConcept::GetOpaqueDrawListPass(drawReflection, drawRefraction);
 
 	SetTeamColor(0, 1.0f);
 	modelDrawerState->SetColorMultiplier();
@@ -1490,7 +1521,9 @@ void CUnitDrawerGL4::DrawOpaqueObjects(int modelType, bool drawReflection, bool
 	smv.Bind();
 
 	for (unsigned int i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
-		if (mdlRenderer.GetObjectBin(i).empty())
+		const auto& drawList = drawLists.GetList(drawListPass, modelType, i);
+
+		if (drawList.empty())
 			continue;
 
 		CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
@@ -1498,7 +1531,7 @@ void CUnitDrawerGL4::DrawOpaqueObjects(int modelType, bool drawReflection, bool
 		static vector<const ObjType*> beingBuilt;
 		beingBuilt.clear();
 
-		for (auto* o : mdlRenderer.GetObjectBin(i)) {
+		for (auto* o : drawList) {
 			if (!ShouldDrawOpaqueUnit(o, thisPassMask))
 				continue;
 
@@ -1528,6 +1561,8 @@ void CUnitDrawerGL4::DrawAlphaObjects(int modelType, bool drawReflection, bool d
 		(drawRefraction * DrawFlags::SO_REFRAC_FLAG);
 
 	const auto& mdlRenderer = modelDrawerData->GetModelRenderer(modelType);
+	const auto& drawLists = modelDrawerData->GetDrawLists();
+	const auto drawListPass = CModelDrawerDataConcept::GetAlphaDrawListPass(drawReflection, drawRefraction);
 
 	auto& smv = S3DModelVAO::GetInstance();
 	smv.Bind();
@@ -1537,14 +1572,14 @@ void CUnitDrawerGL4::DrawAlphaObjects(int modelType, bool drawReflection, bool d
 	modelDrawerState->SetTeamColor(0, IModelDrawerState::alphaValues.x); //teamID doesn't matter here
 	//main cloaked alpha pass
 	for (uint32_t i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
-		if (mdlRenderer.GetObjectBin(i).empty())
+		const auto& drawList = drawLists.GetList(drawListPass, modelType, i);
+
+		if (drawList.empty())
 			continue;
 
 		CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
 
-		const auto& bin = mdlRenderer.GetObjectBin(i);
-
-		for (auto* o : bin) {
+		for (auto* o : drawList) {
 			if (!ShouldDrawAlphaUnit(o, thisPassMask))
 				continue;
 
@@ -78,7 +78,13 @@ public:
 	virtual bool ShowUnitBuildSquare(const BuildInfo& buildInfo, const std::vector<Command>& commands) const = 0;
 
 	virtual void DrawBuildIcons(const std::vector<CCursorIcons::BuildIcon>& buildIcons) const = 0;
+public:
+	// draw-list membership tests, thread-safe; see CModelDrawerDataBase::BuildDrawLists
+	static bool IsOpaqueUnitCandidate(const CUnit* u, uint8_t thisPassMask);
+	static bool IsAlphaUnitCandidate(const CUnit* u, uint8_t thisPassMask);
+	static bool IsUnitShadowCandidate(const CUnit* u);
 protected:
+	// remaining render-thread tests (Lua material binning, engineDrawMask) for draw-list entries
 	static bool ShouldDrawOpaqueUnit(CUnit* u, uint8_t thisPassMask);
 	static bool ShouldDrawAlphaUnit(CUnit* u, uint8_t thisPassMask);
 	static bool ShouldDrawUnitShadow(CUnit* u);
@@ -181,26 +181,39 @@ void CUnitDrawerData::Update()
 
 	iconZoomDist = dist;
 
-	const auto updateBody = [this](CUnit* u) {
+	const auto updatePos = [this](CUnit* u) {
 		UpdateDrawPos(u);
 
 		if (useScreenIcons)
 			UpdateUnitIconStateScreen(u);
 		else
 			UpdateUnitIconState(u);
-
-		UpdateCommon(u);
 	};
 
+	// positions first, then all units are culled against every camera at once
 	if (mtModelDrawer) {
-		for_mt_chunk(0, unsortedObjects.size(), [this, &updateBody](const int k) {
-			CUnit* unit = unsortedObjects[k];
-			updateBody(unit);
+		for_mt_chunk(0, unsortedObjects.size(), [this, &updatePos](const int k) {
+			updatePos(unsortedObjects[k]);
 		}, CModelDrawerDataConcept::MT_CHUNK_OR_MIN_CHUNK_SIZE_UPDT);
 	}
 	else {
 		for (CUnit* unit : unsortedObjects)
-			updateBody(unit);
+			updatePos(unit);
+	}
+
+	{
+		SCOPED_TIMER("Update::WorldDrawer::Cull::Units");
+		CullObjects();
+	}
+
+	if (mtModelDrawer) {
+		for_mt_chunk(0, unsortedObjects.size(), [this](const int k) {
+			UpdateCommon(unsortedObjects[k], k);
+		}, CModelDrawerDataConcept::MT_CHUNK_OR_MIN_CHUNK_SIZE_UPDT);
+	}
+	else {
+		for (size_t k = 0; k < unsortedObjects.size(); k++)
+			UpdateCommon(unsortedObjects[k], k);
 	}
 
 	if ((useDistToGroundForIcons = (camHandler->GetCurrentController()).GetUseDistToGroundForIcons())) {
@@ -213,6 +226,29 @@ void CUnitDrawerData::Update()
 
 		sqCamDistToGroundForIcons = overGround * overGround;
 	}
+
+	{
+		SCOPED_TIMER("Update::WorldDrawer::DrawLists::Units");
+		BuildDrawLists();
+	}
+}
+
+uint32_t CUnitDrawerData::GetDrawListPassMask(const CUnit* u) const
+{
+	if (u->drawFlag == 0)
+		return 0;
+
+	uint32_t passMask = 0;
+
+	passMask |= (CUnitDrawer::IsOpaqueUnitCandidate(u, DrawFlags::SO_OPAQUE_FLAG) << DRAWLIST_OPAQUE       );
+	passMask |= (CUnitDrawer::IsOpaqueUnitCandidate(u, DrawFlags::SO_REFLEC_FLAG) << DRAWLIST_OPAQUE_REFLEC);
+	passMask |= (CUnitDrawer::IsOpaqueUnitCandidate(u, DrawFlags::SO_REFRAC_FLAG) << DRAWLIST_OPAQUE_REFRAC);
+	passMask |= (CUnitDrawer::IsAlphaUnitCandidate (u, DrawFlags::SO_ALPHAF_FLAG) << DRAWLIST_ALPHA        );
+	passMask |= (CUnitDrawer::IsAlphaUnitCandidate (u, DrawFlags::SO_REFLEC_FLAG) << DRAWLIST_ALPHA_REFLEC );
+	passMask |= (CUnitDrawer::IsAlphaUnitCandidate (u, DrawFlags::SO_REFRAC_FLAG) << DRAWLIST_ALPHA_REFRAC );
+	passMask |= (CUnitDrawer::IsUnitShadowCandidate(u                           ) << DRAWLIST_SHADOW       );
+
+	return passMask;
 }
 
 void CUnitDrawerData::UpdateGhostedBuildings()
@@ -383,7 +419,7 @@ void CUnitDrawerData::UpdateDrawPos(CUnit* u)
 	u->drawMidPos = u->GetMdlDrawMidPos();
 }
 
-void CUnitDrawerData::UpdateObjectDrawFlags(CSolidObject* o) const
+void CUnitDrawerData::UpdateObjectDrawFlags(CSolidObject* o, size_t cullIndex) const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	CUnit* u = static_cast<CUnit*>(o);
@@ -417,7 +453,7 @@ void CUnitDrawerData::UpdateObjectDrawFlags(CSolidObject* o) const
 		if (!(u->losStatus[gu->myAllyTeam] & LOS_INLOS) && !gu->spectatingFullView)
 			continue;
 
-		if (!cam->InView(u->drawMidPos, u->GetDrawRadius()))
+		if (!frustumCuller.InView(camType, cullIndex))
 			continue;
 
 		switch (camType)
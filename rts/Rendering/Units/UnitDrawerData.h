@@ -142,7 +142,8 @@ public:
 
 	const spring::unsynced_map<icon::CIconData*, std::vector<const CUnit*> >& GetUnitsByIcon() const { return unitsByIcon; }
 protected:
-	void UpdateObjectDrawFlags(CSolidObject* o) const override;
+	void UpdateObjectDrawFlags(CSolidObject* o, size_t cullIndex) const override;
+	uint32_t GetDrawListPassMask(const CUnit* u) const override;
 private:
 	const icon::CIconData* GetUnitIcon(const CUnit* unit);
 
@@ -39,6 +39,7 @@ void CFeatureHandler::Init() {
 	features.resize(MAX_FEATURES, nullptr);
 	activeFeatureIDs.reserve(MAX_FEATURES); // internal table size must be constant
 	featureMemPool.reserve(128);
+	featureMemPool.set_mem_tag("Features");
 
 	idPool.Clear();
 	idPool.Expand(0, MAX_FEATURES);
@@ -614,6 +614,15 @@ void ILosType::Update()
 }
 
 
+void ILosType::CommitDirtyRects()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	for (CLosMap& losMap: losMaps) {
+		losMap.CommitDirtyRect();
+	}
+}
+
+
 void ILosType::UpdateHeightMapSynced(SRectangle rect)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -850,6 +859,7 @@ void CLosHandler::Update()
 		#endif
 
 		lt->Update();
+		lt->CommitDirtyRects();
 	});
 }
 
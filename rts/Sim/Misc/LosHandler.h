@@ -130,6 +130,7 @@ public:
 public:
 	void Update();
 	void UpdateHeightMapSynced(SRectangle rect);
+	void CommitDirtyRects();
 	void RemoveUnit(CUnit* unit, bool delayed = false);
 	void UpdateUnit(CUnit* unit, bool ignore = false);
 
@@ -170,7 +171,7 @@ public:
 	static size_t cacheHits;
 	static size_t cacheRefs;
 
-	spring::unordered_map<int, std::vector<SLosInstance*> > instanceHashes;
+	spring::flat_hash_map<int, std::vector<SLosInstance*> > instanceHashes;
 
 	std::vector<CLosMap> losMaps;
 	std::deque<SLosInstance> instances;
@@ -409,9 +409,50 @@ void CLosTableHelper::Debug(const LosTable& losRays, const std::vector<int2>& po
 //////////////////////////////////////////////////////////////////////
 /// CLosMap implementation
 
+void CLosMap::MarkDirty(const SLosInstance* instance)
+{
+	// both circles and raycasts stay within the instance radius
+	SRectangle rect(
+		instance->basePos.x - instance->radius    , instance->basePos.y - instance->radius,
+		instance->basePos.x + instance->radius + 1, instance->basePos.y + instance->radius + 1
+	);
+
+	rect.ClampIn(SRectangle(0, 0, size.x, size.y));
+	pendingDirtyRect.Merge(rect);
+}
+
+
+void CLosMap::CommitDirtyRect()
+{
+	if (pendingDirtyRect.Empty())
+		return;
+
+	dirtyRects[++dirtySerial % DIRTY_HISTORY_SIZE] = pendingDirtyRect;
+	pendingDirtyRect = {};
+}
+
+
+SRectangle CLosMap::GetDirtyRect(uint32_t& serial) const
+{
+	SRectangle rect;
+
+	if (serial == DIRTY_SERIAL_NONE || serial > dirtySerial || (dirtySerial - serial) >= DIRTY_HISTORY_SIZE) {
+		rect = SRectangle(0, 0, size.x, size.y);
+	} else {
+		for (uint32_t s = serial + 1; s <= dirtySerial; ++s) {
+			rect.Merge(dirtyRects[s % DIRTY_HISTORY_SIZE]);
+		}
+	}
+
+	serial = dirtySerial;
+	return rect;
+}
+
+
 void CLosMap::AddCircle(SLosInstance* instance, int amount)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	MarkDirty(instance);
 	MidpointCircleAlgoPerLine(instance->radius, [&](int width, int y) {
 		const unsigned y_ = instance->basePos.y + y;
 
@@ -435,6 +476,8 @@ void CLosMap::AddRaycast(SLosInstance* instance, int amount)
 	if (losSquares.empty() || losSquares[0].length == SLosInstance::EMPTY_RLE.length)
 		return;
 
+	MarkDirty(instance);
+
 	// inform ReadMap when squares enter LoS
 	const bool visibleInstanceSquares = (instance->allyteam >= 0 && (instance->allyteam == gu->myAllyTeam || gu->spectatingFullView));
 	const bool updateUnsyncedHeightMap = sendReadmapEvents && visibleInstanceSquares;
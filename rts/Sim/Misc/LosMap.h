@@ -5,8 +5,10 @@
 #ifndef LOS_MAP_H
 #define LOS_MAP_H
 
+#include <array>
 #include <vector>
 #include "System/type2.h"
+#include "System/Rectangle.h"
 #include "System/SpringMath.h"
 
 
@@ -29,10 +31,28 @@ public:
 		mipHeightMap = mipHeightMap_;
 
 		sendReadmapEvents = sendReadmapEvents_;
+
+		pendingDirtyRect = {};
+		dirtyRects.fill({});
+		dirtySerial = DIRTY_SERIAL_NONE + 1;
 	}
 
 	void Kill() {}
 
+public:
+	/// number of committed updates whose dirty rectangles are remembered
+	static constexpr uint32_t DIRTY_HISTORY_SIZE = 16;
+	/// initial consumer serial, GetDirtyRect returns the whole map for it
+	static constexpr uint32_t DIRTY_SERIAL_NONE = 0;
+
+	/// closes an update; the squares changed by it become visible to GetDirtyRect
+	void CommitDirtyRect();
+
+	/// returns the bounding rectangle (in LOS squares) of the squares changed by
+	/// the updates committed after <serial> and advances <serial> to the latest
+	/// one; the whole map if <serial> is unknown or older than the history
+	SRectangle GetDirtyRect(uint32_t& serial) const;
+
 public:
 	/// circular area, for airLosMap, circular radar maps, jammer maps, ...
 	void AddCircle(SLosInstance* instance, int amount);
@@ -54,6 +74,8 @@ public:
 	const unsigned short& front() const { return (losmap.front()); }
 
 private:
+	void MarkDirty(const SLosInstance* instance);
+
 	void LosAdd(SLosInstance* instance) const;
 	void UnsafeLosAdd(SLosInstance* instance) const;
 	void SafeLosAdd(SLosInstance* instance) const;
@@ -70,6 +92,11 @@ protected:
 	const float* mipHeightMap = nullptr;
 
 	bool sendReadmapEvents = false;
+
+	// written by the sim (AddCircle, AddRaycast), read by the info textures
+	SRectangle pendingDirtyRect;
+	std::array<SRectangle, DIRTY_HISTORY_SIZE> dirtyRects;
+	uint32_t dirtySerial = DIRTY_SERIAL_NONE + 1;
 };
 
 #endif // LOS_MAP_H
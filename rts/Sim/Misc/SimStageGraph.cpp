@@ -0,0 +1,159 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "SimStageGraph.h"
+
+#include <algorithm>
+#include <future>
+#include <memory>
+
+#include "System/Threading/ThreadPool.h"
+#include "System/Misc/TracyDefs.h"
+
+static const char* const criticalPathPlot = "SimCriticalPath";
+
+
+void CSimStageGraph::AddStage(const char* name, uint32_t reads, uint32_t writes, bool mainThread, std::function<void()>&& func)
+{
+	Stage& stage = stages.emplace_back();
+
+	stage.name = name;
+	stage.func = std::move(func);
+	stage.reads = reads;
+	stage.writes = writes;
+	stage.mainThread = mainThread;
+	stage.async = !mainThread;
+
+	const size_t stageIdx = stages.size() - 1;
+
+	for (size_t i = 0; i < stageIdx; i++) {
+		if (Conflicts(stages[i], stage))
+			stage.deps.push_back(i);
+	}
+
+	// nothing would overlap with a stage its direct successor has to wait for
+	if (stageIdx > 0 && !stage.deps.empty() && stage.deps.back() == stageIdx - 1)
+		stages[stageIdx - 1].async = false;
+}
+
+
+void CSimStageGraph::Run()
+{
+	ZoneScoped;
+
+	std::vector<std::shared_ptr<std::future<void>>> tasks(stages.size());
+	// last stage that ran on the main thread before each stage was issued
+	std::vector<int> inlinePreds(stages.size(), -1);
+
+	const bool haveThreads = ThreadPool::HasThreads();
+	int lastInlineStage = -1;
+
+	const auto RunStage = [](Stage& stage) {
+		ZoneScoped;
+		ZoneName(stage.name.c_str(), stage.name.size());
+
+		stage.startTime = spring_gettime();
+		stage.func();
+		stage.endTime = spring_gettime();
+	};
+
+	for (size_t i = 0; i < stages.size(); i++) {
+		Stage& stage = stages[i];
+
+		for (const size_t dep: stage.deps) {
+			if (tasks[dep] != nullptr)
+				tasks[dep]->wait();
+		}
+
+		inlinePreds[i] = lastInlineStage;
+
+		if (stage.async && haveThreads) {
+			tasks[i] = ThreadPool::Enqueue([&RunStage, &stage]() { RunStage(stage); });
+			continue;
+		}
+
+		RunStage(stage);
+		lastInlineStage = i;
+	}
+
+	// rethrows anything a worker stage threw
+	for (auto& task: tasks) {
+		if (task != nullptr)
+			task->get();
+	}
+
+	UpdateCriticalPath(inlinePreds);
+	ReportCriticalPath();
+}
+
+
+void CSimStageGraph::UpdateCriticalPath(const std::vector<int>& inlinePreds)
+{
+	criticalPath.clear();
+
+	if (stages.empty())
+		return;
+
+	size_t stageIdx = 0;
+
+	for (size_t i = 1; i < stages.size(); i++) {
+		if (stages[i].endTime >= stages[stageIdx].endTime)
+			stageIdx = i;
+	}
+
+	// walk back through whichever of its dependencies or the main thread's
+	// previous stage finished last, that is what each stage was waiting on
+	while (true) {
+		criticalPath.push_back(stageIdx);
+
+		const Stage& stage = stages[stageIdx];
+		int predIdx = inlinePreds[stageIdx];
+
+		for (const size_t dep: stage.deps) {
+			if (predIdx == -1 || stages[dep].endTime > stages[predIdx].endTime)
+				predIdx = dep;
+		}
+
+		if (predIdx == -1)
+			break;
+
+		stageIdx = predIdx;
+	}
+
+	std::reverse(criticalPath.begin(), criticalPath.end());
+}
+
+
+spring_time CSimStageGraph::GetCriticalPathTime() const
+{
+	spring_time time;
+
+	for (const size_t stageIdx: criticalPath) {
+		time += (stages[stageIdx].endTime - stages[stageIdx].startTime);
+	}
+
+	return time;
+}
+
+
+void CSimStageGraph::ReportCriticalPath()
+{
+	TracyPlotConfig(criticalPathPlot, tracy::PlotFormatType::Number, false, true, 0);
+	TracyPlot(criticalPathPlot, GetCriticalPathTime().toMilliSecsf());
+
+	#ifdef TRACY_ENABLE
+	// only note changes, the path is mostly the same from frame to frame
+	if (criticalPath == reportedPath)
+		return;
+
+	reportedPath = criticalPath;
+
+	std::string msg = "[SimStageGraph] critical path:";
+
+	for (const size_t stageIdx: criticalPath) {
+		msg += " ";
+		msg += stages[stageIdx].name;
+	}
+
+	TracyMessage(msg.c_str(), msg.size());
+	#endif
+}
@@ -0,0 +1,95 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SIM_STAGE_GRAPH_H
+#define SIM_STAGE_GRAPH_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "System/Misc/SpringTime.h"
+
+/**
+ * Runs the stages of a sim frame as a task graph. Every stage declares the
+ * sim resources it reads and writes; a stage depends on all earlier stages
+ * it conflicts with (write/write, write/read or read/write on any resource)
+ * and stages are issued in the order they were added, so the outcome is the
+ * same as running them in sequence. Stages that do not have to run on the
+ * main thread are handed to the thread pool and overlap with the stages
+ * issued after them until one of those depends on them.
+ *
+ * The stage chain that bounded the last Run() (its critical path) is kept
+ * for reporting.
+ */
+class CSimStageGraph {
+public:
+	enum Resource: uint32_t {
+		RES_HEIGHTMAP     = (1 <<  0),
+		RES_HEIGHT_BOUNDS = (1 <<  1),
+		RES_SMOOTH_MESH   = (1 <<  2),
+		RES_UNITS         = (1 <<  3),
+		RES_FEATURES      = (1 <<  4),
+		RES_PROJECTILES   = (1 <<  5),
+		RES_PATHS         = (1 <<  6),
+		RES_SCRIPTS       = (1 <<  7),
+		RES_LOS           = (1 <<  8),
+		RES_GHOSTS        = (1 <<  9),
+		RES_ENV_RES       = (1 << 10),
+		RES_TEAMS         = (1 << 11),
+		RES_PLAYERS       = (1 << 12),
+		RES_SYNCED_RNG    = (1 << 13),
+		// for stages that can reach Lua callins, which can touch anything
+		RES_ALL           = ~0u,
+	};
+
+	struct Stage {
+		std::string name;
+		std::function<void()> func;
+
+		uint32_t reads;
+		uint32_t writes;
+
+		// indices of the earlier stages this one has to wait for
+		std::vector<size_t> deps;
+
+		bool mainThread;
+		// whether Run() may hand this stage to a worker thread
+		bool async = false;
+
+		spring_time startTime;
+		spring_time endTime;
+	};
+
+public:
+	void Clear() {
+		stages.clear();
+		criticalPath.clear();
+		reportedPath.clear();
+	}
+
+	void AddStage(const char* name, uint32_t reads, uint32_t writes, bool mainThread, std::function<void()>&& func);
+	void Run();
+
+	bool Empty() const { return stages.empty(); }
+
+	const std::vector<Stage>& GetStages() const { return stages; }
+	// stage indices, in execution order
+	const std::vector<size_t>& GetCriticalPath() const { return criticalPath; }
+	spring_time GetCriticalPathTime() const;
+
+	static bool Conflicts(const Stage& a, const Stage& b) {
+		return ((a.writes & (b.reads | b.writes)) != 0 || (a.reads & b.writes) != 0);
+	}
+
+private:
+	void UpdateCriticalPath(const std::vector<int>& inlinePreds);
+	void ReportCriticalPath();
+
+private:
+	std::vector<Stage> stages;
+	std::vector<size_t> criticalPath;
+	std::vector<size_t> reportedPath;
+};
+
+#endif // SIM_STAGE_GRAPH_H
@@ -79,7 +79,7 @@ private:
 	CacheItem dummyCacheItem;
 
 	std::deque<CacheQueItem> cacheQue;
-	spring::unordered_map<std::uint64_t, CacheItem> cachedPaths; // ints are sync-safe keys
+	spring::flat_hash_map<std::uint64_t, CacheItem> cachedPaths; // ints are sync-safe keys
 
 	std::uint32_t numBlocksX;
 	std::uint32_t numBlocksZ;
@@ -260,6 +260,8 @@ void PathingState::InitEstimator(const std::string& peFileName, const std::strin
 	// calculate checksum over block-offsets and vertex-costs
 	pathChecksum = CalcChecksum();
 
+	pcMemPool.set_mem_tag("Paths");
+
 	pathCache[0] = pcMemPool.alloc<CPathCache>(mapDimensionsInBlocks.x, mapDimensionsInBlocks.y);
 	pathCache[1] = pcMemPool.alloc<CPathCache>(mapDimensionsInBlocks.x, mapDimensionsInBlocks.y);
 }
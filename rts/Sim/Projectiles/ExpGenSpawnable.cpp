@@ -133,6 +133,13 @@ TypedRenderBuffer<VA_TYPE_PROJ>& CExpGenSpawnable::GetPrimaryRenderBuffer()
 	return RenderBuffer::GetTypedRenderBuffer<VA_TYPE_PROJ>();
 }
 
+static thread_local std::vector<VA_TYPE_PROJ>* effectsQuadSink = nullptr;
+
+void CExpGenSpawnable::SetThreadEffectsQuadSink(std::vector<VA_TYPE_PROJ>* sink)
+{
+	effectsQuadSink = sink;
+}
+
 template<typename Spawnable>
 CExpGenSpawnable::SpawnableTuple GetSpawnableEntryImpl()
 {
@@ -227,12 +234,20 @@ void CExpGenSpawnable::AddEffectsQuad(const VA_TYPE_TC& tl, const VA_TYPE_TC& tr
 		((maxT = std::max(maxT, arg.t)), ...);
 	}, tl, tr, br, bl);
 
-	auto& rb = GetPrimaryRenderBuffer();
-
 	const auto uvInfo = float4{ minS, minT, maxS - minS, maxT - minT };
 	const auto animInfo = float3{ animParams.x, animParams.y, animProgress };
 	constexpr float layer = 0.0f; //for future texture arrays
 
+	if (effectsQuadSink != nullptr) {
+		effectsQuadSink->push_back({ tl.pos, float3{ tl.s, tl.t, layer }, uvInfo, animInfo, tl.c });
+		effectsQuadSink->push_back({ tr.pos, float3{ tr.s, tr.t, layer }, uvInfo, animInfo, tr.c });
+		effectsQuadSink->push_back({ br.pos, float3{ br.s, br.t, layer }, uvInfo, animInfo, br.c });
+		effectsQuadSink->push_back({ bl.pos, float3{ bl.s, bl.t, layer }, uvInfo, animInfo, bl.c });
+		return;
+	}
+
+	auto& rb = GetPrimaryRenderBuffer();
+
 	//pos, uvw, uvmm, col
 	rb.AddQuadTriangles(
 		{ tl.pos, float3{ tl.s, tl.t, layer }, uvInfo, animInfo, tl.c },
@@ -6,6 +6,7 @@
 #include <memory>
 #include <array>
 #include <tuple>
+#include <vector>
 
 #include "Sim/Objects/WorldObject.h"
 #include "System/Threading/ThreadPool.h"
@@ -35,6 +36,11 @@ public:
 	//Memory handled in projectileHandler
 	static CExpGenSpawnable* CreateSpawnable(int spawnableID);
 	static TypedRenderBuffer<VA_TYPE_PROJ>& GetPrimaryRenderBuffer();
+
+	// while set, AddEffectsQuad on the calling thread appends the 4 vertices
+	// of each quad to <sink> instead of the primary buffer; whoever set it
+	// merges the sink into the primary buffer (see CProjectileDrawer::DrawAlpha)
+	static void SetThreadEffectsQuadSink(std::vector<VA_TYPE_PROJ>* sink);
 protected:
 	CExpGenSpawnable();
 
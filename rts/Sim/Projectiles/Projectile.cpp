@@ -46,6 +46,8 @@ CR_REG_METADATA(CProjectile,
 	CR_MEMBER(mygravity),
 	CR_IGNORED(sortDist),
 	CR_MEMBER(sortDistOffset),
+	CR_IGNORED(sortRank),
+	CR_IGNORED(sortRankStamp),
 
 	CR_MEMBER(validTextures),
 
@@ -51,6 +51,10 @@ public:
 	virtual void Draw() {}
 	virtual void DrawOnMinimap() const;
 
+	// whether Draw may run on a worker thread, i.e. it only emits through
+	// AddEffectsQuad and writes no state outside of this projectile
+	virtual bool CanDrawConcurrently() const { return true; }
+
 	virtual int GetProjectilesCount() const = 0;
 
 	// override WorldObject::SetVelocityAndSpeed so
@@ -121,6 +125,10 @@ public:
 	std::array<float, 3> sortDist = {}; // distance used for z-sorting when rendering
 	float sortDistOffset = 0.0f;        // an offset used for z-sorting
 
+	// position in the previous z-sorted draw order and the sort it came from, per camera type
+	std::array<uint32_t, 3> sortRank = {};
+	std::array<uint32_t, 3> sortRankStamp = {};
+
 	int drawOrder = 0;
 
 	inline static spring::mutex mut = {};
@@ -82,6 +82,7 @@ void CProjectileHandler::Init()
 
 	projMemPool.clear();
 	projMemPool.reserve(1024);
+	projMemPool.set_mem_tag("Projectiles");
 
 	for (int modelType = 0; modelType < MODELTYPE_CNT; ++modelType) {
 		flyingPieces[modelType].clear();
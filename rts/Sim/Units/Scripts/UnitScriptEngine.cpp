@@ -18,6 +18,7 @@
 #include "System/Misc/TracyDefs.h"
 
 CONFIG(bool, AnimationMT).defaultValue(true).safemodeValue(false).minimumValue(false).description("Enable multithreaded execution of animation ticks");
+CONFIG_HANDLE(bool, AnimationMT);
 
 static CCobEngine gCobEngine;
 static CCobFileHandler gCobFileHandler;
@@ -132,7 +133,7 @@ void CUnitScriptEngine::Tick(int deltaTime)
 	using ImplFunctionT = decltype(&CUnitScriptEngine::ImplTickST);
 	static constexpr ImplFunctionT ImplFunctions[] = { &CUnitScriptEngine::ImplTickST, &CUnitScriptEngine::ImplTickMT };
 	// TODO: remove the conditional once it's proven to be sync safe
-	(this->*ImplFunctions[configHandler->GetBool("AnimationMT")])(deltaTime);
+	(this->*ImplFunctions[cfgHandleAnimationMT.Get()])(deltaTime);
 
 	currentScript = nullptr;
 }
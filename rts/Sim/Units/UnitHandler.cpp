@@ -37,6 +37,9 @@
 CONFIG(bool, UpdateWeaponVectorsMT).defaultValue(true).safemodeValue(false).minimumValue(false).description("Enable multithreaded update of weapon vectors");
 CONFIG(bool, UpdateBoundingVolumeMT).defaultValue(true).safemodeValue(false).minimumValue(false).description("Enable multithreaded update of unit bounding volumes");
 
+CONFIG_HANDLE(bool, UpdateWeaponVectorsMT);
+CONFIG_HANDLE(bool, UpdateBoundingVolumeMT);
+
 
 
 CR_BIND(CUnitHandler, )
@@ -125,6 +128,7 @@ void CUnitHandler::Init() {
 		activeUnits.reserve(maxUnits);
 
 		unitMemPool.reserve(128);
+		unitMemPool.set_mem_tag("Units");
 
 		// id's are used as indices, so they must lie in [0, units.size() - 1]
 		// (furthermore all id's are treated equally, none have special status)
@@ -391,7 +395,7 @@ void CUnitHandler::SlowUpdateUnits()
 	// They dont have much of an effect if updated late-ish.
 	{
 		ZoneScopedN("Sim::Unit::SlowUpdateMT");
-		if (configHandler->GetBool("UpdateBoundingVolumeMT")) {
+		if (cfgHandleUpdateBoundingVolumeMT) {
 			for_mt(0, updateBoundingVolumeList.size(), [](int i) {
 				updateBoundingVolumeList[i]->localModel.UpdateBoundingVolume();
 			});
@@ -428,15 +432,19 @@ void CUnitHandler::UpdateUnitWeapons()
 	{
 		SCOPED_TIMER("Sim::Unit::UpdateWeaponVectors");
 
-		if (configHandler->GetBool("UpdateWeaponVectorsMT")) {
+		// piece matrices of units animated since the last frame are brought up to
+		// date in one flat pass per model, rather than on demand by each weapon
+		if (cfgHandleUpdateWeaponVectorsMT) {
 			for_mt_chunk(0, activeUnits.size(), [&](const int idx) {
 				auto unit = activeUnits[idx];
+				unit->localModel.UpdatePieceMatrices();
 				unit->UpdateWeaponVectors();
 			});
 		}
 		else {
 			for (size_t idx = 0; idx < activeUnits.size(); ++idx) {
 				auto unit = activeUnits[idx];
+				unit->localModel.UpdatePieceMatrices();
 				unit->UpdateWeaponVectors();
 			}
 		}
@@ -8,6 +8,7 @@
 #include "System/StringUtil.h"
 #include "System/Log/ILog.h"
 #include "System/UnorderedMap.hpp"
+#include "System/UnorderedSet.hpp"
 #include "System/Threading/SpringThreading.h"
 
 #include <cstdio>
@@ -16,6 +17,9 @@
 #include <stdexcept>
 
 CONFIG(bool, StoreDefaultSettings).defaultValue(false).description("springsettings.cfg will save the settings values, if they match the implicit defaults and were set by a user explicitly");
+CONFIG(bool, ConfigReadAudit).defaultValue(false).description("Log every config variable that is read by its name during a simulation frame; such reads should use a cached CONFIG_HANDLE instead.");
+
+CONFIG_HANDLE(bool, ConfigReadAudit);
 
 /******************************************************************************/
 
@@ -35,6 +39,7 @@ public:
 
 	void SetString(const std::string& key, const std::string& value, bool useOverlay, bool notify) override;
 	std::string GetString(const std::string& key) const override;
+	std::string GetStringUnaudited(const std::string& key) const override;
 	bool IsSet(const std::string& key) const override;
 	bool IsReadOnly(const std::string& key) const override;
 	void Delete(const std::string& key) override;
@@ -264,6 +269,14 @@ bool ConfigHandlerImpl::IsReadOnly(const std::string& key) const
 }
 
 std::string ConfigHandlerImpl::GetString(const std::string& key) const
+{
+	if (readAuditScope && cfgHandleConfigReadAudit)
+		AuditRead(key);
+
+	return (GetStringUnaudited(key));
+}
+
+std::string ConfigHandlerImpl::GetStringUnaudited(const std::string& key) const
 {
 	const ConfigVariableMetaData* meta = ConfigVariable::GetMetaData(key);
 
@@ -305,7 +318,7 @@ void ConfigHandlerImpl::SetString(const std::string& key, const std::string& val
 		overlay->Delete(key);
 
 	// Don't do anything if value didn't change.
-	if (IsSet(key) && GetString(key) == value)
+	if (IsSet(key) && GetStringUnaudited(key) == value)
 		return;
 
 	if (useOverlay) {
@@ -425,18 +438,84 @@ void ConfigHandler::Instantiate(const std::string configSource, const bool safem
 	configHandler = new ConfigHandlerImpl(locations, safemode);
 	configHandler->FinalizeLoad();
 
+	ConfigHandleBase::AttachAll();
+
 	//assert(configHandler->GetString("test") == "x y z");
 }
 
 void ConfigHandler::Deallocate()
 {
+	if (configHandler != nullptr)
+		ConfigHandleBase::DetachAll();
+
 	spring::SafeDelete(configHandler);
 }
 
+void ConfigHandler::AuditRead(const std::string& key) const
+{
+	static spring::spinlock auditMutex;
+	static spring::unordered_set<std::string> auditedKeys;
+
+	{
+		std::lock_guard<spring::spinlock> lck(auditMutex);
+
+		if (!auditedKeys.insert(key).second)
+			return;
+	}
+
+	LOG_L(L_WARNING, "[ConfigHandler::%s] config variable \"%s\" read by name during a sim-frame", __func__, key.c_str());
+}
+
 bool ConfigHandler::Get(const std::string& key) const
 {
 	return StringToBool(GetString(key));
 }
 
 
-/******************************************************************************/
\ No newline at end of file
+/******************************************************************************/
+
+static ConfigHandleBase*& GetConfigHandles()
+{
+	// function-local so that handles in other TUs can link themselves during static initialization
+	static ConfigHandleBase* head = nullptr;
+	return head;
+}
+
+ConfigHandleBase::ConfigHandleBase(const char* k): key(k), next(GetConfigHandles())
+{
+	GetConfigHandles() = this;
+}
+
+ConfigHandleBase::~ConfigHandleBase()
+{
+	if (configHandler != nullptr)
+		configHandler->RemoveObserver(this);
+
+	for (ConfigHandleBase** h = &GetConfigHandles(); *h != nullptr; h = &(*h)->next) {
+		if (*h != this)
+			continue;
+
+		*h = next;
+		break;
+	}
+}
+
+void ConfigHandleBase::Attach()
+{
+	Resolve();
+	configHandler->NotifyOnChange(this, {key});
+}
+
+void ConfigHandleBase::AttachAll()
+{
+	for (ConfigHandleBase* h = GetConfigHandles(); h != nullptr; h = h->next) {
+		h->Attach();
+	}
+}
+
+void ConfigHandleBase::DetachAll()
+{
+	for (ConfigHandleBase* h = GetConfigHandles(); h != nullptr; h = h->next) {
+		configHandler->RemoveObserver(h);
+	}
+}
@@ -3,6 +3,7 @@
 #ifndef CONFIGHANDLER_H
 #define CONFIGHANDLER_H
 
+#include <atomic>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -35,6 +36,13 @@ public:
 	 */
 	static void Deallocate();
 
+	/**
+	 * @brief Marks the start or end of a code region (the sim-frame) in which
+	 *        string-keyed reads made by the calling thread are logged if
+	 *        ConfigReadAudit is enabled
+	 */
+	static void SetReadAuditScope(bool enter) { readAuditScope = enter; }
+
 public:
 	/**
 	 * @brief Register an observer
@@ -158,17 +166,35 @@ protected:
 	virtual void AddObserver(ConfigNotifyCallback callback, void* observer, const std::vector<std::string>& configs) = 0;
 	virtual void RemoveObserver(void* observer) = 0;
 
+	/// @brief Logs (once per key) a string-keyed read made inside the audit scope
+	void AuditRead(const std::string& key) const;
+
+	/// @brief GetString without the read audit, for cached lookups
+	virtual std::string GetStringUnaudited(const std::string& key) const = 0;
+
+	// per thread, reads made by draw or loading threads during a sim-frame are fine
+	static inline thread_local bool readAuditScope = false;
+
 private:
-	/// @see GetString
+	template<typename T> friend class ConfigHandle;
+
 	template<typename T>
-	T Get(const std::string& key) const
+	static T FromString(const std::string& str)
 	{
-		std::istringstream buf(GetString(key));
+		std::istringstream buf(str);
 		T temp;
 		buf >> temp;
 		return temp;
 	}
 
+	/// @see GetString
+	template<typename T>
+	T Get(const std::string& key) const { return (FromString<T>(GetString(key))); }
+
+	/// @see GetStringUnaudited
+	template<typename T>
+	T GetUnaudited(const std::string& key) const { return (FromString<T>(GetStringUnaudited(key))); }
+
 	/// @see Get
 	/// @brief <bool> specialization of Get<> (we cannot use template spezialization here, so just overload it)
 	bool Get(const std::string& key) const;
@@ -176,4 +202,81 @@ private:
 
 extern ConfigHandler* configHandler;
 
+
+/**
+ * @brief Untyped base of ConfigHandle, links all handles into a global list
+ *
+ * Handles are resolved when the configHandler is (re-)instantiated and are
+ * registered as its observers, so ConfigHandler::Update keeps them current.
+ */
+class ConfigHandleBase
+{
+public:
+	ConfigHandleBase(const char* k);
+	ConfigHandleBase(const ConfigHandleBase&) = delete;
+	virtual ~ConfigHandleBase();
+
+	ConfigHandleBase& operator = (const ConfigHandleBase&) = delete;
+
+	void ConfigNotify(const std::string& key, const std::string& value) { Resolve(); }
+
+	const char* GetKey() const { return key; }
+
+	/// @brief Resolves and observes every handle; called by ConfigHandler::Instantiate
+	static void AttachAll();
+	/// @brief Stops observing for every handle; called by ConfigHandler::Deallocate
+	static void DetachAll();
+
+protected:
+	/// @brief Resolves the cached value and starts observing the key
+	void Attach();
+
+	virtual void Resolve() = 0;
+
+private:
+	const char* key;
+	ConfigHandleBase* next;
+};
+
+/**
+ * @brief Typed, cached view of a config variable
+ *
+ * Reading a handle is a plain (relaxed atomic) load instead of a string-keyed
+ * lookup through all config sources, so handles should be used for variables
+ * queried from per-frame code. Declare them at namespace scope next to the
+ * CONFIG declaration:
+ *
+ * CONFIG(bool, Example).defaultValue(true);
+ * CONFIG_HANDLE(bool, Example);
+ * ...
+ * if (cfgHandleExample) { ... }
+ *
+ * The cached value follows SetString after the next ConfigHandler::Update.
+ */
+template<typename T>
+class ConfigHandle : public ConfigHandleBase
+{
+public:
+	ConfigHandle(const char* k): ConfigHandleBase(k) {
+		if (configHandler != nullptr)
+			Attach();
+	}
+
+	T Get() const { return (value.load(std::memory_order_relaxed)); }
+	operator T() const { return (Get()); }
+
+protected:
+	void Resolve() override { value.store(configHandler->GetUnaudited<T>(GetKey()), std::memory_order_relaxed); }
+
+private:
+	std::atomic<T> value = {};
+};
+
+/**
+ * @brief Macro to declare a cached handle (named cfgHandle<name>) of a config variable.
+ * @see ConfigHandle
+ */
+#define CONFIG_HANDLE(T, name) \
+	static ConfigHandle<T> cfgHandle##name(#name)
+
 #endif /* CONFIGHANDLER_H */
@@ -0,0 +1,169 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SPRING_DIRTY_RANGE_TRACKER_H
+#define SPRING_DIRTY_RANGE_TRACKER_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "System/Threading/ThreadPool.h"
+
+namespace spring {
+	/**
+	 * Tracks which element ranges of a client-side array changed since they
+	 * were last copied into a GPU buffer that consists of <numParts> parts
+	 * used round-robin (e.g. a persistently mapped ring), so a range has to
+	 * be uploaded once per part before it is clean again.
+	 *
+	 * Writers call Add() with whole per-object ranges; every pool thread has
+	 * its own list and a range that touches or overlaps the previous one is
+	 * merged into it, so objects updated in allocation order collapse into a
+	 * handful of entries. Collect() is called by the uploader once per frame
+	 * (with no concurrent writers) and returns sorted, coalesced batches.
+	 */
+	class DirtyRangeTracker {
+	public:
+		struct Range {
+			uint32_t beg;
+			uint32_t end;
+
+			uint32_t Size() const { return (end - beg); }
+			bool operator == (const Range& r) const { return (beg == r.beg && end == r.end); }
+		};
+
+		static constexpr uint32_t MAX_PARTS = 4;
+	public:
+		void Add(size_t beg, size_t end) {
+			if (beg >= end)
+				return;
+
+			std::vector<Range>& ranges = threadRanges[ThreadPool::GetThreadNum()].ranges;
+
+			if (!ranges.empty() && beg <= ranges.back().end && end >= ranges.back().beg) {
+				ranges.back().beg = std::min(ranges.back().beg, static_cast<uint32_t>(beg));
+				ranges.back().end = std::max(ranges.back().end, static_cast<uint32_t>(end));
+				return;
+			}
+
+			ranges.push_back({static_cast<uint32_t>(beg), static_cast<uint32_t>(end)});
+		}
+
+		// marks [0, size) dirty in every buffer part, e.g. after the GPU buffer was recreated
+		void AddAll(size_t size) { allDirtySize = std::max(allDirtySize, static_cast<uint32_t>(size)); }
+
+		void Clear() {
+			for (auto& tr: threadRanges) {
+				tr.ranges.clear();
+			}
+			for (auto& fr: frameRanges) {
+				fr.clear();
+			}
+
+			batches.clear();
+			allDirtySize = 0;
+		}
+
+		/**
+		 * Gathers the ranges added since the previous call and returns the
+		 * union of those and the ones of the previous <numParts> - 1 calls
+		 * (clamped to <size>), as sorted upload batches. Ranges less than
+		 * <maxGap> elements apart are joined and batches are split so none
+		 * holds more than <maxBatch> elements.
+		 */
+		const std::vector<Range>& Collect(size_t size, uint32_t numParts, uint32_t maxGap, uint32_t maxBatch) {
+			assert(numParts > 0 && numParts <= MAX_PARTS);
+			assert(maxBatch > 0);
+
+			frameIdx = (frameIdx + 1) % numParts;
+
+			std::vector<Range>& curRanges = frameRanges[frameIdx];
+
+			curRanges.clear();
+
+			if (allDirtySize > 0) {
+				for (uint32_t i = 0; i < numParts; i++) {
+					frameRanges[i].clear();
+					frameRanges[i].push_back({0, allDirtySize});
+				}
+
+				allDirtySize = 0;
+			}
+
+			for (auto& tr: threadRanges) {
+				curRanges.insert(curRanges.end(), tr.ranges.begin(), tr.ranges.end());
+				tr.ranges.clear();
+			}
+
+			Coalesce(curRanges, size, 0);
+
+			batches.clear();
+
+			for (uint32_t i = 0; i < numParts; i++) {
+				batches.insert(batches.end(), frameRanges[i].begin(), frameRanges[i].end());
+			}
+
+			Coalesce(batches, size, maxGap);
+
+			// split oversized batches in place, back to front so indices stay valid
+			for (size_t i = batches.size(); i-- > 0; ) {
+				if (batches[i].Size() <= maxBatch)
+					continue;
+
+				const Range r = batches[i];
+				const uint32_t numSplits = (r.Size() + maxBatch - 1) / maxBatch;
+
+				batches.insert(batches.begin() + i + 1, numSplits - 1, Range{});
+
+				for (uint32_t k = 0; k < numSplits; k++) {
+					batches[i + k].beg = r.beg + k * maxBatch;
+					batches[i + k].end = std::min(r.end, r.beg + (k + 1) * maxBatch);
+				}
+			}
+
+			return batches;
+		}
+	private:
+		static void Coalesce(std::vector<Range>& ranges, size_t size, uint32_t maxGap) {
+			for (Range& r: ranges) {
+				r.end = std::min(r.end, static_cast<uint32_t>(size));
+				r.beg = std::min(r.beg, r.end);
+			}
+
+			std::sort(ranges.begin(), ranges.end(), [](const Range& a, const Range& b) { return (a.beg < b.beg); });
+
+			size_t n = 0;
+
+			for (const Range& r: ranges) {
+				if (r.beg == r.end)
+					continue;
+
+				if (n > 0 && r.beg <= ranges[n - 1].end + maxGap) {
+					ranges[n - 1].end = std::max(ranges[n - 1].end, r.end);
+					continue;
+				}
+
+				ranges[n++] = r;
+			}
+
+			ranges.resize(n);
+		}
+	private:
+		// padded to keep writer threads off each other's cache lines
+		struct alignas(64) ThreadRanges {
+			std::vector<Range> ranges;
+		};
+
+		std::array<ThreadRanges, ThreadPool::MAX_THREADS> threadRanges;
+		std::array<std::vector<Range>, MAX_PARTS> frameRanges;
+
+		std::vector<Range> batches;
+
+		uint32_t frameIdx = 0;
+		uint32_t allDirtySize = 0;
+	};
+}
+
+#endif
@@ -4,6 +4,7 @@
 #define EVENT_CLIENT_H
 
 #include <algorithm>
+#include <span>
 #include <typeinfo>
 #include <string>
 #include <vector>
@@ -67,6 +68,14 @@ class CEventClient
 		 * call-ins when an EventClient is being added.
 		 */
 		virtual bool WantsEvent(const std::string& eventName);
+		/**
+		 * Engine-side clients can take high-frequency events (currently
+		 * UnitMoved and RenderProjectileCreated) in bulk through the
+		 * *Batch call-ins below instead of one virtual call per event.
+		 * Only honored for clients with full read access that also want
+		 * the event itself.
+		 */
+		virtual bool WantsBatchedEvent(const std::string& eventName) const { return false; }
 
 		// used by the eventHandler to route certain event types
 		virtual int  GetReadAllyTeam() const { return NoAccessTeam; }
@@ -195,6 +204,10 @@ class CEventClient
 		virtual void RenderProjectileCreated(const CProjectile* proj) {}
 		virtual void RenderProjectileDestroyed(const CProjectile* proj) {}
 
+		// batched variants, see WantsBatchedEvent; spans hold all events since the last flush in order
+		virtual void UnitMovedBatch(std::span<const CUnit* const> units) {}
+		virtual void RenderProjectileCreatedBatch(std::span<const CProjectile* const> projs) {}
+
 		virtual void StockpileChanged(const CUnit* unit,
 		                              const CWeapon* weapon, int oldCount) {}
 
@@ -6,6 +6,7 @@
 #include "Lua/LuaOpenGL.h"  // FIXME -- should be moved
 
 #include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
 #include "System/Platform/Threading.h"
 #include "System/GlobalConfig.h"
 
@@ -13,6 +14,14 @@
 
 CEventHandler eventHandler;
 
+static constexpr const char* EVENT_NAMES[] = {
+	#define SETUP_EVENT(name, props) #name,
+	#define SETUP_UNMANAGED_EVENT(name, props)
+		#include "Events.def"
+	#undef SETUP_UNMANAGED_EVENT
+	#undef SETUP_EVENT
+};
+
 
 /******************************************************************************/
 /******************************************************************************/
@@ -40,7 +49,11 @@ void CEventHandler::ResetState()
 	handles.clear();
 	handles.reserve(16);
 
+	batchUnitMoved.items.clear();
+	batchRenderProjectileCreated.items.clear();
+
 	SetupEvents();
+	ResetDispatchStats();
 }
 
 void CEventHandler::SetupEvents()
@@ -72,6 +85,14 @@ void CEventHandler::AddClient(CEventClient* ec)
 		if (!ec->WantsEvent(element.first))
 			continue;
 
+		// bulk handlers skip the ally-team filter, so they need full read access
+		EventClientList* batchClients = GetBatchClientList(element.first);
+
+		if (batchClients != nullptr && ec->GetFullRead() && ec->WantsBatchedEvent(element.first)) {
+			ListInsert(*batchClients, ec);
+			continue;
+		}
+
 		InsertEvent(ec, element.first);
 	}
 }
@@ -166,6 +187,11 @@ bool CEventHandler::RemoveEvent(CEventClient* ec, const std::string& ciName)
 	if ((iter == eventMap.end()) || (iter->second.GetList() == nullptr) || (iter->first != ciName))
 		return false;
 
+	// events still queued for a removed bulk handler are dropped, it
+	// might already be half-destroyed and can not take a final flush
+	if (EventClientList* batchClients = GetBatchClientList(ciName); batchClients != nullptr)
+		ListRemove(*batchClients, ec);
+
 	ListRemove(*(iter->second.GetList()), ec);
 	return true;
 }
@@ -207,6 +233,120 @@ void CEventHandler::ListRemove(EventClientList& ecList, CEventClient* ec)
 }
 
 
+CEventHandler::EventClientList* CEventHandler::GetBatchClientList(const std::string& eName)
+{
+	if (eName == "UnitMoved")
+		return &batchUnitMoved.clients;
+	if (eName == "RenderProjectileCreated")
+		return &batchRenderProjectileCreated.clients;
+
+	return nullptr;
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+template<typename T, typename F> void CEventHandler::FlushEventBatch(EventBatch<T>& batch, EventIndex idx, F func)
+{
+	if (batch.items.empty())
+		return;
+
+	if (batch.clients.empty()) {
+		batch.items.clear();
+		return;
+	}
+
+	// a bulk handler may raise the same event again, those end up in the next batch
+	std::swap(batch.items, batch.flushItems);
+
+	EventDispatchStats& stats = dispatchStats[idx];
+	const std::span<const T* const> items = {batch.flushItems.data(), batch.flushItems.size()};
+	const spring_time startTime = spring_gettime();
+
+	for (size_t i = 0; i < batch.clients.size(); ) {
+		CEventClient* ec = batch.clients[i];
+
+		(ec->*func)(items);
+		stats.numBatchCalls += 1;
+
+		// the call-in may remove itself from the list
+		i += (i < batch.clients.size() && ec == batch.clients[i]);
+	}
+
+	stats.batchCallTime += (spring_gettime() - startTime).toNanoSecsi();
+	batch.flushItems.clear();
+}
+
+void CEventHandler::FlushUnitMovedBatch()
+{
+	FlushEventBatch(batchUnitMoved, EVENT_UnitMoved, &CEventClient::UnitMovedBatch);
+}
+
+void CEventHandler::FlushRenderProjectileCreatedBatch()
+{
+	FlushEventBatch(batchRenderProjectileCreated, EVENT_RenderProjectileCreated, &CEventClient::RenderProjectileCreatedBatch);
+}
+
+void CEventHandler::FlushBatchedEvents()
+{
+	ZoneScoped;
+	FlushUnitMovedBatch();
+	FlushRenderProjectileCreatedBatch();
+}
+
+
+/******************************************************************************/
+
+std::vector<CEventHandler::EventDispatchStats> CEventHandler::GetDispatchStats() const
+{
+	std::vector<EventDispatchStats> stats;
+	stats.reserve(NUM_MANAGED_EVENTS);
+
+	for (size_t i = 0; i < NUM_MANAGED_EVENTS; i++) {
+		if (dispatchStats[i].numDispatches == 0 && dispatchStats[i].numBatchCalls == 0)
+			continue;
+
+		stats.push_back(dispatchStats[i]);
+		stats.back().name = EVENT_NAMES[i];
+	}
+
+	return stats;
+}
+
+void CEventHandler::ResetDispatchStats()
+{
+	std::fill(std::begin(dispatchStats), std::end(dispatchStats), EventDispatchStats{});
+}
+
+void CEventHandler::LogDispatchStats() const
+{
+	std::vector<EventDispatchStats> stats = GetDispatchStats();
+
+	std::sort(stats.begin(), stats.end(), [](const EventDispatchStats& a, const EventDispatchStats& b) {
+		return (a.GetDispatchTime() > b.GetDispatchTime());
+	});
+
+	LOG("[EventHandler::%s] sample-rate=1/%u", __func__, static_cast<unsigned>(DISPATCH_SAMPLE_RATE));
+	LOG("%-32s %12s %12s %12s %12s %12s %10s", "event", "dispatches", "calls", "batched", "batch-calls", "time(ms)", "us/disp");
+
+	for (const EventDispatchStats& s: stats) {
+		const float avgTime = (s.numSampledDispatches > 0)? (s.sampledDispatchTime * 1e-3f) / s.numSampledDispatches: 0.0f;
+
+		LOG(
+			"%-32s %12lu %12lu %12lu %12lu %12.2f %10.3f",
+			s.name,
+			static_cast<unsigned long>(s.numDispatches),
+			static_cast<unsigned long>(s.numClientCalls),
+			static_cast<unsigned long>(s.numBatchedItems),
+			static_cast<unsigned long>(s.numBatchCalls),
+			s.GetDispatchTime(),
+			avgTime
+		);
+	}
+}
+
+
 /******************************************************************************/
 /******************************************************************************/
 
@@ -508,8 +648,9 @@ template<typename T, typename F, typename... A> void IterateEventClientList(T& l
 
 // not usable: "pasting "::" and "Save" does not give a valid preprocessing token"
 // #define ITERATE_EVENTCLIENTLIST(func, ...) IterateEventClientList(list ## func, &CEventClient:: ## func, __VA_ARGS__)
-#define ITERATE_EVENTCLIENTLIST_NA(func) IterateEventClientList(list ## func, &CEventClient::func)
-#define ITERATE_EVENTCLIENTLIST(func, ...) IterateEventClientList(list ## func, &CEventClient::func, __VA_ARGS__)
+#define EVENT_DISPATCH_SAMPLE(func) const DispatchSample dispatchSample(dispatchStats[EVENT_ ## func], list ## func.size())
+#define ITERATE_EVENTCLIENTLIST_NA(func) EVENT_DISPATCH_SAMPLE(func); IterateEventClientList(list ## func, &CEventClient::func)
+#define ITERATE_EVENTCLIENTLIST(func, ...) EVENT_DISPATCH_SAMPLE(func); IterateEventClientList(list ## func, &CEventClient::func, __VA_ARGS__)
 
 
 void CEventHandler::Save(zipFile archive)
@@ -671,6 +812,7 @@ void CEventHandler::ViewResize()
 		if (listDraw ## name.empty())                                       \
 			return;                                                         \
                                                                             \
+		EVENT_DISPATCH_SAMPLE(Draw ## name);                                \
 		LuaOpenGL::EnableDraw ## name ();                                   \
 		listDraw ## name [0]->Draw ## name ();                              \
                                                                             \
@@ -715,6 +857,7 @@ DRAW_CALLIN(InMiniMapBackground)
 	bool CEventHandler:: Draw ## name args                                    \
 	{                                                                         \
 		ZoneScoped;                                                           \
+		EVENT_DISPATCH_SAMPLE(Draw ## name);                                  \
 		bool skipEngineDrawing = false;                                       \
                                                                               \
 		for (size_t i = 0; i < listDraw ## name.size(); ) {                   \
@@ -3,6 +3,8 @@
 #ifndef EVENT_HANDLER_H
 #define EVENT_HANDLER_H
 
+#include <cstdint>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -40,6 +42,42 @@ class CEventHandler
 		bool IsUnsynced(const std::string& ciName) const;
 		bool IsController(const std::string& ciName) const;
 
+		/**
+		 * Delivers everything queued for bulk handlers (see
+		 * CEventClient::WantsBatchedEvent) since the previous flush.
+		 * Called before GameFramePost and before drawing, and implicitly
+		 * before an object referenced by a queued event is destroyed.
+		 */
+		void FlushBatchedEvents();
+
+	public:
+		struct EventDispatchStats {
+			const char* name = "";
+
+			uint64_t numDispatches = 0;   // times the event was raised
+			uint64_t numClientCalls = 0;  // per-event call-ins (clients visited)
+			uint64_t numBatchedItems = 0; // events queued for bulk handlers
+			uint64_t numBatchCalls = 0;   // bulk call-ins
+
+			// one in every DISPATCH_SAMPLE_RATE dispatches is timed
+			uint64_t numSampledDispatches = 0;
+			int64_t sampledDispatchTime = 0; // ns
+			int64_t batchCallTime = 0; // ns
+
+			// estimated total time spent dispatching, in milliseconds
+			float GetDispatchTime() const {
+				float t = batchCallTime * 1e-6f;
+				if (numSampledDispatches > 0)
+					t += (sampledDispatchTime * 1e-6f) * (numDispatches / float(numSampledDispatches));
+				return t;
+			}
+		};
+
+		// returns stats for every event raised at least once since the last reset
+		std::vector<EventDispatchStats> GetDispatchStats() const;
+		void ResetDispatchStats();
+		void LogDispatchStats() const;
+
 
 	public:
 		/**
@@ -340,12 +378,68 @@ class CEventHandler
 		typedef std::pair<std::string, EventInfo> EventPair;
 		typedef std::vector<EventPair> EventMap;
 
+		enum EventIndex {
+		#define SETUP_EVENT(name, props) EVENT_ ## name,
+		#define SETUP_UNMANAGED_EVENT(name, props)
+			#include "Events.def"
+		#undef SETUP_EVENT
+		#undef SETUP_UNMANAGED_EVENT
+			NUM_MANAGED_EVENTS
+		};
+
+		static constexpr uint64_t DISPATCH_SAMPLE_RATE = 64;
+
+		// counts a dispatch and times one in every DISPATCH_SAMPLE_RATE
+		class DispatchSample {
+			public:
+				DispatchSample(EventDispatchStats& s, size_t numClients): stats(s) {
+					stats.numClientCalls += numClients;
+
+					if (((stats.numDispatches++) % DISPATCH_SAMPLE_RATE) == 0)
+						startTime = spring_gettime().toNanoSecsi();
+				}
+				~DispatchSample() {
+					if (startTime < 0)
+						return;
+
+					stats.sampledDispatchTime += (spring_gettime().toNanoSecsi() - startTime);
+					stats.numSampledDispatches += 1;
+				}
+
+			private:
+				EventDispatchStats& stats;
+				int64_t startTime = -1;
+		};
+
+		/**
+		 * Events raised by the engine at high frequency can be queued here
+		 * and handed to bulk handlers as one span per flush, saving a virtual
+		 * call per event and client; per-event clients (e.g. Lua) are still
+		 * called immediately and in order. Queued pointers stay valid until
+		 * the next flush since both the sim and the destruction paths flush
+		 * before objects are freed.
+		 */
+		template<typename T> struct EventBatch {
+			std::vector<const T*> items;
+			// <items> is swapped in here during a flush, s.t. bulk handlers can raise new events
+			std::vector<const T*> flushItems;
+
+			EventClientList clients;
+		};
+
+		template<typename T, typename F> void FlushEventBatch(EventBatch<T>& batch, EventIndex idx, F func);
+
+		void FlushUnitMovedBatch();
+		void FlushRenderProjectileCreatedBatch();
+
 	private:
 		void SetupEvent(const std::string& ciName,
 		                EventClientList* list, int props);
 		void ListInsert(EventClientList& ciList, CEventClient* ec);
 		void ListRemove(EventClientList& ciList, CEventClient* ec);
 
+		EventClientList* GetBatchClientList(const std::string& ciName);
+
 	private:
 		CEventClient* mouseOwner;
 
@@ -359,6 +453,12 @@ class CEventHandler
 		#include "Events.def"
 	#undef SETUP_EVENT
 	#undef SETUP_UNMANAGED_EVENT
+
+
+		EventBatch<CUnit> batchUnitMoved;
+		EventBatch<CProjectile> batchRenderProjectileCreated;
+
+		EventDispatchStats dispatchStats[NUM_MANAGED_EVENTS];
 };
 
 
@@ -371,7 +471,12 @@ extern CEventHandler eventHandler;
 // Inlined call-in loops
 //
 
+// counts (and samples the cost of) the dispatch of event <name>
+#define EVENT_DISPATCH_SAMPLE(name) \
+	const DispatchSample dispatchSample(dispatchStats[EVENT_ ## name], list ## name.size())
+
 #define ITERATE_EVENTCLIENTLIST(name, ...)                         \
+	EVENT_DISPATCH_SAMPLE(name);                                   \
 	for (size_t i = 0; i < list##name.size(); ) {                  \
 		CEventClient* ec = list##name[i];                          \
 		ec->name(__VA_ARGS__);                                     \
@@ -381,6 +486,7 @@ extern CEventHandler eventHandler;
 	}
 
 #define ITERATE_ALLYTEAM_EVENTCLIENTLIST(name, allyTeam, ...)      \
+	EVENT_DISPATCH_SAMPLE(name);                                   \
 	for (size_t i = 0; i < list##name.size(); ) {                  \
 		CEventClient* ec = list##name[i];                          \
                                                                    \
@@ -392,6 +498,7 @@ extern CEventHandler eventHandler;
 	}
 
 #define ITERATE_UNIT_ALLYTEAM_EVENTCLIENTLIST(name, unit, ...)     \
+	EVENT_DISPATCH_SAMPLE(name);                                   \
 	const auto unitAllyTeam = unit->allyteam;                      \
 	for (size_t i = 0; i < list##name.size(); ) {                  \
 		CEventClient* ec = list##name[i];                          \
@@ -417,6 +524,7 @@ inline void CEventHandler::UnitDestroyed(const CUnit* unit, const CUnit* attacke
 #define UNIT_CALLIN_NO_PARAM(name)                                 \
 	inline void CEventHandler:: name (const CUnit* unit)           \
 	{                                                              \
+		EVENT_DISPATCH_SAMPLE(name);                               \
 		const auto unitAllyTeam = unit->allyteam;                  \
 		for (size_t i = 0; i < list##name.size(); ) {              \
 			CEventClient* ec = list##name[i];                      \
@@ -439,7 +547,28 @@ UNIT_CALLIN_NO_PARAM(UnitEnteredAir)
 UNIT_CALLIN_NO_PARAM(UnitLeftUnderwater)
 UNIT_CALLIN_NO_PARAM(UnitLeftWater)
 UNIT_CALLIN_NO_PARAM(UnitLeftAir)
-UNIT_CALLIN_NO_PARAM(UnitMoved)
+
+inline void CEventHandler::UnitMoved(const CUnit* unit)
+{
+	EVENT_DISPATCH_SAMPLE(UnitMoved);
+
+	// bulk handlers have full read access, see AddClient
+	if (!batchUnitMoved.clients.empty()) {
+		batchUnitMoved.items.push_back(unit);
+		dispatchStats[EVENT_UnitMoved].numBatchedItems += 1;
+	}
+
+	const auto unitAllyTeam = unit->allyteam;
+
+	for (size_t i = 0; i < listUnitMoved.size(); ) {
+		CEventClient* ec = listUnitMoved[i];
+
+		if (ec->CanReadAllyTeam(unitAllyTeam))
+			ec->UnitMoved(unit);
+
+		i += (i < listUnitMoved.size() && ec == listUnitMoved[i]);
+	}
+}
 
 #define UNIT_CALLIN_INT_PARAMS(name)                                              \
 	inline void CEventHandler:: Unit ## name (const CUnit* unit, int p1, int p2)  \
@@ -478,6 +607,8 @@ UNIT_CALLIN_NO_PARAM(UnitDecloaked)
 
 inline bool CEventHandler::UnitUnitCollision(const CUnit* collider, const CUnit* collidee)
 {
+	EVENT_DISPATCH_SAMPLE(UnitUnitCollision);
+
 	auto& clients = listUnitUnitCollision;
 
 	for (size_t i = 0; i < clients.size(); ) {
@@ -499,6 +630,8 @@ inline bool CEventHandler::UnitUnitCollision(const CUnit* collider, const CUnit*
 
 inline bool CEventHandler::UnitFeatureCollision(const CUnit* collider, const CFeature* collidee)
 {
+	EVENT_DISPATCH_SAMPLE(UnitFeatureCollision);
+
 	auto& clients = listUnitFeatureCollision;
 
 	for (size_t i = 0; i < clients.size(); ) {
@@ -569,6 +702,8 @@ inline void  CEventHandler::UnitSeismicPing(const CUnit* unit,
 inline void CEventHandler::UnitLoaded(const CUnit* unit,
                                           const CUnit* transport)
 {
+	EVENT_DISPATCH_SAMPLE(UnitLoaded);
+
 	const size_t count = listUnitLoaded.size();
 
 	for (size_t i = 0; i < count; i++) {
@@ -586,6 +721,8 @@ inline void CEventHandler::UnitLoaded(const CUnit* unit,
 inline void CEventHandler::UnitUnloaded(const CUnit* unit,
                                             const CUnit* transport)
 {
+	EVENT_DISPATCH_SAMPLE(UnitUnloaded);
+
 	const size_t count = listUnitUnloaded.size();
 
 	for (size_t i = 0; i < count; i++) {
@@ -601,6 +738,8 @@ inline void CEventHandler::UnitUnloaded(const CUnit* unit,
 
 inline void CEventHandler::FeatureCreated(const CFeature* feature)
 {
+	EVENT_DISPATCH_SAMPLE(FeatureCreated);
+
 	const int featureAllyTeam = feature->allyteam;
 	const size_t count = listFeatureCreated.size();
 
@@ -614,6 +753,8 @@ inline void CEventHandler::FeatureCreated(const CFeature* feature)
 
 inline void CEventHandler::FeatureDestroyed(const CFeature* feature)
 {
+	EVENT_DISPATCH_SAMPLE(FeatureDestroyed);
+
 	const int featureAllyTeam = feature->allyteam;
 	const size_t count = listFeatureDestroyed.size();
 
@@ -632,6 +773,8 @@ inline void CEventHandler::FeatureDamaged(
 	int weaponDefID,
 	int projectileID)
 {
+	EVENT_DISPATCH_SAMPLE(FeatureDamaged);
+
 	const int featureAllyTeam = feature->allyteam;
 	const size_t count = listFeatureDamaged.size();
 
@@ -645,6 +788,8 @@ inline void CEventHandler::FeatureDamaged(
 
 inline void CEventHandler::FeatureMoved(const CFeature* feature, const float3& oldpos)
 {
+	EVENT_DISPATCH_SAMPLE(FeatureMoved);
+
 	const int featureAllyTeam = feature->allyteam;
 	const size_t count = listFeatureMoved.size();
 	for (size_t i = 0; i < count; i++) {
@@ -658,6 +803,8 @@ inline void CEventHandler::FeatureMoved(const CFeature* feature, const float3& o
 
 inline void CEventHandler::ProjectileCreated(const CProjectile* proj, int allyTeam)
 {
+	EVENT_DISPATCH_SAMPLE(ProjectileCreated);
+
 	const size_t count = listProjectileCreated.size();
 	for (size_t i = 0; i < count; i++) {
 		CEventClient* ec = listProjectileCreated[i];
@@ -671,6 +818,8 @@ inline void CEventHandler::ProjectileCreated(const CProjectile* proj, int allyTe
 
 inline void CEventHandler::ProjectileDestroyed(const CProjectile* proj, int allyTeam)
 {
+	EVENT_DISPATCH_SAMPLE(ProjectileDestroyed);
+
 	const size_t count = listProjectileDestroyed.size();
 
 	for (size_t i = 0; i < count; i++) {
@@ -693,6 +842,8 @@ inline void CEventHandler::UnsyncedHeightMapUpdate(const SRectangle& rect)
 
 inline bool CEventHandler::Explosion(int weaponDefID, int projectileID, const float3& pos, const CUnit* owner)
 {
+	EVENT_DISPATCH_SAMPLE(Explosion);
+
 	auto& clients = listExplosion;
 
 	for (size_t i = 0; i < clients.size(); ) {
@@ -723,6 +874,8 @@ inline void CEventHandler::StockpileChanged(const CUnit* unit,
 
 inline void CEventHandler::DefaultCommand(const CUnit* unit, const CFeature* feature, int& cmd)
 {
+	EVENT_DISPATCH_SAMPLE(DefaultCommand);
+
 	const size_t count = listDefaultCommand.size();
 
 	for (size_t i = 0; i < count; i++) {
@@ -740,7 +893,13 @@ inline void CEventHandler::RenderUnitCreated(const CUnit* unit, int cloaked)
 	ITERATE_EVENTCLIENTLIST(RenderUnitCreated, unit, cloaked)
 }
 
-UNIT_CALLIN_NO_PARAM(RenderUnitDestroyed)
+inline void CEventHandler::RenderUnitDestroyed(const CUnit* unit)
+{
+	// the unit is freed right after this, queued UnitMoved's must not outlive it
+	FlushUnitMovedBatch();
+
+	ITERATE_EVENTCLIENTLIST(RenderUnitDestroyed, unit)
+}
 
 inline void CEventHandler::RenderFeaturePreCreated(const CFeature* feature)
 {
@@ -760,15 +919,24 @@ inline void CEventHandler::RenderFeatureDestroyed(const CFeature* feature)
 
 inline void CEventHandler::RenderProjectileCreated(const CProjectile* proj)
 {
+	if (!batchRenderProjectileCreated.clients.empty()) {
+		batchRenderProjectileCreated.items.push_back(proj);
+		dispatchStats[EVENT_RenderProjectileCreated].numBatchedItems += 1;
+	}
+
 	ITERATE_EVENTCLIENTLIST(RenderProjectileCreated, proj)
 }
 
 inline void CEventHandler::RenderProjectileDestroyed(const CProjectile* proj)
 {
+	// bulk handlers must see the creation of <proj> before its destruction
+	FlushRenderProjectileCreatedBatch();
+
 	ITERATE_EVENTCLIENTLIST(RenderProjectileDestroyed, proj)
 }
 
 
+#undef EVENT_DISPATCH_SAMPLE
 #undef ITERATE_EVENTCLIENTLIST
 #undef ITERATE_ALLYTEAM_EVENTCLIENTLIST
 #undef ITERATE_UNIT_ALLYTEAM_EVENTCLIENTLIST
@@ -131,7 +131,7 @@ protected:
 	// Spring expects the contents of archives to be case-independent
 	// this map (which must be populated by subclass archives) is kept
 	// to allow converting back from lowercase to original case
-	spring::unordered_map<std::string, unsigned int> lcNameIndex;
+	spring::flat_hash_map<std::string, unsigned int> lcNameIndex;
 
 protected:
 	/// "ExampleArchive.sdd"
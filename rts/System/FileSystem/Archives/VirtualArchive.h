@@ -95,7 +95,7 @@ public:
 	void FileInfo(unsigned int fid, std::string& name, int& size) const;
 
 	const std::string& GetFileName() const { return fileName; }
-	const spring::unordered_map<std::string, unsigned int>& GetNameIndex() const { return lcNameIndex; }
+	const spring::flat_hash_map<std::string, unsigned int>& GetNameIndex() const { return lcNameIndex; }
 
 	void WriteToFile();
 
@@ -104,7 +104,7 @@ private:
 
 	std::string fileName;
 	std::vector<CVirtualFile> files;
-	spring::unordered_map<std::string, unsigned int> lcNameIndex;
+	spring::flat_hash_map<std::string, unsigned int> lcNameIndex;
 };
 
 #endif // _VIRTUAL_ARCHIVE_H
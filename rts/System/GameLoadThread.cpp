@@ -31,6 +31,8 @@ __FORCE_ALIGN_STACK__
 void CGameLoadThread::WrapFunc(std::function<void()> f)
 {
 	Threading::SetThreadName("gameload");
+	// pool workers running in this wrapper are re-pinned by ThreadPool::SetDefaultThreadCount
+	Threading::SetAffinity(Threading::GetAffinityPlan().auxCores);
 
 	// init streflop
 	// not needed to maintain sync (precision flags are
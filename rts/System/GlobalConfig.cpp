@@ -63,6 +63,9 @@ CONFIG(bool, VFSCacheArchiveFiles).defaultValue(true);
 CONFIG(bool, DumpGameStateOnDesync).defaultValue(true).description("Enable writing clientgamestate and servergamestate dumps when a desync is detected");
 
 CONFIG(float, MinSimDrawBalance).defaultValue(0.15f).description("Percent of the time for simulation is minimum spend for drawing. E.g. if set to 0.15 then 15% of the total cpu time is exclusively reserved for drawing.");
+CONFIG(int, AffinityPartitions).defaultValue(1).minimumValue(1).maximumValue(64).description("Number of equal slices (whole L3/package domains when possible) the host's cores are divided into, for running several dedicated servers or engine instances side by side without contending for the same caches.");
+CONFIG(int, AffinityPartitionIndex).defaultValue(0).minimumValue(0).maximumValue(63).description("Which slice out of AffinityPartitions this process pins its threads to.");
+
 CONFIG(int, MinDrawFPS).defaultValue(2).description("Defines how many frames per second should minimally be rendered. To reach this number we will delay simframes.");
 
 void GlobalConfig::Init()
@@ -98,6 +101,9 @@ void GlobalConfig::Init()
 	minDrawFPS = configHandler->GetInt("MinDrawFPS");
 
 	teamHighlight = configHandler->GetInt("TeamHighlight");
+
+	affinityPartitions = configHandler->GetInt("AffinityPartitions");
+	affinityPartitionIndex = configHandler->GetInt("AffinityPartitionIndex") % affinityPartitions;
 }
 #endif
 
@@ -123,6 +123,15 @@ public:
 	 */
 	int teamHighlight = 1;
 
+	/**
+	 * @brief affinity partitions
+	 *
+	 * Number of slices the host's cores are divided into and the slice this
+	 * process runs in; see Threading::PlanAffinity.
+	 */
+	int affinityPartitions = 1;
+	int affinityPartitionIndex = 0;
+
 	/**
 	 * @brief simulation drawing balance
 	 *
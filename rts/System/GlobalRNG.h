@@ -81,6 +81,7 @@ public:
 	}
 
 	val_type state() const { return val; }
+	void state(const val_type _val) { val = _val; }
 
 public:
 	static constexpr res_type min_res = std::numeric_limits<res_type>::min();
@@ -115,6 +116,8 @@ public:
 	rng_val_type GetInitSeed() const { return initSeed; }
 	rng_val_type GetLastSeed() const { return lastSeed; }
 	rng_val_type GetGenState() const { return (gen.state()); }
+	// continues a sequence from GetGenState, after seeding with the same seeds
+	void SetGenState(rng_val_type state) { gen.state(state); }
 
 	// needed for std::{random_}shuffle
 	rng_res_type operator()(              ) { return (this->*gnext )( ); }
@@ -1,5 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 #include <zlib.h>
 
@@ -11,6 +13,7 @@
 #include "Game/GameSetup.h"
 #include "Game/GameVersion.h"
 #include "Game/GlobalUnsynced.h"
+#include "Game/Players/PlayerHandler.h"
 #include "Game/WaitCommandsAI.h"
 #include "Game/SelectedUnitsHandler.h"
 #include "Game/UI/Groups/GroupHandler.h"
@@ -40,6 +43,8 @@
 #include "Sim/Units/Scripts/NullUnitScript.h"
 #include "Sim/Weapons/PlasmaRepulser.h"
 #include "System/SafeUtil.h"
+#include "System/SpringHash.h"
+#include "System/StringUtil.h"
 #include "System/Platform/errorhandler.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileQueryFlags.h"
@@ -47,6 +52,7 @@
 #include "System/Threading/ThreadPool.h"
 #include "System/creg/SerializeLuaState.h"
 #include "System/creg/Serializer.h"
+#include "System/Sync/SyncChecker.h"
 #include "System/Exceptions.h"
 #include "System/Log/ILog.h"
 
@@ -193,6 +199,55 @@ void CLuaStateCollector::Serialize(creg::ISerializer* s) {
 	creg::SerializeLuaThread(s, &L_GC);
 }
 
+
+/**
+ * State a savegame leaves to the game setup and the first frames
+ * of a game, but which a client rejoining a running game through
+ * a snapshot (see SaveSnapshot) has to take over from its source.
+ */
+class CSnapshotStateCollector
+{
+	CR_DECLARE_STRUCT(CSnapshotStateCollector)
+
+public:
+	CSnapshotStateCollector() = default;
+	void Read();
+	void Write() const;
+
+	std::uint64_t rngGenState = 0;
+	std::uint64_t rngInitSeed = 0;
+	std::uint64_t rngLastSeed = 0;
+
+	void Serialize(creg::ISerializer* s);
+};
+
+CR_BIND(CSnapshotStateCollector, )
+CR_REG_METADATA(CSnapshotStateCollector, (
+	CR_MEMBER(rngGenState),
+	CR_MEMBER(rngInitSeed),
+	CR_MEMBER(rngLastSeed),
+	CR_SERIALIZER(Serialize)
+))
+
+void CSnapshotStateCollector::Read() {
+	rngGenState = gsRNG.GetGenState();
+	rngInitSeed = gsRNG.GetInitSeed();
+	rngLastSeed = gsRNG.GetLastSeed();
+}
+
+void CSnapshotStateCollector::Write() const {
+	gsRNG.SetSeed(rngInitSeed, true);
+	gsRNG.SetSeed(rngLastSeed, false);
+	gsRNG.SetGenState(rngGenState);
+
+	playerHandler.PostLoad();
+}
+
+void CSnapshotStateCollector::Serialize(creg::ISerializer* s) {
+	s->SerializeObjectInstance(&playerHandler, playerHandler.GetClass());
+}
+
+
 static void WriteString(std::ostream& s, const std::string& str)
 {
 	if (str.length() > MAX_STRING_SIZE)
@@ -213,6 +268,24 @@ static void PrintSize(const char* txt, int size)
 		LOG("%s %u B",    txt, size);
 	}
 }
+
+/// covers the layout of every registered class, a snapshot only loads into
+/// an engine built the same way (see creg::CInputStreamSerializer::LoadPackage)
+static std::string GetMetadataChecksum()
+{
+	std::vector<creg::Class*> classes = creg::System::GetClasses();
+	unsigned int checksum = creg::CREG_FORMAT_VERSION;
+
+	// registration order depends on static initialization
+	std::sort(classes.begin(), classes.end(), [](const creg::Class* a, const creg::Class* b) { return (strcmp(a->name, b->name) < 0); });
+
+	for (creg::Class* c: classes) {
+		checksum = spring::LiteHash(c->name, strlen(c->name), checksum);
+		c->CalculateChecksum(checksum);
+	}
+
+	return IntToString(static_cast<int>(checksum), "%08x");
+}
 #endif //USING_CREG
 
 static void ReadString(std::istream& s, std::string& str)
@@ -250,6 +323,59 @@ static void LoadLuaState(CSplitLuaHandle* handle, creg::CInputStreamSerializer&
 }
 
 
+#ifdef USING_CREG
+static void SaveGameState(std::stringstream& oss, const std::string& modName, const std::string& mapName, bool snapshot)
+{
+	// write our own header. SavePackage() will add its own
+	WriteString(oss, SpringVersion::GetSync());
+	WriteString(oss, gameSetup->setupText);
+	WriteString(oss, modName);
+	WriteString(oss, mapName);
+
+	// checked by joining clients before they accept the snapshot
+	if (snapshot)
+		WriteString(oss, GetMetadataChecksum());
+
+	Sim::SaveComponents(oss);
+
+	creg::COutputStreamSerializer os;
+
+	// save lua state first as lua unit scripts depend on it
+	const int luaStart = oss.tellp();
+	SaveLuaState(luaGaia, os, oss);
+	SaveLuaState(luaRules, os, oss);
+	PrintSize("Lua", ((int)oss.tellp()) - luaStart);
+
+	// save creg state
+	const int gameStart = oss.tellp();
+	CGameStateCollector gsc;
+	os.SavePackage(&oss, &gsc, gsc.GetClass());
+
+	if (snapshot) {
+		CSnapshotStateCollector ssc;
+		ssc.Read();
+		os.SavePackage(&oss, &ssc, ssc.GetClass());
+	}
+	PrintSize("Game", ((int)oss.tellp()) - gameStart);
+
+
+	// save AI state
+	const int aiStart = oss.tellp();
+
+	for (const auto& ai: skirmishAIHandler.GetAllSkirmishAIs()) {
+		std::stringstream aiData;
+		eoh->Save(&aiData, ai.first);
+
+		std::uint64_t aiSize = aiData.tellp();
+		creg::WriteUInt(&oss, aiSize);
+		if (aiSize > 0)
+			oss << aiData.rdbuf();
+	}
+	PrintSize("AIs", ((int)oss.tellp()) - aiStart);
+}
+#endif //USING_CREG
+
+
 void CCregLoadSaveHandler::SaveGame(const std::string& path)
 {
 #ifdef USING_CREG
@@ -262,45 +388,7 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 	try {
 		std::stringstream oss;
 
-		// write our own header. SavePackage() will add its own
-		WriteString(oss, SpringVersion::GetSync());
-		WriteString(oss, gameSetup->setupText);
-		WriteString(oss, modName);
-		WriteString(oss, mapName);
-
-
-		{
-			Sim::SaveComponents(oss);
-
-			creg::COutputStreamSerializer os;
-
-			// save lua state first as lua unit scripts depend on it
-			const int luaStart = oss.tellp();
-			SaveLuaState(luaGaia, os, oss);
-			SaveLuaState(luaRules, os, oss);
-			PrintSize("Lua", ((int)oss.tellp()) - luaStart);
-
-			// save creg state
-			const int gameStart = oss.tellp();
-			CGameStateCollector gsc;
-			os.SavePackage(&oss, &gsc, gsc.GetClass());
-			PrintSize("Game", ((int)oss.tellp()) - gameStart);
-
-
-			// save AI state
-			const int aiStart = oss.tellp();
-
-			for (const auto& ai: skirmishAIHandler.GetAllSkirmishAIs()) {
-				std::stringstream aiData;
-				eoh->Save(&aiData, ai.first);
-
-				std::uint64_t aiSize = aiData.tellp();
-				creg::WriteUInt(&oss, aiSize);
-				if (aiSize > 0)
-					oss << aiData.rdbuf();
-			}
-			PrintSize("AIs", ((int)oss.tellp()) - aiStart);
-		}
+		SaveGameState(oss, modName, mapName, false);
 
 		{
 			gzFile file = gzopen(dataDirsAccess.LocateFile(path, FileQueryFlags::WRITE).c_str(), "wb5");
@@ -339,6 +427,50 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 #endif //USING_CREG
 }
 
+/// saves the uncompressed game state a rejoining client can load through LoadSnapshotStartInfo
+bool CCregLoadSaveHandler::SaveSnapshot(std::string& state)
+{
+#ifdef USING_CREG
+	// same as for SaveGame, but the snapshot is taken behind the
+	// player's back so give them their selection back afterwards
+	const std::vector<int> selectedUnitIDs(selectedUnitsHandler.selectedUnits.begin(), selectedUnitsHandler.selectedUnits.end());
+	selectedUnitsHandler.ClearSelected();
+
+	bool ret = false;
+
+	try {
+		std::stringstream oss;
+
+		SaveGameState(oss, modName, mapName, true);
+
+		state = oss.str();
+		ret = true;
+	} catch (const content_error& ex) {
+		LOG_L(L_ERROR, "[LSH::%s] content error \"%s\"", __func__, ex.what());
+	} catch (const std::exception& ex) {
+		LOG_L(L_ERROR, "[LSH::%s] exception \"%s\"", __func__, ex.what());
+	} catch (const char*& exStr) {
+		LOG_L(L_ERROR, "[LSH::%s] cstr error \"%s\"", __func__, exStr);
+	} catch (const std::string& str) {
+		LOG_L(L_ERROR, "[LSH::%s] str error \"%s\"", __func__, str.c_str());
+	} catch (...) {
+		LOG_L(L_ERROR, "[LSH::%s] unknown error", __func__);
+	}
+
+	for (const int unitID: selectedUnitIDs) {
+		CUnit* unit = unitHandler.GetUnit(unitID);
+
+		if (unit != nullptr)
+			selectedUnitsHandler.AddUnit(unit);
+	}
+
+	return ret;
+#else //USING_CREG
+	LOG_L(L_ERROR, "[LSH::%s] creg is disabled", __func__);
+	return false;
+#endif //USING_CREG
+}
+
 /// loads the data (map&mod-name,setup-script) needed by PreGame
 bool CCregLoadSaveHandler::LoadGameStartInfo(const std::string& path)
 {
@@ -370,10 +502,60 @@ bool CCregLoadSaveHandler::LoadGameStartInfo(const std::string& path)
 	return (saveVersion == syncVersion);
 }
 
+/// loads a SaveSnapshot state received from the server, the setup-script is already known from NETMSG_GAMEDATA
+bool CCregLoadSaveHandler::LoadSnapshotStartInfo(const std::vector<std::uint8_t>& snapshot, std::uint32_t syncChecksum)
+{
+	const std::vector<std::uint8_t> state = zlib::inflate(snapshot);
+
+	if (state.empty()) {
+		LOG_L(L_ERROR, "[LSH::%s] could not decompress snapshot (%u bytes)", __func__, uint32_t(snapshot.size()));
+		return false;
+	}
+
+	std::stringbuf* sbuf = iss.rdbuf();
+	std::string saveVersion;
+	std::string syncVersion = SpringVersion::GetSync();
+
+	sbuf->sputn(reinterpret_cast<const char*>(state.data()), state.size());
+
+	ReadString(iss, saveVersion);
+
+	if (saveVersion != syncVersion) {
+		LOG_L(L_WARNING, "[LSH::%s] snapshot taken by engine version \"%s\" incompatible with \"%s\"", __func__, saveVersion.c_str(), syncVersion.c_str());
+		return false;
+	}
+
+	ReadString(iss, scriptText);
+	ReadString(iss, modName);
+	ReadString(iss, mapName);
+
+#ifdef USING_CREG
+	std::string metadataChecksum;
+	ReadString(iss, metadataChecksum);
+
+	// LoadPackage would throw on this only once loading has started
+	if (metadataChecksum != GetMetadataChecksum()) {
+		LOG_L(L_WARNING, "[LSH::%s] snapshot saved with creg metadata %s, expected %s", __func__, metadataChecksum.c_str(), GetMetadataChecksum().c_str());
+		return false;
+	}
+
+	snapshotSyncChecksum = syncChecksum;
+	isSnapshot = true;
+	return iss.good();
+#else //USING_CREG
+	LOG_L(L_ERROR, "[LSH::%s] creg is disabled", __func__);
+	return false;
+#endif //USING_CREG
+}
+
 /// this should be called on frame 0 when the game has started
 void CCregLoadSaveHandler::LoadGame()
 {
 #ifdef USING_CREG
+	const int myPlayerNum = gu->myPlayerNum;
+	// players that joined after the snapshot was taken are not part of it
+	const CPlayer myPlayer = *playerHandler.Player(myPlayerNum);
+
 	ENTER_SYNCED_CODE();
 	{
 		Sim::LoadComponents(iss);
@@ -394,6 +576,24 @@ void CCregLoadSaveHandler::LoadGame()
 		// the only job of gsc is to collect gamestate data
 		CGameStateCollector* gsc = static_cast<CGameStateCollector*>(pGSC);
 		spring::SafeDelete(gsc);
+
+		if (isSnapshot) {
+			void* pSSC = nullptr;
+			creg::Class* ssccls = nullptr;
+
+			inputStream.LoadPackage(&iss, pSSC, ssccls);
+			assert(pSSC && ssccls == CSnapshotStateCollector::StaticClass());
+
+			CSnapshotStateCollector* ssc = static_cast<CSnapshotStateCollector*>(pSSC);
+			ssc->Write();
+			spring::SafeDelete(ssc);
+
+			if (!playerHandler.IsValidPlayer(myPlayerNum))
+				playerHandler.AddPlayer(myPlayer);
+
+			// gu was overwritten with the snapshot source's view of the game
+			gu->SetMyPlayer(myPlayerNum);
+		}
 	}
 
 	LEAVE_SYNCED_CODE();
@@ -424,10 +624,18 @@ void CCregLoadSaveHandler::LoadAIData()
 	// cleanup
 	iss.str("");
 
-	gs->paused = false;
-	if (gameServer != nullptr) {
-		gameServer->isPaused = false;
-		gameServer->syncErrorFrame = 0;
+	if (isSnapshot) {
+		// the game kept running (or paused) while this client was away,
+		// and the sync checksum runs on from where the snapshot left off
+		#ifdef SYNCCHECK
+		CSyncChecker::SetChecksum(snapshotSyncChecksum);
+		#endif
+	} else {
+		gs->paused = false;
+		if (gameServer != nullptr) {
+			gameServer->isPaused = false;
+			gameServer->syncErrorFrame = 0;
+		}
 	}
 
 	LEAVE_SYNCED_CODE();
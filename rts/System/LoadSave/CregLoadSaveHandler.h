@@ -3,8 +3,11 @@
 #ifndef CREG_LOAD_SAVE_HANDLER_H
 #define CREG_LOAD_SAVE_HANDLER_H
 
+#include <cstdint>
 #include <string>
 #include <sstream>
+#include <vector>
+
 #include "LoadSaveHandler.h"
 
 class CCregLoadSaveHandler : public ILoadSaveHandler
@@ -18,8 +21,15 @@ public:
 	void LoadAIData() override;
 	void SaveGame(const std::string& path) override;
 
+	/// savestate for clients rejoining a running game, see CGameServer::RequestSnapshot
+	bool SaveSnapshot(std::string& state);
+	bool LoadSnapshotStartInfo(const std::vector<std::uint8_t>& snapshot, std::uint32_t syncChecksum);
+
 protected:
 	std::stringstream iss;
+
+	std::uint32_t snapshotSyncChecksum = 0;
+	bool isSnapshot = false;
 };
 
 #endif // CREG_LOAD_SAVE_HANDLER_H
@@ -7,9 +7,18 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 #include "Backend.h"
 #include "DefaultFilter.h"
+#include "FramePrefixer.h"
+#include "ILog.h"
+#include "Level.h"
 #include "LogUtil.h"
 #include "System/MainDefines.h"
 
@@ -17,9 +26,11 @@
 
 namespace log_formatter {
 	static std::array<log_sink_ptr, MAX_LOG_SINKS> sinks = {{nullptr}};
+	static std::array<log_sink_ptr, MAX_LOG_SINKS> syncSinks = {{nullptr}};
 	static std::array<log_cleanup_ptr, MAX_LOG_SINKS> cleanupFuncs = {{nullptr}};
 
 	static size_t numSinks = 0;
+	static size_t numSyncSinks = 0;
 	static size_t numFuncs = 0;
 
 	template<typename T, size_t S> bool array_insert(std::array<T, S>& array, T value, size_t& count) {
@@ -57,6 +68,20 @@ namespace log_formatter {
 		return (array_remove(sinks, sink, numSinks));
 	}
 
+	bool insert_sync_sink(log_sink_ptr sink) {
+		return (array_insert(syncSinks, sink, numSyncSinks));
+	}
+	bool remove_sync_sink(log_sink_ptr sink) {
+		return (array_remove(syncSinks, sink, numSyncSinks));
+	}
+
+	static void sink_record(int level, const char* section, const char* msg) {
+		for (size_t i = 0; i < numSinks; i++) {
+			assert(sinks[i] != nullptr);
+			sinks[i](level, section, msg);
+		}
+	}
+
 	bool insert_func(log_cleanup_ptr func) {
 		return (array_insert(cleanupFuncs, func, numFuncs));
 	}
@@ -66,6 +91,327 @@ namespace log_formatter {
 }
 
 
+namespace log_async {
+	// per-thread ring size in bytes; larger records bypass the ring
+	static constexpr size_t RING_SIZE = 1 << 16;
+	static constexpr size_t MAX_RINGS = 256;
+	static constexpr size_t MAX_SECTION_SIZE = 64;
+
+	struct RecordHeader {
+		uint32_t size; // total size including this header; 0 marks a wrap to the ring start
+		uint32_t level;
+		log_frame_stamp_t stamp;
+		char section[MAX_SECTION_SIZE];
+	};
+
+	static constexpr size_t ALIGN_RECORD(size_t n) { return ((n + alignof(RecordHeader) - 1) & ~(alignof(RecordHeader) - 1)); }
+
+	/**
+	 * Single-producer (the owning thread) single-consumer (whoever holds
+	 * drainMutex) byte ring; positions grow monotonically and are wrapped
+	 * on access.
+	 */
+	struct Ring {
+		alignas(64) std::atomic<uint64_t> head = {0};
+		alignas(64) std::atomic<uint64_t> tail = {0};
+		alignas(64) std::atomic<bool> owned = {false};
+
+		alignas(RecordHeader) std::array<char, RING_SIZE> data;
+
+		bool Push(int level, const char* section, const char* msg, size_t msgSize, const log_frame_stamp_t& stamp) {
+			const size_t recSize = ALIGN_RECORD(sizeof(RecordHeader) + msgSize + 1);
+
+			const uint64_t h = head.load(std::memory_order_relaxed);
+			const uint64_t t = tail.load(std::memory_order_acquire);
+
+			const size_t offset = h & (RING_SIZE - 1);
+			const size_t padding = ((offset + recSize) > RING_SIZE)? (RING_SIZE - offset): 0;
+
+			if ((RING_SIZE - (h - t)) < (padding + recSize))
+				return false;
+
+			if (padding != 0)
+				reinterpret_cast<RecordHeader*>(&data[offset])->size = 0;
+
+			RecordHeader* hdr = reinterpret_cast<RecordHeader*>(&data[(h + padding) & (RING_SIZE - 1)]);
+
+			hdr->size = recSize;
+			hdr->level = level;
+			hdr->stamp = stamp;
+
+			strncpy(hdr->section, log_util_prepareSection(section), MAX_SECTION_SIZE - 1);
+			hdr->section[MAX_SECTION_SIZE - 1] = 0;
+
+			memcpy(reinterpret_cast<char*>(hdr + 1), msg, msgSize);
+			reinterpret_cast<char*>(hdr + 1)[msgSize] = 0;
+
+			head.store(h + padding + recSize, std::memory_order_release);
+			return true;
+		}
+
+		// consumer-side; skips wrap markers, returns nullptr if nothing is pending before <end>
+		const RecordHeader* Front(uint64_t end) {
+			uint64_t t = tail.load(std::memory_order_relaxed);
+
+			while (t < end) {
+				const RecordHeader* hdr = reinterpret_cast<const RecordHeader*>(&data[t & (RING_SIZE - 1)]);
+
+				if (hdr->size != 0)
+					return hdr;
+
+				tail.store(t += (RING_SIZE - (t & (RING_SIZE - 1))), std::memory_order_release);
+			}
+
+			return nullptr;
+		}
+
+		void PopFront(const RecordHeader* hdr) { tail.store(tail.load(std::memory_order_relaxed) + hdr->size, std::memory_order_release); }
+
+		bool Empty() const { return (tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire)); }
+		bool HalfFull() const { return ((head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed)) >= (RING_SIZE / 2)); }
+	};
+
+
+	static std::array<std::unique_ptr<Ring>, MAX_RINGS> rings;
+	static std::atomic<size_t> numRings = {0};
+	static std::mutex ringsMutex;
+
+	// held by whoever consumes the rings and calls into the (async) sinks
+	static std::mutex drainMutex;
+
+	static std::atomic<bool> enabled = {false};
+	// threads between their enabled check and the end of QueueRecord
+	static std::atomic<uint32_t> numProducers = {0};
+	static std::atomic<bool> running = {false};
+	static std::atomic<bool> writerSleeping = {false};
+
+	static std::mutex writerMutex;
+	static std::condition_variable writerCond;
+	static std::thread writerThread;
+
+	static std::atomic<uint64_t> numQueued = {0};
+	static std::atomic<uint64_t> numDropped = {0};
+	static std::atomic<uint64_t> numBlocked = {0};
+	static std::atomic<uint64_t> numOversized = {0};
+
+	static _threadlocal bool isWriterThread = false;
+
+
+	struct RingOwner {
+		~RingOwner() {
+			// hand the ring back; it can be claimed again once drained
+			if (ring != nullptr)
+				ring->owned.store(false, std::memory_order_release);
+		}
+
+		Ring* ring = nullptr;
+	};
+
+	static thread_local RingOwner ringOwner;
+
+
+	static Ring* ClaimRing() {
+		if (ringOwner.ring != nullptr)
+			return ringOwner.ring;
+
+		for (size_t i = 0, n = numRings.load(std::memory_order_acquire); i < n; i++) {
+			Ring* ring = rings[i].get();
+			bool owned = false;
+
+			if (!ring->Empty())
+				continue;
+			if (!ring->owned.compare_exchange_strong(owned, true, std::memory_order_acquire))
+				continue;
+
+			return (ringOwner.ring = ring);
+		}
+
+		std::lock_guard<std::mutex> lock(ringsMutex);
+
+		const size_t n = numRings.load(std::memory_order_relaxed);
+
+		if (n == MAX_RINGS)
+			return nullptr;
+
+		rings[n] = std::make_unique<Ring>();
+		rings[n]->owned.store(true, std::memory_order_relaxed);
+
+		numRings.store(n + 1, std::memory_order_release);
+		return (ringOwner.ring = rings[n].get());
+	}
+
+
+	static void SinkRecord(const RecordHeader* hdr) {
+		log_framePrefixer_setStampOverride(&hdr->stamp);
+		log_formatter::sink_record(hdr->level, hdr->section, reinterpret_cast<const char*>(hdr + 1));
+		log_framePrefixer_setStampOverride(nullptr);
+	}
+
+	/**
+	 * Merges all pending records by timestamp into the sinks.
+	 * Caller must hold drainMutex.
+	 * @return the number of records sunk
+	 */
+	static size_t DrainRings() {
+		std::array<uint64_t, MAX_RINGS> ends;
+
+		const size_t n = numRings.load(std::memory_order_acquire);
+		size_t numSunk = 0;
+
+		// records pushed after this snapshot are left for the next pass
+		for (size_t i = 0; i < n; i++) {
+			ends[i] = rings[i]->head.load(std::memory_order_acquire);
+		}
+
+		while (true) {
+			const RecordHeader* minHdr = nullptr;
+			Ring* minRing = nullptr;
+
+			for (size_t i = 0; i < n; i++) {
+				const RecordHeader* hdr = rings[i]->Front(ends[i]);
+
+				if (hdr == nullptr)
+					continue;
+				if (minHdr != nullptr && minHdr->stamp.time <= hdr->stamp.time)
+					continue;
+
+				minHdr = hdr;
+				minRing = rings[i].get();
+			}
+
+			if (minHdr == nullptr)
+				break;
+
+			SinkRecord(minHdr);
+			minRing->PopFront(minHdr);
+
+			numSunk += 1;
+		}
+
+		return numSunk;
+	}
+
+	static void WakeWriter() {
+		if (!writerSleeping.load(std::memory_order_relaxed))
+			return;
+
+		writerCond.notify_one();
+	}
+
+	static void WriterLoop() {
+		isWriterThread = true;
+
+		while (running.load(std::memory_order_acquire)) {
+			size_t numSunk = 0;
+
+			{
+				std::lock_guard<std::mutex> lock(drainMutex);
+				numSunk = DrainRings();
+			}
+
+			if (numSunk > 0)
+				continue;
+
+			std::unique_lock<std::mutex> lock(writerMutex);
+
+			// a missed notification only delays sinking until the timeout
+			writerSleeping.store(true, std::memory_order_relaxed);
+			writerCond.wait_for(lock, std::chrono::milliseconds(10));
+			writerSleeping.store(false, std::memory_order_relaxed);
+		}
+
+		std::lock_guard<std::mutex> lock(drainMutex);
+		DrainRings();
+	}
+
+
+	/// Sinks <msg> in-order with everything queued before it on the calling thread
+	static void SinkDirect(int level, const char* section, const char* msg) {
+		std::lock_guard<std::mutex> lock(drainMutex);
+
+		DrainRings();
+		log_formatter::sink_record(level, section, msg);
+	}
+
+	static void QueueRecord(int level, const char* section, const char* msg) {
+		log_frame_stamp_t stamp;
+		log_framePrefixer_createStamp(&stamp);
+
+		const size_t msgSize = strlen(msg);
+		const size_t recSize = ALIGN_RECORD(sizeof(RecordHeader) + msgSize + 1);
+
+		Ring* ring = nullptr;
+
+		// sinks logging from the writer thread must not wait for themselves
+		if (isWriterThread || recSize > (RING_SIZE / 4) || (ring = ClaimRing()) == nullptr) {
+			numOversized.fetch_add(recSize > (RING_SIZE / 4), std::memory_order_relaxed);
+			log_framePrefixer_setStampOverride(&stamp);
+			SinkDirect(level, section, msg);
+			log_framePrefixer_setStampOverride(nullptr);
+			return;
+		}
+
+		if (!ring->Push(level, section, msg, msgSize, stamp)) {
+			if (level < LOG_LEVEL_WARNING) {
+				numDropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			numBlocked.fetch_add(1, std::memory_order_relaxed);
+
+			// backpressure; warnings and errors are never dropped
+			do {
+				writerCond.notify_one();
+				std::this_thread::yield();
+			} while (!ring->Push(level, section, msg, msgSize, stamp));
+		}
+
+		numQueued.fetch_add(1, std::memory_order_relaxed);
+
+		if (level >= LOG_LEVEL_ERROR || ring->HalfFull())
+			WakeWriter();
+	}
+
+
+	static void Start() {
+		if (running.exchange(true))
+			return;
+
+		writerThread = std::thread(WriterLoop);
+		enabled.store(true, std::memory_order_release);
+	}
+
+	static void Stop() {
+		if (!running.load())
+			return;
+
+		enabled.store(false);
+
+		// producers that still saw the queue enabled push after this point,
+		// wait for them (everyone else now sinks directly) while the writer
+		// can still make room in their rings
+		while (numProducers.load() != 0) {
+			writerCond.notify_one();
+			std::this_thread::yield();
+		}
+
+		running.store(false, std::memory_order_release);
+
+		writerCond.notify_one();
+		writerThread.join();
+
+		// pick up anything pushed while the writer was exiting
+		std::lock_guard<std::mutex> lock(drainMutex);
+		DrainRings();
+	}
+
+	/// Joins the writer thread (if still running) when the process exits
+	struct WriterJoiner {
+		~WriterJoiner() { Stop(); }
+	} static writerJoiner;
+}
+
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -78,8 +424,12 @@ static _threadlocal log_record_t prv_record = {{0}, "", "",  0, 0};
 
 extern void log_formatter_format(log_record_t* log, va_list arguments);
 
-void log_backend_registerSink(log_sink_ptr sink) { log_formatter::insert_sink(sink); }
-void log_backend_unregisterSink(log_sink_ptr sink) { log_formatter::remove_sink(sink); }
+// the writer thread may be iterating over the (async) sinks
+void log_backend_registerSink(log_sink_ptr sink) { std::lock_guard<std::mutex> lock(log_async::drainMutex); log_formatter::insert_sink(sink); }
+void log_backend_unregisterSink(log_sink_ptr sink) { std::lock_guard<std::mutex> lock(log_async::drainMutex); log_formatter::remove_sink(sink); }
+
+void log_backend_registerSyncSink(log_sink_ptr sink) { log_formatter::insert_sync_sink(sink); }
+void log_backend_unregisterSyncSink(log_sink_ptr sink) { log_formatter::remove_sync_sink(sink); }
 
 void log_backend_registerCleanup(log_cleanup_ptr cleanupFunc) { log_formatter::insert_func(cleanupFunc); }
 void log_backend_unregisterCleanup(log_cleanup_ptr cleanupFunc) { log_formatter::remove_func(cleanupFunc); }
@@ -94,9 +444,9 @@ void log_backend_unregisterCleanup(log_cleanup_ptr cleanupFunc) { log_formatter:
 // formats and routes the record to all sinks
 void log_backend_record(int level, const char* section, const char* fmt, va_list arguments)
 {
-	const auto& sinks = log_formatter::sinks;
+	const auto& syncSinks = log_formatter::syncSinks;
 
-	if (log_formatter::numSinks == 0)
+	if ((log_formatter::numSinks + log_formatter::numSyncSinks) == 0)
 		return;
 
 	cur_record.sec = section;
@@ -117,9 +467,20 @@ void log_backend_record(int level, const char* section, const char* fmt, va_list
 		return;
 
 	// sink the record into each registered sink
-	for (size_t i = 0; i < log_formatter::numSinks; i++) {
-		assert(sinks[i] != nullptr);
-		sinks[i](level, section, cur_record.msg);
+	for (size_t i = 0; i < log_formatter::numSyncSinks; i++) {
+		assert(syncSinks[i] != nullptr);
+		syncSinks[i](level, section, cur_record.msg);
+	}
+
+	// seq-cst pairs with Stop, which either sees this producer or is seen by it
+	log_async::numProducers.fetch_add(1);
+
+	if (log_async::enabled.load()) {
+		log_async::QueueRecord(level, section, cur_record.msg);
+		log_async::numProducers.fetch_sub(1, std::memory_order_release);
+	} else {
+		log_async::numProducers.fetch_sub(1, std::memory_order_release);
+		log_formatter::sink_record(level, section, cur_record.msg);
 	}
 
 	if (cur_record.cnt > 0)
@@ -132,12 +493,60 @@ void log_backend_record(int level, const char* section, const char* fmt, va_list
 void log_backend_cleanup() {
 	const auto& funcs = log_formatter::cleanupFuncs;
 
+	// called on crashes; get queued records out first, without waiting
+	// forever for a writer that might have died while holding the lock
+	if (log_async::numRings.load() > 0) {
+		std::unique_lock<std::mutex> lock(log_async::drainMutex, std::defer_lock);
+
+		for (int i = 0; i < 100 && !log_async::isWriterThread && !lock.try_lock(); i++) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		if (lock.owns_lock())
+			log_async::DrainRings();
+	}
+
 	for (size_t i = 0; i < log_formatter::numFuncs; i++) {
 		assert(funcs[i] != nullptr);
 		funcs[i]();
 	}
 }
 
+void log_backend_setAsync(int enable)
+{
+	if (enable) {
+		log_async::Start();
+		return;
+	}
+
+	log_async::Stop();
+
+	log_backend_stats_t stats;
+	log_backend_getStats(&stats);
+
+	if ((stats.numDropped + stats.numBlocked) == 0)
+		return;
+
+	LOG_L(L_WARNING, "[%s] %llu of %llu asynchronous log records were dropped, %llu had to wait for buffer space", __func__, (unsigned long long) stats.numDropped, (unsigned long long) (stats.numQueued + stats.numDropped), (unsigned long long) stats.numBlocked);
+}
+
+void log_backend_flush()
+{
+	if (!log_async::enabled.load(std::memory_order_acquire))
+		return;
+
+	std::lock_guard<std::mutex> lock(log_async::drainMutex);
+	log_async::DrainRings();
+}
+
+void log_backend_getStats(log_backend_stats_t* stats)
+{
+	stats->numQueued = log_async::numQueued.load(std::memory_order_relaxed);
+	stats->numDropped = log_async::numDropped.load(std::memory_order_relaxed);
+	stats->numBlocked = log_async::numBlocked.load(std::memory_order_relaxed);
+	stats->numOversized = log_async::numOversized.load(std::memory_order_relaxed);
+}
+
 ///@}
 
 #ifdef __cplusplus
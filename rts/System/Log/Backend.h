@@ -6,8 +6,14 @@
 /**
  * This is the universal, global backend for the ILog.h logging API.
  * It may format log records, and routes them to all the registered sinks.
+ *
+ * In asynchronous mode, records are formatted on the logging thread into a
+ * per-thread ring buffer, and a dedicated writer thread drains all buffers
+ * into the registered (non-sync) sinks in timestamp order.
  */
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -26,6 +32,15 @@ void log_backend_registerSink(log_sink_ptr sink);
 /// Stop routing log records to the supplied sink
 void log_backend_unregisterSink(log_sink_ptr sink);
 
+/**
+ * Start routing log records to the supplied sink, which is always called
+ * on the thread the record was logged from, even in asynchronous mode.
+ */
+void log_backend_registerSyncSink(log_sink_ptr sink);
+
+/// Stop routing log records to the supplied synchronous sink
+void log_backend_unregisterSyncSink(log_sink_ptr sink);
+
 
 typedef void (*log_cleanup_ptr)();
 
@@ -40,6 +55,31 @@ void log_backend_registerCleanup(log_cleanup_ptr cleanupFunc);
  */
 void log_backend_unregisterCleanup(log_cleanup_ptr cleanupFunc);
 
+
+struct log_backend_stats_t {
+	/// records passed through the ring buffers
+	uint64_t numQueued;
+	/// records of level < WARNING dropped because their ring buffer was full
+	uint64_t numDropped;
+	/// records of level >= WARNING that had to wait for ring buffer space
+	uint64_t numBlocked;
+	/// records too large for a ring buffer, sunk synchronously
+	uint64_t numOversized;
+};
+
+/**
+ * Enables or disables asynchronous sinking through the writer thread.
+ * Disabling joins the writer after it drained all pending records.
+ */
+void log_backend_setAsync(int enable);
+
+/**
+ * Blocks until all records queued so far were sunk (asynchronous mode only).
+ */
+void log_backend_flush();
+
+void log_backend_getStats(struct log_backend_stats_t* stats);
+
 ///@}
 
 #ifdef __cplusplus
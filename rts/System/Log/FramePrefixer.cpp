@@ -4,6 +4,7 @@
  * This eventually prefixes log records with the current frame number.
  */
 
+#include "FramePrefixer.h"
 #include "System/MainDefines.h"
 
 #include <cassert>
@@ -23,17 +24,40 @@ extern "C" {
 // GlobalSynced makes sure this can not be dangling
 static int* frameNumRef = nullptr;
 
+// set by the async log writer while it sinks a record
+static _threadlocal const log_frame_stamp_t* stampOverride = nullptr;
+
 void log_framePrefixer_setFrameNumReference(int* frameNumReference)
 {
 	frameNumRef = frameNumReference;
 }
 
-size_t log_framePrefixer_createPrefix(char* result, size_t resultSize)
+void log_framePrefixer_createStamp(log_frame_stamp_t* stamp)
 {
 	const static auto refTime = std::chrono::high_resolution_clock::now();
 	const        auto curTime = std::chrono::high_resolution_clock::now();
 
-	int64_t ns = (curTime - refTime).count();
+	stamp->time = (curTime - refTime).count();
+	stamp->frameNum = (frameNumRef != nullptr)? *frameNumRef: 0;
+	stamp->hasFrameNum = (frameNumRef != nullptr);
+}
+
+void log_framePrefixer_setStampOverride(const log_frame_stamp_t* stamp)
+{
+	stampOverride = stamp;
+}
+
+size_t log_framePrefixer_createPrefix(char* result, size_t resultSize)
+{
+	log_frame_stamp_t stamp;
+
+	if (stampOverride == nullptr) {
+		log_framePrefixer_createStamp(&stamp);
+	} else {
+		stamp = *stampOverride;
+	}
+
+	int64_t ns = stamp.time;
 
 	// prefix with engine running-time in hh:mm:ss.us format since first log call
 	const int32_t hh = ns / HOURS_TO_NANOSECS; ns %= HOURS_TO_NANOSECS;
@@ -43,10 +67,10 @@ size_t log_framePrefixer_createPrefix(char* result, size_t resultSize)
 	assert(resultSize != 0);
 	using nsCastType = long long int;
 
-	if (frameNumRef == nullptr)
+	if (!stamp.hasFrameNum)
 		return (SNPRINTF(result, resultSize, "[t=%02d:%02d:%02d.%06lld] ", hh, mm, ss, static_cast<nsCastType>((ns / 1000) % 1000000)));
 
-	return (SNPRINTF(result, resultSize, "[t=%02d:%02d:%02d.%06lld][f=%07d] ", hh, mm, ss, static_cast<nsCastType>((ns / 1000) % 1000000), *frameNumRef));
+	return (SNPRINTF(result, resultSize, "[t=%02d:%02d:%02d.%06lld][f=%07d] ", hh, mm, ss, static_cast<nsCastType>((ns / 1000) % 1000000), stamp.frameNum));
 }
 
 #ifdef __cplusplus
@@ -4,6 +4,7 @@
 #define LOG_FRAME_PREFIXER_H
 
 #include <stdio.h> // for size_t
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -22,6 +23,28 @@ void log_framePrefixer_setFrameNumReference(int* frameNumReference);
  */
 size_t log_framePrefixer_createPrefix(char* result, size_t resultSize);
 
+
+/**
+ * Running-time and frame number a prefix is made of.
+ * Records that are sunk asynchronously capture these when they are logged.
+ */
+struct log_frame_stamp_t {
+	int64_t time; // nanoseconds since the first log call
+	int frameNum;
+	int hasFrameNum;
+};
+
+/**
+ * Captures the stamp createPrefix would use at this point.
+ */
+void log_framePrefixer_createStamp(struct log_frame_stamp_t* stamp);
+
+/**
+ * Makes createPrefix use the given stamp on the calling thread instead of
+ * the current time and frame; NULL restores the default.
+ */
+void log_framePrefixer_setStampOverride(const struct log_frame_stamp_t* stamp);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
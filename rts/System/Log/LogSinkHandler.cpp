@@ -8,7 +8,8 @@
 
 
 
-// forwards a log entry to all ILogSinks (e.g. InfoConsole) added to the handler
+// forwards a log entry to all ILogSinks (e.g. InfoConsole) added to the handler;
+// registered as sync sink so in-game consumers see records in the same frame
 static void log_sink_record_logSinkHandler(int level, const char* section, const char* record)
 {
 	logSinkHandler.RecordLogMessage(level, (section == nullptr) ? "" : section, record);
@@ -20,7 +21,7 @@ void LogSinkHandler::AddSink(ILogSink* logSink) {
 	assert(logSink != nullptr);
 
 	if (sinks.empty())
-		log_backend_registerSink(&log_sink_record_logSinkHandler);
+		log_backend_registerSyncSink(&log_sink_record_logSinkHandler);
 
 	sinks.insert(logSink);
 }
@@ -32,7 +33,7 @@ void LogSinkHandler::RemoveSink(ILogSink* logSink) {
 	if (!sinks.empty())
 		return;
 
-	log_backend_unregisterSink(&log_sink_record_logSinkHandler);
+	log_backend_unregisterSyncSink(&log_sink_record_logSinkHandler);
 }
 
 void LogSinkHandler::RecordLogMessage(
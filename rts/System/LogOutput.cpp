@@ -6,6 +6,7 @@
 #include "Game/GameVersion.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/FileSystem.h"
+#include "System/Log/Backend.h"
 #include "System/Log/DefaultFilter.h"
 #include "System/Log/FileSink.h"
 #include "System/Log/ILog.h"
@@ -43,6 +44,11 @@ CONFIG(int, LogRepeatLimit)
 	.defaultValue(10)
 	.description("Allow at most this many consecutive identical messages to be logged.");
 
+CONFIG(bool, LogAsync)
+	.defaultValue(false)
+	.safemodeValue(false)
+	.description("Queue log messages in per-thread buffers and write them to the logfile and console from a separate thread. Messages below WARNING level may be dropped when a buffer overflows.");
+
 /******************************************************************************/
 /******************************************************************************/
 
@@ -185,6 +191,10 @@ void CLogOutput::Initialize()
 	log_filter_setRepeatLimit(configHandler->GetInt("LogRepeatLimit")); // all sinks
 	log_file_addLogFile(filePath.c_str(), nullptr, LOG_LEVEL_ALL, configHandler->GetInt("LogFlushLevel"));
 
+#if !defined(UNITSYNC)
+	log_backend_setAsync(configHandler->GetBool("LogAsync"));
+#endif
+
 	LOG("LogOutput initialized. Logging to %s", filePath.c_str());
 }
 
@@ -15,6 +15,7 @@
 #include "System/Platform/Misc.h"
 #include "System/Log/ILog.h"
 
+#include <cinttypes>
 #include <clocale>
 #include <cstdlib>
 #include <cstdint>
@@ -44,9 +45,9 @@ int Run(int argc, char* argv[])
 	Threading::DetectCores();
 	Threading::SetMainThread();
 
-	LOG("%s: thread affinity %x", __func__, Threading::GetAffinity());
+	LOG("%s: thread affinity %" PRIx64, __func__, Threading::GetAffinity());
 	SpringApp app(argc, argv);
-	LOG("%s: thread affinity %x", __func__, Threading::GetAffinity());
+	LOG("%s: thread affinity %" PRIx64, __func__, Threading::GetAffinity());
 	return (app.Run());
 }
 
@@ -0,0 +1,205 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "System/MemAccounting.h"
+#include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
+#include "System/Threading/SpringThreading.h"
+
+namespace MemAccounting {
+	static constexpr float RATE_INTERVAL = 1000.0f; // ms
+
+	struct TagRates {
+		int64_t peakLiveBytes = 0;
+
+		uint64_t lastNumAllocs = 0;
+		uint64_t lastAllocBytes = 0;
+		uint64_t lastHeapAllocBytes = 0;
+
+		float allocRate = 0.0f;
+		float allocByteRate = 0.0f;
+		float heapAllocByteRate = 0.0f;
+	};
+
+	// written under registryMutex, never erased; readers load numTags first
+	static std::array<const char*, MAX_TAGS> tagNames = {"Other"};
+	static std::array<GaugeFunc, MAX_TAGS> tagGauges = {};
+	static spring::spinlock registryMutex;
+
+	// only touched by Update and its readers
+	static std::array<TagRates, MAX_TAGS> tagRates;
+	static spring_time lastRateTime;
+	static spring::spinlock ratesMutex;
+
+
+	TagId RegisterTag(const char* name)
+	{
+		std::lock_guard<spring::spinlock> lock(registryMutex);
+
+		const TagId n = numTags.load(std::memory_order_relaxed);
+
+		for (TagId i = 0; i < n; i++) {
+			if (std::strcmp(tagNames[i], name) == 0)
+				return i;
+		}
+
+		if (n == MAX_TAGS)
+			return TAG_OTHER;
+
+		tagNames[n] = name;
+		numTags.store(n + 1, std::memory_order_release);
+		return n;
+	}
+
+	TagId RegisterGauge(const char* name, GaugeFunc func)
+	{
+		const TagId tag = RegisterTag(name);
+
+		if (tag != TAG_OTHER) {
+			std::lock_guard<spring::spinlock> lock(registryMutex);
+			tagGauges[tag] = func;
+		}
+
+		return tag;
+	}
+
+
+	void Update()
+	{
+		const TagId n = numTags.load(std::memory_order_acquire);
+
+		for (TagId i = 0; i < n; i++) {
+			GaugeFunc func = nullptr;
+
+			{
+				std::lock_guard<spring::spinlock> lock(registryMutex);
+				func = tagGauges[i];
+			}
+
+			if (func == nullptr)
+				continue;
+
+			GaugeSample sample;
+			func(sample);
+
+			tagCounters[i].liveBytes.store(sample.liveBytes, std::memory_order_relaxed);
+			tagCounters[i].numAllocs.store(sample.numAllocs, std::memory_order_relaxed);
+			tagCounters[i].allocBytes.store(sample.allocBytes, std::memory_order_relaxed);
+		}
+
+		const spring_time curTime = spring_gettime();
+		const float deltaTime = (curTime - lastRateTime).toMilliSecsf();
+		const bool updateRates = (deltaTime >= RATE_INTERVAL);
+
+		std::lock_guard<spring::spinlock> lock(ratesMutex);
+
+		for (TagId i = 0; i < n; i++) {
+			const TagCounters& c = tagCounters[i];
+			TagRates& r = tagRates[i];
+
+			r.peakLiveBytes = std::max(r.peakLiveBytes, c.liveBytes.load(std::memory_order_relaxed));
+
+			if (!updateRates)
+				continue;
+
+			const uint64_t numAllocs = c.numAllocs.load(std::memory_order_relaxed);
+			const uint64_t allocBytes = c.allocBytes.load(std::memory_order_relaxed);
+			const uint64_t heapAllocBytes = c.heapAllocBytes.load(std::memory_order_relaxed);
+			const float scale = 1000.0f / deltaTime;
+
+			// counters are only ever reset together with lastRateTime, except gauges
+			r.allocRate = (numAllocs >= r.lastNumAllocs)? (numAllocs - r.lastNumAllocs) * scale: 0.0f;
+			r.allocByteRate = (allocBytes >= r.lastAllocBytes)? (allocBytes - r.lastAllocBytes) * scale: 0.0f;
+			r.heapAllocByteRate = (heapAllocBytes - r.lastHeapAllocBytes) * scale;
+
+			r.lastNumAllocs = numAllocs;
+			r.lastAllocBytes = allocBytes;
+			r.lastHeapAllocBytes = heapAllocBytes;
+		}
+
+		if (updateRates)
+			lastRateTime = curTime;
+	}
+
+	void ResetStats()
+	{
+		const TagId n = numTags.load(std::memory_order_acquire);
+
+		std::lock_guard<spring::spinlock> lock(ratesMutex);
+
+		for (TagId i = 0; i < n; i++) {
+			TagRates& r = tagRates[i];
+
+			r = {};
+			r.peakLiveBytes = tagCounters[i].liveBytes.load(std::memory_order_relaxed);
+			r.lastNumAllocs = tagCounters[i].numAllocs.load(std::memory_order_relaxed);
+			r.lastAllocBytes = tagCounters[i].allocBytes.load(std::memory_order_relaxed);
+			r.lastHeapAllocBytes = tagCounters[i].heapAllocBytes.load(std::memory_order_relaxed);
+		}
+
+		lastRateTime = spring_gettime();
+	}
+
+
+	std::vector<TagStats> GetStats()
+	{
+		const TagId n = numTags.load(std::memory_order_acquire);
+
+		std::vector<TagStats> stats;
+		stats.reserve(n);
+
+		std::lock_guard<spring::spinlock> lock(ratesMutex);
+
+		for (TagId i = 0; i < n; i++) {
+			const TagCounters& c = tagCounters[i];
+			const TagRates& r = tagRates[i];
+
+			TagStats& s = stats.emplace_back();
+
+			s.name = tagNames[i];
+
+			s.liveBytes = c.liveBytes.load(std::memory_order_relaxed);
+			s.peakLiveBytes = std::max(r.peakLiveBytes, s.liveBytes);
+
+			s.numAllocs = c.numAllocs.load(std::memory_order_relaxed);
+			s.numFrees = c.numFrees.load(std::memory_order_relaxed);
+			s.allocBytes = c.allocBytes.load(std::memory_order_relaxed);
+
+			s.allocRate = r.allocRate;
+			s.allocByteRate = r.allocByteRate;
+
+			s.heapLiveBytes = c.heapLiveBytes.load(std::memory_order_relaxed);
+			s.heapAllocBytes = c.heapAllocBytes.load(std::memory_order_relaxed);
+			s.heapAllocByteRate = r.heapAllocByteRate;
+		}
+
+		return stats;
+	}
+
+	void LogStats()
+	{
+		const std::vector<TagStats> stats = GetStats();
+
+		LOG("[MemAccounting::%s] heap-sampling=%d", __func__, IsHeapSamplingEnabled());
+		LOG("%-24s %12s %12s %12s %12s %12s %12s", "tag", "live(KB)", "peak(KB)", "allocs", "allocs/s", "KB/s", "heap(KB)");
+
+		for (const TagStats& s: stats) {
+			if (s.numAllocs == 0 && s.liveBytes == 0 && s.heapAllocBytes == 0)
+				continue;
+
+			LOG(
+				"%-24s %12.1f %12.1f %12lu %12.1f %12.1f %12.1f",
+				s.name,
+				s.liveBytes / 1024.0f,
+				s.peakLiveBytes / 1024.0f,
+				static_cast<unsigned long>(s.numAllocs),
+				s.allocRate,
+				s.allocByteRate / 1024.0f,
+				s.heapLiveBytes / 1024.0f
+			);
+		}
+	}
+}
@@ -0,0 +1,185 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef MEM_ACCOUNTING_H
+#define MEM_ACCOUNTING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Per-subsystem memory accounting.
+ *
+ * Every memory pool or major container registers a named tag once and then
+ * reports its allocations and frees against that tag; the counters are plain
+ * relaxed atomics, so reporting is safe from any thread and costs about as
+ * much as the pool bookkeeping it accompanies. Subsystems that already keep
+ * their own totals (e.g. Lua) can instead register a gauge which is polled by
+ * Update. Allocation rates are derived in Update, once per RATE_INTERVAL.
+ *
+ * Builds with MEMORY_ACCOUNTING_SAMPLE_NEW additionally sample global operator
+ * new (see TraceMemory.cpp) and attribute each sampled allocation to the tag
+ * that is active on the allocating thread, set through ScopedTag; these heap
+ * estimates are kept apart from the exact pool counters since pools obtain
+ * their own backing memory from the heap as well.
+ */
+namespace MemAccounting {
+	typedef uint32_t TagId;
+
+	static constexpr TagId MAX_TAGS = 64;
+	// allocations made outside of any ScopedTag
+	static constexpr TagId TAG_OTHER = 0;
+	static constexpr TagId TAG_NONE = MAX_TAGS;
+
+	struct alignas(64) TagCounters {
+		std::atomic<int64_t> liveBytes = {0};
+		std::atomic<uint64_t> numAllocs = {0};
+		std::atomic<uint64_t> numFrees = {0};
+		std::atomic<uint64_t> allocBytes = {0};
+
+		// sampled operator new estimates
+		std::atomic<int64_t> heapLiveBytes = {0};
+		std::atomic<uint64_t> heapAllocBytes = {0};
+	};
+
+	struct GaugeSample {
+		int64_t liveBytes = 0;
+		uint64_t numAllocs = 0;
+		uint64_t allocBytes = 0;
+	};
+
+	typedef void (*GaugeFunc)(GaugeSample& sample);
+
+	struct TagStats {
+		const char* name = "";
+
+		int64_t liveBytes = 0;
+		int64_t peakLiveBytes = 0;
+
+		uint64_t numAllocs = 0;
+		uint64_t numFrees = 0;
+		uint64_t allocBytes = 0;
+
+		// per second, over the last completed rate interval
+		float allocRate = 0.0f;
+		float allocByteRate = 0.0f;
+
+		int64_t heapLiveBytes = 0;
+		uint64_t heapAllocBytes = 0;
+		float heapAllocByteRate = 0.0f;
+	};
+
+
+	inline std::atomic<TagId> numTags = {1};
+	inline TagCounters tagCounters[MAX_TAGS];
+	inline thread_local TagId threadTag = TAG_OTHER;
+
+
+	/**
+	 * Returns the id of the tag called <name>, registering it on first use.
+	 * <name> must outlive the registry (a string literal), and registering
+	 * never allocates so tags can be created during static initialization.
+	 * Returns TAG_OTHER once all MAX_TAGS slots are taken.
+	 */
+	TagId RegisterTag(const char* name);
+	// registers <name> and polls <func> for its counters in every Update
+	TagId RegisterGauge(const char* name, GaugeFunc func);
+
+
+	inline void RecordAlloc(TagId tag, size_t bytes) {
+		TagCounters& c = tagCounters[tag];
+
+		c.liveBytes.fetch_add(bytes, std::memory_order_relaxed);
+		c.allocBytes.fetch_add(bytes, std::memory_order_relaxed);
+		c.numAllocs.fetch_add(1, std::memory_order_relaxed);
+	}
+	inline void RecordFree(TagId tag, size_t bytes) {
+		TagCounters& c = tagCounters[tag];
+
+		c.liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+		c.numFrees.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// <bytes> is the weight of a sampled allocation, i.e. its estimated share of all heap traffic
+	inline void RecordHeapAlloc(TagId tag, size_t bytes) {
+		tagCounters[tag].heapLiveBytes.fetch_add(bytes, std::memory_order_relaxed);
+		tagCounters[tag].heapAllocBytes.fetch_add(bytes, std::memory_order_relaxed);
+	}
+	inline void RecordHeapFree(TagId tag, size_t bytes) {
+		tagCounters[tag].heapLiveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+	}
+
+
+	inline TagId GetThreadTag() { return threadTag; }
+	inline TagId SetThreadTag(TagId tag) {
+		const TagId prv = threadTag;
+		threadTag = tag;
+		return prv;
+	}
+
+	inline constexpr bool IsHeapSamplingEnabled() {
+	#ifdef MEMORY_ACCOUNTING_SAMPLE_NEW
+		return true;
+	#else
+		return false;
+	#endif
+	}
+
+
+	// polls gauges and tracks peaks; updates rates every RATE_INTERVAL (main thread only)
+	void Update();
+	// clears peaks and rates, e.g. between benchmark runs
+	void ResetStats();
+
+	std::vector<TagStats> GetStats();
+	void LogStats();
+
+
+	/**
+	 * Attributes (sampled) heap allocations made by the current thread to
+	 * <tag> for the duration of the scope; ThreadPool tasks inherit the tag
+	 * that was active where they were issued.
+	 */
+	class ScopedTag {
+	public:
+		explicit ScopedTag(TagId tag): prvTag(SetThreadTag(tag)) {}
+		explicit ScopedTag(const char* name): ScopedTag(RegisterTag(name)) {}
+		~ScopedTag() { SetThreadTag(prvTag); }
+
+		ScopedTag(const ScopedTag&) = delete;
+		ScopedTag& operator = (const ScopedTag&) = delete;
+
+	private:
+		TagId prvTag;
+	};
+
+
+	/**
+	 * Accounting handle embedded in pools and containers; inert until given
+	 * a name so that unnamed instances (e.g. in tests) report nothing.
+	 */
+	class Tag {
+	public:
+		Tag() = default;
+		explicit Tag(const char* name): id(RegisterTag(name)) {}
+
+		void SetName(const char* name) { id = RegisterTag(name); }
+
+		void Alloc(size_t bytes) const {
+			if (id != TAG_NONE)
+				RecordAlloc(id, bytes);
+		}
+		void Free(size_t bytes) const {
+			if (id != TAG_NONE && bytes != 0)
+				RecordFree(id, bytes);
+		}
+
+		TagId GetId() const { return id; }
+
+	private:
+		TagId id = TAG_NONE;
+	};
+}
+
+#endif
@@ -17,6 +17,7 @@
 
 #include "System/UnorderedMap.hpp"
 #include "System/ContainerUtil.h"
+#include "System/MemAccounting.h"
 #include "System/SafeUtil.h"
 #include "System/Platform/Threading.h"
 #include "System/Log/ILog.h"
@@ -91,6 +92,7 @@ public:
 		m = pages[curr_page_index = i].data;
 
 		table.emplace(m, i);
+		memTag.Alloc(PAGE_SIZE());
 		return m;
 	}
 
@@ -112,6 +114,7 @@ public:
 
 		indcs.push_back(pair.second);
 		table.erase(pair.first);
+		memTag.Free(PAGE_SIZE());
 	}
 
 
@@ -137,6 +140,8 @@ public:
 	bool can_free() const { return indcs.size() < pages.size(); }
 
 	void clear() {
+		memTag.Free(alloc_size() - freed_size());
+
 		pages.clear();
 		indcs.clear();
 		table.clear();
@@ -148,6 +153,8 @@ public:
 		table.reserve(n);
 	}
 
+	void set_mem_tag(const char* name) { memTag.SetName(name); }
+
 private:
 	struct page {
 		alignas(Alignment) uint8_t data[S];
@@ -160,6 +167,8 @@ private:
 	spring::unsynced_map<void*, size_t> table;
 
 	size_t curr_page_index = 0;
+
+	MemAccounting::Tag memTag;
 };
 
 // Helper to infer the DynMemPool pool parameters from a types.
@@ -203,6 +212,7 @@ public:
 		assert(size <= PAGE_SIZE());
 		t_page_mem* page = page_mem(idx);
 		page_index = page->index = idx;
+		memTag.Alloc(PAGE_SIZE());
 		return page->data;
 	}
 
@@ -221,10 +231,12 @@ public:
 		assert(page->index < (N * K));
 		indcs.push_back(page->index);
 		memset(page, 0, sizeof(t_page_mem));
+		memTag.Free(PAGE_SIZE());
 	}
 
 	void reserve(size_t n) { indcs.reserve(n); }
 	void clear() {
+		memTag.Free(alloc_size() - freed_size());
 		indcs.clear();
 
 		// for every allocated chunk, add back all indices
@@ -250,6 +262,8 @@ public:
 	bool can_alloc() const { return num_chunks < N || !indcs.empty() ; }
 	bool can_free() const { return indcs.size() < (NUM_CHUNKS() * NUM_PAGES()); }
 
+	void set_mem_tag(const char* name) { memTag.SetName(name); }
+
 private:
 	struct t_page_mem {
 		uint32_t index;
@@ -279,6 +293,8 @@ private:
 
 	size_t num_chunks = 0;
 	size_t page_index = 0;
+
+	MemAccounting::Tag memTag;
 };
 
 // Helper to infer the FixedDynMemPool pool parameters from a types.
@@ -304,6 +320,7 @@ public:
 			i = indcs[--free_page_count];
 		}
 
+		memTag.Alloc(PAGE_SIZE());
 		return (pages[curr_page_index = i].data());
 	}
 
@@ -322,6 +339,7 @@ public:
 
 		// mark page as free
 		indcs[free_page_count++] = base_offset(m) / PAGE_SIZE();
+		memTag.Free(PAGE_SIZE());
 	}
 
 
@@ -350,6 +368,8 @@ public:
 
 	void reserve(size_t) {} // no-op
 	void clear() {
+		memTag.Free(alloc_size() - freed_size());
+
 		std::memset(pages.data(), 0, total_size());
 		std::memset(indcs.data(), 0, NUM_PAGES());
 
@@ -358,6 +378,8 @@ public:
 		curr_page_index = 0;
 	}
 
+	void set_mem_tag(const char* name) { memTag.SetName(name); }
+
 private:
 	alignas(Alignment) std::array<std::array<uint8_t, S>, N> pages;
 	std::array<size_t, N> indcs;
@@ -365,6 +387,8 @@ private:
 	size_t used_page_count = 0;
 	size_t free_page_count = 0; // indcs[fpc-1] is the last recycled page
 	size_t curr_page_index = 0;
+
+	MemAccounting::Tag memTag;
 };
 
 // Helper to infer the StaticMemPool pool parameters from a types.
@@ -403,6 +427,8 @@ public:
 	const std::vector<T>& GetData() const { return data; }
 	      std::vector<T>& GetData()       { return data; }
 
+	void SetMemTag(const char* name) { memTag.SetName(name); }
+
 	virtual const T& operator[](std::size_t idx) const { return data[idx]; }
 	virtual       T& operator[](std::size_t idx)       { return data[idx]; }
 
@@ -413,6 +439,8 @@ private:
 	std::vector<T> data;
 	std::multimap<size_t, size_t> sizeToPositions;
 	std::map<size_t, size_t> positionToSize;
+
+	MemAccounting::Tag memTag;
 };
 
 template<typename T>
@@ -421,6 +449,8 @@ inline size_t StablePosAllocator<T>::Allocate(size_t numElems)
 	if (numElems == 0)
 		return ~0u;
 
+	memTag.Alloc(numElems * sizeof(T));
+
 	//no gaps
 	if (positionToSize.empty()) {
 		size_t returnPos = data.size();
@@ -529,6 +559,8 @@ inline void StablePosAllocator<T>::Free(size_t firstElem, size_t numElems, const
 		return;
 	}
 
+	memTag.Free(numElems * sizeof(T));
+
 	if (T0)
 		std::fill(data.begin() + firstElem, data.begin() + firstElem + numElems, *T0);
 
@@ -71,6 +71,14 @@ public:
 	virtual void Close(bool flush = false) = 0;
 	virtual void SetLossFactor(int factor) = 0;
 
+	/**
+	 * @brief compress outgoing data from now on
+	 * Trades CPU time for bandwidth, meant for connections
+	 * (e.g. to spectators) that receive the full stream but send little.
+	 * Only supported by connections that go over the network.
+	 */
+	virtual void SetStreamCompression(bool enable) {}
+
 	/**
 	 * @brief update internals
 	 * Check for unack'd packets, timeout etc.
@@ -4,6 +4,7 @@
 
 #include <cinttypes>
 
+#include <zlib.h>
 
 #include "Socket.h"
 #include "ProtocolDef.h"
@@ -28,6 +29,11 @@ static constexpr unsigned udpMaxPacketSize = 4096;
 static constexpr int maxChunkSize = 254;
 static constexpr int chunksPerSec = 30;
 
+/// largest amount of packet data compressed into one NETMSG_STREAM_BUNDLE,
+/// deflate output for this much input always fits into maxBundleSize
+static constexpr unsigned maxBundleInput = 16384;
+static constexpr unsigned maxBundleSize = 32768;
+
 
 
 #if NETWORK_TEST
@@ -241,6 +247,7 @@ UDPConnection::UDPConnection(std::shared_ptr<ip::udp::socket> netSocket, const i
 
 UDPConnection::UDPConnection(int sourcePort, const std::string& address, const unsigned port)
 	: sharedSocket(false)
+	, acceptBundles(true)
 {
 	asio::error_code err;
 	addr = ResolveAddr(address, port, &err);
@@ -344,11 +351,26 @@ UDPConnection::~UDPConnection()
 	waitingPackets.clear();
 
 	Flush(true);
+
+	if (deflateStream != nullptr)
+		deflateEnd(deflateStream);
+	if (inflateStream != nullptr)
+		inflateEnd(inflateStream);
+
+	spring::SafeDelete(deflateStream);
+	spring::SafeDelete(inflateStream);
 }
 
 void UDPConnection::SendData(std::shared_ptr<const RawPacket> pkt)
 {
 	assert(pkt->length > 0);
+
+	// keep the order if compression was just turned off
+	if (compressStream || !bundleData.empty()) {
+		bundleData.push_back(pkt);
+		return;
+	}
+
 	outgoingData.push_back(pkt);
 }
 
@@ -528,6 +550,10 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 		LOG_L(L_INFO, "\t[%s] checksum=(%u : %u) mtu=%u", __func__, incoming.GetChecksum(), incoming.checksum, mtu);
 	#endif
 
+	// nothing is read from a closed connection, so the other end times out
+	if (closed)
+		return;
+
 	lastPacketRecvTime = spring_gettime();
 	dataRecv += incoming.GetSize();
 	recvOverhead += Packet::headerSize;
@@ -644,36 +670,17 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 
 			// this returns false for zero/invalid pktLength
 			if (ProtocolDef::GetInstance()->IsValidLength(pktLength, msgLength)) {
-				msgQueue.emplace_back(new RawPacket(bufp, pktLength));
-				std::shared_ptr<const RawPacket>& msgPacket = msgQueue.back();
-
-				#ifdef ENABLE_DEBUG_STATS
-				// server sends both of these, clients send only keyframe messages
-				// TODO: would be easy to feed this data into a Q3A-style lagometer
-				//
-				if (msgPacket->data[0] == NETMSG_NEWFRAME || msgPacket->data[0] == NETMSG_KEYFRAME) {
-					const spring_time dt = spring_gettime() - lastFramePacketRecvTime;
-
-					sumDeltaFramePacketRecvTime += dt.toMilliSecsf();
-					minDeltaFramePacketRecvTime = std::min(dt.toMilliSecsf(), minDeltaFramePacketRecvTime);
-					maxDeltaFramePacketRecvTime = std::max(dt.toMilliSecsf(), maxDeltaFramePacketRecvTime);
-
-					numReceivedFramePackets += 1;
-					numEnqueuedFramePackets += 1;
-					lastFramePacketRecvTime = spring_gettime();
-
-					if (logMessages) {
-						LOG_L(L_INFO,
-							"\t[%s] (received=%u enqueued=%u) packets (dt=%fms mindt=%fms maxdt=%fms sumdt=%fms)",
-							__func__, numReceivedFramePackets, numEnqueuedFramePackets, dt.toMilliSecsf(),
-							minDeltaFramePacketRecvTime, maxDeltaFramePacketRecvTime, sumDeltaFramePacketRecvTime
-						);
+				if (*bufp == NETMSG_STREAM_BUNDLE) {
+					// the rest of the stream depends on this bundle
+					if (!UnpackBundle(bufp, pktLength)) {
+						Close(false);
+						return;
 					}
+				} else {
+					EnqueueMessage(bufp, pktLength);
 				}
-				#endif
 
 				pos += pktLength;
-				numPings += (msgPacket->data[0] == NETMSG_PING); // incoming
 			} else {
 				if (pktLength >= 0) {
 					// partial packet in buffer
@@ -693,6 +700,186 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 	UpdateWaitingPackets();
 }
 
+void UDPConnection::EnqueueMessage(const unsigned char* data, unsigned length)
+{
+	msgQueue.emplace_back(new RawPacket(data, length));
+	std::shared_ptr<const RawPacket>& msgPacket = msgQueue.back();
+
+	#ifdef ENABLE_DEBUG_STATS
+	// server sends both of these, clients send only keyframe messages
+	// TODO: would be easy to feed this data into a Q3A-style lagometer
+	//
+	if (msgPacket->data[0] == NETMSG_NEWFRAME || msgPacket->data[0] == NETMSG_KEYFRAME) {
+		const spring_time dt = spring_gettime() - lastFramePacketRecvTime;
+
+		sumDeltaFramePacketRecvTime += dt.toMilliSecsf();
+		minDeltaFramePacketRecvTime = std::min(dt.toMilliSecsf(), minDeltaFramePacketRecvTime);
+		maxDeltaFramePacketRecvTime = std::max(dt.toMilliSecsf(), maxDeltaFramePacketRecvTime);
+
+		numReceivedFramePackets += 1;
+		numEnqueuedFramePackets += 1;
+		lastFramePacketRecvTime = spring_gettime();
+
+		if (logMessages) {
+			LOG_L(L_INFO,
+				"\t[%s] (received=%u enqueued=%u) packets (dt=%fms mindt=%fms maxdt=%fms sumdt=%fms)",
+				__func__, numReceivedFramePackets, numEnqueuedFramePackets, dt.toMilliSecsf(),
+				minDeltaFramePacketRecvTime, maxDeltaFramePacketRecvTime, sumDeltaFramePacketRecvTime
+			);
+		}
+	}
+	#endif
+
+	numPings += (msgPacket->data[0] == NETMSG_PING); // incoming
+}
+
+bool UDPConnection::UnpackBundle(const unsigned char* data, unsigned length)
+{
+	const spring_time startTime = spring_gettime();
+	const unsigned headerSize = sizeof(std::uint8_t) + sizeof(std::uint16_t);
+
+	if (!acceptBundles) {
+		LOG_L(L_ERROR, "[UDPConnection::%s] closing connection, received a bundle without compression being enabled (LEN %u)", __func__, length);
+		return false;
+	}
+
+	if (inflateStream == nullptr) {
+		inflateStream = new z_stream_s{};
+
+		if (inflateInit(inflateStream) != Z_OK) {
+			LOG_L(L_ERROR, "[UDPConnection::%s] closing connection, inflateInit failed", __func__);
+			spring::SafeDelete(inflateStream);
+			return false;
+		}
+	}
+
+	inflateStream->next_in = const_cast<Bytef*>(data + headerSize);
+	inflateStream->avail_in = length - headerSize;
+
+	// senders never put more than maxBundleInput bytes into a bundle, the
+	// extra byte tells a bundle that fits apart from one that would not
+	bundleBuffer.resize(maxBundleInput + 1);
+
+	inflateStream->next_out = bundleBuffer.data();
+	inflateStream->avail_out = bundleBuffer.size();
+
+	const int ret = inflate(inflateStream, Z_SYNC_FLUSH);
+
+	bundleBuffer.resize(bundleBuffer.size() - inflateStream->avail_out);
+
+	// bundles depend on all previous ones, the stream can not recover from this
+	if (ret != Z_OK || inflateStream->avail_in > 0 || bundleBuffer.size() > maxBundleInput) {
+		LOG_L(L_ERROR, "[UDPConnection::%s] closing connection, undecodable or oversized bundle (error %d, LEN %u)", __func__, ret, length);
+		return false;
+	}
+
+	for (unsigned pos = 0; pos < bundleBuffer.size(); ) {
+		const unsigned char* bufp = &bundleBuffer[pos];
+		const unsigned int msgLength = bundleBuffer.size() - pos;
+
+		const int pktLength = ProtocolDef::GetInstance()->PacketLength(bufp, msgLength);
+
+		// bundles only ever contain whole packets, and no further bundles
+		if (!ProtocolDef::GetInstance()->IsValidLength(pktLength, msgLength) || *bufp == NETMSG_STREAM_BUNDLE) {
+			LOG_L(L_ERROR, "[UDPConnection::%s] discarding invalid bundled packet: ID %d, LEN %d", __func__, (int)*bufp, pktLength);
+			break;
+		}
+
+		EnqueueMessage(bufp, pktLength);
+		pos += pktLength;
+	}
+
+	recvBundleBytes[0] += bundleBuffer.size();
+	recvBundleBytes[1] += length;
+	recvBundles += 1;
+
+	inflateTime += (spring_gettime() - startTime);
+	return true;
+}
+
+void UDPConnection::CreateBundles()
+{
+	if (bundleData.empty())
+		return;
+
+	const spring_time startTime = spring_gettime();
+	const unsigned headerSize = sizeof(std::uint8_t) + sizeof(std::uint16_t);
+
+	if (deflateStream == nullptr) {
+		deflateStream = new z_stream_s{};
+
+		// favor speed, every connection compresses its own copy of the stream
+		if (deflateInit(deflateStream, Z_BEST_SPEED) != Z_OK) {
+			LOG_L(L_ERROR, "[UDPConnection::%s] deflateInit failed, sending uncompressed", __func__);
+
+			spring::SafeDelete(deflateStream);
+			compressStream = false;
+
+			outgoingData.insert(outgoingData.end(), bundleData.begin(), bundleData.end());
+			bundleData.clear();
+			return;
+		}
+	}
+
+	while (!bundleData.empty()) {
+		unsigned rawSize = 0;
+
+		bundleBuffer.resize(maxBundleSize);
+
+		deflateStream->next_out = bundleBuffer.data() + headerSize;
+		deflateStream->avail_out = maxBundleSize - headerSize;
+
+		while (!bundleData.empty()) {
+			const std::shared_ptr<const RawPacket>& packet = bundleData.front();
+
+			if (!ProtocolDef::GetInstance()->IsValidPacket(packet->data, packet->length)) {
+				LOG_L(L_ERROR, "[UDPConnection::%s] discarding outgoing invalid packet: ID %d, LEN %d", __func__, (int)packet->data[0], packet->length);
+				bundleData.pop_front();
+				continue;
+			}
+
+			if ((rawSize + packet->length) > maxBundleInput)
+				break;
+
+			deflateStream->next_in = const_cast<Bytef*>(packet->data);
+			deflateStream->avail_in = packet->length;
+
+			deflate(deflateStream, Z_NO_FLUSH);
+			assert(deflateStream->avail_in == 0);
+
+			rawSize += packet->length;
+			bundleData.pop_front();
+		}
+
+		if (rawSize == 0) {
+			// too large to be worth bundling, goes out as it is
+			if (!bundleData.empty()) {
+				outgoingData.push_back(bundleData.front());
+				bundleData.pop_front();
+			}
+
+			continue;
+		}
+
+		// complete this bundle; the stream (and its history) goes on
+		deflate(deflateStream, Z_SYNC_FLUSH);
+		assert(deflateStream->avail_out > 0);
+
+		const std::uint16_t bundleSize = maxBundleSize - deflateStream->avail_out;
+
+		bundleBuffer[0] = NETMSG_STREAM_BUNDLE;
+		std::memcpy(&bundleBuffer[1], &bundleSize, sizeof(bundleSize));
+
+		outgoingData.emplace_back(new RawPacket(bundleBuffer.data(), bundleSize));
+
+		sentBundleBytes[0] += rawSize;
+		sentBundleBytes[1] += bundleSize;
+		sentBundles += 1;
+	}
+
+	deflateTime += (spring_gettime() - startTime);
+}
+
 void UDPConnection::Flush(const bool forced)
 {
 	if (muted)
@@ -711,9 +898,15 @@ void UDPConnection::Flush(const bool forced)
 		for (auto pi = outgoingData.begin(); (pi != outgoingData.end()) && (outgoingLength <= requiredLength); ++pi) {
 			outgoingLength += (*pi)->length;
 		}
+		for (auto pi = bundleData.begin(); (pi != bundleData.end()) && (outgoingLength <= requiredLength); ++pi) {
+			outgoingLength += (*pi)->length;
+		}
 	}
 
 	if (forced || (!waitMore && outgoingLength > requiredLength)) {
+		// whatever was queued since the last flush goes out in one bundle
+		CreateBundles();
+
 		std::uint8_t buffer[udpMaxPacketSize];
 		unsigned pos = 0;
 
@@ -809,6 +1002,8 @@ std::string UDPConnection::Statistics() const
 		"\t{%.3fx, %.3fx} relative protocol overhead {up, down}\n",
 		"\t%u incoming chunks dropped, %u outgoing chunks resent\n",
 		"\t%u incoming chunks processed\n",
+		"\t%u bytes sent   in %u bundles compressed to %.3fx in %.3fms\n",
+		"\t%u bytes recv'd in %u bundles compressed to %.3fx in %.3fms\n",
 	};
 
 	std::string msg = "[UDPConnection::Statistics]\n";
@@ -817,6 +1012,8 @@ std::string UDPConnection::Statistics() const
 	msg += spring::format(fmts[2], spring::SafeDivide(sentOverhead * 1.0f, dataSent * 1.0f), spring::SafeDivide(recvOverhead * 1.0f, dataRecv * 1.0f));
 	msg += spring::format(fmts[3], droppedChunks, resentChunks);
 	msg += spring::format(fmts[4], lastInOrder + 1);
+	msg += spring::format(fmts[5], sentBundleBytes[0], sentBundles, spring::SafeDivide(sentBundleBytes[1] * 1.0f, sentBundleBytes[0] * 1.0f), deflateTime.toMilliSecsf());
+	msg += spring::format(fmts[6], recvBundleBytes[0], recvBundles, spring::SafeDivide(recvBundleBytes[1] * 1.0f, recvBundleBytes[0] * 1.0f), inflateTime.toMilliSecsf());
 	return msg;
 }
 
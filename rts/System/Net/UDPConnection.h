@@ -12,6 +12,7 @@
 #include "System/UnorderedSet.hpp"
 
 class CRC;
+struct z_stream_s;
 
 
 namespace netcode {
@@ -131,6 +132,7 @@ public:
 	void Unmute() override { muted = false; }
 	void Close(bool flush) override;
 	void SetLossFactor(int factor) override;
+	void SetStreamCompression(bool enable) override { compressStream = enable; }
 
 	const asio::ip::udp::endpoint& GetEndpoint() const { return addr; }
 
@@ -155,6 +157,13 @@ private:
 	void UpdateWaitingPackets();
 	void UpdateResendRequests();
 
+	/// compress the packets in bundleData into NETMSG_STREAM_BUNDLE's
+	void CreateBundles();
+	/// add received messages to msgQueue, unpacking bundles
+	void EnqueueMessage(const unsigned char* data, unsigned length);
+	/// false if the bundle can not be decoded, or is not accepted on this connection
+	bool UnpackBundle(const unsigned char* data, unsigned length);
+
 private:
 	spring_time lastChunkCreatedTime;
 	spring_time lastPacketSendTime;
@@ -185,6 +194,8 @@ private:
 
 	/// outgoing stuff (pure data without header) waiting to be sent
 	std::deque< std::shared_ptr<const RawPacket> > outgoingData;
+	/// outgoing stuff waiting to be compressed into outgoingData, see SetStreamCompression
+	std::deque< std::shared_ptr<const RawPacket> > bundleData;
 	/// packets we have received but not yet read
 	std::vector< std::pair<int, RawPacket> > waitingPackets;
 	spring::unordered_set<int> incomingChunkNums;
@@ -205,6 +216,12 @@ private:
 	std::vector<std::uint8_t> sendBuffer;
 	std::vector<std::uint8_t> recvBuffer;
 	std::vector<std::uint8_t> waitBuffer;
+	std::vector<std::uint8_t> bundleBuffer;
+
+	/// one zlib stream per direction that spans all bundles, so each
+	/// bundle can refer back to the data of previous ones
+	z_stream_s* deflateStream = nullptr;
+	z_stream_s* inflateStream = nullptr;
 
 	std::vector<int> droppedPackets;
 
@@ -244,6 +261,20 @@ private:
 	unsigned int sentOverhead, recvOverhead;
 	unsigned int sentPackets, recvPackets;
 
+	/// {raw, compressed} bytes of all bundles and the time spent on them
+	unsigned int sentBundleBytes[2] = {0, 0};
+	unsigned int recvBundleBytes[2] = {0, 0};
+	unsigned int sentBundles = 0;
+	unsigned int recvBundles = 0;
+
+	spring_time deflateTime;
+	spring_time inflateTime;
+
+	bool compressStream = false;
+	/// only servers compress their streams, so bundles are only accepted
+	/// on connections this side opened; never on those a listener accepted
+	bool acceptBundles = false;
+
 	class BandwidthUsage {
 	public:
 		BandwidthUsage() = default;
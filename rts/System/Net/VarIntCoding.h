@@ -0,0 +1,108 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef VARINT_CODING_H
+#define VARINT_CODING_H
+
+#include "UnpackPacket.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace netcode
+{
+
+/**
+ * Variable-length encodings for packets carrying long runs of similar
+ * numbers. Integers are stored 7 bits per byte (LEB128), signed values
+ * zigzag-mapped first so small negative deltas stay short as well.
+ */
+static inline uint32_t ZigZagEncode(int32_t v) { return ((static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31)); }
+static inline int32_t ZigZagDecode(uint32_t v) { return (static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1)); }
+
+static inline void PackVarInt(std::vector<uint8_t>& buf, uint32_t v)
+{
+	for (; v >= 0x80; v >>= 7) {
+		buf.push_back(static_cast<uint8_t>(v | 0x80));
+	}
+
+	buf.push_back(static_cast<uint8_t>(v));
+}
+
+static inline uint32_t UnpackVarInt(UnpackPacket& pckt)
+{
+	uint32_t v = 0;
+
+	for (uint32_t shift = 0; shift < 35; shift += 7) {
+		uint8_t b; pckt >> b;
+
+		v |= (static_cast<uint32_t>(b & 0x7F) << shift);
+
+		if ((b & 0x80) == 0)
+			return v;
+	}
+
+	throw UnpackPacketException("Unpack failure (varint)");
+}
+
+
+/**
+ * Floats that are whole multiples of 1/DELTA_FLOAT_SCALE (map coordinates
+ * snapped to that grid, integer IDs, ...) are stored as the varint delta
+ * to the previous such value of the same stream, all others as an escape
+ * byte followed by the raw float. Either way the decoded value is exactly
+ * the packed one, quantizing is up to the caller (see QuantizeDeltaFloat).
+ */
+static constexpr float DELTA_FLOAT_SCALE = 16.0f;
+// keeps value * scale, and deltas between two such values, exact in floats and ints
+static constexpr float DELTA_FLOAT_LIMIT = float(1 << 24);
+
+static inline float QuantizeDeltaFloat(float v)
+{
+	if (!(std::fabs(v * DELTA_FLOAT_SCALE) <= DELTA_FLOAT_LIMIT))
+		return v;
+
+	return (std::round(v * DELTA_FLOAT_SCALE) / DELTA_FLOAT_SCALE);
+}
+
+static inline void PackDeltaFloat(std::vector<uint8_t>& buf, float v, int32_t& prev)
+{
+	const float scaled = v * DELTA_FLOAT_SCALE;
+
+	// also rejects NaN; -0 would come back as +0
+	if (std::fabs(scaled) <= DELTA_FLOAT_LIMIT && scaled == std::trunc(scaled) && !(v == 0.0f && std::signbit(v))) {
+		const int32_t q = static_cast<int32_t>(scaled);
+
+		PackVarInt(buf, ZigZagEncode(q - prev) << 1);
+		prev = q;
+		return;
+	}
+
+	uint8_t raw[sizeof(float)];
+	std::memcpy(raw, &v, sizeof(float));
+
+	buf.push_back(1);
+	buf.insert(buf.end(), raw, raw + sizeof(float));
+}
+
+static inline float UnpackDeltaFloat(UnpackPacket& pckt, int32_t& prev)
+{
+	const uint32_t code = UnpackVarInt(pckt);
+
+	if ((code & 1) != 0) {
+		float v; pckt >> v;
+		return v;
+	}
+
+	const int64_t q = int64_t(prev) + ZigZagDecode(code >> 1);
+
+	if (q < -int64_t(DELTA_FLOAT_LIMIT) || q > int64_t(DELTA_FLOAT_LIMIT))
+		throw UnpackPacketException("Unpack failure (delta float)");
+
+	return ((prev = static_cast<int32_t>(q)) / DELTA_FLOAT_SCALE);
+}
+
+} // namespace netcode
+
+#endif // VARINT_CODING_H
@@ -14,7 +14,10 @@
 #include "System/Threading/SpringThreading.h"
 #include "System/UnorderedSet.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cinttypes>
+#include <cstring>
 #include <tuple>
 
 
@@ -87,6 +90,17 @@ namespace springproc {
 		return cpuid;
 	}
 
+	// number of bits needed to enumerate <n> distinct ids
+	static uint32_t CountOrder(uint32_t n) {
+		uint32_t order = 0;
+
+		while ((1u << order) < n)
+			order++;
+
+		return order;
+	}
+
+
 	CPUID::CPUID()
 		: shiftCore(0)
 		, shiftPackage(0)
@@ -113,7 +127,7 @@ namespace springproc {
 	void CPUID::EnumerateCores() {
 		const auto oldAffinity = Threading::GetAffinity();
 
-		LOG("%s: thread affinity %x", __func__, Threading::GetAffinity());
+		LOG("%s: thread affinity %" PRIx64, __func__, Threading::GetAffinity());
 
 		availableProceesorAffinityMask = 0;
 		numLogicalCores = 0;
@@ -142,7 +156,7 @@ namespace springproc {
 		auto& [raw_array, system, badResult] = cpuID.Get();
 
 		Threading::SetAffinity(oldAffinity);
-		LOG("%s: thread affinity %x ...", __func__, Threading::GetAffinity());
+		LOG("%s: thread affinity %" PRIx64 " ...", __func__, Threading::GetAffinity());
 		if (badResult) {
 			LOG_L(L_WARNING, "[CpuId] error: %s", cpuid_error());
 			return;
@@ -156,15 +170,116 @@ namespace springproc {
 				availableProceesorAffinityMask |= *(uint64_t*)&cpu_id.affinity_mask;
 				numLogicalCores += cpu_id.num_logical_cpus;
 				numPhysicalCores += cpu_id.num_cores;
-				LOG("[CpuId] found %d cores and %d logical cpus (mask: 0x%x) of type %s"
+				LOG("[CpuId] found %d cores and %d logical cpus (mask: 0x%" PRIx64 ") of type %s"
 						, cpu_id.num_cores
 						, cpu_id.num_logical_cpus
-						, *(int*)&cpu_id.affinity_mask
+						, *(uint64_t*)&cpu_id.affinity_mask
 						, cpu_purpose_str(cpu_id.purpose));
-				LOG("[CpuId] setting logical cpu affinity mask to 0x%x", (int)availableProceesorAffinityMask);
+				LOG("[CpuId] setting logical cpu affinity mask to 0x%" PRIx64, availableProceesorAffinityMask);
 			// ignore case PURPOSE_EFFICIENCY:
 			}
 		}
+
+		if (system.num_cpu_types > 0)
+			EnumerateTopology(raw_array, system.cpu_types[0].vendor);
+	}
+
+	void CPUID::EnumerateTopology(const cpu_raw_data_array_t& rawArray, int vendor)
+	{
+		// raw data is only per-cpu if libcpuid could pin itself to each one in turn
+		if (!rawArray.with_affinity)
+			return;
+		if (vendor != VENDOR_INTEL && vendor != VENDOR_AMD && vendor != VENDOR_HYGON)
+			return;
+
+		const int numRaw = std::min(int(rawArray.num_raw), MAX_PROCESSORS);
+
+		uint32_t coreIds[MAX_PROCESSORS];
+		uint32_t packageIds[MAX_PROCESSORS];
+		uint32_t cacheIds[MAX_PROCESSORS];
+
+		for (int i = 0; i < numRaw; i++) {
+			const cpu_raw_data_t& raw = rawArray.raw[i];
+
+			uint32_t shiftSMT = 0;
+			uint32_t shiftPkg = 0;
+			uint32_t shiftL3 = ~0u;
+
+			// x2APIC id and level widths from leaf 0Bh if available, else the initial APIC id
+			if (raw.basic_cpuid[0][REG_EAX] >= 11 && (raw.basic_cpuid[11][REG_EBX] & 0xFFFF) != 0) {
+				processorApicIds[i] = raw.intel_fn11[0][REG_EDX];
+
+				for (int subleaf = 0; subleaf < MAX_INTELFN11_LEVEL; subleaf++) {
+					const uint32_t* regs = raw.intel_fn11[subleaf];
+					const uint32_t levelType = (regs[REG_ECX] >> 8) & 0xFF;
+
+					if (levelType == 0)
+						break;
+					if (levelType == 1)
+						shiftSMT = regs[REG_EAX] & 0x1F;
+
+					shiftPkg = regs[REG_EAX] & 0x1F;
+				}
+			} else {
+				processorApicIds[i] = raw.basic_cpuid[1][REG_EBX] >> 24;
+				shiftPkg = CountOrder((raw.basic_cpuid[1][REG_EBX] >> 16) & 0xFF);
+			}
+
+			// deterministic cache parameters share one register layout on Intel (4) and AMD (8000001Dh)
+			const bool amdLeaf = (vendor != VENDOR_INTEL);
+			const uint32_t (*cacheRegs)[NUM_REGS] = amdLeaf? raw.amd_fn8000001dh: raw.intel_fn4;
+			const int numCacheLeaves = amdLeaf? MAX_AMDFN8000001DH_LEVEL: MAX_INTELFN4_LEVEL;
+
+			for (int subleaf = 0; subleaf < numCacheLeaves; subleaf++) {
+				const uint32_t eax = cacheRegs[subleaf][REG_EAX];
+				const uint32_t level = (eax >> 5) & 0x7;
+				const uint32_t type = eax & 0x1F;
+
+				if (type == 0)
+					break;
+				// unified L3
+				if (level == 3 && type == 3)
+					shiftL3 = CountOrder(((eax >> 14) & 0xFFF) + 1);
+			}
+
+			coreIds[i] = processorApicIds[i] >> shiftSMT;
+			packageIds[i] = processorApicIds[i] >> shiftPkg;
+			// a cache shared by more cpus than the package holds is treated as per-package
+			cacheIds[i] = processorApicIds[i] >> std::min(shiftL3, shiftPkg);
+		}
+
+		// map the sparse ids onto dense indices, in order of first appearance
+		const auto BuildMasks = [&](const uint32_t* ids, uint64_t* masks) {
+			uint32_t seenIds[MAX_PROCESSORS];
+			int numSeen = 0;
+
+			std::fill(masks, masks + MAX_PROCESSORS, 0);
+
+			for (int i = 0; i < numRaw; i++) {
+				int n = 0;
+
+				while (n < numSeen && seenIds[n] != ids[i])
+					n++;
+
+				if (n == numSeen)
+					seenIds[numSeen++] = ids[i];
+
+				masks[n] |= (uint64_t(1) << i);
+			}
+
+			return numSeen;
+		};
+
+		numCoreMasks = BuildMasks(coreIds, affinityMaskOfCores);
+		numPackageMasks = BuildMasks(packageIds, affinityMaskOfPackages);
+		numCacheDomains = BuildMasks(cacheIds, affinityMaskOfCaches);
+		totalNumPackages = numPackageMasks;
+
+		LOG("[CpuId] topology: %d logical cpus, %d cores, %d packages, %d L3 domains", numRaw, numCoreMasks, numPackageMasks, numCacheDomains);
+
+		for (int i = 0; i < numCacheDomains; i++) {
+			LOG("[CpuId] L3 domain %d: mask 0x%" PRIx64, i, affinityMaskOfCaches[i]);
+		}
 	}
 
 	void CPUID::SetDefault()
@@ -184,13 +299,22 @@ namespace springproc {
 		memset(affinityMaskOfPackages, 0, sizeof(affinityMaskOfPackages));
 		memset(processorApicIds      , 0, sizeof(processorApicIds      ));
 
-		for (int i = 0; i<numLogicalCores; ++i)
-			availableProceesorAffinityMask |= 1 << i;
+		for (int i = 0; i < std::min(numLogicalCores, MAX_PROCESSORS); ++i)
+			availableProceesorAffinityMask |= uint64_t(1) << i;
+
+		// failed to determine CPU anatomy; one core per logical cpu, all in a single package and cache domain
+		numCoreMasks = std::min(numLogicalCores, MAX_PROCESSORS);
+		numPackageMasks = 1;
+		numCacheDomains = 1;
 
-		// failed to determine CPU anatomy, just set affinity mask to (-1)
-		for (int i = 0; i < numLogicalCores; i++) {
-			affinityMaskOfCores[i] = affinityMaskOfPackages[i] = -1;
+		memset(affinityMaskOfCaches, 0, sizeof(affinityMaskOfCaches));
+
+		for (int i = 0; i < numCoreMasks; i++) {
+			affinityMaskOfCores[i] = uint64_t(1) << i;
 		}
+
+		affinityMaskOfPackages[0] = availableProceesorAffinityMask;
+		affinityMaskOfCaches[0] = availableProceesorAffinityMask;
 	}
 
 }
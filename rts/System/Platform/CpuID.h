@@ -11,6 +11,8 @@
 
 #include <cstdint>
 
+struct cpu_raw_data_array_t;
+
 namespace springproc {
 	_noinline void ExecCPUID(unsigned int* a, unsigned int* b, unsigned int* c, unsigned int* d);
 
@@ -51,24 +53,41 @@ namespace springproc {
 		uint64_t GetAvailableProceesorAffinityMask() const { return availableProceesorAffinityMask; };
 
 		uint64_t GetCoreAffinityMask(int x) const { return affinityMaskOfCores[x & (MAX_PROCESSORS - 1)]; }
-		uint64_t GetPackageAffinityMask(int x) { return affinityMaskOfPackages[x & (MAX_PROCESSORS - 1)]; }
+		uint64_t GetPackageAffinityMask(int x) const { return affinityMaskOfPackages[x & (MAX_PROCESSORS - 1)]; }
+
+		/** Number of physical cores, packages and last-level (L3) cache
+		    domains whose masks are returned by the getters above and
+		    below, enumerated in logical cpu order. Every logical cpu is
+		    in exactly one of each. */
+		int GetNumCoreMasks() const { return numCoreMasks; }
+		int GetNumPackageMasks() const { return numPackageMasks; }
+		int GetNumCacheDomains() const { return numCacheDomains; }
+
+		uint64_t GetCacheDomainAffinityMask(int x) const { return affinityMaskOfCaches[x & (MAX_PROCESSORS - 1)]; }
+
+		static constexpr int MAX_PROCESSORS = 64;
 
 	private:
 		CPUID();
 
 		void SetDefault();
 		void EnumerateCores();
+		void EnumerateTopology(const ::cpu_raw_data_array_t& rawArray, int vendor);
 
 		int numLogicalCores;
 		int numPhysicalCores;
 		int totalNumPackages;
 
-		static constexpr int MAX_PROCESSORS = 64;
+		int numCoreMasks;
+		int numPackageMasks;
+		int numCacheDomains;
 
 		/** Array of the size coreTotalNumber, containing for each
 		    core the affinity mask. */
 		uint64_t affinityMaskOfCores[MAX_PROCESSORS];
 		uint64_t affinityMaskOfPackages[MAX_PROCESSORS];
+		/** logical cpus sharing an L3 (or the package if there is none) */
+		uint64_t affinityMaskOfCaches[MAX_PROCESSORS];
 		uint64_t availableProceesorAffinityMask;
 
 		////////////////////////
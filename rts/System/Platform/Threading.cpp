@@ -9,8 +9,11 @@
 	#include "System/Sync/FPUCheck.h"
 #endif
 
+#include <algorithm>
+#include <bit>
 #include <functional>
 #include <memory>
+#include <vector>
 #include <cinttypes>
 #if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__)
 #elif defined(_WIN32)
@@ -78,27 +81,25 @@ namespace Threading {
 	#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__)
 	#elif defined(_WIN32)
 	#else
-	static std::uint32_t CalcCoreAffinityMask(const cpu_set_t* cpuSet) {
-		std::uint32_t coreMask = 0;
+	// masks cover the first 64 cpu ids; sets can be sparse, so scan ids rather than CPU_COUNT
+	static constexpr int MAX_MASK_CPUS = std::min(CPU_SETSIZE, 64);
 
-		// without the min(..., 32), `(1 << n)` could overflow
-		const int numCPUs = std::min(CPU_COUNT(&cpusSystem), 32);
+	static std::uint64_t CalcCoreAffinityMask(const cpu_set_t* cpuSet) {
+		std::uint64_t coreMask = 0;
 
-		for (int n = numCPUs - 1; n >= 0; --n) {
+		for (int n = MAX_MASK_CPUS - 1; n >= 0; --n) {
 			if (CPU_ISSET(n, cpuSet))
-				coreMask |= (1 << n);
+				coreMask |= (std::uint64_t(1) << n);
 		}
 
 		return coreMask;
 	}
 
-	static void SetWantedCoreAffinityMask(cpu_set_t* cpuDstSet, std::uint32_t coreMask) {
+	static void SetWantedCoreAffinityMask(cpu_set_t* cpuDstSet, std::uint64_t coreMask) {
 		CPU_ZERO(cpuDstSet);
 
-		const int numCPUs = std::min(CPU_COUNT(&cpusSystem), 32);
-
-		for (int n = numCPUs - 1; n >= 0; --n) {
-			if ((coreMask & (1 << n)) != 0)
+		for (int n = MAX_MASK_CPUS - 1; n >= 0; --n) {
+			if ((coreMask & (std::uint64_t(1) << n)) != 0)
 				CPU_SET(n, cpuDstSet);
 		}
 
@@ -108,7 +109,7 @@ namespace Threading {
 
 
 
-	std::uint32_t GetAffinity()
+	std::uint64_t GetAffinity()
 	{
 	#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__)
 		// no-op
@@ -129,10 +130,10 @@ namespace Threading {
 	}
 
 
-	std::uint32_t SetAffinity(std::uint32_t coreMask, bool hard)
+	std::uint64_t SetAffinity(std::uint64_t coreMask, bool hard)
 	{
 		if (coreMask == 0)
-			return (~0);
+			return (~std::uint64_t(0));
 
 	#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__)
 		// no-op
@@ -153,7 +154,7 @@ namespace Threading {
 		}
 
 		// return final mask
-		return ((static_cast<std::uint32_t>(cpusWanted)) * (result > 0));
+		return ((static_cast<std::uint64_t>(cpusWanted)) * (result > 0));
 	#else
 		cpu_set_t cpusWanted;
 
@@ -168,27 +169,27 @@ namespace Threading {
 	#endif
 	}
 
-	void SetAffinityHelper(const char* threadName, std::uint32_t affinity) {
-		const std::uint32_t cpuMask = Threading::SetAffinity(affinity);
+	void SetAffinityHelper(const char* threadName, std::uint64_t affinity) {
+		const std::uint64_t cpuMask = Threading::SetAffinity(affinity);
 
-		if (cpuMask == ~0u) {
+		if (cpuMask == ~std::uint64_t(0)) {
 			LOG("[Threading] %s thread CPU affinity not set", threadName);
 			return;
 		}
 		if (cpuMask == 0) {
-			LOG_L(L_ERROR, "[Threading] %s thread CPU affinity mask failed: 0x%x", threadName, affinity);
+			LOG_L(L_ERROR, "[Threading] %s thread CPU affinity mask failed: 0x%" PRIx64, threadName, affinity);
 			return;
 		}
 		if (cpuMask != affinity) {
-			LOG("[Threading] %s thread CPU affinity mask set: 0x%x (config is %x)", threadName, cpuMask, affinity);
+			LOG("[Threading] %s thread CPU affinity mask set: 0x%" PRIx64 " (config is %" PRIx64 ")", threadName, cpuMask, affinity);
 			return;
 		}
 
-		LOG("[Threading] %s thread CPU affinity mask set: 0x%x", threadName, cpuMask);
+		LOG("[Threading] %s thread CPU affinity mask set: 0x%" PRIx64, threadName, cpuMask);
 	}
 
 
-	std::uint32_t GetAvailableCoresMask()
+	std::uint64_t GetAvailableCoresMask()
 	{
 	#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__)
 		// no-op
@@ -201,6 +202,199 @@ namespace Threading {
 	}
 
 
+	// guards the last published plan, readers get a copy
+	static spring::mutex affinityPlanMutex;
+	static AffinityPlan affinityPlan;
+	static bool haveAffinityPlan = false;
+
+	static AffinityPlan CalcAffinityPlan(int numPartitions, int partitionIndex)
+	{
+		const springproc::CPUID& cpuid = springproc::CPUID::GetInstance();
+
+		// physical cores in logical cpu order, each with its cache domain
+		struct Core { std::uint64_t mask; int domain; };
+
+		std::vector<Core> cores;
+		std::vector<std::uint64_t> domainMasks;
+
+		std::uint64_t availCores = cpuid.GetAvailableProceesorAffinityMask() & GetAvailableCoresMask();
+
+		if (availCores == 0)
+			availCores = cpuid.GetAvailableProceesorAffinityMask();
+
+		for (int i = 0; i < cpuid.GetNumCacheDomains(); i++) {
+			if ((cpuid.GetCacheDomainAffinityMask(i) & availCores) != 0)
+				domainMasks.push_back(cpuid.GetCacheDomainAffinityMask(i) & availCores);
+		}
+		for (int i = 0; i < cpuid.GetNumCoreMasks(); i++) {
+			const std::uint64_t coreMask = cpuid.GetCoreAffinityMask(i) & availCores;
+
+			if (coreMask == 0)
+				continue;
+
+			int domain = 0;
+
+			while (domain < int(domainMasks.size()) - 1 && (domainMasks[domain] & coreMask) == 0)
+				domain++;
+
+			cores.push_back({coreMask, domain});
+		}
+
+		AffinityPlan plan;
+
+		if (cores.empty() || domainMasks.empty()) {
+			LOG_L(L_WARNING, "[Threading::%s] no usable cpu topology, threads will not be pinned", __func__);
+			return plan;
+		}
+
+		const int numDomains = domainMasks.size();
+
+		numPartitions = std::max(numPartitions, 1);
+		partitionIndex = std::clamp(partitionIndex, 0, numPartitions - 1);
+
+		if (numPartitions == 1) {
+			plan.partitionCores = availCores;
+		} else if (numDomains >= numPartitions) {
+			// whole domains per partition; consecutive domains are usually on the same package
+			plan.partitionCores = 0;
+
+			for (int d = (partitionIndex * numDomains) / numPartitions; d < ((partitionIndex + 1) * numDomains) / numPartitions; d++) {
+				plan.partitionCores |= domainMasks[d];
+			}
+		} else {
+			// several partitions per domain, each takes a contiguous run of its physical cores
+			const int domain = (partitionIndex * numDomains) / numPartitions;
+
+			int slice = 0;
+			int numSlices = 0;
+
+			for (int p = 0; p < numPartitions; p++) {
+				if (((p * numDomains) / numPartitions) != domain)
+					continue;
+
+				slice += (p < partitionIndex);
+				numSlices += 1;
+			}
+
+			std::vector<std::uint64_t> domainCores;
+
+			for (const Core& core: cores) {
+				if (core.domain == domain)
+					domainCores.push_back(core.mask);
+			}
+
+			const int numCores = domainCores.size();
+			const int sliceBeg = (slice * numCores) / numSlices;
+			const int sliceEnd = std::max(((slice + 1) * numCores) / numSlices, sliceBeg + 1);
+
+			plan.partitionCores = 0;
+
+			for (int c = sliceBeg; c < std::min(sliceEnd, numCores); c++) {
+				plan.partitionCores |= domainCores[c];
+			}
+		}
+
+		// the sim domain is whichever one has the most physical cores left in our partition
+		std::vector<int> domainCoreCounts(numDomains, 0);
+
+		for (const Core& core: cores) {
+			domainCoreCounts[core.domain] += ((core.mask & plan.partitionCores) != 0);
+		}
+
+		const int simDomain = std::max_element(domainCoreCounts.begin(), domainCoreCounts.end()) - domainCoreCounts.begin();
+
+		std::vector<std::uint64_t> simCores;
+
+		for (const Core& core: cores) {
+			if (core.domain == simDomain && (core.mask & plan.partitionCores) != 0)
+				simCores.push_back(core.mask & plan.partitionCores);
+		}
+
+		plan.simDomainCores = domainMasks[simDomain] & plan.partitionCores;
+		plan.mainCores = simCores[0];
+		plan.workerCores = 0;
+
+		for (size_t c = 1; c < simCores.size(); c++) {
+			plan.workerCores |= simCores[c];
+		}
+
+		// first logical cpu of every other core, then their SMT siblings; the
+		// main core's own siblings are not handed out
+		for (std::uint64_t pending = plan.workerCores; pending != 0; ) {
+			for (size_t c = 1; c < simCores.size(); c++) {
+				const std::uint64_t cpus = simCores[c] & pending;
+
+				if (cpus == 0)
+					continue;
+
+				const int cpu = std::countr_zero(cpus);
+
+				plan.workerCpus[plan.numWorkerCpus++] = cpu;
+				pending &= ~(std::uint64_t(1) << cpu);
+			}
+		}
+
+		// a single-core domain; share the rest of the partition
+		if (plan.workerCores == 0)
+			plan.workerCores = plan.partitionCores & ~plan.mainCores;
+		if (plan.workerCores == 0)
+			plan.workerCores = plan.mainCores;
+
+		plan.auxCores = plan.partitionCores & ~plan.simDomainCores;
+
+		// everything is in one domain; prefer SMT siblings not handed to a pinned worker
+		if (plan.auxCores == 0) {
+			std::uint64_t pinnedCores = plan.mainCores;
+
+			for (int i = 0; i < plan.numWorkerCpus; i++) {
+				pinnedCores |= plan.GetWorkerCore(i);
+			}
+
+			if ((plan.auxCores = plan.partitionCores & ~pinnedCores) == 0)
+				plan.auxCores = plan.partitionCores & ~plan.mainCores;
+			if (plan.auxCores == 0)
+				plan.auxCores = plan.partitionCores;
+		}
+
+		LOG("[Threading::%s] partition %d/%d: cores=0x%" PRIx64 " sim-domain=0x%" PRIx64 " main=0x%" PRIx64 " workers=0x%" PRIx64 " (%d pinned) aux=0x%" PRIx64,
+			__func__, partitionIndex + 1, numPartitions, plan.partitionCores, plan.simDomainCores, plan.mainCores, plan.workerCores, plan.numWorkerCpus, plan.auxCores);
+
+		return plan;
+	}
+
+	AffinityPlan PlanAffinity(int numPartitions, int partitionIndex)
+	{
+		const AffinityPlan plan = CalcAffinityPlan(numPartitions, partitionIndex);
+
+		std::lock_guard<spring::mutex> lock(affinityPlanMutex);
+		affinityPlan = plan;
+		haveAffinityPlan = true;
+		return plan;
+	}
+
+	AffinityPlan GetAffinityPlan()
+	{
+		{
+			std::lock_guard<spring::mutex> lock(affinityPlanMutex);
+
+			if (haveAffinityPlan)
+				return affinityPlan;
+		}
+
+		const AffinityPlan plan = CalcAffinityPlan(1, 0);
+
+		// an explicit PlanAffinity call in the meantime takes precedence
+		std::lock_guard<spring::mutex> lock(affinityPlanMutex);
+
+		if (!haveAffinityPlan) {
+			affinityPlan = plan;
+			haveAffinityPlan = true;
+		}
+
+		return affinityPlan;
+	}
+
+
 	int GetLogicalCpuCores() {
 		// auto-detect number of system threads (including hyperthreading)
 		//return spring::thread::hardware_concurrency();
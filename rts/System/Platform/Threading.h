@@ -109,13 +109,58 @@ namespace Threading {
 	 *
 	 * Interpret <cores_bitmask> as a bit-mask indicating on which of the
 	 * available system CPU's (which are numbered logically from 1 to N) we
-	 * want to run. Note that this approach will fail when N > 32.
+	 * want to run. Note that this approach will fail when N > 64.
 	 */
 	void DetectCores();
-	std::uint32_t GetAffinity();
-	std::uint32_t SetAffinity(std::uint32_t cores_bitmask, bool hard = true);
-	void SetAffinityHelper(const char* threadName, std::uint32_t affinity);
-	std::uint32_t GetAvailableCoresMask();
+	std::uint64_t GetAffinity();
+	std::uint64_t SetAffinity(std::uint64_t cores_bitmask, bool hard = true);
+	void SetAffinityHelper(const char* threadName, std::uint64_t affinity);
+	std::uint64_t GetAvailableCoresMask();
+
+
+	/**
+	 * Where the engine's long-lived threads should run, derived from the
+	 * L3 cache domains reported by CpuID (which on current multi-socket
+	 * hosts never straddle a NUMA node).
+	 *
+	 * The main (sim) thread gets one physical core and the pool workers the
+	 * remaining cores of the same L3 domain, so that sim data stays within
+	 * one last-level cache. Netcode, loading and async pool threads go to
+	 * auxCores, which avoids that domain whenever the host has another one.
+	 * Every mask is a subset of partitionCores, this instance's share of
+	 * the host when several engines run side by side.
+	 */
+	struct AffinityPlan {
+		std::uint64_t partitionCores = ~std::uint64_t(0);
+		std::uint64_t simDomainCores = ~std::uint64_t(0);
+		std::uint64_t mainCores      = ~std::uint64_t(0);
+		std::uint64_t workerCores    = ~std::uint64_t(0);
+		std::uint64_t auxCores       = ~std::uint64_t(0);
+
+		// logical cpus for pinned workers, one per physical core before any SMT sibling
+		std::uint8_t workerCpus[64] = {};
+		int numWorkerCpus = 0;
+
+		// single cpu for worker <index>; workers beyond numWorkerCpus float over workerCores
+		std::uint64_t GetWorkerCore(int index) const {
+			if (index < 0 || index >= numWorkerCpus)
+				return workerCores;
+
+			return (std::uint64_t(1) << workerCpus[index]);
+		}
+	};
+
+	/**
+	 * (Re)computes the plan for partition <partitionIndex> out of
+	 * <numPartitions> equal shares of the host; shares follow L3 domain
+	 * boundaries when there are at least as many domains as partitions,
+	 * otherwise domains are split along physical cores. numPartitions <= 1
+	 * plans for the whole host. Safe to call from any thread, the plan is
+	 * published once it is complete.
+	 */
+	AffinityPlan PlanAffinity(int numPartitions = 1, int partitionIndex = 0);
+	// returns a copy of the last plan, computing a whole-host plan on first use
+	AffinityPlan GetAffinityPlan();
 
 	/**
 	 * returns count of cpu cores/ hyperthreadings cores
@@ -0,0 +1,171 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SPRING_RADIX_SORT_H
+#define SPRING_RADIX_SORT_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace spring {
+	// sort-key helpers; keys are compared as unsigned integers, ascending
+
+	// maps a float onto an unsigned int with the same ordering (-0 sorts before +0)
+	static inline uint32_t FloatToOrderedKey(float f) {
+		uint32_t u;
+		std::memcpy(&u, &f, sizeof(u));
+		return (u ^ ((u >> 31) != 0 ? 0xFFFFFFFFu : 0x80000000u));
+	}
+	static inline uint32_t IntToOrderedKey(int32_t i) {
+		return (static_cast<uint32_t>(i) ^ 0x80000000u);
+	}
+
+
+	// runs f(i) for i in [0, n); the default runs serially, callers can pass
+	// e.g. a for_mt wrapper instead. f must tolerate concurrent invocations
+	struct SerialFor {
+		template<typename F> void operator () (int n, F&& f) const {
+			for (int i = 0; i < n; i++) {
+				f(i);
+			}
+		}
+	};
+
+
+	/**
+	 * Stable LSD radix sort of <n> items by the 64-bit unsigned key that
+	 * <keyFunc> returns for each (which should be a cheap member read, it
+	 * is evaluated twice per item per pass). <scratch> must hold at least
+	 * n items; the result always ends up in <items>.
+	 *
+	 * Sorts one byte per pass and skips every byte that is the same across
+	 * all keys, so e.g. keys whose low byte is zeroed by quantization or
+	 * whose upper half is constant cost fewer passes. Each pass splits the
+	 * input into <numChunks> contiguous runs which are histogrammed and then
+	 * scattered through <parFor>; since every run scatters to precomputed
+	 * per-bucket offsets the result does not depend on numChunks.
+	 */
+	template<typename T, typename KeyFunc, typename ParallelFor = SerialFor>
+	void RadixSort(T* items, T* scratch, size_t n, KeyFunc&& keyFunc, int numChunks = 1, ParallelFor&& parFor = {}) {
+		constexpr int RADIX_BITS = 8;
+		constexpr int NUM_BUCKETS = 1 << RADIX_BITS;
+		constexpr int NUM_PASSES = 64 / RADIX_BITS;
+
+		if (n <= 1)
+			return;
+
+		uint64_t keyBitsSet = 0;
+		uint64_t keyBitsClr = 0;
+
+		for (size_t i = 0; i < n; i++) {
+			keyBitsSet |=  keyFunc(items[i]);
+			keyBitsClr |= ~keyFunc(items[i]);
+		}
+
+		// bits that are not the same in every key
+		const uint64_t keyBitsDiff = keyBitsSet & keyBitsClr;
+
+		numChunks = std::clamp(numChunks, 1, static_cast<int>(std::min(n, size_t(256))));
+
+		using Histogram = std::array<size_t, NUM_BUCKETS>;
+
+		std::vector<Histogram> histograms(numChunks);
+
+		T* src = items;
+		T* dst = scratch;
+
+		const auto ChunkBeg = [&](int c) { return ((c    ) * n) / numChunks; };
+		const auto ChunkEnd = [&](int c) { return ((c + 1) * n) / numChunks; };
+
+		for (int pass = 0; pass < NUM_PASSES; pass++) {
+			const int shift = pass * RADIX_BITS;
+
+			if (((keyBitsDiff >> shift) & (NUM_BUCKETS - 1)) == 0)
+				continue;
+
+			parFor(numChunks, [&](int c) {
+				Histogram& hist = histograms[c];
+
+				hist.fill(0);
+
+				for (size_t i = ChunkBeg(c), e = ChunkEnd(c); i < e; i++) {
+					hist[(keyFunc(src[i]) >> shift) & (NUM_BUCKETS - 1)]++;
+				}
+			});
+
+			// turn counts into scatter offsets, bucket-major so that chunk c
+			// writes after chunks [0, c) within every bucket (stability)
+			for (size_t b = 0, offset = 0; b < NUM_BUCKETS; b++) {
+				for (int c = 0; c < numChunks; c++) {
+					const size_t count = histograms[c][b];
+
+					histograms[c][b] = offset;
+					offset += count;
+				}
+			}
+
+			parFor(numChunks, [&](int c) {
+				Histogram& offsets = histograms[c];
+
+				for (size_t i = ChunkBeg(c), e = ChunkEnd(c); i < e; i++) {
+					dst[offsets[(keyFunc(src[i]) >> shift) & (NUM_BUCKETS - 1)]++] = std::move(src[i]);
+				}
+			});
+
+			std::swap(src, dst);
+		}
+
+		if (src == items)
+			return;
+
+		parFor(numChunks, [&](int c) {
+			std::move(src + ChunkBeg(c), src + ChunkEnd(c), items + ChunkBeg(c));
+		});
+	}
+
+	template<typename T, typename KeyFunc, typename ParallelFor = SerialFor>
+	void RadixSort(std::vector<T>& items, std::vector<T>& scratch, KeyFunc&& keyFunc, int numChunks = 1, ParallelFor&& parFor = {}) {
+		scratch.resize(items.size());
+		RadixSort(items.data(), scratch.data(), items.size(), std::forward<KeyFunc>(keyFunc), numChunks, std::forward<ParallelFor>(parFor));
+	}
+
+
+	/**
+	 * Stable insertion sort by the same keys as RadixSort, for input that is
+	 * already nearly in order (e.g. last frame's order). Gives up as soon as
+	 * more than <maxMoves> single-slot moves were needed and returns false,
+	 * leaving <items> a permutation of the input that is only partly sorted.
+	 */
+	template<typename T, typename KeyFunc>
+	bool InsertionSortBounded(T* items, size_t n, size_t maxMoves, KeyFunc&& keyFunc) {
+		size_t numMoves = 0;
+
+		for (size_t i = 1; i < n; i++) {
+			const uint64_t key = keyFunc(items[i]);
+
+			if (keyFunc(items[i - 1]) <= key)
+				continue;
+
+			T item = std::move(items[i]);
+			size_t j = i;
+
+			for (; j > 0 && keyFunc(items[j - 1]) > key; j--) {
+				items[j] = std::move(items[j - 1]);
+			}
+
+			items[j] = std::move(item);
+
+			if ((numMoves += (i - j)) > maxMoves)
+				return false;
+		}
+
+		return true;
+	}
+}
+
+#endif
@@ -27,6 +27,24 @@ struct SRectangle {
 	int GetHeight() const { return z2 - z1; }
 	int GetArea() const { return (GetWidth() * GetHeight()); }
 
+	bool Empty() const { return (x2 <= x1 || z2 <= z1); }
+
+	// grows *this to the bounding rectangle of both; empty ones are ignored
+	void Merge(const SRectangle& rect) {
+		if (rect.Empty())
+			return;
+
+		if (Empty()) {
+			*this = rect;
+			return;
+		}
+
+		x1 = std::min(x1, rect.x1);
+		z1 = std::min(z1, rect.z1);
+		x2 = std::max(x2, rect.x2);
+		z2 = std::max(z2, rect.z2);
+	}
+
 	int OverlapArea(SRectangle&& with) const;
 	int OverlapArea(const SRectangle& with) const;
 
@@ -42,6 +42,7 @@
 #include "Game/UI/ScanCodes.h"
 #include "Game/UI/InfoConsole.h"
 #include "Game/UI/MouseHandler.h"
+#include "Lua/LuaAllocState.h"
 #include "Lua/LuaOpenGL.h"
 #include "Lua/LuaVFSDownload.h"
 #include "Menu/LuaMenuController.h"
@@ -86,10 +87,12 @@
 #include "System/Input/KeyInput.h"
 #include "System/Input/MouseInput.h"
 #include "System/LoadSave/LoadSaveHandler.h"
+#include "System/Log/Backend.h"
 #include "System/Log/ConsoleSink.h"
 #include "System/Log/ILog.h"
 #include "System/Log/DefaultFilter.h"
 #include "System/LogOutput.h"
+#include "System/MemAccounting.h"
 #include "System/Platform/errorhandler.h"
 #include "System/Platform/CrashHandler.h"
 #include "System/Platform/Threading.h"
@@ -101,6 +104,7 @@
 #include "Game/UnsyncedGameCommands.h"
 #include "Game/SyncedGameCommands.h"
 #include "lib/luasocket/src/restrictions.h"
+#include "lib/lua/include/LuaUser.h" // spring_lua_alloc_get_stats
 
 
 
@@ -226,6 +230,13 @@ bool SpringApp::Init()
 {
 	SpringMath::Init();
 	LuaMemPool::InitStatic(configHandler->GetBool("UseLuaMemPools"));
+	MemAccounting::RegisterGauge("Lua", [](MemAccounting::GaugeSample& sample) {
+		SLuaAllocState state = {{0}, {0}, {0}, {0}};
+		spring_lua_alloc_get_stats(&state);
+
+		sample.liveBytes = state.allocedBytes.load();
+		sample.numAllocs = state.numLuaAllocs.load();
+	});
 
 	CGlobalRendering::InitStatic();
 	globalRendering->SetFullScreen(FLAGS_window, FLAGS_fullscreen);
@@ -834,6 +845,8 @@ bool SpringApp::Update()
 	bool swap = true;
 
 	configHandler->Update();
+	CTimeProfiler::GetInstance().MergeThreadRecords();
+	MemAccounting::Update();
 	globalRendering->UpdateWindow();
 	globalRendering->UpdateTimer();
 
@@ -1018,6 +1031,9 @@ void SpringApp::Kill(bool fromRun)
 	Watchdog::Uninstall();
 	LOG("[SpringApp::%s][9]", __func__);
 
+	// drain and join the async log writer while all sinks still exist
+	log_backend_setAsync(false);
+
 	killedCount -= 1;
 }
 
@@ -0,0 +1,446 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _SPRING_FLAT_HASH_TABLE_H_
+#define _SPRING_FLAT_HASH_TABLE_H_
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SPRING_FLAT_HASH_SSE2
+	#include <emmintrin.h>
+#endif
+
+/**
+ * Open-addressing hash tables with a separate, densely packed value array.
+ *
+ * Elements live in a std::vector in insertion order; the index table only
+ * holds one control byte (7 bits of the hash, or EMPTY / DELETED) and one
+ * 32-bit element index per slot. Lookups compare a whole group of sixteen
+ * control bytes at once (one SSE2 compare where available) and touch the
+ * elements themselves only for candidates whose tag matches.
+ *
+ * Iteration walks the element vector, so its order depends solely on the
+ * sequence of inserts and erases and never on hash values or capacity: it
+ * is deterministic across platforms and independent of reserve or clear,
+ * which makes these tables safe to iterate in synced code even with an
+ * unsynced hasher. Erasing moves the last element into the hole.
+ *
+ * Like emilib's HashMap, pointers and iterators are invalidated by insert
+ * and erase, and there is no multimap.
+ */
+namespace spring {
+	namespace flat_hash_detail {
+		static constexpr size_t GROUP_SIZE = 16;
+		static constexpr size_t MIN_CAPACITY = GROUP_SIZE;
+
+		// full slots store the low 7 bits of the hash, i.e. are non-negative
+		static constexpr int8_t CTRL_EMPTY   = -128;
+		static constexpr int8_t CTRL_DELETED = -2;
+
+		struct Group {
+		public:
+			explicit Group(const int8_t* p) {
+			#ifdef SPRING_FLAT_HASH_SSE2
+				ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			#else
+				for (size_t i = 0; i < GROUP_SIZE; i++) { ctrl[i] = p[i]; }
+			#endif
+			}
+
+			// bit i is set if the i-th control byte equals <tag>
+			uint32_t Match(int8_t tag) const {
+			#ifdef SPRING_FLAT_HASH_SSE2
+				return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), ctrl)));
+			#else
+				uint32_t mask = 0;
+				for (size_t i = 0; i < GROUP_SIZE; i++) { mask |= (uint32_t(ctrl[i] == tag) << i); }
+				return mask;
+			#endif
+			}
+
+			uint32_t MatchEmpty() const { return (Match(CTRL_EMPTY)); }
+			uint32_t MatchEmptyOrDeleted() const {
+			#ifdef SPRING_FLAT_HASH_SSE2
+				// both special values are less than -1, full tags are not
+				return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmplt_epi8(ctrl, _mm_set1_epi8(-1))));
+			#else
+				uint32_t mask = 0;
+				for (size_t i = 0; i < GROUP_SIZE; i++) { mask |= (uint32_t(ctrl[i] < -1) << i); }
+				return mask;
+			#endif
+			}
+
+		private:
+		#ifdef SPRING_FLAT_HASH_SSE2
+			__m128i ctrl;
+		#else
+			int8_t ctrl[GROUP_SIZE];
+		#endif
+		};
+
+		// spreads weak (e.g. identity) hashes over all bits; the high bits pick the slot
+		inline uint64_t MixHash(uint64_t h) {
+			h *= 0x9E3779B97F4A7C15ull;
+			return (h ^ (h >> 32));
+		}
+
+		struct MapKeyOf {
+			template<typename P> const auto& operator()(const P& p) const { return p.first; }
+		};
+		struct SetKeyOf {
+			template<typename K> const K& operator()(const K& k) const { return k; }
+		};
+	};
+
+
+	template<typename K, typename T, typename KeyOf, typename H, typename C>
+	class FlatHashTable {
+	public:
+		typedef K key_type;
+		typedef T value_type;
+		typedef size_t size_type;
+
+		typedef typename std::vector<T>::iterator iterator;
+		typedef typename std::vector<T>::const_iterator const_iterator;
+
+		FlatHashTable() = default;
+		FlatHashTable(size_t numElems) { reserve(numElems); }
+		FlatHashTable(const FlatHashTable& t) = default;
+		FlatHashTable(FlatHashTable&& t) noexcept { swap(t); }
+
+		FlatHashTable& operator = (const FlatHashTable& t) = default;
+		FlatHashTable& operator = (FlatHashTable&& t) noexcept { swap(t); return *this; }
+
+		void swap(FlatHashTable& t) noexcept {
+			std::swap(values, t.values);
+			std::swap(ctrlBytes, t.ctrlBytes);
+			std::swap(slotIndices, t.slotIndices);
+			std::swap(slotMask, t.slotMask);
+			std::swap(growthLeft, t.growthLeft);
+			std::swap(hasher, t.hasher);
+			std::swap(comparator, t.comparator);
+		}
+
+		iterator begin() { return values.begin(); }
+		iterator end() { return values.end(); }
+		const_iterator begin() const { return values.begin(); }
+		const_iterator end() const { return values.end(); }
+		const_iterator cbegin() const { return values.cbegin(); }
+		const_iterator cend() const { return values.cend(); }
+
+		// elements in iteration order
+		const std::vector<T>& data() const { return values; }
+
+		size_t size() const { return values.size(); }
+		size_t capacity() const { return slotIndices.size(); }
+		bool empty() const { return values.empty(); }
+
+		// bytes owned by the table, including the unused slots
+		size_t memory_usage() const {
+			return (values.capacity() * sizeof(T) + ctrlBytes.capacity() + slotIndices.capacity() * sizeof(uint32_t));
+		}
+
+
+		iterator find(const K& key) {
+			const size_t slot = FindSlot(key, HashKey(key));
+			return ((slot == NO_SLOT)? end(): (begin() + slotIndices[slot]));
+		}
+		const_iterator find(const K& key) const {
+			const size_t slot = FindSlot(key, HashKey(key));
+			return ((slot == NO_SLOT)? end(): (begin() + slotIndices[slot]));
+		}
+
+		bool contains(const K& key) const { return (FindSlot(key, HashKey(key)) != NO_SLOT); }
+		size_t count(const K& key) const { return (contains(key)); }
+
+
+		size_t erase(const K& key) {
+			const size_t slot = FindSlot(key, HashKey(key));
+
+			if (slot == NO_SLOT)
+				return 0;
+
+			EraseSlot(slot);
+			return 1;
+		}
+
+		// returns an iterator to the element that took the place of <it> (or end())
+		iterator erase(const_iterator it) {
+			const size_t index = it - values.cbegin();
+			const size_t slot = FindIndexSlot(HashKey(KeyOf()(*it)), index);
+
+			EraseSlot(slot);
+			return (begin() + index);
+		}
+
+		// keeps the index table allocated; iteration order is unaffected by capacity
+		void clear() {
+			values.clear();
+
+			if (ctrlBytes.empty())
+				return;
+
+			std::fill(ctrlBytes.begin(), ctrlBytes.end(), flat_hash_detail::CTRL_EMPTY);
+			growthLeft = GrowthCapacity(capacity());
+		}
+
+		void reserve(size_t numElems) {
+			values.reserve(numElems);
+
+			if (numElems <= GrowthCapacity(capacity()))
+				return;
+
+			size_t numSlots = flat_hash_detail::MIN_CAPACITY;
+
+			while (GrowthCapacity(numSlots) < numElems)
+				numSlots <<= 1;
+
+			Rehash(numSlots);
+		}
+
+	protected:
+		static constexpr size_t NO_SLOT = size_t(-1);
+
+		// maximum load factor of 7/8
+		static size_t GrowthCapacity(size_t numSlots) { return (numSlots - numSlots / 8); }
+
+		uint64_t HashKey(const K& key) const { return (flat_hash_detail::MixHash(hasher(key))); }
+
+		static int8_t HashTag(uint64_t hash) { return (static_cast<int8_t>(hash & 0x7F)); }
+		size_t HashPos(uint64_t hash) const { return ((hash >> 7) & slotMask); }
+
+		void SetCtrl(size_t slot, int8_t ctrl) {
+			ctrlBytes[slot] = ctrl;
+
+			// mirror the first group past the end so unaligned group loads never wrap
+			if (slot < flat_hash_detail::GROUP_SIZE)
+				ctrlBytes[capacity() + slot] = ctrl;
+		}
+
+		// groups are probed quadratically, which visits all of them for power-of-two capacities
+		template<typename F> size_t Probe(uint64_t hash, F&& f) const {
+			size_t pos = HashPos(hash);
+
+			for (size_t step = flat_hash_detail::GROUP_SIZE; ; step += flat_hash_detail::GROUP_SIZE) {
+				const flat_hash_detail::Group group(&ctrlBytes[pos]);
+				const size_t slot = f(group, pos);
+
+				if (slot != NO_SLOT)
+					return slot;
+				if (group.MatchEmpty() != 0)
+					return NO_SLOT;
+
+				pos = (pos + step) & slotMask;
+			}
+		}
+
+		size_t FindSlot(const K& key, uint64_t hash) const {
+			if (values.empty())
+				return NO_SLOT;
+
+			return (Probe(hash, [&](const flat_hash_detail::Group& group, size_t pos) {
+				for (uint32_t m = group.Match(HashTag(hash)); m != 0; m &= (m - 1)) {
+					const size_t slot = (pos + std::countr_zero(m)) & slotMask;
+
+					if (comparator(KeyOf()(values[slotIndices[slot]]), key))
+						return slot;
+				}
+
+				return NO_SLOT;
+			}));
+		}
+
+		// finds the slot referring to element <index> without comparing any keys
+		size_t FindIndexSlot(uint64_t hash, size_t index) const {
+			const size_t slot = Probe(hash, [&](const flat_hash_detail::Group& group, size_t pos) {
+				for (uint32_t m = group.Match(HashTag(hash)); m != 0; m &= (m - 1)) {
+					const size_t slot = (pos + std::countr_zero(m)) & slotMask;
+
+					if (slotIndices[slot] == index)
+						return slot;
+				}
+
+				return NO_SLOT;
+			});
+
+			assert(slot != NO_SLOT);
+			return slot;
+		}
+
+		size_t FindFreeSlot(uint64_t hash) const {
+			size_t pos = HashPos(hash);
+
+			for (size_t step = flat_hash_detail::GROUP_SIZE; ; step += flat_hash_detail::GROUP_SIZE) {
+				const uint32_t m = flat_hash_detail::Group(&ctrlBytes[pos]).MatchEmptyOrDeleted();
+
+				if (m != 0)
+					return ((pos + std::countr_zero(m)) & slotMask);
+
+				pos = (pos + step) & slotMask;
+			}
+		}
+
+		// claims a slot for a key known to be absent; the caller appends the element
+		void PrepareInsert(uint64_t hash) {
+			if (growthLeft == 0) {
+				// tombstones can eat up all growth, rebuild in place if they dominate
+				if (values.size() <= GrowthCapacity(capacity()) / 2) {
+					Rehash(std::max(capacity(), flat_hash_detail::MIN_CAPACITY));
+				} else {
+					Rehash(capacity() * 2);
+				}
+			}
+
+			size_t slot = FindFreeSlot(hash);
+
+			// reusing a tombstone costs no growth
+			growthLeft -= (ctrlBytes[slot] == flat_hash_detail::CTRL_EMPTY);
+
+			SetCtrl(slot, HashTag(hash));
+			slotIndices[slot] = static_cast<uint32_t>(values.size());
+		}
+
+		void EraseSlot(size_t slot) {
+			const size_t index = slotIndices[slot];
+			const size_t lastIndex = values.size() - 1;
+
+			SetCtrl(slot, flat_hash_detail::CTRL_DELETED);
+
+			if (index != lastIndex) {
+				slotIndices[FindIndexSlot(HashKey(KeyOf()(values[lastIndex])), lastIndex)] = static_cast<uint32_t>(index);
+				values[index] = std::move(values[lastIndex]);
+			}
+
+			values.pop_back();
+		}
+
+		void Rehash(size_t numSlots) {
+			assert(std::has_single_bit(numSlots));
+			assert(values.size() <= GrowthCapacity(numSlots));
+
+			ctrlBytes.assign(numSlots + flat_hash_detail::GROUP_SIZE, flat_hash_detail::CTRL_EMPTY);
+			slotIndices.resize(numSlots);
+
+			slotMask = numSlots - 1;
+			growthLeft = GrowthCapacity(numSlots) - values.size();
+
+			for (size_t i = 0, n = values.size(); i < n; i++) {
+				const uint64_t hash = HashKey(KeyOf()(values[i]));
+				const size_t slot = FindFreeSlot(hash);
+
+				SetCtrl(slot, HashTag(hash));
+				slotIndices[slot] = static_cast<uint32_t>(i);
+			}
+		}
+
+		template<typename... A> std::pair<iterator, bool> EmplaceKey(const K& key, A&&... args) {
+			const uint64_t hash = HashKey(key);
+			const size_t slot = FindSlot(key, hash);
+
+			if (slot != NO_SLOT)
+				return {begin() + slotIndices[slot], false};
+
+			PrepareInsert(hash);
+			values.emplace_back(std::forward<A>(args)...);
+			return {end() - 1, true};
+		}
+
+	protected:
+		std::vector<T> values;
+
+		// capacity() + GROUP_SIZE bytes, the tail mirrors the first group
+		std::vector<int8_t> ctrlBytes;
+		std::vector<uint32_t> slotIndices;
+
+		size_t slotMask = 0;
+		size_t growthLeft = 0;
+
+		H hasher;
+		C comparator;
+	};
+
+
+	template<typename K, typename V, typename H, typename C = std::equal_to<K>>
+	class FlatHashMap: public FlatHashTable<K, std::pair<K, V>, flat_hash_detail::MapKeyOf, H, C> {
+	public:
+		typedef FlatHashTable<K, std::pair<K, V>, flat_hash_detail::MapKeyOf, H, C> BaseType;
+		typedef V mapped_type;
+		typedef typename BaseType::iterator iterator;
+		typedef typename BaseType::const_iterator const_iterator;
+
+		using BaseType::BaseType;
+
+		FlatHashMap() = default;
+		FlatHashMap(const std::initializer_list< std::pair<K, V> >& l) {
+			this->reserve(l.size());
+
+			for (const auto& pair: l) {
+				insert(pair.first, pair.second);
+			}
+		}
+
+		std::pair<iterator, bool> insert(const std::pair<K, V>& p) { return (this->EmplaceKey(p.first, p)); }
+		std::pair<iterator, bool> insert(std::pair<K, V>&& p) { return (this->EmplaceKey(p.first, std::move(p))); }
+		std::pair<iterator, bool> insert(const K& key, const V& val) { return (this->EmplaceKey(key, key, val)); }
+
+		template<typename... A> std::pair<iterator, bool> emplace(const K& key, A&&... args) {
+			return (this->EmplaceKey(key, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<A>(args)...)));
+		}
+		template<typename... A> std::pair<iterator, bool> try_emplace(const K& key, A&&... args) {
+			return (emplace(key, std::forward<A>(args)...));
+		}
+
+		V& operator [] (const K& key) { return ((emplace(key).first)->second); }
+
+		V* try_get(const K& key) {
+			const auto it = this->find(key);
+			return ((it == this->end())? nullptr: &it->second);
+		}
+		const V* try_get(const K& key) const {
+			const auto it = this->find(key);
+			return ((it == this->end())? nullptr: &it->second);
+		}
+	};
+
+	template<typename K, typename H, typename C = std::equal_to<K>>
+	class FlatHashSet: public FlatHashTable<K, K, flat_hash_detail::SetKeyOf, H, C> {
+	public:
+		typedef FlatHashTable<K, K, flat_hash_detail::SetKeyOf, H, C> BaseType;
+		// keys must not be modified through iterators
+		typedef typename BaseType::const_iterator iterator;
+		typedef typename BaseType::const_iterator const_iterator;
+
+		using BaseType::BaseType;
+
+		FlatHashSet() = default;
+		FlatHashSet(const std::initializer_list<K>& l) {
+			this->reserve(l.size());
+
+			for (const K& key: l) {
+				insert(key);
+			}
+		}
+
+		const_iterator begin() const { return (BaseType::cbegin()); }
+		const_iterator end() const { return (BaseType::cend()); }
+
+		std::pair<iterator, bool> insert(const K& key) { return (this->EmplaceKey(key, key)); }
+		// <key> is only moved from once the lookup is done
+		std::pair<iterator, bool> insert(K&& key) { return (this->EmplaceKey(key, std::move(key))); }
+		std::pair<iterator, bool> emplace(const K& key) { return (insert(key)); }
+
+		const_iterator find(const K& key) const { return (BaseType::find(key)); }
+		iterator erase(const_iterator it) { return (BaseType::erase(it)); }
+		size_t erase(const K& key) { return (BaseType::erase(key)); }
+	};
+};
+
+#endif
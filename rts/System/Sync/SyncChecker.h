@@ -30,6 +30,8 @@ class CSyncChecker {
 		 */
 		static unsigned GetChecksum() { return g_checksum; }
 		static void NewFrame() { g_checksum = 0xfade1eaf; }
+		/// continue the running checksum of a game state that was loaded mid-frame-sequence
+		static void SetChecksum(unsigned checksum) { g_checksum = checksum; }
 		static void debugSyncCheckThreading();
 		static void Sync(const void* p, unsigned size) {
 #ifdef DEBUG_SYNC_MT_CHECK
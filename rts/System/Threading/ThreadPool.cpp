@@ -12,11 +12,13 @@
 #include "System/StringUtil.h"
 #ifndef UNIT_TEST
 	#include "System/Config/ConfigHandler.h"
+	#include "System/GlobalConfig.h"
 #endif
 #include "System/Log/ILog.h"
 #include "System/Platform/CpuID.h"
 #include "System/Platform/Threading.h"
 #include "System/Threading/SpringThreading.h"
+#include "System/Threading/WorkStealingDeque.h"
 
 #ifdef   likely
 #undef   likely
@@ -57,6 +59,21 @@ struct ThreadStats {
 };
 
 
+// sub-range of a for_mt job, in iteration-space [beg, end)
+struct RangeTask {
+	ThreadPool::RangeJob* job;
+
+	int beg;
+	int end;
+};
+
+typedef WorkStealingDeque<RangeTask, 256> RangeTaskDeque;
+
+// deques which can be claimed for the duration of a for_mt call by any thread
+// that is not a sync worker (the main thread, async workers, loading threads,
+// ...); if all are in use the caller runs its loop serially
+static constexpr int NUM_EXTERNAL_RANGE_DEQUES = 8;
+
 
 // external background threads which are only joined on exit
 static std::vector< spring::thread > extThreads;
@@ -64,22 +81,45 @@ static std::vector< std::future<void> > extFutures;
 
 bool ThreadPool::inMultiThreadedSection;
 
+// all per-thread storage below is allocated once for GetMaxThreads() entries
+// when the first workers are spawned, and never reallocated afterwards
+static int numThreadSlots = 0;
+
 // global [idx = 0] and smaller per-thread [idx > 0] queues; the latter are
 // for tasks that want to execute on specific threads, e.g. parallel_reduce
 // note: std::shared_ptr<T> can not be made atomic, queues must store T*'s
 #ifdef USE_BOOST_LOCKFREE_QUEUE
-static std::array<boost::lockfree::queue<ITaskGroup*>, ThreadPool::MAX_THREADS> taskQueues[2];
+static std::unique_ptr<boost::lockfree::queue<ITaskGroup*>[]> taskQueues[2];
 #else
-static std::array<moodycamel::ConcurrentQueue<ITaskGroup*>, ThreadPool::MAX_THREADS> taskQueues[2];
+static std::unique_ptr<moodycamel::ConcurrentQueue<ITaskGroup*>[]> taskQueues[2];
 #endif
 
+// [0, numThreadSlots) are owned by sync workers (entry 0 is free for claiming
+// since the main thread is not a worker), the remaining ones by other threads
+// while they are inside a for_mt call
+static std::unique_ptr<RangeTaskDeque[]> rangeTaskDeques;
+static std::unique_ptr<std::atomic_bool[]> rangeDequeClaims;
+static int numRangeDeques = 0;
+
 static std::vector<void*> workerThreads[2];
-static std::array<bool, ThreadPool::MAX_THREADS> exitFlags;
-static std::array<ThreadStats, ThreadPool::MAX_THREADS> threadStats[2];
+static std::unique_ptr<std::atomic_bool[]> exitFlags;
+static std::vector<ThreadStats> threadStats[2];
 static spring::signal newTasksSignal[2];
+// cpus async workers bind themselves to, see SetDefaultThreadCount
+static std::atomic<std::uint64_t> asyncWorkerCores = {0};
 
 static _threadlocal int threadnum(0);
 
+struct LocalRangeDeque {
+	int index = -1;
+	int depth = 0; // for_mt nesting level of claimed deques
+
+	bool claimed = false;
+};
+
+static thread_local LocalRangeDeque localRangeDeque;
+static thread_local uint32_t stealSeed = 0;
+
 #ifndef UNITSYNC
 // if enabled, allows OpenGL calls from ThreadPool tasks
 // so certain logic (e.g. loading models) can be written
@@ -132,6 +172,188 @@ int GetMaxThreads() { return std::min(MAX_THREADS, Threading::GetLogicalCpuCores
 bool HasThreads() { return !workerThreads[false].empty(); }
 
 
+static void InitThreadSlots()
+{
+	if (numThreadSlots != 0)
+		return;
+
+	numThreadSlots = GetMaxThreads();
+	numRangeDeques = numThreadSlots + NUM_EXTERNAL_RANGE_DEQUES;
+
+	#ifdef USE_BOOST_LOCKFREE_QUEUE
+	taskQueues[false] = std::make_unique<boost::lockfree::queue<ITaskGroup*>[]>(numThreadSlots);
+	taskQueues[ true] = std::make_unique<boost::lockfree::queue<ITaskGroup*>[]>(numThreadSlots);
+	#else
+	taskQueues[false] = std::make_unique<moodycamel::ConcurrentQueue<ITaskGroup*>[]>(numThreadSlots);
+	taskQueues[ true] = std::make_unique<moodycamel::ConcurrentQueue<ITaskGroup*>[]>(numThreadSlots);
+	#endif
+
+	rangeTaskDeques = std::make_unique<RangeTaskDeque[]>(numRangeDeques);
+	rangeDequeClaims = std::make_unique<std::atomic_bool[]>(numRangeDeques);
+	exitFlags = std::make_unique<std::atomic_bool[]>(numThreadSlots);
+
+	for (int i = 0; i < numRangeDeques; i++) {
+		// worker deques are bound directly, never claimed
+		rangeDequeClaims[i].store(i > 0 && i < numThreadSlots);
+	}
+	for (int i = 0; i < numThreadSlots; i++) {
+		exitFlags[i].store(false);
+	}
+
+	threadStats[false].resize(numThreadSlots);
+	threadStats[ true].resize(numThreadSlots);
+}
+
+
+static RangeTaskDeque* GetLocalRangeDeque()
+{
+	const LocalRangeDeque& lrd = localRangeDeque;
+
+	if (lrd.index < 0)
+		return nullptr;
+
+	return &rangeTaskDeques[lrd.index];
+}
+
+static RangeTaskDeque* ClaimLocalRangeDeque()
+{
+	LocalRangeDeque& lrd = localRangeDeque;
+
+	if (lrd.index >= 0) {
+		lrd.depth += lrd.claimed;
+		return &rangeTaskDeques[lrd.index];
+	}
+
+	for (int i = 0; i < numRangeDeques; i++) {
+		if (rangeDequeClaims[i].load(std::memory_order_relaxed))
+			continue;
+		if (rangeDequeClaims[i].exchange(true, std::memory_order_acquire))
+			continue;
+
+		lrd.index = i;
+		lrd.depth = 1;
+		lrd.claimed = true;
+		return &rangeTaskDeques[i];
+	}
+
+	return nullptr;
+}
+
+static void ReleaseLocalRangeDeque()
+{
+	LocalRangeDeque& lrd = localRangeDeque;
+
+	if (!lrd.claimed)
+		return;
+	if ((lrd.depth -= 1) > 0)
+		return;
+
+	// every sub-range pushed by this thread has been run by the time the
+	// outermost for_mt returns, nothing can be left behind for thieves
+	assert(rangeTaskDeques[lrd.index].Empty());
+	rangeDequeClaims[lrd.index].store(false, std::memory_order_release);
+
+	lrd.index = -1;
+	lrd.claimed = false;
+}
+
+static void BindLocalRangeDeque(int tid)
+{
+	assert(tid > 0 && tid < numThreadSlots);
+	assert(localRangeDeque.index == -1);
+
+	localRangeDeque.index = tid;
+	localRangeDeque.claimed = false;
+}
+
+
+static void RunRangeTask(RangeTaskDeque* deque, RangeTask task)
+{
+	RangeJob& job = *task.job;
+
+	bool pushed = false;
+
+	// split off the upper halves (at grain boundaries) for others to steal
+	// and keep the lower one, until the remainder is small enough to run
+	while (deque != nullptr && (task.end - task.beg) > job.grain) {
+		const int numGrains = (task.end - task.beg + job.grain - 1) / job.grain;
+		const int mid = task.beg + (numGrains >> 1) * job.grain;
+
+		// deque is full, just run everything we have left
+		if (!deque->Push({task.job, mid, task.end}))
+			break;
+
+		task.end = mid;
+		pushed = true;
+	}
+
+	if (pushed)
+		NotifyWorkerThreads(false, false);
+
+	// nested calls made by <job> are attributed to the same scope as <job>
+	job.stats.RunChunk([&]() { job.execFunc(job, task.beg, task.end); });
+
+	// last access to <job>; its owner may return as soon as this reaches zero
+	job.remaining.fetch_sub(task.end - task.beg, std::memory_order_acq_rel);
+}
+
+static bool RunLocalRangeTasks(RangeTaskDeque* deque)
+{
+	RangeTask task;
+
+	if (deque == nullptr || !deque->Pop(task))
+		return false;
+
+	do {
+		RunRangeTask(deque, task);
+	} while (deque->Pop(task));
+
+	return true;
+}
+
+static bool StealRangeTask(RangeTaskDeque* deque)
+{
+	if (numRangeDeques == 0)
+		return false;
+
+	// xorshift, only used to spread thieves over victims
+	uint32_t& seed = stealSeed;
+
+	if (seed == 0)
+		seed = 0x9E3779B9u ^ static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&seed));
+
+	seed ^= (seed << 13);
+	seed ^= (seed >> 17);
+	seed ^= (seed <<  5);
+
+	const int offset = seed % numRangeDeques;
+
+	for (int i = 0; i < numRangeDeques; i++) {
+		RangeTaskDeque& victim = rangeTaskDeques[(offset + i) % numRangeDeques];
+		RangeTask task;
+
+		if (&victim == deque)
+			continue;
+		if (victim.Empty())
+			continue;
+		if (!victim.Steal(task))
+			continue;
+
+		// there is more where this came from, let sleeping workers help
+		if (!victim.Empty())
+			NotifyWorkerThreads(true, false);
+
+		// stolen tasks are split into our own deque, or run whole if we have none
+		RunRangeTask(deque, task);
+		RunLocalRangeTasks(deque);
+
+		return true;
+	}
+
+	return false;
+}
+
+
 
 static bool DoTask(int tid, bool async)
 {
@@ -141,6 +363,12 @@ static bool DoTask(int tid, bool async)
 
 	ITaskGroup* tg = nullptr;
 
+	// for_mt sub-ranges pushed by this thread itself take precedence; they
+	// are the most cache-friendly work and other threads may be waiting on
+	// them to finish
+	if (!async && RunLocalRangeTasks(GetLocalRangeDeque()))
+		return true;
+
 	// any external thread calling WaitForFinished will have
 	// id=0 and *only* processes tasks from the global queue
 	for (int idx = 0; idx <= tid; idx += std::max(tid, 1)) {
@@ -201,7 +429,11 @@ static bool DoTask(int tid, bool async)
 	}
 
 	// if true, queue contained at least one element
-	return (tg != nullptr);
+	if (tg != nullptr)
+		return true;
+
+	// nothing queued for us, try to take over part of another thread's for_mt
+	return (!async && StealRangeTask(GetLocalRangeDeque()));
 }
 
 
@@ -210,6 +442,10 @@ static void WorkerLoop(int tid, bool async)
 {
 	assert(tid != 0);
 	SetThreadNum(tid);
+
+	// async workers share their tid with a sync worker, claim on demand instead
+	if (!async)
+		BindLocalRangeDeque(tid);
 	#ifndef UNIT_TEST
 	Threading::SetThreadName(IntToString(tid, "worker%i"));
 	#endif
@@ -222,7 +458,13 @@ static void WorkerLoop(int tid, bool async)
 	const auto ourSpinTime = spring_time::fromMicroSecs(30 * (tid == 1));
 	const auto maxSleepTime = spring_time::fromMilliSecs(30);
 
+	std::uint64_t curAffinity = 0;
+
 	while (!exitFlags[tid]) {
+		// async workers are not pinned by SetDefaultThreadCount, they pick up the aux-mask themselves
+		if (async && curAffinity != asyncWorkerCores.load(std::memory_order_relaxed))
+			Threading::SetAffinity(curAffinity = asyncWorkerCores.load(std::memory_order_relaxed));
+
 		const auto spinlockEnd = spring_now() + ourSpinTime;
 		      auto sleepTime   = spring_time::fromMicroSecs(1);
 
@@ -294,6 +536,80 @@ void WaitForFinished(std::shared_ptr<ITaskGroup>&& taskGroup)
 }
 
 
+void ExecuteRangeJob(RangeJob& job, int numIters)
+{
+	RangeTaskDeque* deque = ClaimLocalRangeDeque();
+
+	const spring_time t0 = spring_now();
+	      spring_time t1 = spring_notime;
+
+	job.remaining.store(numIters, std::memory_order_relaxed);
+
+	// too many concurrent non-worker callers, can not split
+	if (deque == nullptr) {
+		RunRangeTask(nullptr, {&job, 0, numIters});
+		AddTaskStats(job.stats, spring_now() - t0, spring_notime);
+		return;
+	}
+
+	RunRangeTask(deque, {&job, 0, numIters});
+
+	if (job.remaining.load(std::memory_order_acquire) > 0) {
+		t1 = spring_now();
+
+		#ifndef UNIT_TEST
+		SCOPED_MT_TIMER("ThreadPool::WaitFor");
+		#endif
+
+		// help out until every sub-range has run, starting with those still
+		// in our own deque; other work is fine too since a nested for_mt is
+		// never waiting on its parent
+		const int tid = GetThreadNum();
+
+		while (job.remaining.load(std::memory_order_acquire) > 0) {
+			if (RunLocalRangeTasks(deque))
+				continue;
+			if (StealRangeTask(deque))
+				continue;
+
+			DoTask(tid, false);
+		}
+	}
+
+	ReleaseLocalRangeDeque();
+
+	const spring_time t2 = spring_now();
+
+	AddTaskStats(job.stats, t2 - t0, (t1 > spring_notime)? (t2 - t1): spring_notime);
+}
+
+
+void AddTaskStats(const TaskStats& stats, const spring_time wallTime, const spring_time waitTime)
+{
+	#if (!defined(UNITSYNC) && !defined(UNIT_TEST))
+	uint64_t sumBusyTime = 0;
+	uint64_t maxBusyTime = 0;
+
+	for (int i = 0; i < stats.numThreads; i++) {
+		const uint64_t busyTime = stats.busyTimes[i].load(std::memory_order_relaxed);
+
+		sumBusyTime += busyTime;
+		maxBusyTime = std::max(maxBusyTime, busyTime);
+	}
+
+	CTimeProfiler::GetInstance().AddTaskGroupStats(
+		stats.scopeHash,
+		stats.numChunks.load(std::memory_order_relaxed),
+		stats.numThreads,
+		wallTime,
+		spring_time::fromNanoSecs(sumBusyTime),
+		spring_time::fromNanoSecs(maxBusyTime),
+		waitTime
+	);
+	#endif
+}
+
+
 // WARNING:
 //   leaking the raw pointer *forces* caller to WaitForFinished
 //   otherwise task might get deleted while its pointer is still
@@ -417,42 +733,6 @@ static void KillThreads(int wantedNumThreads, int curNumThreads)
 }
 
 
-static std::uint32_t FindWorkerThreadCore(std::int32_t index, std::uint32_t availCores, std::uint32_t avoidCores)
-{
-	// find an unused core for worker-thread <index>
-	const auto FindCore = [&index](std::uint32_t targetCores) {
-		std::uint32_t workerCore = 1;
-		std::int32_t n = index;
-
-		while ((workerCore != 0) && !(workerCore & targetCores))
-			workerCore <<= 1;
-
-		// select n'th bit in targetCores
-		// counts down because hyper-thread cores are appended to the end
-		// and we prefer those for our worker threads (physical cores are
-		// preferred for task specific threads)
-		while (n--)
-			do workerCore <<= 1; while ((workerCore != 0) && !(workerCore & targetCores));
-
-		return workerCore;
-	};
-
-	const std::uint32_t threadAvailCore = FindCore(availCores);
-	const std::uint32_t threadAvoidCore = FindCore(avoidCores);
-
-	if (threadAvailCore != 0)
-		return threadAvailCore;
-	// select one of the main-thread cores if no others are available
-	if (threadAvoidCore != 0)
-		return threadAvoidCore;
-
-	// fallback; use all
-	return (~0u);
-}
-
-
-
-
 void SetThreadCount(int wantedNumThreads)
 {
 	const int curNumThreads = GetNumThreads(); // includes main
@@ -475,6 +755,8 @@ void SetThreadCount(int wantedNumThreads)
 	if (workerThreads[false].empty()) {
 		assert(workerThreads[true].empty());
 
+		InitThreadSlots();
+
 		#ifdef USE_BOOST_LOCKFREE_QUEUE
 		taskQueues[false][0].reserve(1024);
 		taskQueues[ true][0].reserve(1024);
@@ -482,7 +764,7 @@ void SetThreadCount(int wantedNumThreads)
 
 		#ifdef USE_TASK_STATS_TRACKING
 		for (bool async: {false, true}) {
-			for (int i = 0; i < MAX_THREADS; i++) {
+			for (int i = 0; i < numThreadSlots; i++) {
 				threadStats[async][i].numTasksRun = std::numeric_limits<uint64_t>::min();
 				threadStats[async][i].sumExecTime = std::numeric_limits<uint64_t>::min();
 				threadStats[async][i].minExecTime = std::numeric_limits<uint64_t>::max();
@@ -566,8 +848,8 @@ void SetThreadCount(int wantedNumThreads)
 void SetMaximumThreadCount()
 {
 	if (workerThreads[false].empty()) {
-		workerThreads[false].reserve(MAX_THREADS);
-		workerThreads[ true].reserve(MAX_THREADS);
+		workerThreads[false].reserve(GetMaxThreads());
+		workerThreads[ true].reserve(GetMaxThreads());
 
 		// NOTE:
 		//   do *not* remove, this makes sure the profiler instance
@@ -586,30 +868,41 @@ void SetMaximumThreadCount()
 
 void SetDefaultThreadCount()
 {
-	std::uint32_t systemCores  = springproc::CPUID::GetInstance().GetAvailableProceesorAffinityMask();
-	std::uint32_t mainAffinity = systemCores;
+	#ifndef UNIT_TEST
+	const Threading::AffinityPlan plan = Threading::PlanAffinity(globalConfig.affinityPartitions, globalConfig.affinityPartitionIndex);
+	#else
+	const Threading::AffinityPlan plan = Threading::GetAffinityPlan();
+	#endif
+
+	std::uint64_t mainAffinity = plan.mainCores;
 
 	#ifndef UNIT_TEST
-	mainAffinity &= configHandler->GetUnsigned("SetCoreAffinity");
+	// an explicit user mask overrides the planned core, but not the partition
+	if ((configHandler->GetUnsigned("SetCoreAffinity") & plan.partitionCores) != 0)
+		mainAffinity = configHandler->GetUnsigned("SetCoreAffinity") & plan.partitionCores;
 	#endif
 
-	std::uint32_t workerAvailCores = systemCores & ~mainAffinity;
+	asyncWorkerCores.store(plan.auxCores, std::memory_order_relaxed);
 
 	SetThreadCount(GetDefaultNumWorkers());
 
 	{
 		// parallel_reduce now folds over shared_ptrs to futures
-		// const auto ReduceFunc = [](std::uint32_t a, std::future<std::uint32_t>& b) -> std::uint32_t { return (a | b.get()); };
-		const auto ReduceFunc = [](std::uint32_t a, std::shared_ptr< std::future<std::uint32_t> >& b) -> std::uint32_t { return (a | (b.get())->get()); };
-		const auto AffinityFunc = [&]() -> std::uint32_t {
+		const auto ReduceFunc = [](std::uint64_t a, std::shared_ptr< std::future<std::uint64_t> >& b) -> std::uint64_t { return (a | (b.get())->get()); };
+		const auto AffinityFunc = [&]() -> std::uint64_t {
 			const int i = ThreadPool::GetThreadNum();
 
 			// 0 is the source thread, skip
 			if (i == 0)
 				return 0;
 
-			const std::uint32_t workerCore = FindWorkerThreadCore(i - 1, workerAvailCores, mainAffinity);
-			// const std::uint32_t workerCore = workerAvailCores;
+			// one physical core per worker first, SMT siblings after; keeps
+			// the pool inside the sim thread's L3 domain
+			std::uint64_t workerCore = plan.GetWorkerCore(i - 1);
+
+			// the user moved the main thread onto what would be this worker's cpu
+			if ((workerCore & ~mainAffinity) == 0)
+				workerCore = plan.workerCores;
 
 			char threadName[20];
 			std::snprintf(threadName, sizeof(threadName), "Worker %d", i);
@@ -618,13 +911,13 @@ void SetDefaultThreadCount()
 			return workerCore;
 		};
 
-		const std::uint32_t poolCoreAffinity = parallel_reduce(AffinityFunc, ReduceFunc);
-		const std::uint32_t mainCoreAffinity = Threading::HasHyperThreading() ? ~poolCoreAffinity : ~0;
+		const std::uint64_t poolCoreAffinity = parallel_reduce(AffinityFunc, ReduceFunc);
 
-		if (mainAffinity == 0)
-			mainAffinity = systemCores;
+		// keep main off any cpu a worker is pinned to, unless that leaves it nothing
+		if ((mainAffinity & ~poolCoreAffinity) != 0)
+			mainAffinity &= ~poolCoreAffinity;
 
-		Threading::SetAffinityHelper("Main", mainAffinity & mainCoreAffinity);
+		Threading::SetAffinityHelper("Main", mainAffinity);
 	}
 }
 
@@ -64,6 +64,7 @@ static inline auto parallel_reduce(F&& f, G&& g) -> std::invoke_result_t<F>
 
 #else
 
+#include "System/MemAccounting.h"
 #include "System/TimeProfiler.h"
 #include "System/Platform/Threading.h"
 #include "System/Threading/SpringThreading.h"
@@ -72,6 +73,8 @@ static inline auto parallel_reduce(F&& f, G&& g) -> std::invoke_result_t<F>
 #include <vector>
 #include <numeric>
 #include <atomic>
+#include <algorithm>
+#include <limits>
 
 #undef gt
 #include <memory>
@@ -111,7 +114,104 @@ namespace ThreadPool {
 
 	extern bool inMultiThreadedSection;
 
-	static constexpr int MAX_THREADS = 32;
+	// compile-time ceiling for static per-thread scratch storage (e.g. in Sim);
+	// the pool itself sizes its queues at runtime from GetMaxThreads()
+	static constexpr int MAX_THREADS = 64;
+
+
+	// scheduling statistics of a single for_mt or parallel call, reported to
+	// CTimeProfiler under the name of the SCOPED_TIMER it was issued from
+	struct TaskStats {
+		TaskStats()
+			: scopeHash(ScopedTimer::GetCurrentScope())
+			, scopePath(ScopedTimer::GetCurrentPath())
+			, memTag(MemAccounting::GetThreadTag())
+			, numThreads(GetNumThreads())
+		{
+			for (int i = 0; i < numThreads; i++) {
+				busyTimes[i].store(0, std::memory_order_relaxed);
+			}
+		}
+
+		void AddChunk(const spring_time dt) {
+			// async workers and external threads share ids with sync workers, hence atomics
+			busyTimes[std::min(GetThreadNum(), numThreads - 1)].fetch_add(dt.toNanoSecsi(), std::memory_order_relaxed);
+			numChunks.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// runs <f> as if it were nested in the issuing SCOPED_TIMER (also
+		// for timers inside <f>) and memory-accounting tag, and accounts its
+		// duration as one chunk
+		template<typename F> void RunChunk(F&& f) {
+			const unsigned prvScopeHash = ScopedTimer::GetCurrentScope();
+			const unsigned prvScopePath = ScopedTimer::GetCurrentPath();
+			const MemAccounting::TagId prvMemTag = MemAccounting::SetThreadTag(memTag);
+			const spring_time t0 = spring_now();
+
+			ScopedTimer::SetCurrentScope(scopeHash);
+			ScopedTimer::SetCurrentPath(scopePath);
+			f();
+			ScopedTimer::SetCurrentScope(prvScopeHash);
+			ScopedTimer::SetCurrentPath(prvScopePath);
+			MemAccounting::SetThreadTag(prvMemTag);
+
+			AddChunk(spring_now() - t0);
+		}
+
+		unsigned scopeHash;
+		unsigned scopePath;
+		MemAccounting::TagId memTag;
+		int numThreads;
+
+		std::atomic_int numChunks = {0};
+		std::array<std::atomic<uint64_t>, MAX_THREADS> busyTimes;
+	};
+
+	void AddTaskStats(const TaskStats& stats, const spring_time wallTime, const spring_time waitTime);
+
+
+	// type-erased state of a single for_mt or for_mt_chunk call, lives on the
+	// caller's stack; sub-ranges of [0, numIters) are split off recursively
+	// into per-thread work-stealing deques until they are at most <grain>
+	// iterations long
+	struct RangeJob {
+		void (*execFunc)(const RangeJob& job, int beg, int end) = nullptr;
+		const void* func = nullptr;
+
+		int start = 0;
+		int step = 1;
+		int grain = 1;
+
+		std::atomic_int remaining = {0};
+
+		TaskStats stats;
+	};
+
+	// number of leaf ranges for_mt aims to create per thread, more
+	// gives better balancing for uneven workloads at a small cost
+	static constexpr int RANGE_SPLITS_PER_THREAD = 8;
+
+	// runs (and helps run) all iterations of <job>, returns when the last one is done
+	void ExecuteRangeJob(RangeJob& job, int numIters);
+
+	template<typename F>
+	static void ExecuteRange(const RangeJob& job, int beg, int end) {
+		F& f = *static_cast<F*>(const_cast<void*>(job.func));
+
+		for (int k = beg; k < end; ++k) {
+			f(job.start + k * job.step);
+		}
+	}
+
+	template<typename F>
+	static void InitRangeJob(RangeJob& job, F& f, int start, int step, int grain) {
+		job.execFunc = &ExecuteRange<F>;
+		job.func = static_cast<const void*>(std::addressof(f));
+
+		job.start = start;
+		job.step = step;
+		job.grain = std::max(grain, 1);
+	}
 }
 
 
@@ -542,110 +642,13 @@ private:
 
 
 
-#if 0
-template<typename F>
-class ForTaskGroup: public ITaskGroup
-{
-public:
-	typedef  TTaskGroup<F, void, int>  ChildTaskType;
-
-	ForTaskGroup(bool pooled) : ITaskGroup(false, pooled) {}
-
-	void Enqueue(const int from, const int to, const int step, F& func)
-	{
-		assert(to >= from);
-
-		remainingTasks.store((step == 1) ? (to - from) : ((to - from + step - 1) / step));
-
-		childTasks.clear();
-		childTasks.reserve(remainingTasks);
-
-		for (int i = 0; i < remainingTasks; i++) {
-			auto task = std::make_shared<ChildTaskType>(1);
-
-			task->Enqueue(func, from + (step * i));
-			task->wantedThread.store(1 + i % (ThreadPool::GetNumThreads() - 1));
-
-			childTasks.push_back(task);
-			ThreadPool::PushTaskGroup(task);
-		}
-	}
-
-
-	bool ExecuteStep() override
-	{
-		bool isFinished = true;
-
-		for (size_t n = 0; n < childTasks.size(); n++) {
-			isFinished &= (childTasks[n]->IsFinished() && !childTasks[n]->IsInJobQueue());
-		}
-
-		if (!isFinished)
-			return true;
-
-		remainingTasks.store(0);
-		childTasks.clear();
-		return false;
-	}
-
-private:
-	std::vector< std::shared_ptr<ITaskGroup> > childTasks;
-};
-
-#else
-
-template<typename F>
-class ForTaskGroup: public ITaskGroup
-{
-public:
-	typedef  TTaskGroup<F, void, int>  ChildTaskType;
-
-	ForTaskGroup(bool pooled) : ITaskGroup(false, pooled) {}
-
-	void Enqueue(const int from, const int to, const int step, F& func)
-	{
-		assert(to >= from);
-
-		remainingTasks.store((step == 1) ? (to - from) : ((to - from + step - 1) / step));
-		ctr.store(0);
-
-		this->from = from;
-		this->to   = to;
-		this->step = step;
-		this->func = func;
-	}
-
-	bool IsSliceTask() const override { return true; }
-	bool ExecuteStep() override
-	{
-		const int i = from + (step * ctr.fetch_add(1, std::memory_order_relaxed));
-
-		if (i < to) {
-			func(i);
-			remainingTasks -= 1;
-			return true;
-		}
-
-		return false;
-	}
-
-private:
-	std::atomic<int> ctr;
-	std::function<void(const int)> func;
-
-	int from;
-	int to;
-	int step;
-};
-#endif
-
-
 template <template<typename> class TG, typename F>
 struct TaskPool {
 	typedef TG<F> FuncTaskGroup;
 	typedef std::shared_ptr<FuncTaskGroup> FuncTaskGroupPtr;
 
-	// more than 256 nested for_mt's or parallel's should be uncommon
+	// more than 256 nested parallel's should be uncommon
+	// (for_mt does not use pooled groups and nests freely)
 	std::array<FuncTaskGroupPtr, 256> tgPool;
 	std::atomic_int pos = {0};
 
@@ -683,27 +686,14 @@ static inline void for_mt(int start, int end, int step, F&& f)
 	else {
 		SCOPED_MT_TIMER("ThreadPool::AddTask");
 
-		// static, so TaskGroup's are recycled
-		static TaskPool<ForTaskGroup, F> pool;
-		auto taskGroup = pool.GetTaskGroup();
-
-		taskGroup->Enqueue(start, end, step, f);
-		taskGroup->UpdateId();
-
-		assert(taskGroup->IsInJobQueue());
-
-		#if 0
-		ThreadPool::PushTaskGroup(taskGroup);
-		#else
-		// store the group in all worker queues s.t. each executes a slice
-		for (size_t i = 1; i < ThreadPool::GetNumThreads(); ++i) {
-			taskGroup->wantedThread.store(i);
-			ThreadPool::PushTaskGroup(taskGroup);
-		}
-		#endif
+		const int numIters = (end - start + step - 1) / step;
+		const int numLeafs = ThreadPool::GetNumThreads() * ThreadPool::RANGE_SPLITS_PER_THREAD;
 
-		// make calling thread also run ExecuteLoop
-		ThreadPool::WaitForFinished(taskGroup);
+		// no pooled task-groups; the job outlives all of its sub-ranges
+		// since ExecuteRangeJob only returns after the last one has run
+		ThreadPool::RangeJob job;
+		ThreadPool::InitRangeJob(job, f, start, step, numIters / numLeafs);
+		ThreadPool::ExecuteRangeJob(job, numIters);
 	}
 
 	ThreadPool::inMultiThreadedSection = false;
@@ -722,25 +712,25 @@ static inline void for_mt_chunk(int b, int e, F&& f, int minChunkSize = 1, int m
 	if (numElems <= 0)
 		return;
 
-	static const int maxThreads = ThreadPool::GetNumThreads();
+	const int maxThreads = ThreadPool::GetNumThreads();
 
 	const int chunkSize = std::clamp(numElems / maxThreads + (numElems % maxThreads != 0), minChunkSize, maxChunkSize);
-	const int numThreads = numElems / chunkSize + (numElems % chunkSize != 0);
+	const int numChunks = numElems / chunkSize + (numElems % chunkSize != 0);
 
-	if (numThreads == 1) {
+	if (numChunks == 1) {
 		for (int i = b; i < e; ++i)
 			f(i);
 
 		return;
 	}
 
-	for_mt(0, numThreads, 1, [&f, b, e, chunkSize](const int jobId) {
-		const int bb = b + jobId * chunkSize;
-		const int ee = std::min(bb + chunkSize, e);
+	SCOPED_MT_TIMER("ThreadPool::AddTask");
 
-		for (int i = bb; i < ee; ++i)
-			std::forward<F>(f)(i);
-	});
+	// ranges are only split at multiples of the grain, so every
+	// chunk except the last one contains exactly chunkSize items
+	ThreadPool::RangeJob job;
+	ThreadPool::InitRangeJob(job, f, b, 1, chunkSize);
+	ThreadPool::ExecuteRangeJob(job, numElems);
 }
 
 
@@ -752,11 +742,19 @@ static inline void parallel(F&& f)
 
 	SCOPED_MT_TIMER("ThreadPool::AddTask");
 
+	const spring_time t0 = spring_now();
+
+	ThreadPool::TaskStats stats;
+
+	auto statsFunc = [&f, &stats]() {
+		stats.RunChunk(f);
+	};
+
 	// static, so TaskGroup's are recycled
-	static TaskPool<Parallel2TaskGroup, F> pool;
+	static TaskPool<Parallel2TaskGroup, decltype(statsFunc)> pool;
 	auto taskGroup = pool.GetTaskGroup();
 
-	taskGroup->Enqueue(f);
+	taskGroup->Enqueue(statsFunc);
 	taskGroup->UpdateId();
 
 	assert(taskGroup->IsInJobQueue());
@@ -764,6 +762,11 @@ static inline void parallel(F&& f)
 	// note: child-tasks are pushed, parent itself should not be
 	// ThreadPool::PushTaskGroup(taskGroup);
 	ThreadPool::WaitForFinished(taskGroup);
+
+	// caller does not run <f> itself, all of its time is spent waiting
+	const spring_time dt = spring_now() - t0;
+
+	ThreadPool::AddTaskStats(stats, dt, dt);
 }
 
 
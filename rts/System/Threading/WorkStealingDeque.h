@@ -0,0 +1,120 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _WORK_STEALING_DEQUE_H
+#define _WORK_STEALING_DEQUE_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Chase-Lev work-stealing deque with a fixed-size ring buffer, following
+ * "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al.)
+ *
+ * Push and Pop may only be called by the thread owning the deque, which
+ * treats it as a LIFO stack; any other thread may Steal from the FIFO end.
+ * Items are copied in and out word-by-word through relaxed atomics so that
+ * a thief racing with the owner never reads a torn value it can keep: a
+ * slot is only overwritten after top has moved past it, which makes the
+ * thief's CAS fail.
+ *
+ * Push does not grow the buffer; when it fails the owner is expected to
+ * execute the item inline instead.
+ */
+template<typename T, size_t CAPACITY = 1024>
+class WorkStealingDeque {
+	static_assert(std::is_trivially_copyable_v<T>, "deque items are copied via memcpy");
+	static_assert((CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+	static constexpr size_t NUM_ITEM_WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+	struct Slot {
+		std::array<std::atomic<uint64_t>, NUM_ITEM_WORDS> words;
+
+		void Store(const T& item) {
+			std::array<uint64_t, NUM_ITEM_WORDS> tmp = {};
+			std::memcpy(tmp.data(), &item, sizeof(T));
+
+			for (size_t i = 0; i < NUM_ITEM_WORDS; i++)
+				words[i].store(tmp[i], std::memory_order_relaxed);
+		}
+		void Load(T& item) const {
+			std::array<uint64_t, NUM_ITEM_WORDS> tmp;
+
+			for (size_t i = 0; i < NUM_ITEM_WORDS; i++)
+				tmp[i] = words[i].load(std::memory_order_relaxed);
+
+			std::memcpy(&item, tmp.data(), sizeof(T));
+		}
+	};
+
+public:
+	bool Push(const T& item) {
+		const int64_t b = bottom.load(std::memory_order_relaxed);
+		const int64_t t = top.load(std::memory_order_acquire);
+
+		if ((b - t) >= int64_t(CAPACITY))
+			return false;
+
+		slots[b & (CAPACITY - 1)].Store(item);
+
+		// publishes the item (and whatever it points to) to thieves
+		bottom.store(b + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool Pop(T& item) {
+		const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		int64_t t = top.load(std::memory_order_relaxed);
+
+		if (t > b) {
+			// empty
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		slots[b & (CAPACITY - 1)].Load(item);
+
+		if (t != b)
+			return true;
+
+		// last item, race against thieves
+		const bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return won;
+	}
+
+	bool Steal(T& item) {
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t b = bottom.load(std::memory_order_acquire);
+
+		if (t >= b)
+			return false;
+
+		slots[t & (CAPACITY - 1)].Load(item);
+
+		return (top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed));
+	}
+
+	// approximate when called by non-owners
+	int64_t Size() const { return (std::max(bottom.load(std::memory_order_relaxed) - top.load(std::memory_order_relaxed), int64_t(0))); }
+	bool Empty() const { return (Size() == 0); }
+
+private:
+	// keep the thief-side and owner-side indices on separate cache lines
+	alignas(64) std::atomic<int64_t> top = {0};
+	alignas(64) std::atomic<int64_t> bottom = {0};
+	alignas(64) std::array<Slot, CAPACITY> slots;
+};
+
+#endif
@@ -2,7 +2,9 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstdio>
 #include <cstring>
+#include <memory>
 
 #include "System/TimeProfiler.h"
 #include "System/GlobalRNG.h"
@@ -16,14 +18,172 @@
 
 using ProfileMutexType = spring::mutex; //spring::spinlock
 using HashNamMutexType = spring::mutex; //spring::spinlock
+using TaskGrpMutexType = spring::spinlock;
 
 static ProfileMutexType profileMutex;
 static HashNamMutexType hashToNameMutex;
+static TaskGrpMutexType taskGroupMutex;
 static spring::unordered_map<unsigned, std::string> hashToName;
-static spring::unordered_map<unsigned, int> refCounters;
 
 static CGlobalUnsyncedRNG profileColorRNG;
 
+
+namespace {
+	// one per (parent-path, name) pair seen by a thread
+	struct ThreadTimerSlot {
+		// written once by the owning thread, 0 while the slot is free
+		std::atomic<unsigned> path = {0};
+
+		// immutable after <path> is published
+		unsigned parentPath = 0;
+		unsigned nameHash = 0;
+		const char* name = nullptr;
+		bool showGraph = false;
+
+		// added to by the owning thread, exchanged with 0 when merging
+		std::atomic<int64_t> totalTime = {0}; // flame-graph (inclusive) time
+		std::atomic<int64_t> flatTime = {0}; // profile time, only of timers not enclosed by the same name
+		std::atomic<int64_t> maxFlatTime = {0};
+		std::atomic<uint32_t> numCalls = {0};
+	};
+
+	/**
+	 * Lock-free accumulator owned by a single thread; CTimeProfiler drains
+	 * it once per frame. Slots are never freed, which keeps the merge free
+	 * of any synchronization with the owner beyond the atomics above.
+	 */
+	struct ThreadTimerRecords {
+		static constexpr size_t NUM_SLOTS = 512;
+		static constexpr size_t NUM_INTERVALS = 2048;
+
+		ThreadTimerSlot* GetSlot(unsigned path, unsigned parentPath, unsigned nameHash, const char* name, bool showGraph) {
+			for (size_t i = 0; i < NUM_SLOTS; i++) {
+				ThreadTimerSlot& slot = slots[(path + i) & (NUM_SLOTS - 1)];
+
+				// only the owner writes <path>, relaxed is enough here
+				const unsigned slotPath = slot.path.load(std::memory_order_relaxed);
+
+				if (slotPath == path)
+					return &slot;
+				if (slotPath != 0)
+					continue;
+
+				slot.parentPath = parentPath;
+				slot.nameHash = nameHash;
+				slot.name = name;
+				slot.showGraph = showGraph;
+				slot.path.store(path, std::memory_order_release);
+				return &slot;
+			}
+
+			numDropped.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		void Add(unsigned path, unsigned parentPath, unsigned nameHash, const char* name, const spring_time dt, bool flat, bool showGraph) {
+			ThreadTimerSlot* slot = GetSlot(path, parentPath, nameHash, name, showGraph);
+
+			if (slot == nullptr)
+				return;
+
+			const int64_t ns = dt.toNanoSecsi();
+
+			slot->totalTime.fetch_add(ns, std::memory_order_relaxed);
+			slot->numCalls.fetch_add(1, std::memory_order_relaxed);
+
+			if (!flat)
+				return;
+
+			slot->flatTime.fetch_add(ns, std::memory_order_relaxed);
+
+			// a lost maximum (racing with the merge) only affects the lag-peak display
+			if (ns > slot->maxFlatTime.load(std::memory_order_relaxed))
+				slot->maxFlatTime.store(ns, std::memory_order_relaxed);
+		}
+
+		// SCOPED_MT_TIMER intervals for the ProfileDrawer thread-view, SPSC ring
+		void AddInterval(const spring_time t0, const spring_time t1) {
+			const uint64_t h = intervalHead.load(std::memory_order_relaxed);
+
+			if ((h - intervalTail.load(std::memory_order_acquire)) >= NUM_INTERVALS) {
+				numDropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			intervals[h & (NUM_INTERVALS - 1)] = {t0.toNanoSecsi(), t1.toNanoSecsi()};
+			intervalHead.store(h + 1, std::memory_order_release);
+		}
+
+		std::array<ThreadTimerSlot, NUM_SLOTS> slots;
+		std::array<std::pair<int64_t, int64_t>, NUM_INTERVALS> intervals;
+
+		std::atomic<uint64_t> intervalHead = {0};
+		std::atomic<uint64_t> intervalTail = {0};
+		std::atomic<uint64_t> numDropped = {0};
+
+		std::atomic<bool> owned = {false};
+		int threadNum = 0;
+	};
+
+	static constexpr size_t MAX_TIMER_THREADS = 256;
+
+	static std::array<std::unique_ptr<ThreadTimerRecords>, MAX_TIMER_THREADS> threadRecords;
+	static std::atomic<size_t> numThreadRecords = {0};
+	static spring::mutex threadRecordsMutex;
+
+	struct ThreadRecordsOwner {
+		~ThreadRecordsOwner() {
+			// slots keep their paths; a thread claiming these later inherits them
+			if (records != nullptr)
+				records->owned.store(false, std::memory_order_release);
+		}
+
+		ThreadTimerRecords* records = nullptr;
+	};
+
+	static thread_local ThreadRecordsOwner threadRecordsOwner;
+
+	// names of the timers enclosing the current one, to find recursive timers
+	static thread_local std::array<unsigned, 64> activeTimerNames;
+	static thread_local unsigned numActiveTimerNames = 0;
+
+
+	static ThreadTimerRecords* GetThreadRecords() {
+		if (threadRecordsOwner.records != nullptr)
+			return threadRecordsOwner.records;
+
+		ThreadTimerRecords* records = nullptr;
+
+		for (size_t i = 0, n = numThreadRecords.load(std::memory_order_acquire); i < n && records == nullptr; i++) {
+			bool owned = false;
+
+			if (threadRecords[i]->owned.compare_exchange_strong(owned, true, std::memory_order_acquire))
+				records = threadRecords[i].get();
+		}
+
+		if (records == nullptr) {
+			std::lock_guard<spring::mutex> lock(threadRecordsMutex);
+
+			const size_t n = numThreadRecords.load(std::memory_order_relaxed);
+
+			if (n == MAX_TIMER_THREADS)
+				return nullptr;
+
+			threadRecords[n] = std::make_unique<ThreadTimerRecords>();
+			threadRecords[n]->owned.store(true, std::memory_order_relaxed);
+
+			numThreadRecords.store(n + 1, std::memory_order_release);
+			records = threadRecords[n].get();
+		}
+
+		#ifdef THREADPOOL
+		records->threadNum = ThreadPool::GetThreadNum();
+		#endif
+
+		return (threadRecordsOwner.records = records);
+	}
+}
+
 const std::array<CTimeProfiler::ProfileSortFunc, CTimeProfiler::SortType::ST_COUNT> CTimeProfiler::SortingFunctions = {
 	[](const TimeRecordPair& a, const TimeRecordPair& b) { return (a.first          < b.first         ); }, // ST_ALPHABETICAL = 0,
 	[](const TimeRecordPair& a, const TimeRecordPair& b) { return (a.second.total   > b.second.total  ); }, // ST_TOTALTIME    = 1,
@@ -40,31 +200,52 @@ spring_time BasicTimer::GetDuration() const
 
 ScopedTimer::ScopedTimer(const unsigned _nameHash, bool _autoShowGraph, bool _specialTimer)
 	: BasicTimer(_nameHash)
+	, name(nullptr)
+	, parentScope(currentScope)
+	, parentPath(currentPath)
+	, path(GetChildPath(currentPath, _nameHash))
 
 	// Game::SendClientProcUsage depends on "Sim" and "Draw" percentages, BenchMark on "Lua"
 	// note that address-comparison is intended here, timer names are (and must be) literals
 	, autoShowGraph(_autoShowGraph)
 	, specialTimer(_specialTimer)
+	, outermost(true)
 {
-	auto iter = refCounters.find(nameHash);
+	currentScope = nameHash;
+	currentPath = path;
 
-	if (iter == refCounters.end())
-		iter = refCounters.insert(std::pair<unsigned, int>(nameHash, 0)).first;
+	for (unsigned i = 0, n = std::min(numActiveTimerNames, unsigned(activeTimerNames.size())); i < n; i++) {
+		outermost &= (activeTimerNames[i] != nameHash);
+	}
+
+	if (numActiveTimerNames < activeTimerNames.size())
+		activeTimerNames[numActiveTimerNames] = nameHash;
+
+	numActiveTimerNames += 1;
+}
 
-	++(iter->second);
+ScopedTimer::ScopedTimer(const unsigned _nameHash, const char* _name, bool _specialTimer)
+	: ScopedTimer(_nameHash, false, _specialTimer)
+{
+	name = _name;
 }
 
 ScopedTimer::~ScopedTimer()
 {
-	// no avoiding a second lookup since iterators can be invalidated with unordered_map
-	auto iter = refCounters.find(nameHash);
+	numActiveTimerNames -= 1;
 
-	assert(iter != refCounters.end());
-	assert(iter->second > 0);
+	currentScope = parentScope;
+	currentPath = parentPath;
 
-	if (--(iter->second) == 0) {
-		CTimeProfiler::GetInstance().AddTime(nameHash, startTime, GetDuration(), autoShowGraph, specialTimer, false);
-	}
+	if (!specialTimer && !CTimeProfiler::GetInstance().IsEnabled())
+		return;
+
+	ThreadTimerRecords* records = GetThreadRecords();
+
+	if (records == nullptr)
+		return;
+
+	records->Add(path, parentPath, nameHash, name, GetDuration(), outermost, autoShowGraph);
 }
 
 
@@ -99,15 +280,29 @@ spring_time ScopedOnceTimer::GetDuration() const
 
 
 
-ScopedMtTimer::ScopedMtTimer(unsigned _nameHash, bool _autoShowGraph)
+ScopedMtTimer::ScopedMtTimer(unsigned _nameHash, const char* _name, bool _autoShowGraph)
 	: BasicTimer(_nameHash)
+	, name(_name)
 	, autoShowGraph(_autoShowGraph)
 {
 }
 
 ScopedMtTimer::~ScopedMtTimer()
 {
-	CTimeProfiler::GetInstance().AddTime(nameHash, startTime, GetDuration(), autoShowGraph, false, true);
+	if (!CTimeProfiler::GetInstance().IsEnabled())
+		return;
+
+	ThreadTimerRecords* records = GetThreadRecords();
+
+	if (records == nullptr)
+		return;
+
+	// not part of the scope chain, but still shows up below it in the flame-graph
+	const spring_time t1 = spring_gettime();
+	const unsigned parentPath = ScopedTimer::GetCurrentPath();
+
+	records->Add(ScopedTimer::GetChildPath(parentPath, nameHash), parentPath, nameHash, name, t1 - startTime, true, autoShowGraph);
+	records->AddInterval(startTime, t1);
 }
 
 
@@ -119,7 +314,7 @@ ScopedMtTimer::~ScopedMtTimer()
 CTimeProfiler::CTimeProfiler()
 {
 	// self
-	RegisterTimer("Misc::Profiler::AddTime");
+	RegisterTimer("Misc::Profiler::Merge");
 	// specials (conditional on LuaContextData)
 	RegisterTimer("Lua::Callins::Synced");
 	RegisterTimer("Lua::Callins::Unsynced");
@@ -185,7 +380,11 @@ void CTimeProfiler::ResetState() {
 	// grab lock; ThreadPool workers might already be running SCOPED_MT_TIMER
 	std::lock_guard<ProfileMutexType> lock(profileMutex);
 
+	// throw away whatever threads accumulated for the previous state
+	MergeThreadRecordsRaw(true);
+
 	profiles.clear();
+	flameGraphNodes.clear();
 	profiles.reserve(128);
 	sortedProfiles.clear();
 	#ifdef THREADPOOL
@@ -193,6 +392,11 @@ void CTimeProfiler::ResetState() {
 	threadProfiles.resize(ThreadPool::GetMaxThreads());
 	#endif
 
+	{
+		std::lock_guard<TaskGrpMutexType> taskGroupLock(taskGroupMutex);
+		taskGroupRecords.clear();
+	}
+
 	profileColorRNG.Seed(spring_tomsecs(lastBigUpdate = spring_gettime()));
 
 	currentPosition = 0;
@@ -213,6 +417,8 @@ void CTimeProfiler::ToggleLock(bool lock)
 
 void CTimeProfiler::Update()
 {
+	MergeThreadRecords();
+
 	if (!enabled) {
 		UpdateRaw();
 		ResortProfilesRaw();
@@ -350,38 +556,28 @@ void CTimeProfiler::AddTime(
 	const bool specialTimer,
 	const bool threadTimer
 ) {
-	const spring_time t0 = spring_now();
+	if (!enabled && !specialTimer)
+		return;
 
-	if (!enabled) {
-		if (!specialTimer)
-			return;
+	ThreadTimerRecords* records = GetThreadRecords();
 
-		assert(!threadTimer);
-		AddTimeRaw(nameHash, startTime, deltaTime, showGraph, threadTimer);
-		AddTimeRaw(hashString("Misc::Profiler::AddTime"), t0, spring_now() - t0, false, false);
+	if (records == nullptr)
 		return;
-	}
 
-	// acquire lock at the start; one inserting thread could
-	// cause a profile rehash and invalidate <pi> for another
-	std::lock_guard<ProfileMutexType> lock(profileMutex);
+	const unsigned parentPath = ScopedTimer::GetCurrentPath();
 
-	AddTimeRaw(nameHash, startTime, deltaTime, showGraph, threadTimer);
-	AddTimeRaw(hashString("Misc::Profiler::AddTime"), t0, spring_now() - t0, false, false);
+	records->Add(ScopedTimer::GetChildPath(parentPath, nameHash), parentPath, nameHash, nullptr, deltaTime, true, showGraph);
+
+	if (threadTimer)
+		records->AddInterval(startTime, startTime + deltaTime);
 }
 
 void CTimeProfiler::AddTimeRaw(
 	const unsigned nameHash,
-	const spring_time startTime,
 	const spring_time deltaTime,
-	const bool showGraph,
-	const bool threadTimer
+	const spring_time maxDeltaTime,
+	const bool showGraph
 ) {
-#ifdef THREADPOOL
-	if (threadTimer)
-		threadProfiles[ThreadPool::GetThreadNum()].emplace_back(startTime, spring_gettime());
-#endif
-
 	auto pi = profiles.find(nameHash);
 	auto& p = (pi != profiles.end()) ? pi->second: profiles[nameHash];
 
@@ -389,8 +585,8 @@ void CTimeProfiler::AddTimeRaw(
 	p.total   += deltaTime;
 	p.current += deltaTime;
 
-	p.newLagPeak = (p.stats.x > 0.0f && deltaTime.toMilliSecsf() > p.stats.x);
-	p.stats.x    = std::max(p.stats.x, deltaTime.toMilliSecsf());
+	p.newLagPeak = (p.stats.x > 0.0f && maxDeltaTime.toMilliSecsf() > p.stats.x);
+	p.stats.x    = std::max(p.stats.x, maxDeltaTime.toMilliSecsf());
 
 	if (pi != profiles.end()) {
 		// profile already exists, add dt
@@ -406,6 +602,224 @@ void CTimeProfiler::AddTimeRaw(
 	}
 }
 
+
+void CTimeProfiler::MergeThreadRecords()
+{
+	std::lock_guard<ProfileMutexType> lock(profileMutex);
+	MergeThreadRecordsRaw(false);
+}
+
+void CTimeProfiler::MergeThreadRecordsRaw(bool discard)
+{
+	const spring_time t0 = spring_now();
+
+	for (size_t i = 0, n = numThreadRecords.load(std::memory_order_acquire); i < n; i++) {
+		ThreadTimerRecords& records = *threadRecords[i];
+
+		for (ThreadTimerSlot& slot: records.slots) {
+			const unsigned path = slot.path.load(std::memory_order_acquire);
+
+			if (path == 0)
+				continue;
+
+			const uint32_t numCalls = slot.numCalls.exchange(0, std::memory_order_relaxed);
+			const int64_t totalTime = slot.totalTime.exchange(0, std::memory_order_relaxed);
+			const int64_t flatTime = slot.flatTime.exchange(0, std::memory_order_relaxed);
+			const int64_t maxFlatTime = slot.maxFlatTime.exchange(0, std::memory_order_relaxed);
+
+			if (numCalls == 0 || discard)
+				continue;
+
+			auto iter = flameGraphNodes.find(path);
+
+			if (iter == flameGraphNodes.end()) {
+				// first record of this timer here, make its name known
+				if (slot.name != nullptr)
+					RegisterTimer(slot.name);
+
+				iter = flameGraphNodes.insert(path, FlameGraphNode{slot.parentPath, slot.nameHash}).first;
+			}
+
+			iter->second.numCalls += numCalls;
+			iter->second.totalTime += spring_time::fromNanoSecs(totalTime);
+
+			if (flatTime == 0)
+				continue;
+
+			AddTimeRaw(slot.nameHash, spring_time::fromNanoSecs(flatTime), spring_time::fromNanoSecs(maxFlatTime), slot.showGraph);
+		}
+
+		const uint64_t intervalHead = records.intervalHead.load(std::memory_order_acquire);
+
+		#ifdef THREADPOOL
+		if (!discard && size_t(records.threadNum) < threadProfiles.size()) {
+			auto& threadProfile = threadProfiles[records.threadNum];
+
+			for (uint64_t j = records.intervalTail.load(std::memory_order_relaxed); j < intervalHead; j++) {
+				const auto& interval = records.intervals[j & (ThreadTimerRecords::NUM_INTERVALS - 1)];
+				threadProfile.emplace_back(spring_time::fromNanoSecs(interval.first), spring_time::fromNanoSecs(interval.second));
+			}
+		}
+		#endif
+
+		records.intervalTail.store(intervalHead, std::memory_order_release);
+	}
+
+	if (discard)
+		return;
+
+	const spring_time dt = spring_now() - t0;
+	AddTimeRaw(hashString("Misc::Profiler::Merge"), dt, dt, false);
+}
+
+
+bool CTimeProfiler::WriteFlameGraphJSON(const std::string& fileName) const
+{
+	std::vector< std::pair<unsigned, FlameGraphNode> > nodes;
+	spring::unordered_map<unsigned, std::vector<size_t>> children;
+
+	{
+		std::lock_guard<ProfileMutexType> lock(profileMutex);
+
+		nodes.assign(flameGraphNodes.begin(), flameGraphNodes.end());
+
+		for (size_t i = 0; i < nodes.size(); i++) {
+			// nodes whose parent was never recorded (e.g. profiler was disabled) hang off the root
+			const unsigned parentPath = nodes[i].second.parentPath;
+			const bool hasParent = (flameGraphNodes.find(parentPath) != flameGraphNodes.end());
+
+			children[hasParent? parentPath: 0].push_back(i);
+		}
+	}
+	{
+		std::lock_guard<HashNamMutexType> lock(hashToNameMutex);
+
+		FILE* file = fopen(fileName.c_str(), "w");
+
+		if (file == nullptr) {
+			LOG_L(L_ERROR, "[TimeProfiler::%s] could not open \"%s\" for writing", __func__, fileName.c_str());
+			return false;
+		}
+
+		const auto WriteName = [&](unsigned nameHash) {
+			const auto iter = hashToName.find(nameHash);
+			const char* name = (iter != hashToName.end())? iter->second.c_str(): "???";
+
+			fputc('"', file);
+
+			for (const char* c = name; *c != 0; c++) {
+				if (*c == '"' || *c == '\\')
+					fputc('\\', file);
+
+				fputc(*c, file);
+			}
+
+			fputc('"', file);
+		};
+		const auto WriteNode = [&](const auto& self, unsigned path, unsigned nameHash, uint64_t numCalls, spring_time totalTime) -> void {
+			fprintf(file, "{\"name\":");
+
+			if (path == 0) {
+				fprintf(file, "\"root\"");
+			} else {
+				WriteName(nameHash);
+			}
+
+			fprintf(file, ",\"value\":%lld,\"calls\":%llu,\"children\":[", static_cast<long long>(totalTime.toMicroSecsi()), static_cast<unsigned long long>(numCalls));
+
+			const auto iter = children.find(path);
+
+			if (iter != children.end()) {
+				for (size_t i = 0; i < iter->second.size(); i++) {
+					const auto& node = nodes[iter->second[i]];
+
+					if (i > 0)
+						fputc(',', file);
+
+					self(self, node.first, node.second.nameHash, node.second.numCalls, node.second.totalTime);
+				}
+			}
+
+			fprintf(file, "]}");
+		};
+
+		// the root spans all top-level timers
+		spring_time rootTime = spring_notime;
+
+		for (const size_t i: children[0]) {
+			rootTime += nodes[i].second.totalTime;
+		}
+
+		WriteNode(WriteNode, 0, 0, 1, rootTime);
+		fprintf(file, "\n");
+		fclose(file);
+	}
+
+	return true;
+}
+
+
+void CTimeProfiler::AddTaskGroupStats(
+	const unsigned scopeHash,
+	const int numChunks,
+	const int numThreads,
+	const spring_time wallTime,
+	const spring_time busyTime,
+	const spring_time maxBusyTime,
+	const spring_time waitTime
+) {
+	// unlike AddTime these are always gathered, cost is one (rarely contended) spinlock per call
+	const float meanBusyTime = busyTime.toMilliSecsf() / std::max(numThreads, 1);
+	const float imbalance = (meanBusyTime > 0.0f)? (maxBusyTime.toMilliSecsf() / meanBusyTime): 1.0f;
+	const spring_time idleTime = std::max(wallTime * numThreads - busyTime, spring_notime);
+
+	std::lock_guard<TaskGrpMutexType> lock(taskGroupMutex);
+
+	TaskGroupRecord& r = taskGroupRecords[scopeHash];
+
+	r.numCalls += 1;
+	r.numChunks += numChunks;
+
+	r.wallTime += wallTime;
+	r.busyTime += busyTime;
+	r.idleTime += idleTime;
+	r.waitTime += waitTime;
+
+	r.sumImbalance += imbalance;
+	r.maxImbalance = std::max(r.maxImbalance, imbalance);
+}
+
+std::vector< std::pair<std::string, CTimeProfiler::TaskGroupRecord> > CTimeProfiler::GetTaskGroupRecords() const
+{
+	std::vector< std::pair<unsigned, TaskGroupRecord> > hashedRecords;
+	std::vector< std::pair<std::string, TaskGroupRecord> > namedRecords;
+
+	{
+		std::lock_guard<TaskGrpMutexType> lock(taskGroupMutex);
+		hashedRecords.assign(taskGroupRecords.begin(), taskGroupRecords.end());
+	}
+	{
+		// resolve names outside the spinlock, hashToName has its own mutex
+		std::lock_guard<HashNamMutexType> lock(hashToNameMutex);
+
+		namedRecords.reserve(hashedRecords.size());
+
+		for (const auto& p: hashedRecords) {
+			const auto iter = hashToName.find(p.first);
+
+			if (iter != hashToName.end()) {
+				namedRecords.emplace_back(iter->second, p.second);
+			} else {
+				namedRecords.emplace_back((p.first == 0)? "(unscoped)": "???", p.second);
+			}
+		}
+	}
+
+	std::sort(namedRecords.begin(), namedRecords.end(), [](const auto& a, const auto& b) { return (a.first < b.first); });
+	return namedRecords;
+}
+
+
 void CTimeProfiler::PrintProfilingInfo() const
 {
 	if (sortedProfiles.empty())
@@ -419,5 +833,26 @@ void CTimeProfiler::PrintProfilingInfo() const
 
 		LOG("%35s %16.2fms %5.2f%%", name.c_str(), tr.total.toMilliSecsf(), tr.stats.y * 100);
 	}
+
+	const auto taskGroupRecs = GetTaskGroupRecords();
+
+	if (taskGroupRecs.empty())
+		return;
+
+	LOG("%35s|%10s|%10s|%14s|%14s|%14s|%s", "Parallel Part", "Calls", "Chunks", "Wall Time", "Idle Time", "Wait Time", "Imbalance (avg/max)");
+
+	for (const auto& p: taskGroupRecs) {
+		const TaskGroupRecord& r = p.second;
+
+		const float avgImbalance = r.sumImbalance / std::max(r.numCalls, uint64_t(1));
+
+		LOG("%35s %10lu %10lu %12.2fms %12.2fms %12.2fms %5.2f/%5.2f",
+			p.first.c_str(),
+			static_cast<unsigned long>(r.numCalls),
+			static_cast<unsigned long>(r.numChunks),
+			r.wallTime.toMilliSecsf(), r.idleTime.toMilliSecsf(), r.waitTime.toMilliSecsf(),
+			avgImbalance, r.maxImbalance
+		);
+	}
 }
 
@@ -8,6 +8,7 @@
 #include <deque>
 #include <vector>
 #include <array>
+#include <type_traits>
 
 #include "System/Misc/SpringTime.h"
 #include "System/Misc/NonCopyable.h"
@@ -17,16 +18,21 @@
 
 #include "System/Misc/TracyDefs.h"
 
+// forces the name-hash of a literal to be computed at compile-time
+#define TIMER_NAME_HASH(name) (std::integral_constant<unsigned, hashString(name)>::value)
+
 // disable these for minimal profiling; all special
 // timers contribute even when profiler is disabled
-// NB: names are assumed to be compile-time literals
-#define SCOPED_TIMER(      name)  ZoneScopedNC(name, tracy::Color::Goldenrod); static TimerNameRegistrar __tnr(name); ScopedTimer __scopedTimer(hashString(name));
-#define SCOPED_TIMER_NOREG(name)  ZoneScopedNC(name, tracy::Color::Goldenrod);                                        ScopedTimer __scopedTimer(hashString(name));
+// NB: names are assumed to be compile-time literals, they are registered
+// when CTimeProfiler first merges a record of the timer; NOREG variants
+// accept runtime names but expect them to be registered by the caller
+#define SCOPED_TIMER(      name)  ZoneScopedNC(name, tracy::Color::Goldenrod); ScopedTimer __scopedTimer(TIMER_NAME_HASH(name), name);
+#define SCOPED_TIMER_NOREG(name)  ZoneScopedNC(name, tracy::Color::Goldenrod); ScopedTimer __scopedTimer(hashString(name));
 
-#define SCOPED_SPECIAL_TIMER(      name)  static TimerNameRegistrar __stnr(name); ScopedTimer __scopedTimer(hashString(name), false, true);
-#define SCOPED_SPECIAL_TIMER_NOREG(name)                                          ScopedTimer __scopedTimer(hashString(name), false, true);
+#define SCOPED_SPECIAL_TIMER(      name)  ScopedTimer __scopedTimer(TIMER_NAME_HASH(name), name, true);
+#define SCOPED_SPECIAL_TIMER_NOREG(name)  ScopedTimer __scopedTimer(hashString(name), false, true);
 
-#define SCOPED_MT_TIMER(name)  ScopedMtTimer __scopedTimer(hashString(name));
+#define SCOPED_MT_TIMER(name)  ScopedMtTimer __scopedTimer(TIMER_NAME_HASH(name), name);
 
 #define SCOPED_ONCE_TIMER(name) ZoneScopedNC(name, tracy::Color::Purple); ScopedOnceTimer __timer(name);
 
@@ -54,21 +60,49 @@ class ScopedTimer : public BasicTimer
 {
 public:
 	ScopedTimer(const unsigned _nameHash, bool _autoShowGraph = false, bool _specialTimer = false);
+	ScopedTimer(const unsigned _nameHash, const char* _name, bool _specialTimer = false);
 	~ScopedTimer();
 
+	// name-hash of the innermost ScopedTimer alive on the calling thread (0 if none);
+	// ThreadPool attributes its per-call task statistics to this
+	static unsigned GetCurrentScope() { return currentScope; }
+	static void SetCurrentScope(unsigned nameHash) { currentScope = nameHash; }
+
+	// hash of the whole chain of ScopedTimer's alive on the calling thread (0 if none),
+	// identifies a node in the flame-graph; ThreadPool forwards it to worker threads
+	static unsigned GetCurrentPath() { return currentPath; }
+	static void SetCurrentPath(unsigned pathHash) { currentPath = pathHash; }
+
+	static unsigned GetChildPath(unsigned parentPath, unsigned nameHash) {
+		const unsigned path = (parentPath ^ nameHash) * 0x9E3779B1u + (parentPath << 6) + (parentPath >> 2);
+		return (path + (path == 0));
+	}
+
 private:
+	const char* name;
+
+	const unsigned parentScope;
+	const unsigned parentPath;
+	const unsigned path;
+
 	const bool autoShowGraph;
 	const bool specialTimer;
+	// false if a timer of the same name encloses this one on the same thread
+	bool outermost;
+
+	static inline thread_local unsigned currentScope = 0;
+	static inline thread_local unsigned currentPath = 0;
 };
 
 
 class ScopedMtTimer : public BasicTimer
 {
 public:
-	ScopedMtTimer(const unsigned _nameHash, bool _autoShowGraph = false);
+	ScopedMtTimer(const unsigned _nameHash, const char* _name = nullptr, bool _autoShowGraph = false);
 	~ScopedMtTimer();
 
 private:
+	const char* name;
 	const bool autoShowGraph;
 };
 
@@ -126,6 +160,30 @@ public:
 		bool showGraph = false;
 	};
 
+	// one node per distinct chain of nested timers, accumulated since the last reset
+	struct FlameGraphNode {
+		unsigned parentPath = 0;
+		unsigned nameHash = 0;
+
+		uint64_t numCalls = 0;
+		spring_time totalTime = spring_notime; // includes children
+	};
+
+	// aggregated over all for_mt / parallel calls issued inside the same SCOPED_TIMER
+	struct TaskGroupRecord {
+		uint64_t numCalls = 0;
+		uint64_t numChunks = 0;
+
+		spring_time wallTime = spring_notime; // caller-side duration of each call
+		spring_time busyTime = spring_notime; // time all threads spent running chunks
+		spring_time idleTime = spring_notime; // (wallTime * numThreads) - busyTime
+		spring_time waitTime = spring_notime; // time the caller spent waiting on others
+
+		// max / mean per-thread busy time of each call; 1 is perfectly balanced
+		float sumImbalance = 0.0f;
+		float maxImbalance = 0.0f;
+	};
+
 	enum SortType {
 		ST_ALPHABETICAL = 0,
 		ST_TOTALTIME    = 1,
@@ -180,6 +238,17 @@ public:
 	void Update();
 	void UpdateRaw();
 
+	/**
+	 * Moves the times accumulated by each thread since the last call into
+	 * the profiles and the flame-graph; called once per frame.
+	 */
+	void MergeThreadRecords();
+	/**
+	 * Writes the flame-graph in the nested {name, value, children} format
+	 * understood by d3-flame-graph and speedscope; value is in microseconds.
+	 */
+	bool WriteFlameGraphJSON(const std::string& fileName) const;
+
 	void ResortProfilesRaw();
 	void RefreshProfiles();
 	void RefreshProfilesRaw();
@@ -187,6 +256,10 @@ public:
 	void SetEnabled(bool b) { enabled = b; }
 	void PrintProfilingInfo() const;
 
+	/**
+	 * Accumulates into the calling thread's records, without locking;
+	 * the time shows up in the profiles after the next merge.
+	 */
 	void AddTime(
 		unsigned nameHash,
 		const spring_time startTime,
@@ -197,19 +270,38 @@ public:
 	);
 	void AddTimeRaw(
 		unsigned nameHash,
-		const spring_time startTime,
 		const spring_time deltaTime,
-		const bool showGraph,
-		const bool threadTimer
+		const spring_time maxDeltaTime,
+		const bool showGraph
 	);
 
+	void AddTaskGroupStats(
+		unsigned scopeHash,
+		int numChunks,
+		int numThreads,
+		const spring_time wallTime,
+		const spring_time busyTime,
+		const spring_time maxBusyTime,
+		const spring_time waitTime
+	);
+
+	// name-sorted copy, taken under lock since workers may be adding to it
+	std::vector< std::pair<std::string, TaskGroupRecord> > GetTaskGroupRecords() const;
+
+	bool IsEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
 private:
+	void MergeThreadRecordsRaw(bool discard);
+
 	SortType sortingType = SortType::ST_ALPHABETICAL;
 	spring::unordered_map<unsigned, TimeRecord> profiles;
 
 	std::vector< std::pair<std::string, TimeRecord> > sortedProfiles;
 	std::vector< std::deque< std::pair<spring_time, spring_time> > > threadProfiles;
 
+	spring::unordered_map<unsigned, TaskGroupRecord> taskGroupRecords;
+	spring::unordered_map<unsigned, FlameGraphNode> flameGraphNodes;
+
 	spring_time lastBigUpdate;
 
 	/// increases each update, from 0 to (numFrames-1)
@@ -221,12 +313,4 @@ private:
 };
 
 
-class TimerNameRegistrar : public spring::noncopyable
-{
-public:
-	TimerNameRegistrar(const char* timerName) {
-		CTimeProfiler::RegisterTimer(timerName);
-	}
-};
-
 #endif // TIME_PROFILER_H
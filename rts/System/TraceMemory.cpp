@@ -1,6 +1,105 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#if defined(MEMORY_ACCOUNTING_SAMPLE_NEW)
+
+#include <new>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+
+#include "System/MemAccounting.h"
+
 #if defined(TRACY_ENABLE)
+#include <tracy/Tracy.hpp>
+#endif
+
+// every allocation carries a header recording whether (and under which tag)
+// it was sampled, so that frees can be attributed without a lookup table; the
+// header size preserves the default new-alignment of the returned pointer
+struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) AllocHeader {
+	uint64_t weight; // 0 if not sampled
+	uint32_t tag;
+	uint32_t magic;
+};
+
+static constexpr uint32_t ALLOC_HEADER_MAGIC = 0x5A3D0C11;
+// on average one allocation per this many bytes is sampled
+static constexpr int64_t SAMPLE_INTERVAL = 256 * 1024;
+
+static thread_local int64_t bytesUntilSample = SAMPLE_INTERVAL;
+
+
+static void* SampledAlloc(std::size_t count) noexcept
+{
+	AllocHeader* hdr = static_cast<AllocHeader*>(malloc(sizeof(AllocHeader) + count));
+
+	if (hdr == nullptr)
+		return nullptr;
+
+	hdr->weight = 0;
+	hdr->tag = MemAccounting::TAG_OTHER;
+	hdr->magic = ALLOC_HEADER_MAGIC;
+
+	// sample the allocation that crosses the interval boundary and let it
+	// stand in for every byte allocated since the previous sample
+	if ((bytesUntilSample -= count) <= 0) {
+		hdr->weight = SAMPLE_INTERVAL - bytesUntilSample;
+		hdr->tag = MemAccounting::GetThreadTag();
+
+		bytesUntilSample = SAMPLE_INTERVAL;
+
+		MemAccounting::RecordHeapAlloc(hdr->tag, hdr->weight);
+	}
+
+	#if defined(TRACY_ENABLE)
+	TracyAlloc(hdr + 1, count);
+	#endif
+
+	return (hdr + 1);
+}
+
+static void SampledFree(void* ptr) noexcept
+{
+	if (ptr == nullptr)
+		return;
+
+	AllocHeader* hdr = static_cast<AllocHeader*>(ptr) - 1;
+
+	assert(hdr->magic == ALLOC_HEADER_MAGIC);
+
+	#if defined(TRACY_ENABLE)
+	TracyFree(ptr);
+	#endif
+
+	if (hdr->weight != 0)
+		MemAccounting::RecordHeapFree(hdr->tag, hdr->weight);
+
+	free(hdr);
+}
+
+
+void* operator new(std::size_t count)
+{
+	void* ptr = SampledAlloc(count);
+
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+
+	return ptr;
+}
+
+void* operator new[](std::size_t count) { return (operator new(count)); }
+void* operator new(std::size_t count, const std::nothrow_t&) noexcept { return (SampledAlloc(count)); }
+void* operator new[](std::size_t count, const std::nothrow_t&) noexcept { return (SampledAlloc(count)); }
+
+void operator delete(void* ptr) noexcept { SampledFree(ptr); }
+void operator delete[](void* ptr) noexcept { SampledFree(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { SampledFree(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { SampledFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { SampledFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { SampledFree(ptr); }
+
+#elif defined(TRACY_ENABLE)
 
 #include <new>
 #include <cstdlib>
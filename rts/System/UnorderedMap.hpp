@@ -43,7 +43,17 @@
 #endif
 
 
+#include "SpringFlatHashTable.hpp"
+#include "SpringHash.h"
+
 namespace spring {
+	// dense open-addressing maps for hot paths; iteration order does not depend on
+	// hashes or capacity (see SpringFlatHashTable.hpp), so unsynced keys are fine too
+	template<typename K, typename V, typename H = spring::synced_hash<K>, typename C = std::equal_to<K>>
+	using flat_hash_map = FlatHashMap<K, V, H, C>;
+	template<typename K, typename V, typename H = std::hash<K>, typename C = std::equal_to<K>>
+	using unsynced_flat_map = FlatHashMap<K, V, H, C>;
+
 	// Synced unordered maps must be reconstructed (on reload)
 	// since clear() may keep the container resized which will
 	// lead to differences in iteration order and then desyncs
@@ -41,7 +41,15 @@
 #endif
 
 
+#include "SpringFlatHashTable.hpp"
+#include "SpringHash.h"
+
 namespace spring {
+	template<typename K, typename H = spring::synced_hash<K>, typename C = std::equal_to<K>>
+	using flat_hash_set = FlatHashSet<K, H, C>;
+	template<typename K, typename H = std::hash<K>, typename C = std::equal_to<K>>
+	using unsynced_flat_set = FlatHashSet<K, H, C>;
+
 	// Synced unordered sets must be reconstructed (on reload)
 	// since clear() may keep the container resized which will
 	// lead to differences in iteration order and then desyncs
@@ -3,6 +3,8 @@
 #ifndef CR_BASIC_TYPES_H
 #define CR_BASIC_TYPES_H
 
+#include <algorithm>
+
 namespace creg {
 	class ObjectPointerBaseType : public IType
 	{
@@ -48,9 +50,11 @@ namespace creg {
 
 		void Serialize(ISerializer* s, void* instance)
 		{
-			for (int a=0;a<size;a++) {
-				char c=0;
-				s->Serialize(&c,1);
+			// ignored members are stored as zeroes (and skipped on load)
+			char buf[256] = {0};
+
+			for (size_t a = 0; a < size; a += sizeof(buf)) {
+				s->Serialize(buf, std::min(sizeof(buf), size - a));
 			}
 		}
 		std::string GetName() const
@@ -67,6 +71,7 @@ namespace creg {
 
 		void Serialize(ISerializer* s, void* instance);
 		std::string GetName() const;
+		bool IsRawCopyable() const { return true; }
 
 		BasicTypeID id;
 	};
@@ -15,7 +15,9 @@ namespace creg {
 	template<typename T>
 	struct ListType : public IType
 	{
-		ListType() : IType(sizeof(T)) {}
+		std::unique_ptr<IType> elemType;
+
+		ListType() : IType(sizeof(T)), elemType(DeduceType<typename T::value_type>::Get()) {}
 		~ListType() {}
 
 		void Serialize(ISerializer* s, void* inst) {
@@ -25,7 +27,7 @@ namespace creg {
 				s->SerializeInt(&size,sizeof(int));
 				for (typename T::iterator it = ct.begin(); it != ct.end(); ++it)
 				{
-					DeduceType<T>::Get()->Serialize(s, &*it);
+					elemType->Serialize(s, &*it);
 				}
 			} else {
 				ct.clear();
@@ -34,11 +36,11 @@ namespace creg {
 				ct.resize(size);
 				for (typename T::iterator it = ct.begin(); it != ct.end(); ++it)
 				{
-					DeduceType<T>::Get()->Serialize(s, &*it);
+					elemType->Serialize(s, &*it);
 				}
 			}
 		}
-		std::string GetName() const { return "list<" + DeduceType<T>::Get()->GetName() + ">"; }
+		std::string GetName() const { return "list<" + elemType->GetName() + ">"; }
 	};
 
 
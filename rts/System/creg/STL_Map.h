@@ -42,7 +42,12 @@ namespace creg
 	{
 		typedef typename T::iterator iterator;
 
-		MapType() : IType(sizeof(T)) { }
+		std::unique_ptr<IType> keyType, mappedType;
+
+		MapType()
+				: IType(sizeof(T))
+				, keyType(DeduceType<typename T::key_type>::Get())
+				, mappedType(DeduceType<typename T::mapped_type>::Get()) {}
 
 		~MapType() { }
 
@@ -53,8 +58,8 @@ namespace creg
 				int size = ct.size();
 				s->SerializeInt(&size, sizeof(int));
 				for (iterator i = ct.begin(); i != ct.end(); ++i)  {
-					DeduceType<typename T::key_type>::Get()->Serialize(s, (void*) &i->first);
-					DeduceType<typename T::mapped_type>::Get()->Serialize(s, &i->second);
+					keyType->Serialize(s, (void*) &i->first);
+					mappedType->Serialize(s, &i->second);
 				}
 			} else {
 				ct.clear();
@@ -63,13 +68,13 @@ namespace creg
 				for (int a = 0; a < size; a++) {
 					typename T::value_type pt;
 					// only allow copying of the key type
-					DeduceType<typename T::key_type>::Get()->Serialize(s, (void*) &pt.first);
+					keyType->Serialize(s, (void*) &pt.first);
 					iterator i = MapInserter<T>().insert(ct, pt);
-					DeduceType<typename T::mapped_type>::Get()->Serialize(s, &i->second);
+					mappedType->Serialize(s, &i->second);
 				}
 			}
 		}
-		std::string GetName() const { return "map<" + DeduceType<typename T::key_type>::Get()->GetName() + ", " + DeduceType<typename T::mapped_type>::Get()->GetName() + ">"; }
+		std::string GetName() const { return "map<" + keyType->GetName() + ", " + mappedType->GetName() + ">"; }
 	};
 
 	// Map type
@@ -99,6 +104,14 @@ namespace creg
 			return std::unique_ptr<IType>(new MapType<spring::unsynced_map<TKey, TValue> >());
 		}
 	};
+	// Flat hash map; elements are written in iteration order and reinserted
+	// in that order, which restores the same iteration order on load
+	template<typename TKey, typename TValue, typename H, typename C>
+	struct DeduceType<spring::FlatHashMap<TKey, TValue, H, C> > {
+		static std::unique_ptr<IType> Get() {
+			return std::unique_ptr<IType>(new MapType<spring::FlatHashMap<TKey, TValue, H, C> >());
+		}
+	};
 
 	template<typename T>
 	struct PairType : public IType
@@ -12,16 +12,21 @@ namespace creg
 	class PairType : public IType
 	{
 	public:
-		PairType() : IType(sizeof(T)) { }
+		std::unique_ptr<IType> firstType, secondType;
+
+		PairType()
+			: IType(sizeof(T))
+			, firstType(DeduceType<typename T::first_type>::Get())
+			, secondType(DeduceType<typename T::second_type>::Get()) { }
 		~PairType() { }
 
 		void Serialize(ISerializer* s, void* instance)
 		{
 			T& p = *(T*)instance;
-			DeduceType<typename T::first_type>::Get()->Serialize(s,(void*) &p.first);
-			DeduceType<typename T::second_type>::Get()->Serialize(s,(void*) &p.second);
+			firstType->Serialize(s,(void*) &p.first);
+			secondType->Serialize(s,(void*) &p.second);
 		}
-		std::string GetName() const { return "pair<" + DeduceType<typename T::first_type>::Get()->GetName() + "," + DeduceType<typename T::second_type>::Get()->GetName() + ">"; }
+		std::string GetName() const { return "pair<" + firstType->GetName() + "," + secondType->GetName() + ">"; }
 	};
 
 
@@ -26,7 +26,9 @@ namespace creg {
 	template<class T, class S, class C>
 	struct PQueueType : public IType
 	{
-		PQueueType() : IType(sizeof(std::priority_queue<T, S, C>)) { }
+		std::unique_ptr<IType> elemType;
+
+		PQueueType() : IType(sizeof(std::priority_queue<T, S, C>)), elemType(DeduceType<T>::Get()) { }
 		~PQueueType() { }
 
 		void Serialize(ISerializer* s, void* inst) {
@@ -36,7 +38,7 @@ namespace creg {
 				s->SerializeInt(&size,sizeof(int));
 				for (typename S::iterator it = ct.begin(); it != ct.end(); ++it)
 				{
-					DeduceType<T>::Get()->Serialize(s, &*it);
+					elemType->Serialize(s, &*it);
 				}
 			} else {
 				ct.clear();
@@ -45,11 +47,11 @@ namespace creg {
 				ct.resize(size);
 				for (typename S::iterator it = ct.begin(); it != ct.end(); ++it)
 				{
-					DeduceType<T>::Get()->Serialize(s, &*it);
+					elemType->Serialize(s, &*it);
 				}
 			}
 		}
-		std::string GetName() const { return "priority_queue<" + DeduceType<T>::Get()->GetName() + ">"; }
+		std::string GetName() const { return "priority_queue<" + elemType->GetName() + ">"; }
 	};
 
 
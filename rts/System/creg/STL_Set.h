@@ -19,7 +19,9 @@ namespace creg
 	public:
 		typedef typename T::iterator iterator;
 
-		SetType() : IType(sizeof(T)) { }
+		std::unique_ptr<IType> elemType;
+
+		SetType() : IType(sizeof(T)), elemType(DeduceType<typename T::value_type>::Get()) { }
 		~SetType() { }
 
 		void Serialize(ISerializer* s, void* instance)
@@ -29,7 +31,7 @@ namespace creg
 				int size = ct.size();
 				s->SerializeInt(&size, sizeof(int));
 				for (iterator i = ct.begin(); i != ct.end(); ++i) {
-					DeduceType<typename T::value_type>::Get()->Serialize(s,(void*) &*i);
+					elemType->Serialize(s,(void*) &*i);
 				}
 			} else {
 				ct.clear();
@@ -37,12 +39,12 @@ namespace creg
 				s->SerializeInt(&size, sizeof(int));
 				for (int i = 0; i < size; i++) {
 					typename T::value_type v;
-					DeduceType<typename T::value_type>::Get()->Serialize(s, &v);
+					elemType->Serialize(s, &v);
 					ct.insert(v);
 				}
 			}
 		}
-		std::string GetName() const { return "set<" + DeduceType<typename T::value_type>::Get()->GetName() + ">"; }
+		std::string GetName() const { return "set<" + elemType->GetName() + ">"; }
 	};
 
 
@@ -74,6 +76,13 @@ namespace creg
 			return std::unique_ptr<IType>(new SetType<spring::unsynced_set<T> >());
 		}
 	};
+	// Flat hash set
+	template<typename T, typename H, typename C>
+	struct DeduceType<spring::FlatHashSet<T, H, C> > {
+		static std::unique_ptr<IType> Get() {
+			return std::unique_ptr<IType>(new SetType<spring::FlatHashSet<T, H, C> >());
+		}
+	};
 }
 
 #endif // USING_CREG
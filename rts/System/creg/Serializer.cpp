@@ -11,7 +11,6 @@
 #include "Serializer.h"
 
 #include "System/Log/ILog.h"
-#include "System/Platform/byteorder.h"
 #include "System/Exceptions.h"
 
 #include <algorithm>
@@ -34,7 +33,7 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_CREG_SERIALIZER)
 //
 #define CREG_PACKAGE_FILE_ID "CRPK"
 
-// File format structures
+// File format structures, stored in native byte order like the object data
 struct PackageHeader
 {
 	char magic[4];
@@ -45,15 +44,6 @@ struct PackageHeader
 	int numObjClassRefs = 0;
 	unsigned int metadataChecksum = 0;
 
-	void SwapBytes()
-	{
-		swabDWordInPlace(objDataOffset);
-		swabDWordInPlace(objTableOffset);
-		swabDWordInPlace(objClassRefOffset);
-		swabDWordInPlace(numObjClassRefs);
-		swabDWordInPlace(numObjects);
-		swabDWordInPlace(metadataChecksum);
-	}
 	PackageHeader()
 	{
 		magic[0] = 0;
@@ -146,51 +136,29 @@ COutputStreamSerializer::ObjectRef* COutputStreamSerializer::FindObjectRef(void*
 	return nullptr;
 }
 
-void COutputStreamSerializer::SerializeObject(Class* c, void* ptr, ObjectRef* objr)
+void COutputStreamSerializer::SerializeObject(Class* c, void* ptr)
 {
-	const unsigned objstart = stream->tellp();
-
-	if (c->base())
-		SerializeObject(c->base(), ptr, objr);
+	// stream positions are only needed for the per-class size statistics
+	const bool logSizes = LOG_IS_ENABLED(L_DEBUG);
+	const unsigned objstart = logSizes? unsigned(stream->tellp()): 0;
 
-	ObjectMemberGroup omg;
-	omg.membersClass = c;
-	omg.size = 0;
+	for (const Class::PlanStep& step: c->GetSerializePlan()) {
+		char* addr = static_cast<char*>(ptr) + step.offset;
 
-	for (uint a = 0; a < c->members.size(); a++)
-	{
-		creg::Class::Member* m = &c->members[a];
-		if (m->flags & CM_NoSerialize)
+		if (step.type != nullptr) {
+			step.type->Serialize(this, addr);
 			continue;
+		}
+		if (step.procClass != nullptr) {
+			step.procClass->CallSerializeProc(ptr, this);
+			continue;
+		}
 
-		ObjectMember om;
-		om.member = m;
-		om.memberId = a;
-		void* memberAddr = ((char*)ptr) + m->offset;
-		unsigned mstart = stream->tellp();
-		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s::%s type:%s", c->name, m->name, m->type->GetName().c_str());
-		m->type->Serialize(this, memberAddr);
-		unsigned mend = stream->tellp();
-		om.size = mend - mstart;
-		omg.members.push_back(om);
-		omg.size += om.size;
-		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s::%s type:%s size:%d", c->name, m->name, m->type->GetName().c_str(), om.size);
-	}
-
-
-	if (c->HasSerialize()) {
-		ObjectMember om;
-		om.member = nullptr;
-		om.memberId = -1;
-		unsigned mstart = stream->tellp();
-		c->CallSerializeProc(ptr, this);
-		unsigned mend = stream->tellp();
-		om.size = mend - mstart;
-		omg.members.push_back(om);
-		omg.size += om.size;
+		stream->write(addr, step.size);
 	}
 
-	objr->memberGroups.push_back(omg);
+	if (!logSizes)
+		return;
 
 	const unsigned objend = stream->tellp();
 	const int sz = objend - objstart;
@@ -209,12 +177,11 @@ void COutputStreamSerializer::SerializeObjectInstance(void* inst, creg::Class* o
 	} else if (obj->isEmbedded) {
 		throw std::string("Reserialization of embedded object (") + objClass->name + ")";
 	} else {
-		std::vector<ObjectRef*>::iterator it = std::find(pendingObjects.begin(), pendingObjects.end(), obj);
-		if (it == pendingObjects.end()) {
+		if (!obj->isPending)
 			throw std::string("Object pointer was serialized (") + objClass->name + ")";
-		} else {
-			pendingObjects.erase(it);
-		}
+
+		// saved here instead, the stale entry in pendingObjects is skipped
+		obj->isPending = false;
 	}
 	obj->class_ = objClass;
 	obj->isEmbedded = true;
@@ -223,7 +190,7 @@ void COutputStreamSerializer::SerializeObjectInstance(void* inst, creg::Class* o
 	WriteVarSizeUInt(stream, obj->id);
 
 	// write the object
-	SerializeObject(objClass, inst, obj);
+	SerializeObject(objClass, inst);
 }
 
 void COutputStreamSerializer::SerializeObjectPtr(void** ptr, creg::Class* objClass)
@@ -235,6 +202,7 @@ void COutputStreamSerializer::SerializeObjectPtr(void** ptr, creg::Class* objCla
 		if (!obj) {
 			objects.emplace_back(*ptr, objects.size(), false, objClass);
 			obj = &objects.back();
+			obj->isPending = true;
 			ptrToId[*ptr].push_back(obj);
 			pendingObjects.push_back(obj);
 		}
@@ -254,9 +222,9 @@ void COutputStreamSerializer::Serialize(void* data, int byteSize)
 
 void COutputStreamSerializer::SerializeInt(void* data, int byteSize)
 {
-	// always save ints as 64bit
-	// cause of int-types might differ in size depending on platforms
-	// to make savegames compatible between those we need to so
+	// stored as 64bit varint whatever byteSize is; used for container sizes
+	// and basic types outside of plans (e.g. map keys), members in a plan's
+	// raw ranges are native-endian bytes instead (see CREG_FORMAT_VERSION)
 	std::uint64_t x = 0;
 	switch (byteSize) {
 		case 1: { x = *(std::uint8_t* )data; break; }
@@ -295,6 +263,7 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	// Insert the first object that will provide references to everything
 	objects.emplace_back(rootObj, objects.size(), false, rootObjClass);
 	obj = &objects.back();
+	obj->isPending = true;
 	ptrToId[rootObj].push_back(obj);
 	pendingObjects.push_back(obj);
 
@@ -305,7 +274,12 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 		pendingObjects.clear();
 
 		for (ObjectRef* obj: po) {
-			SerializeObject(obj->class_, obj->ptr, obj);
+			// became embedded since it was queued
+			if (!obj->isPending)
+				continue;
+
+			obj->isPending = false;
+			SerializeObject(obj->class_, obj->ptr);
 			//LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s size:%i", obj->class_->name.c_str(), sz);
 		}
 	}
@@ -381,7 +355,7 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	}
 
 	// Calculate a checksum for metadata verification
-	ph.metadataChecksum = 0;
+	ph.metadataChecksum = CREG_FORMAT_VERSION;
 	for (auto& classRef: classRefs) {
 		Class* c = classRef->class_;
 		c->CalculateChecksum(ph.metadataChecksum);
@@ -390,7 +364,6 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	int endOffset = stream->tellp();
 	stream->seekp(startOffset);
 	memcpy(ph.magic, CREG_PACKAGE_FILE_ID, 4);
-	ph.SwapBytes();
 	stream->write((const char*)&ph, sizeof(PackageHeader));
 
 	LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG,
@@ -429,23 +402,19 @@ bool CInputStreamSerializer::IsWriting()
 
 void CInputStreamSerializer::SerializeObject(Class* c, void* ptr)
 {
-	if (c->base())
-		SerializeObject(c->base(), ptr);
+	for (const Class::PlanStep& step: c->GetSerializePlan()) {
+		char* addr = static_cast<char*>(ptr) + step.offset;
 
-	for (uint a = 0; a < c->members.size(); a++)
-	{
-		creg::Class::Member* m = &c->members[a];
-		if (m->flags & CM_NoSerialize)
+		if (step.type != nullptr) {
+			step.type->Serialize(this, addr);
 			continue;
+		}
+		if (step.procClass != nullptr) {
+			step.procClass->CallSerializeProc(ptr, this);
+			continue;
+		}
 
-		const unsigned oldPos = stream->tellg();
-		void* memberAddr = ((char*)ptr) + m->offset;
-		m->type->Serialize(this, memberAddr);
-		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Deserialized %s::%s type:%s size:%u", c->name, m->name, m->type->GetName().c_str(), unsigned(stream->tellg()) - oldPos);
-	}
-
-	if (c->HasSerialize()) {
-		c->CallSerializeProc(ptr, this);
+		stream->read(addr, step.size);
 	}
 }
 
@@ -456,9 +425,9 @@ void CInputStreamSerializer::Serialize(void* data, int byteSize)
 
 void CInputStreamSerializer::SerializeInt(void* data, int byteSize)
 {
-	// always save ints as 64bit
-	// cause of int-types might differ in size depending on platforms
-	// to make savegames compatible between those we need to so
+	// stored as 64bit varint whatever byteSize is; used for container sizes
+	// and basic types outside of plans (e.g. map keys), members in a plan's
+	// raw ranges are native-endian bytes instead (see CREG_FORMAT_VERSION)
 	std::uint64_t x = 0;
 	ReadVarSizeUInt(stream, &x);
 	switch (byteSize) {
@@ -553,7 +522,7 @@ void CInputStreamSerializer::LoadPackage(std::istream* s, void*& root, creg::Cla
 
 	{
 		// Calculate metadata checksum and compare with stored checksum
-		unsigned int checksum = 0;
+		unsigned int checksum = CREG_FORMAT_VERSION;
 
 		for (const auto& classRef: classRefs)
 			classRef->CalculateChecksum(checksum);
@@ -8,13 +8,21 @@
 
 #ifdef USING_CREG
 
+#include <bit>
 #include <map>
 #include <vector>
 #include <deque>
 #include <istream>
 
+#include "System/UnorderedMap.hpp"
+
 namespace creg {
 
+	// mixed into the metadata checksum; bump whenever the encoding of members changes
+	// (2: adjacent raw-copyable members and POD arrays are stored as raw bytes)
+	// packages are native-endian, the top bit keeps the other byte order from loading them
+	static constexpr unsigned int CREG_FORMAT_VERSION = 2 | ((std::endian::native == std::endian::big)? 0x80000000u: 0u);
+
 	/**
 	 * Output stream serializer
 	 * Usage: create an instance of this class and call SavePackage
@@ -23,22 +31,13 @@ namespace creg {
 	class COutputStreamSerializer : public ISerializer
 	{
 	protected:
-		struct ObjectMember {
-			Class::Member* member;
-			int memberId;
-			int size;
-		};
-		struct ObjectMemberGroup {
-			Class* membersClass;
-			std::vector<COutputStreamSerializer::ObjectMember> members;
-			int size;
-		};
 		struct ObjectRef {
 			ObjectRef() {
 				ptr = 0;
 				id=0;
 				classIndex=0;
 				isEmbedded=false;
+				isPending=false;
 				class_=0;
 			}
 			ObjectRef(void* ptr, int id, bool isEmbedded, Class* class_) {
@@ -46,20 +45,14 @@ namespace creg {
 				this->id=id;
 				classIndex=0;
 				this->isEmbedded=isEmbedded;
+				isPending=false;
 				this->class_=class_;
 			}
-			ObjectRef(const ObjectRef&src) :memberGroups(src.memberGroups){
-				ptr=src.ptr;
-				id=src.id;
-				classIndex=src.classIndex;
-				isEmbedded=src.isEmbedded;
-				class_=src.class_;
-			}
 			void* ptr;
 			int id, classIndex;
 			bool isEmbedded;
+			bool isPending; // referenced by pointer, but not yet saved
 			Class* class_;
-			std::vector<COutputStreamSerializer::ObjectMemberGroup> memberGroups;
 			bool isThisObject(void* objPtr, Class* objClass, bool objEmbedded) const
 			{
 				if (ptr != objPtr) return false;
@@ -81,7 +74,7 @@ namespace creg {
 		struct ClassRef;
 
 		std::ostream* stream;
-		std::map<void*,std::vector<ObjectRef*> > ptrToId;
+		spring::unsynced_map<void*, std::vector<ObjectRef*> > ptrToId;
 		std::deque<ObjectRef> objects;
 		std::vector<ObjectRef*> pendingObjects; // these objects still have to be saved
 		std::map<Class*, int> classSizes;
@@ -94,7 +87,7 @@ namespace creg {
 
 		ObjectRef* FindObjectRef(void* inst, Class* objClass, bool isEmbedded);
 
-		void SerializeObject(Class* c, void* ptr, ObjectRef* objr);
+		void SerializeObject(Class* c, void* ptr);
 
 	public:
 		COutputStreamSerializer();
@@ -8,6 +8,7 @@
 #ifndef _TYPE_DEDUCTION_H
 #define _TYPE_DEDUCTION_H
 
+#include <iterator>
 #include <memory>
 #include "creg_cond.h"
 
@@ -61,6 +62,11 @@ struct DeduceType<SyncedPrimitive<T>, typename std::enable_if<std::is_floating_p
 };
 #endif
 
+// types whose DeduceType is a BasicType, i.e. which are saved as raw native-endian bytes
+// inside plans and can be bulk-copied when stored contiguously
+template<typename T>
+static constexpr bool IsRawCopyableType = (std::is_arithmetic<T>::value || std::is_enum<T>::value);
+
 // helper
 template<typename T>
 class ObjectPointerType : public ObjectPointerBaseType
@@ -104,10 +110,15 @@ public:
 	{
 		T* array = (T*) instance;
 
-		for (int a = 0; a < N; a++) {
-			DeduceType<T>::Get()->Serialize(s, &array[a]);
+		if constexpr (IsRawCopyableType<T>) {
+			s->Serialize(array, N * sizeof(T));
+		} else {
+			for (int a = 0; a < N; a++) {
+				elemType->Serialize(s, &array[a]);
+			}
 		}
 	}
+	bool IsRawCopyable() const { return IsRawCopyableType<T>; }
 };
 
 template<typename T, size_t ArraySize>
@@ -132,10 +143,15 @@ public:
 	{
 		ArrayT& array = *(ArrayT*) instance;
 
-		for (size_t a = 0; a < array.size(); a++) {
-			DeduceType<ElemT>::Get()->Serialize(s, &array[a]);
+		if constexpr (IsRawCopyableType<ElemT>) {
+			s->Serialize(array.data(), array.size() * sizeof(ElemT));
+		} else {
+			for (size_t a = 0; a < array.size(); a++) {
+				elemType->Serialize(s, &array[a]);
+			}
 		}
 	}
+	bool IsRawCopyable() const { return IsRawCopyableType<ElemT>; }
 };
 
 template<typename ElemT, size_t ArraySize>
@@ -162,19 +178,28 @@ public:
 		if (s->IsWriting()) {
 			int size = (int) ct.size();
 			s->SerializeInt(&size, sizeof(int));
-
-			for (int a = 0; a < size; a++) {
-				DeduceType<ElemT>::Get()->Serialize(s, &ct[a]);
-			}
+			SerializeElements(s, ct, size);
 		} else {
 			int size;
 			s->SerializeInt(&size, sizeof(int));
 
 			ct.clear();
 			ct.resize(size);
+			SerializeElements(s, ct, size);
+		}
+	}
+
+private:
+	void SerializeElements(ISerializer* s, VectorT& ct, int size) {
+		// std::deque also lands here but is not contiguous
+		constexpr bool isContiguous = std::contiguous_iterator<typename VectorT::iterator>;
 
+		if constexpr (IsRawCopyableType<ElemT> && isContiguous) {
+			if (size > 0)
+				s->Serialize(&ct[0], size * sizeof(ElemT));
+		} else {
 			for (int a = 0; a < size; a++) {
-				DeduceType<ElemT>::Get()->Serialize(s, &ct[a]);
+				elemType->Serialize(s, &ct[a]);
 			}
 		}
 	}
@@ -206,7 +231,7 @@ public:
 			s->SerializeInt(&size, sizeof(int));
 			for (int a = 0; a < size; a++) {
 				bool b = (*ct)[a];
-				DeduceType<ElemT>::Get()->Serialize(s, &b);
+				elemType->Serialize(s, &b);
 			}
 		} else {
 			int size;
@@ -214,7 +239,7 @@ public:
 			ct->resize(size);
 			for (int a = 0; a < size; a++) {
 				bool b;
-				DeduceType<ElemT>::Get()->Serialize(s, &b);
+				elemType->Serialize(s, &b);
 				(*ct)[a] = b;
 			}
 		}
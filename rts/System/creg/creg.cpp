@@ -232,6 +232,49 @@ void Class::CalculateChecksum(unsigned int& checksum)
 }
 
 
+static void AppendPlanSteps(Class* c, std::vector<Class::PlanStep>& plan)
+{
+	if (c->base() != nullptr)
+		AppendPlanSteps(c->base(), plan);
+
+	for (const Class::Member& m: c->members) {
+		if (m.flags & CM_NoSerialize)
+			continue;
+
+		if (!m.type->IsRawCopyable()) {
+			plan.push_back({m.offset, 0, m.type.get(), nullptr});
+			continue;
+		}
+
+		// padding between members breaks a run, s.t. only member bytes are written
+		if (!plan.empty()) {
+			Class::PlanStep& prv = plan.back();
+
+			if (prv.type == nullptr && prv.procClass == nullptr && (prv.offset + prv.size) == m.offset) {
+				prv.size += m.type->GetSize();
+				continue;
+			}
+		}
+
+		plan.push_back({m.offset, static_cast<unsigned int>(m.type->GetSize()), nullptr, nullptr});
+	}
+
+	if (c->HasSerialize())
+		plan.push_back({0, 0, nullptr, c});
+}
+
+const std::vector<Class::PlanStep>& Class::GetSerializePlan()
+{
+	if (!hasSerializePlan) {
+		serializePlan.clear();
+		AppendPlanSteps(this, serializePlan);
+		hasSerializePlan = true;
+	}
+
+	return serializePlan;
+}
+
+
 // -------------------------------------------------------------------
 // System
 // -------------------------------------------------------------------
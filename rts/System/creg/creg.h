@@ -54,6 +54,8 @@ namespace creg {
 
 		virtual void Serialize(ISerializer* s, void* instance) = 0;
 		virtual std::string GetName() const = 0;
+		/// true if instances are saved as their raw native-endian bytes, s.t. adjacent members can be copied in one go
+		virtual bool IsRawCopyable() const { return false; }
 		size_t GetSize() const { return size; };
 		size_t size;
 		std::string name;
@@ -83,6 +85,19 @@ namespace creg {
 			int flags; // combination of ClassMemberFlag's
 		};
 
+		/**
+		 * One step of a serialization plan: either a raw byte range
+		 * covering one or more adjacent raw-copyable members, a member
+		 * that needs its IType, or a call to a custom serialize method.
+		 */
+		struct PlanStep
+		{
+			unsigned int offset;
+			unsigned int size; // raw range size in bytes if type and procClass are null
+			IType* type;
+			Class* procClass; // class whose serializeProc to call
+		};
+
 
 		Class(const char* className, ClassFlags cf, Class* base,
 				void (*memberRegistrator)(creg::Class*),
@@ -104,6 +119,14 @@ namespace creg {
 
 		/// Calculate a checksum from the class metadata
 		void CalculateChecksum(unsigned int& checksum);
+
+		/**
+		 * Returns the members of this class and its bases in serialization
+		 * order, with runs of adjacent raw-copyable members merged. Built on
+		 * first use since the Class objects of bases are not guaranteed to
+		 * be constructed yet when this one is registered.
+		 */
+		const std::vector<PlanStep>& GetSerializePlan();
 		void AddMember(const char* name, std::unique_ptr<IType> type, unsigned int offset, int alignment, ClassMemberFlag flags);
 		void SetMemberFlag(const char* name, ClassMemberFlag f);
 		Member* FindMember(const char* name, const bool inherited = true);
@@ -147,6 +170,9 @@ namespace creg {
 		bool isCregStruct;
 
 		std::vector<Member> members;
+		std::vector<PlanStep> serializePlan;
+		bool hasSerializePlan = false;
+
 		const char* name;
 		int size; // size of an instance in bytes
 		int alignment;
@@ -129,6 +129,10 @@ int main(int argc, char* argv[])
 		FileSystemInitializer::InitializeLogOutput();
 		FileSystemInitializer::Initialize();
 
+		// several servers on one host each take their own share of the cores
+		Threading::DetectCores();
+		Threading::SetAffinityHelper("Main", Threading::PlanAffinity(globalConfig.affinityPartitions, globalConfig.affinityPartitionIndex).partitionCores);
+
 		// Initialize crash reporting
 		CrashHandler::Install();
 
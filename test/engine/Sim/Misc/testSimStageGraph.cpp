@@ -0,0 +1,104 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/SimStageGraph.h"
+#include "System/Threading/ThreadPool.h"
+#include "System/Threading/SpringThreading.h"
+#include "System/Platform/Threading.h"
+
+#include <atomic>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+InitSpringTime ist;
+
+struct InitThreads {
+	InitThreads() {
+		Threading::DetectCores();
+		ThreadPool::SetThreadCount(ThreadPool::GetMaxThreads());
+	}
+};
+
+static InitThreads initThreads;
+
+
+TEST_CASE("SimStageGraph_Dependencies")
+{
+	using SSG = CSimStageGraph;
+
+	SSG graph;
+	graph.AddStage("a", SSG::RES_HEIGHTMAP, SSG::RES_HEIGHT_BOUNDS, false, []() {});
+	graph.AddStage("b", SSG::RES_HEIGHTMAP, SSG::RES_SMOOTH_MESH, false, []() {});
+	graph.AddStage("c", SSG::RES_HEIGHT_BOUNDS, SSG::RES_LOS, false, []() {});
+	graph.AddStage("d", SSG::RES_ALL, SSG::RES_ALL, true, []() {});
+
+	const auto& stages = graph.GetStages();
+
+	// shared reads do not conflict
+	CHECK(stages[1].deps.empty());
+	CHECK(stages[2].deps == std::vector<size_t>{0});
+	CHECK(stages[3].deps == std::vector<size_t>{0, 1, 2});
+
+	// a and b overlap with their successors, c is waited on right away
+	CHECK(stages[0].async);
+	CHECK(stages[1].async);
+	CHECK(!stages[2].async);
+	CHECK(!stages[3].async);
+}
+
+
+TEST_CASE("SimStageGraph_Order")
+{
+	using SSG = CSimStageGraph;
+
+	static constexpr int NUM_STAGES = 64;
+	static constexpr int NUM_RUNS = 50;
+
+	std::atomic<int> counter = {0};
+	std::vector<int> order(NUM_STAGES, -1);
+	std::vector<int> resOwner(2, -1);
+
+	SSG graph;
+
+	for (int i = 0; i < NUM_STAGES; i++) {
+		// every fourth stage writes both resources, the others one of them
+		const uint32_t writes = ((i % 4) == 3)? (SSG::RES_UNITS | SSG::RES_PATHS): ((i & 1)? SSG::RES_PATHS: SSG::RES_UNITS);
+
+		graph.AddStage("stage", 0, writes, false, [&, i, writes]() {
+			order[i] = counter++;
+
+			if (writes & SSG::RES_UNITS)
+				resOwner[0] = i;
+			if (writes & SSG::RES_PATHS)
+				resOwner[1] = i;
+		});
+	}
+
+	for (int n = 0; n < NUM_RUNS; n++) {
+		counter = 0;
+		graph.Run();
+
+		const auto& stages = graph.GetStages();
+
+		for (int i = 0; i < NUM_STAGES; i++) {
+			for (const size_t dep: stages[i].deps) {
+				CHECK(order[dep] < order[i]);
+			}
+		}
+
+		// the last writers of each resource win, as if run in sequence
+		CHECK(resOwner[0] == NUM_STAGES - 1);
+		CHECK(resOwner[1] == NUM_STAGES - 1);
+	}
+
+	// the critical path ends at the last stage and follows dependencies
+	const auto& path = graph.GetCriticalPath();
+
+	REQUIRE(!path.empty());
+	CHECK(path.back() == NUM_STAGES - 1);
+
+	for (size_t i = 1; i < path.size(); i++) {
+		CHECK(path[i - 1] < path[i]);
+	}
+}
@@ -2,6 +2,8 @@
 
 #include "System/creg/creg_cond.h"
 #include "System/creg/Serializer.h"
+#include <chrono>
+#include <cstdint>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -173,3 +175,246 @@ TEST_CASE("CregLoadSave")
 
 	delete root;
 }
+
+
+
+struct WorldVec {
+	CR_DECLARE_STRUCT(WorldVec);
+	float x, y, z;
+};
+
+CR_BIND(WorldVec, );
+CR_REG_METADATA(WorldVec, (CR_MEMBER(x), CR_MEMBER(y), CR_MEMBER(z)));
+
+struct WorldObj {
+	CR_DECLARE(WorldObj);
+
+	WorldObj() = default;
+	virtual ~WorldObj() {}
+
+	int id = 0;
+	int team = 0;
+	float health = 0.0f;
+	float speed[4] = {};
+	WorldVec pos = {};
+	WorldVec dir = {};
+	std::vector<float> history;
+	std::vector<int> flags;
+	std::string name;
+	WorldObj* target = nullptr;
+};
+
+CR_BIND(WorldObj, );
+CR_REG_METADATA(WorldObj, (
+	CR_MEMBER(id),
+	CR_MEMBER(team),
+	CR_MEMBER(health),
+	CR_MEMBER(speed),
+	CR_MEMBER(pos),
+	CR_MEMBER(dir),
+	CR_MEMBER(history),
+	CR_MEMBER(flags),
+	CR_MEMBER(name),
+	CR_MEMBER(target)
+));
+
+struct World {
+	CR_DECLARE(World);
+
+	World() = default;
+	virtual ~World() {
+		for (WorldObj* o: objects) delete o;
+	}
+
+	std::vector<WorldObj*> objects;
+};
+
+CR_BIND(World, );
+CR_REG_METADATA(World, (CR_MEMBER(objects)));
+
+
+TEST_CASE("CregLoadSaveWorld")
+{
+	constexpr int NUM_OBJECTS = 10000;
+
+	World* world = new World();
+	world->objects.reserve(NUM_OBJECTS);
+
+	for (int i = 0; i < NUM_OBJECTS; i++) {
+		WorldObj* o = new WorldObj();
+		o->id = i;
+		o->team = i % 16;
+		o->health = i * 0.5f;
+		o->pos = {i * 1.0f, i * 2.0f, i * 3.0f};
+		o->dir = {0.0f, 1.0f, 0.0f};
+		o->history.assign(32, i * 0.25f);
+		o->flags.assign(8, i);
+		o->name = "obj" + std::to_string(i);
+
+		for (int a = 0; a < 4; a++) o->speed[a] = i + a;
+
+		world->objects.push_back(o);
+	}
+	for (int i = 0; i < NUM_OBJECTS; i++) {
+		world->objects[i]->target = world->objects[(i * 7) % NUM_OBJECTS];
+	}
+
+	std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+
+	const auto t0 = std::chrono::steady_clock::now();
+	{
+		creg::COutputStreamSerializer os;
+		os.SavePackage(&ss, world, world->GetClass());
+	}
+	const auto t1 = std::chrono::steady_clock::now();
+
+	void* root = nullptr;
+	creg::Class* rootCls = nullptr;
+	{
+		creg::CInputStreamSerializer is;
+		is.LoadPackage(&ss, root, rootCls);
+	}
+	const auto t2 = std::chrono::steady_clock::now();
+
+	printf("\tsave: %.2fms load: %.2fms (%d objects, %d bytes)\n",
+		std::chrono::duration<float, std::milli>(t1 - t0).count(),
+		std::chrono::duration<float, std::milli>(t2 - t1).count(),
+		NUM_OBJECTS, int(ss.str().size())
+	);
+
+	World* loaded = static_cast<World*>(root);
+
+	REQUIRE(rootCls == World::StaticClass());
+	REQUIRE(loaded->objects.size() == NUM_OBJECTS);
+
+	for (int i = 0; i < NUM_OBJECTS; i++) {
+		const WorldObj* a = world->objects[i];
+		const WorldObj* b = loaded->objects[i];
+
+		CHECK(b->id == a->id);
+		CHECK(b->team == a->team);
+		CHECK(b->health == a->health);
+		CHECK(b->speed[3] == a->speed[3]);
+		CHECK(b->pos.z == a->pos.z);
+		CHECK(b->dir.y == a->dir.y);
+		CHECK(b->history == a->history);
+		CHECK(b->flags == a->flags);
+		CHECK(b->name == a->name);
+		CHECK(b->target == loaded->objects[(i * 7) % NUM_OBJECTS]);
+	}
+
+	delete loaded;
+	delete world;
+}
+
+
+
+struct SnapshotPlayer {
+	CR_DECLARE(SnapshotPlayer);
+
+	SnapshotPlayer() = default;
+	virtual ~SnapshotPlayer() {}
+
+	int playerNum = -1;
+	int team = 0;
+	bool spectator = false;
+	std::string name;
+};
+
+CR_BIND(SnapshotPlayer, );
+CR_REG_METADATA(SnapshotPlayer, (
+	CR_MEMBER(playerNum),
+	CR_MEMBER(team),
+	CR_MEMBER(spectator),
+	CR_MEMBER(name)
+));
+
+struct SnapshotPlayerHandler {
+	CR_DECLARE_STRUCT(SnapshotPlayerHandler);
+
+	std::vector<SnapshotPlayer> players;
+};
+
+CR_BIND(SnapshotPlayerHandler, );
+CR_REG_METADATA(SnapshotPlayerHandler, (CR_MEMBER(players)));
+
+static SnapshotPlayerHandler snapshotPlayerHandler;
+
+// same layout as the state CregLoadSaveHandler adds to rejoin snapshots:
+// plain members plus a global that is not owned by the package itself
+struct SnapshotStateCollector {
+	CR_DECLARE_STRUCT(SnapshotStateCollector);
+
+	std::uint64_t rngGenState = 0;
+	std::uint64_t rngInitSeed = 0;
+	std::uint64_t rngLastSeed = 0;
+
+	void Serialize(creg::ISerializer* s) {
+		s->SerializeObjectInstance(&snapshotPlayerHandler, snapshotPlayerHandler.GetClass());
+	}
+};
+
+CR_BIND(SnapshotStateCollector, );
+CR_REG_METADATA(SnapshotStateCollector, (
+	CR_MEMBER(rngGenState),
+	CR_MEMBER(rngInitSeed),
+	CR_MEMBER(rngLastSeed),
+	CR_SERIALIZER(Serialize)
+));
+
+
+TEST_CASE("CregLoadSaveSnapshotState")
+{
+	snapshotPlayerHandler.players.resize(3);
+
+	for (int i = 0; i < 3; i++) {
+		snapshotPlayerHandler.players[i].playerNum = i;
+		snapshotPlayerHandler.players[i].team = i * 2;
+		snapshotPlayerHandler.players[i].spectator = (i == 2);
+		snapshotPlayerHandler.players[i].name = "player" + std::to_string(i);
+	}
+
+	std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+
+	{
+		SnapshotStateCollector ssc;
+		ssc.rngGenState = 0x853c49e6748fea9bULL;
+		ssc.rngInitSeed = 1234;
+		ssc.rngLastSeed = 5678;
+
+		creg::COutputStreamSerializer os;
+		os.SavePackage(&ss, &ssc, ssc.GetClass());
+	}
+
+	// the loading client knows fewer players, and different ones
+	snapshotPlayerHandler.players.resize(1);
+	snapshotPlayerHandler.players[0].name = "joining";
+	snapshotPlayerHandler.players[0].team = 7;
+
+	void* root = nullptr;
+	creg::Class* rootCls = nullptr;
+	{
+		creg::CInputStreamSerializer is;
+		is.LoadPackage(&ss, root, rootCls);
+	}
+
+	REQUIRE(rootCls == SnapshotStateCollector::StaticClass());
+
+	const SnapshotStateCollector* ssc = static_cast<SnapshotStateCollector*>(root);
+
+	CHECK(ssc->rngGenState == 0x853c49e6748fea9bULL);
+	CHECK(ssc->rngInitSeed == 1234);
+	CHECK(ssc->rngLastSeed == 5678);
+
+	// the global itself was overwritten, not a copy of it
+	REQUIRE(snapshotPlayerHandler.players.size() == 3);
+
+	for (int i = 0; i < 3; i++) {
+		CHECK(snapshotPlayerHandler.players[i].playerNum == i);
+		CHECK(snapshotPlayerHandler.players[i].team == i * 2);
+		CHECK(snapshotPlayerHandler.players[i].spectator == (i == 2));
+		CHECK(snapshotPlayerHandler.players[i].name == "player" + std::to_string(i));
+	}
+
+	delete ssc;
+}
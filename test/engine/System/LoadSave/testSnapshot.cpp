@@ -0,0 +1,214 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "Net/Protocol/SnapshotData.h"
+#include "System/GlobalRNG.h"
+#include "System/Net/RawPacket.h"
+#include "System/Net/UnpackPacket.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+static constexpr uint8_t PROVIDER_NUM = 3;
+static constexpr int32_t SNAPSHOT_FRAME = 9000;
+static constexpr uint32_t SYNC_CHECKSUM = 0x12345678;
+
+static std::vector<uint8_t> MakeState(uint32_t size)
+{
+	std::vector<uint8_t> state(size);
+
+	for (uint32_t i = 0; i < size; i++) {
+		state[i] = static_cast<uint8_t>((i * 31) ^ (i >> 8));
+	}
+
+	return state;
+}
+
+static std::vector<std::shared_ptr<const netcode::RawPacket>> MakeChunks(
+	const std::vector<uint8_t>& state,
+	uint32_t chunkSize,
+	uint8_t playerNum = PROVIDER_NUM,
+	int32_t frameNum = SNAPSHOT_FRAME
+) {
+	std::vector<std::shared_ptr<const netcode::RawPacket>> chunks;
+
+	const uint32_t dataSize = state.size();
+	const uint32_t dataChecksum = CSnapshotData::GetChecksum(state);
+
+	for (uint32_t offset = 0; offset < dataSize; offset += chunkSize) {
+		const auto chunkBeg = state.begin() + offset;
+		const auto chunkEnd = chunkBeg + std::min(chunkSize, dataSize - offset);
+
+		chunks.push_back(CBaseNetProtocol::Get().SendSnapshotData(playerNum, frameNum, SYNC_CHECKSUM, dataChecksum, dataSize, offset, {chunkBeg, chunkEnd}));
+	}
+
+	return chunks;
+}
+
+
+
+TEST_CASE("SnapshotChunks")
+{
+	const std::vector<uint8_t> state = MakeState(20000);
+	const auto chunks = MakeChunks(state, 8192);
+
+	REQUIRE(chunks.size() == 3);
+
+	SECTION("server reassembles the upload it asked for") {
+		CSnapshotData snapshot;
+		snapshot.Expect(PROVIDER_NUM, SNAPSHOT_FRAME);
+
+		for (const auto& chunk: chunks) {
+			CHECK(!snapshot.IsComplete());
+			CHECK(snapshot.AddChunk(chunk) == CSnapshotData::CHUNK_ADDED);
+		}
+
+		CHECK(snapshot.IsComplete());
+		CHECK(snapshot.CheckData());
+		CHECK(snapshot.data == state);
+		CHECK(snapshot.dataSize == state.size());
+		CHECK(snapshot.syncChecksum == SYNC_CHECKSUM);
+		CHECK(snapshot.playerNum == PROVIDER_NUM);
+		CHECK(snapshot.frameNum == SNAPSHOT_FRAME);
+	}
+
+	SECTION("client takes the first snapshot it is sent") {
+		CSnapshotData snapshot;
+		snapshot.ExpectAny();
+
+		for (const auto& chunk: chunks) {
+			CHECK(snapshot.AddChunk(chunk) == CSnapshotData::CHUNK_ADDED);
+		}
+
+		CHECK(snapshot.CheckData());
+		CHECK(snapshot.playerNum == PROVIDER_NUM);
+		CHECK(snapshot.frameNum == SNAPSHOT_FRAME);
+
+		// the source is fixed once the first chunk arrived
+		snapshot.ExpectAny();
+		CHECK(snapshot.AddChunk(chunks[0]) == CSnapshotData::CHUNK_ADDED);
+		CHECK(snapshot.AddChunk(MakeChunks(state, 8192, PROVIDER_NUM, SNAPSHOT_FRAME + 1)[1]) == CSnapshotData::CHUNK_IGNORED);
+	}
+
+	SECTION("chunks of other snapshots, duplicates and gaps are ignored") {
+		CSnapshotData snapshot;
+
+		// nothing was requested
+		CHECK(snapshot.AddChunk(chunks[0]) == CSnapshotData::CHUNK_IGNORED);
+
+		snapshot.Expect(PROVIDER_NUM, SNAPSHOT_FRAME);
+
+		CHECK(snapshot.AddChunk(MakeChunks(state, 8192, PROVIDER_NUM + 1)[0]) == CSnapshotData::CHUNK_IGNORED);
+		CHECK(snapshot.AddChunk(MakeChunks(state, 8192, PROVIDER_NUM, SNAPSHOT_FRAME - 1)[0]) == CSnapshotData::CHUNK_IGNORED);
+		CHECK(snapshot.AddChunk(chunks[1]) == CSnapshotData::CHUNK_IGNORED);
+		CHECK(snapshot.IsEmpty());
+
+		CHECK(snapshot.AddChunk(chunks[0]) == CSnapshotData::CHUNK_ADDED);
+		CHECK(snapshot.AddChunk(chunks[0]) == CSnapshotData::CHUNK_IGNORED);
+		CHECK(snapshot.AddChunk(chunks[2]) == CSnapshotData::CHUNK_IGNORED);
+		CHECK(snapshot.AddChunk(chunks[1]) == CSnapshotData::CHUNK_ADDED);
+		CHECK(snapshot.AddChunk(chunks[2]) == CSnapshotData::CHUNK_ADDED);
+		CHECK(snapshot.CheckData());
+	}
+
+	SECTION("sizes are checked") {
+		CSnapshotData snapshot;
+		snapshot.Expect(PROVIDER_NUM, SNAPSHOT_FRAME);
+
+		const std::vector<uint8_t> chunk(16);
+
+		CHECK(snapshot.AddChunk(CBaseNetProtocol::Get().SendSnapshotData(PROVIDER_NUM, SNAPSHOT_FRAME, SYNC_CHECKSUM, 0, CSnapshotData::MAX_DATA_SIZE + 1, 0, chunk)) == CSnapshotData::CHUNK_INVALID);
+		CHECK(snapshot.AddChunk(CBaseNetProtocol::Get().SendSnapshotData(PROVIDER_NUM, SNAPSHOT_FRAME, SYNC_CHECKSUM, 0, 0, 0, chunk)) == CSnapshotData::CHUNK_INVALID);
+		// more data than announced
+		CHECK(snapshot.AddChunk(CBaseNetProtocol::Get().SendSnapshotData(PROVIDER_NUM, SNAPSHOT_FRAME, SYNC_CHECKSUM, 0, 8, 0, chunk)) == CSnapshotData::CHUNK_INVALID);
+		CHECK(snapshot.IsEmpty());
+
+		CHECK(snapshot.AddChunk(CBaseNetProtocol::Get().SendSnapshotData(PROVIDER_NUM, SNAPSHOT_FRAME, SYNC_CHECKSUM, 0, 24, 0, chunk)) == CSnapshotData::CHUNK_ADDED);
+		CHECK(snapshot.AddChunk(CBaseNetProtocol::Get().SendSnapshotData(PROVIDER_NUM, SNAPSHOT_FRAME, SYNC_CHECKSUM, 0, 24, 16, chunk)) == CSnapshotData::CHUNK_INVALID);
+		// later chunks can not change what the first one announced
+		CHECK(snapshot.AddChunk(CBaseNetProtocol::Get().SendSnapshotData(PROVIDER_NUM, SNAPSHOT_FRAME, SYNC_CHECKSUM, 0, 32, 16, chunk)) == CSnapshotData::CHUNK_INVALID);
+		CHECK(snapshot.AddChunk(CBaseNetProtocol::Get().SendSnapshotData(PROVIDER_NUM, SNAPSHOT_FRAME, SYNC_CHECKSUM + 1, 0, 24, 16, std::vector<uint8_t>(8))) == CSnapshotData::CHUNK_INVALID);
+		CHECK(snapshot.AddChunk(CBaseNetProtocol::Get().SendSnapshotData(PROVIDER_NUM, SNAPSHOT_FRAME, SYNC_CHECKSUM, 0, 24, 16, std::vector<uint8_t>(8))) == CSnapshotData::CHUNK_ADDED);
+		CHECK(snapshot.IsComplete());
+		// the announced checksum was 0
+		CHECK(!snapshot.CheckData());
+	}
+
+	SECTION("corrupted data fails the checksum") {
+		CSnapshotData snapshot;
+		snapshot.Expect(PROVIDER_NUM, SNAPSHOT_FRAME);
+
+		for (const auto& chunk: chunks) {
+			snapshot.AddChunk(chunk);
+		}
+
+		REQUIRE(snapshot.CheckData());
+		snapshot.data[1234] ^= 1;
+		CHECK(!snapshot.CheckData());
+	}
+
+	SECTION("truncated headers throw") {
+		CSnapshotData snapshot;
+		snapshot.Expect(PROVIDER_NUM, SNAPSHOT_FRAME);
+
+		const uint8_t truncated[] = {NETMSG_SNAPSHOT_DATA, 8, 0, PROVIDER_NUM, 0x28, 0x23, 0, 0};
+
+		CHECK_THROWS_AS(snapshot.AddChunk(std::make_shared<const netcode::RawPacket>(truncated, sizeof(truncated))), netcode::UnpackPacketException);
+	}
+}
+
+
+TEST_CASE("SnapshotLoadedAnswer")
+{
+	// the server resumes the join from what the client reports
+	for (const uint8_t loaded: {uint8_t(0), uint8_t(1)}) {
+		const auto packet = CBaseNetProtocol::Get().SendSnapshotLoaded(SNAPSHOT_FRAME, loaded);
+
+		REQUIRE(packet->length == 6);
+		CHECK(packet->data[0] == NETMSG_SNAPSHOT_LOADED);
+
+		netcode::UnpackPacket pckt(packet, 1);
+
+		int32_t frameNum; pckt >> frameNum;
+		uint8_t packetLoaded; pckt >> packetLoaded;
+
+		CHECK(frameNum == SNAPSHOT_FRAME);
+		CHECK(packetLoaded == loaded);
+	}
+}
+
+
+TEST_CASE("SnapshotRNGState")
+{
+	// the snapshot carries the synced RNG's seeds and generator state,
+	// a client loading it has to continue the exact same sequence
+	CGlobalSyncedRNG source;
+	CGlobalSyncedRNG loaded;
+
+	source.SetSeed(1234, true);
+	source.SetSeed(5678, false);
+
+	for (int i = 0; i < 1000; i++) {
+		source.NextInt();
+	}
+
+	loaded.SetSeed(source.GetInitSeed(), true);
+	loaded.SetSeed(source.GetLastSeed(), false);
+	loaded.SetGenState(source.GetGenState());
+
+	CHECK(loaded.GetInitSeed() == 1234);
+	CHECK(loaded.GetLastSeed() == 5678);
+
+	for (int i = 0; i < 1000; i++) {
+		CHECK(loaded.NextInt() == source.NextInt());
+	}
+
+	CHECK(loaded.NextInt(77) == source.NextInt(77));
+	CHECK(loaded.GetGenState() == source.GetGenState());
+}
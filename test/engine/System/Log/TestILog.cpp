@@ -1,5 +1,6 @@
 
 #include "System/Log/ILog.h"
+#include "System/Log/Backend.h"
 #include "System/Log/FileSink.h"
 #include "System/Log/StreamSink.h"
 #include "System/Log/LogUtil.h"
@@ -10,6 +11,8 @@
 
 #include <cstdarg>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 
 
@@ -233,3 +236,57 @@ TEST_CASE("IsEnabled")
 	TLOG_SL(   "other-one-time-section", L_DEBUG, "Testing LOG_IS_ENABLED_S");
 }
 
+
+
+TEST_CASE("Async")
+{
+	constexpr int NUM_THREADS = 4;
+	constexpr int NUM_RECORDS = 500;
+
+	log_backend_setAsync(true);
+
+	std::vector<std::thread> threads;
+
+	for (int t = 0; t < NUM_THREADS; t++) {
+		threads.emplace_back([t]() {
+			// warnings are never dropped, at worst they wait for buffer space
+			for (int i = 0; i < NUM_RECORDS; i++) {
+				LOG_L(L_WARNING, "async %d %d", t, i);
+			}
+		});
+	}
+	for (std::thread& t: threads) {
+		t.join();
+	}
+
+	log_backend_flush();
+	log_backend_setAsync(false);
+
+	std::array<int, NUM_THREADS> nextIndex = {};
+	std::string line;
+
+	for (std::istringstream lines(ls.logStream.str()); std::getline(lines, line); ) {
+		int t = -1;
+		int i = -1;
+
+		REQUIRE(sscanf(line.c_str(), "Warning: async %d %d", &t, &i) == 2);
+		REQUIRE(t >= 0);
+		REQUIRE(t < NUM_THREADS);
+
+		// records of one thread keep their order
+		CHECK(nextIndex[t] == i);
+		nextIndex[t] = i + 1;
+	}
+
+	for (int t = 0; t < NUM_THREADS; t++) {
+		CHECK(nextIndex[t] == NUM_RECORDS);
+	}
+
+	log_backend_stats_t stats;
+	log_backend_getStats(&stats);
+
+	CHECK(stats.numDropped == 0);
+	CHECK(stats.numQueued == (NUM_THREADS * NUM_RECORDS));
+
+	ls.logStream.str(std::string());
+}
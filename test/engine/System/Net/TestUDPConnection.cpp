@@ -0,0 +1,203 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "System/Misc/SpringTime.h"
+#include "System/Net/RawPacket.h"
+#include "System/Net/UDPConnection.h"
+#include "System/Net/UDPListener.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+InitSpringTime ist;
+
+/**
+ * A server-side connection accepted by a UDPListener and the client
+ * connection it talks to, both on the loopback interface.
+ */
+class LoopbackPair {
+public:
+	LoopbackPair(int port): listener(port, "127.0.0.1") {
+		listener.SetAcceptingConnections(true);
+
+		client = std::make_shared<netcode::UDPConnection>(0, "127.0.0.1", port);
+		client->Unmute();
+		client->SendData(CBaseNetProtocol::Get().SendNewFrame());
+		client->Flush(true);
+
+		for (int i = 0; i < 1000 && !listener.HasIncomingConnections(); i++) {
+			listener.Update();
+			spring_sleep(spring_msecs(1));
+		}
+
+		REQUIRE(listener.HasIncomingConnections());
+
+		server = listener.AcceptConnection();
+		server->Unmute();
+
+		// the packet that opened the connection
+		REQUIRE(server->GetData() != nullptr);
+
+		// answer it, the server ignores a client that never heard back as reconnecting
+		server->SendData(CBaseNetProtocol::Get().SendNewFrame());
+
+		REQUIRE(Pump([&]() { return (!clientReceived.empty()); }));
+		clientReceived.clear();
+	}
+
+	/// runs both ends until done returns true, or about maxMillis passed
+	bool Pump(const std::function<bool()>& done, int maxMillis = 10000) {
+		for (int i = 0; i < maxMillis; i++) {
+			listener.Update();
+			client->Update();
+
+			ReadAll(server, serverReceived);
+			ReadAll(client, clientReceived);
+
+			if (done())
+				return true;
+
+			spring_sleep(spring_msecs(1));
+		}
+
+		return false;
+	}
+
+	static void ReadAll(std::shared_ptr<netcode::UDPConnection>& conn, std::vector<std::shared_ptr<const netcode::RawPacket>>& received) {
+		for (std::shared_ptr<const netcode::RawPacket> packet; (packet = conn->GetData()) != nullptr; ) {
+			received.push_back(packet);
+		}
+	}
+
+public:
+	netcode::UDPListener listener;
+
+	std::shared_ptr<netcode::UDPConnection> server;
+	std::shared_ptr<netcode::UDPConnection> client;
+
+	std::vector<std::shared_ptr<const netcode::RawPacket>> serverReceived;
+	std::vector<std::shared_ptr<const netcode::RawPacket>> clientReceived;
+};
+
+
+static std::string MessageText(int i)
+{
+	// repetitive, like most of the real stream
+	return ("message number " + std::to_string(i) + std::string(i % 200, 'x'));
+}
+
+static bool IsMessage(const std::shared_ptr<const netcode::RawPacket>& packet, int i)
+{
+	if (packet->data[0] != NETMSG_SYSTEMMSG)
+		return false;
+
+	// id, size and player precede the text
+	return (std::string(reinterpret_cast<const char*>(packet->data + 4)) == MessageText(i));
+}
+
+static void SendMessages(netcode::UDPConnection& conn, int first, int count)
+{
+	for (int i = first; i < (first + count); i++) {
+		conn.SendData(CBaseNetProtocol::Get().SendSystemMessage(1, MessageText(i)));
+	}
+}
+
+static bool CheckMessages(const std::vector<std::shared_ptr<const netcode::RawPacket>>& received, int count)
+{
+	if (received.size() != count)
+		return false;
+
+	for (int i = 0; i < count; i++) {
+		if (!IsMessage(received[i], i))
+			return false;
+	}
+
+	return true;
+}
+
+
+
+TEST_CASE("UDPConnectionStreamCompression")
+{
+	LoopbackPair pair(13001);
+
+	pair.server->SetStreamCompression(true);
+
+	SECTION("many small packets arrive in order") {
+		constexpr int numMessages = 3000;
+
+		for (int i = 0; i < numMessages; i += 100) {
+			SendMessages(*pair.server, i, 100);
+			pair.Pump([]() { return true; });
+		}
+
+		CHECK(pair.Pump([&]() { return (pair.clientReceived.size() >= numMessages); }));
+		CHECK(CheckMessages(pair.clientReceived, numMessages));
+	}
+
+	SECTION("packets larger than a bundle bypass it") {
+		// more than maxBundleInput, goes out uncompressed in between bundles
+		const std::vector<uint8_t> clientData(40000, 7);
+
+		SendMessages(*pair.server, 0, 10);
+		pair.server->SendData(CBaseNetProtocol::Get().SendClientData(1, clientData));
+		SendMessages(*pair.server, 10, 10);
+
+		CHECK(pair.Pump([&]() { return (pair.clientReceived.size() >= 21); }));
+		REQUIRE(pair.clientReceived.size() == 21);
+
+		for (int i = 0; i < 10; i++) {
+			CHECK(IsMessage(pair.clientReceived[i], i));
+			CHECK(IsMessage(pair.clientReceived[i + 11], i + 10));
+		}
+
+		const std::shared_ptr<const netcode::RawPacket>& bigPacket = pair.clientReceived[10];
+
+		CHECK(bigPacket->data[0] == NETMSG_CLIENTDATA);
+		CHECK(bigPacket->length == (clientData.size() + 4));
+		CHECK(std::vector<uint8_t>(bigPacket->data + 4, bigPacket->data + bigPacket->length) == clientData);
+	}
+
+	SECTION("compression can be turned off mid-stream") {
+		SendMessages(*pair.server, 0, 500);
+		pair.server->SetStreamCompression(false);
+		// still behind the queued bundle data
+		SendMessages(*pair.server, 500, 250);
+		pair.server->Flush(true);
+		SendMessages(*pair.server, 750, 250);
+		pair.server->Flush(true);
+		pair.server->SetStreamCompression(true);
+		SendMessages(*pair.server, 1000, 500);
+
+		CHECK(pair.Pump([&]() { return (pair.clientReceived.size() >= 1500); }));
+		CHECK(CheckMessages(pair.clientReceived, 1500));
+	}
+}
+
+
+TEST_CASE("UDPConnectionRejectsBundles")
+{
+	LoopbackPair pair(13002);
+
+	SendMessages(*pair.client, 0, 1);
+
+	CHECK(pair.Pump([&]() { return (pair.serverReceived.size() >= 1); }));
+	CHECK(CheckMessages(pair.serverReceived, 1));
+
+	// only servers compress, the server's link to a client does not take bundles
+	pair.client->SetStreamCompression(true);
+	SendMessages(*pair.client, 1, 1);
+	pair.client->Flush(true);
+	pair.client->SetStreamCompression(false);
+	// and closes, so nothing after the bundle is read either
+	SendMessages(*pair.client, 2, 1);
+
+	CHECK(!pair.Pump([&]() { return (pair.serverReceived.size() > 1); }, 1000));
+	CHECK(pair.serverReceived.size() == 1);
+}
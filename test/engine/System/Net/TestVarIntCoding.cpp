@@ -0,0 +1,91 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/Net/RawPacket.h"
+#include "System/Net/VarIntCoding.h"
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+static std::shared_ptr<const netcode::RawPacket> MakePacket(const std::vector<uint8_t>& buf)
+{
+	return std::make_shared<const netcode::RawPacket>(buf.data(), buf.size());
+}
+
+
+TEST_CASE("VarInt")
+{
+	const std::vector<uint32_t> values = {0, 1, 127, 128, 300, 16383, 16384, 0xFFFFFFFF};
+	std::vector<uint8_t> buf;
+
+	for (const uint32_t v: values) {
+		netcode::PackVarInt(buf, v);
+	}
+
+	// one byte per 7 bits
+	CHECK(buf.size() == (1 + 1 + 1 + 2 + 2 + 2 + 3 + 5));
+
+	netcode::UnpackPacket pckt(MakePacket(buf));
+
+	for (const uint32_t v: values) {
+		CHECK(netcode::UnpackVarInt(pckt) == v);
+	}
+
+	CHECK_THROWS_AS(netcode::UnpackVarInt(pckt), netcode::UnpackPacketException);
+
+	for (const int32_t v: {0, 1, -1, 63, -64, std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::min()}) {
+		CHECK(netcode::ZigZagDecode(netcode::ZigZagEncode(v)) == v);
+	}
+
+	CHECK(netcode::ZigZagEncode(-64) < 128);
+}
+
+
+TEST_CASE("DeltaFloat")
+{
+	const std::vector<float> values = {
+		1024.0f, 1040.5f, 1024.0625f, -3.0f, 0.0f,
+		// not on the grid, sent raw
+		0.3f, -0.0f, std::numeric_limits<float>::quiet_NaN(), 1e30f,
+		// continues from the last grid value
+		-2.0f,
+	};
+
+	std::vector<uint8_t> buf;
+	int32_t prev = 0;
+
+	for (const float v: values) {
+		netcode::PackDeltaFloat(buf, v, prev);
+	}
+
+	netcode::UnpackPacket pckt(MakePacket(buf));
+	prev = 0;
+
+	for (const float v: values) {
+		const float u = netcode::UnpackDeltaFloat(pckt, prev);
+
+		if (std::isnan(v)) {
+			CHECK(std::isnan(u));
+		} else {
+			CHECK(u == v);
+			CHECK(std::signbit(u) == std::signbit(v));
+		}
+	}
+
+	// small steps on the grid take a single byte
+	buf.clear();
+	prev = 0;
+
+	netcode::PackDeltaFloat(buf, 0.5f, prev);
+	netcode::PackDeltaFloat(buf, 1.0f, prev);
+	CHECK(buf.size() == 2);
+
+	CHECK(netcode::QuantizeDeltaFloat(100.03f) == 100.0f);
+	CHECK(netcode::QuantizeDeltaFloat(100.04f) == 100.0625f);
+	CHECK(netcode::QuantizeDeltaFloat(1e30f) == 1e30f);
+}
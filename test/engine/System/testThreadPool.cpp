@@ -145,6 +145,39 @@ TEST_CASE("test_nested_for_mt")
 	});
 }
 
+TEST_CASE("test_deep_nested_for_mt")
+{
+	LOG("[%s::test_deep_nested_for_mt]", __func__);
+
+	// more concurrently live for_mt's than the old fixed-size task-group pool held
+	std::atomic<int> cnt(0);
+
+	for_mt(0, 32, [&](const int z) {
+		for_mt(0, 32, [&](const int y) {
+			for_mt(0, 32, [&](const int x) {
+				++cnt;
+			});
+		});
+	});
+
+	CHECK(cnt == (32 * 32 * 32));
+}
+
+TEST_CASE("test_for_mt_chunk")
+{
+	LOG("[%s::test_for_mt_chunk]", __func__);
+
+	std::vector<int> nums(NUM_RUNS, 0);
+
+	for_mt_chunk(0, NUM_RUNS, [&](const int i) {
+		nums[i] += 1;
+	}, 16);
+
+	for (int i = 0; i < NUM_RUNS; i++) {
+		CHECK(nums[i] == 1);
+	}
+}
+
 TEST_CASE("test_nested_parallel")
 {
 	#if 0
@@ -256,6 +289,56 @@ TEST_CASE("test_for_vs_for_mt")
 }
 
 
+static void for_mt_scaling_kernel(const int numRuns, const spring_time kernelLoad)
+{
+	LOG("\t[%s] running %.3fms kernel for %i runs:", __func__, kernelLoad.toMilliSecsf(), numRuns);
+
+	const auto& ExecKernel = [](const spring_time t) {
+		const spring_time finish = spring_now() + t;
+		while (spring_now() < finish) {}
+	};
+
+	// 1, 2, 4, ..., NUM_THREADS
+	std::vector<int> threadCounts;
+
+	for (int n = 1; n < NUM_THREADS; n *= 2)
+		threadCounts.push_back(n);
+
+	threadCounts.push_back(NUM_THREADS);
+
+	spring_time t_base;
+
+	for (const int numThreads: threadCounts) {
+		ThreadPool::SetThreadCount(numThreads);
+
+		const spring_time start = spring_now();
+
+		for_mt(0, numRuns, [&](const int i) {
+			ExecKernel(kernelLoad);
+		});
+
+		const spring_time t_formt = spring_now() - start;
+
+		if (numThreads == 1)
+			t_base = t_formt;
+
+		LOG("\t\t%2d threads took %.4fms (speedup %.2fx)", numThreads, t_formt.toMilliSecsf(), t_base.toMilliSecsf() / std::max(t_formt.toMilliSecsf(), 0.0001f));
+	}
+
+	ThreadPool::SetThreadCount(NUM_THREADS);
+}
+
+TEST_CASE("test_for_mt_scaling")
+{
+	LOG("[%s::test_for_mt_scaling] (1 to %d threads)", __func__, NUM_THREADS);
+
+	for_mt_scaling_kernel(1000, spring_time::fromMicroSecs(20));
+	for_mt_scaling_kernel( 100, spring_time::fromMicroSecs(500));
+
+	CHECK(ThreadPool::GetNumThreads() == NUM_THREADS);
+}
+
+
 static void test_parallel_reaction_times_aux(int numRuns)
 {
 	LOG("\t[%s]", __func__);
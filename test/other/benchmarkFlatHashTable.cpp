@@ -0,0 +1,179 @@
+#include "System/UnorderedMap.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// compares the flat tables against the emilib and std maps they replace, with
+// key types matching CPathCache (uint64), ILosType (int) and LuaRulesParams
+// and IArchive (string); memory overhead is reported as bytes per element
+
+namespace {
+	template<typename K> K MakeKey(uint32_t i);
+	template<> int MakeKey<int>(uint32_t i) { return static_cast<int>(i * 2654435761u); }
+	template<> uint64_t MakeKey<uint64_t>(uint32_t i) { return (uint64_t(i) << 32) | (i * 40503u); }
+	template<> std::string MakeKey<std::string>(uint32_t i) { return ("unit_rules_param_" + std::to_string(i)); }
+
+	template<typename K> std::vector<K> MakeKeys(size_t n, uint32_t seed) {
+		std::vector<K> keys;
+		std::mt19937 rng(seed);
+
+		keys.reserve(n);
+
+		for (size_t i = 0; i < n; i++) {
+			keys.push_back(MakeKey<K>(rng()));
+		}
+
+		return keys;
+	}
+
+	// std::unordered_map has no way to ask, approximate its node and bucket layout
+	template<typename M> size_t MemoryUsage(const M& m) {
+		return (m.size() * (sizeof(typename M::value_type) + 2 * sizeof(void*)) + m.bucket_count() * sizeof(void*));
+	}
+	template<typename K, typename V, typename H, typename C> size_t MemoryUsage(const spring::FlatHashMap<K, V, H, C>& m) {
+		return (m.memory_usage());
+	}
+	template<typename K, typename V, typename H, typename C> size_t MemoryUsage(const emilib::HashMap<K, V, H, C>& m) {
+		// one state byte per bucket, buckets are 1.5x-3x the element count
+		size_t numBuckets = 4;
+		while (numBuckets < (m.size() + m.size() / 2 + 1)) { numBuckets *= 2; }
+		return (numBuckets * (1 + sizeof(typename emilib::HashMap<K, V, H, C>::value_type)));
+	}
+}
+
+template<typename M> using KeyOf = typename M::key_type;
+
+
+template<typename M>
+static void BenchInsert(benchmark::State& state) {
+	const auto keys = MakeKeys<KeyOf<M>>(state.range(0), 1);
+
+	for (auto _ : state) {
+		M m;
+
+		for (const auto& key: keys) {
+			m[key] = 1;
+		}
+
+		benchmark::DoNotOptimize(m.size());
+	}
+
+	state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+template<typename M>
+static void BenchLookupHit(benchmark::State& state) {
+	const auto keys = MakeKeys<KeyOf<M>>(state.range(0), 1);
+
+	M m;
+
+	for (const auto& key: keys) {
+		m[key] = 1;
+	}
+
+	for (auto _ : state) {
+		int sum = 0;
+
+		for (const auto& key: keys) {
+			sum += m.find(key)->second;
+		}
+
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(state.iterations() * keys.size());
+	state.counters["bytes/elem"] = MemoryUsage(m) / double(m.size());
+}
+
+template<typename M>
+static void BenchLookupMiss(benchmark::State& state) {
+	const auto keys = MakeKeys<KeyOf<M>>(state.range(0), 1);
+	const auto miss = MakeKeys<KeyOf<M>>(state.range(0), 2);
+
+	M m;
+
+	for (const auto& key: keys) {
+		m[key] = 1;
+	}
+
+	for (auto _ : state) {
+		size_t n = 0;
+
+		for (const auto& key: miss) {
+			n += (m.find(key) == m.end());
+		}
+
+		benchmark::DoNotOptimize(n);
+	}
+
+	state.SetItemsProcessed(state.iterations() * miss.size());
+}
+
+template<typename M>
+static void BenchIterate(benchmark::State& state) {
+	const auto keys = MakeKeys<KeyOf<M>>(state.range(0), 1);
+
+	M m;
+
+	for (const auto& key: keys) {
+		m[key] = 1;
+	}
+
+	for (auto _ : state) {
+		int sum = 0;
+
+		for (const auto& p: m) {
+			sum += p.second;
+		}
+
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(state.iterations() * m.size());
+}
+
+// insert-one, erase-oldest at constant size (the CPathCache pattern)
+template<typename M>
+static void BenchChurn(benchmark::State& state) {
+	const auto keys = MakeKeys<KeyOf<M>>(state.range(0) * 16, 1);
+	const size_t window = state.range(0);
+
+	for (auto _ : state) {
+		M m;
+
+		for (size_t i = 0; i < keys.size(); i++) {
+			m[keys[i]] = 1;
+
+			if (i >= window)
+				m.erase(keys[i - window]);
+		}
+
+		benchmark::DoNotOptimize(m.size());
+	}
+
+	state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+
+#define BENCH_MAP_TYPES(func, K) \
+	BENCHMARK_TEMPLATE(func, spring::flat_hash_map<K, int>)->Range(64, 1 << 16); \
+	BENCHMARK_TEMPLATE(func, spring::unordered_map<K, int>)->Range(64, 1 << 16); \
+	BENCHMARK_TEMPLATE(func, std::unordered_map<K, int>)->Range(64, 1 << 16);
+
+#define BENCH_MAP_KEYS(func) \
+	BENCH_MAP_TYPES(func, int) \
+	BENCH_MAP_TYPES(func, uint64_t) \
+	BENCH_MAP_TYPES(func, std::string)
+
+BENCH_MAP_KEYS(BenchInsert)
+BENCH_MAP_KEYS(BenchLookupHit)
+BENCH_MAP_KEYS(BenchLookupMiss)
+BENCH_MAP_KEYS(BenchIterate)
+BENCH_MAP_KEYS(BenchChurn)
+
+BENCHMARK_MAIN();
@@ -0,0 +1,168 @@
+#include "System/RadixSort.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <future>
+#include <random>
+#include <tuple>
+#include <vector>
+
+// compares the CProjectileDrawer particle depth sort before (std::sort with a
+// predicate reading the sort distance through the particle pointer) and after
+// (packed keys, radix sorted or insertion-sorted from the previous order)
+
+namespace {
+	struct Particle {
+		std::array<float, 3> sortDist;
+		int drawOrder;
+	};
+
+	struct Entry {
+		uint64_t key;
+		Particle* p;
+	};
+
+	struct AsyncFor {
+		template<typename F> void operator () (int n, F&& f) const {
+			std::vector<std::future<void>> futures;
+
+			for (int i = 1; i < n; i++) {
+				futures.emplace_back(std::async(std::launch::async, [&f, i]() { f(i); }));
+			}
+
+			f(0);
+
+			for (auto& fut: futures) {
+				fut.wait();
+			}
+		}
+	};
+
+	std::vector<Particle> MakeParticles(size_t n) {
+		std::vector<Particle> particles(n);
+		std::mt19937 rng(n);
+		std::uniform_real_distribution<float> dist(10.0f, 8000.0f);
+
+		for (Particle& p: particles) {
+			p.sortDist = {dist(rng), dist(rng), dist(rng)};
+			p.drawOrder = (rng() % 16 == 0);
+		}
+
+		return particles;
+	}
+
+	std::vector<Particle*> MakePointers(std::vector<Particle>& particles) {
+		std::vector<Particle*> ptrs(particles.size());
+		std::mt19937 rng(1);
+
+		for (size_t i = 0; i < particles.size(); i++) {
+			ptrs[i] = &particles[i];
+		}
+
+		// container order is unrelated to depth
+		std::shuffle(ptrs.begin(), ptrs.end(), rng);
+		return ptrs;
+	}
+
+	uint64_t SortKey(const Particle* p) {
+		const uint32_t distKey = ~spring::FloatToOrderedKey(p->sortDist[0]) & ~0xFFu;
+		const uint32_t ordrKey = spring::IntToOrderedKey(p->drawOrder);
+
+		return ((uint64_t(ordrKey) << 32) | distKey);
+	}
+
+	const auto EntryKey = [](const Entry& e) { return e.key; };
+}
+
+
+static void BenchStdSort(benchmark::State& state) {
+	auto particles = MakeParticles(state.range(0));
+	auto input = MakePointers(particles);
+	auto ptrs = input;
+
+	for (auto _ : state) {
+		ptrs = input;
+
+		std::sort(ptrs.begin(), ptrs.end(), [](const Particle* p1, const Particle* p2) {
+			return std::forward_as_tuple(p2->drawOrder, p1->sortDist[0], p1) > std::forward_as_tuple(p1->drawOrder, p2->sortDist[0], p2);
+		});
+
+		benchmark::DoNotOptimize(ptrs.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * ptrs.size());
+}
+
+template<int numChunks>
+static void BenchRadixSort(benchmark::State& state) {
+	auto particles = MakeParticles(state.range(0));
+	auto input = MakePointers(particles);
+
+	std::vector<Entry> entries(input.size());
+	std::vector<Entry> scratch;
+
+	for (auto _ : state) {
+		for (size_t i = 0; i < input.size(); i++) {
+			entries[i] = {SortKey(input[i]), input[i]};
+		}
+
+		if constexpr (numChunks == 1) {
+			spring::RadixSort(entries, scratch, EntryKey);
+		} else {
+			spring::RadixSort(entries, scratch, EntryKey, numChunks, AsyncFor{});
+		}
+
+		benchmark::DoNotOptimize(entries.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * entries.size());
+}
+
+// previous frame's order with every particle moved a little along the view axis
+static void BenchIncrementalSort(benchmark::State& state) {
+	auto particles = MakeParticles(state.range(0));
+	auto ptrs = MakePointers(particles);
+
+	std::vector<Entry> entries(ptrs.size());
+	std::vector<Entry> scratch;
+	std::mt19937 rng(2);
+	std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+
+	for (size_t i = 0; i < ptrs.size(); i++) {
+		entries[i] = {SortKey(ptrs[i]), ptrs[i]};
+	}
+
+	spring::RadixSort(entries, scratch, EntryKey);
+
+	for (auto _ : state) {
+		state.PauseTiming();
+		for (Particle& p: particles) {
+			p.sortDist[0] += jitter(rng);
+		}
+		state.ResumeTiming();
+
+		for (Entry& e: entries) {
+			e.key = SortKey(e.p);
+		}
+
+		if (!spring::InsertionSortBounded(entries.data(), entries.size(), entries.size() * 4, EntryKey))
+			spring::RadixSort(entries, scratch, EntryKey);
+
+		benchmark::DoNotOptimize(entries.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * entries.size());
+}
+
+
+#define BENCH_PARTICLE_COUNTS(bench) bench->Arg(10000)->Arg(50000)->Arg(200000)->Unit(benchmark::kMicrosecond)
+
+BENCH_PARTICLE_COUNTS(BENCHMARK(BenchStdSort));
+BENCH_PARTICLE_COUNTS(BENCHMARK_TEMPLATE(BenchRadixSort, 1));
+BENCH_PARTICLE_COUNTS(BENCHMARK_TEMPLATE(BenchRadixSort, 4));
+BENCH_PARTICLE_COUNTS(BENCHMARK(BenchIncrementalSort));
+
+BENCHMARK_MAIN();
@@ -0,0 +1,109 @@
+#include "System/DirtyRangeTracker.h"
+
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+using Range = spring::DirtyRangeTracker::Range;
+
+namespace {
+	// elements covered by <ranges>
+	std::vector<bool> ToMask(const std::vector<Range>& ranges, size_t size) {
+		std::vector<bool> mask(size, false);
+
+		for (const Range& r: ranges) {
+			for (uint32_t i = r.beg; i < r.end; i++) {
+				mask[i] = true;
+			}
+		}
+
+		return mask;
+	}
+}
+
+
+TEST_CASE("DirtyRangeTracker merges adjacent and overlapping ranges")
+{
+	spring::DirtyRangeTracker tracker;
+
+	tracker.Add(10, 20);
+	tracker.Add(20, 25);
+	tracker.Add(15, 18);
+	tracker.Add(40, 41);
+	tracker.Add(30, 30);
+
+	const auto& batches = tracker.Collect(100, 1, 0, 1000);
+
+	REQUIRE(batches == std::vector<Range>{{10, 25}, {40, 41}});
+	REQUIRE(tracker.Collect(100, 1, 0, 1000).empty());
+}
+
+TEST_CASE("DirtyRangeTracker bridges gaps, splits batches and clamps to size")
+{
+	spring::DirtyRangeTracker tracker;
+
+	tracker.Add(0, 4);
+	tracker.Add(6, 8);
+	tracker.Add(90, 120);
+
+	const auto& batches = tracker.Collect(100, 1, 2, 4);
+
+	REQUIRE(batches == std::vector<Range>{{0, 4}, {4, 8}, {90, 94}, {94, 98}, {98, 100}});
+}
+
+TEST_CASE("DirtyRangeTracker keeps ranges dirty once per buffer part")
+{
+	spring::DirtyRangeTracker tracker;
+
+	tracker.Add(5, 10);
+	REQUIRE(tracker.Collect(100, 3, 0, 1000) == std::vector<Range>{{5, 10}});
+
+	tracker.Add(50, 60);
+	REQUIRE(tracker.Collect(100, 3, 0, 1000) == std::vector<Range>{{5, 10}, {50, 60}});
+	REQUIRE(tracker.Collect(100, 3, 0, 1000) == std::vector<Range>{{5, 10}, {50, 60}});
+	REQUIRE(tracker.Collect(100, 3, 0, 1000) == std::vector<Range>{{50, 60}});
+	REQUIRE(tracker.Collect(100, 3, 0, 1000).empty());
+
+	tracker.AddAll(100);
+
+	for (int i = 0; i < 3; i++) {
+		REQUIRE(tracker.Collect(100, 3, 0, 1000) == std::vector<Range>{{0, 100}});
+	}
+
+	REQUIRE(tracker.Collect(100, 3, 0, 1000).empty());
+}
+
+TEST_CASE("DirtyRangeTracker matches a per-element dirty map")
+{
+	constexpr size_t SIZE = 4096;
+	constexpr uint32_t NUM_PARTS = 3;
+
+	spring::DirtyRangeTracker tracker;
+	std::vector<uint8_t> dirtyMap(SIZE, 0);
+	std::mt19937 rng(42);
+
+	for (int frame = 0; frame < 200; frame++) {
+		for (int k = 0, n = rng() % 64; k < n; k++) {
+			const size_t beg = rng() % SIZE;
+			const size_t end = std::min(SIZE, beg + 1 + rng() % 40);
+
+			tracker.Add(beg, end);
+			std::fill(dirtyMap.begin() + beg, dirtyMap.begin() + end, NUM_PARTS);
+		}
+
+		const auto& batches = tracker.Collect(SIZE, NUM_PARTS, 0, 256);
+		const auto mask = ToMask(batches, SIZE);
+
+		for (size_t i = 0; i < SIZE; i++) {
+			REQUIRE(mask[i] == (dirtyMap[i] > 0));
+			dirtyMap[i] -= (dirtyMap[i] > 0);
+		}
+
+		for (size_t i = 0; i < batches.size(); i++) {
+			REQUIRE(batches[i].Size() <= 256);
+			REQUIRE((i == 0 || batches[i - 1].end <= batches[i].beg));
+		}
+	}
+}
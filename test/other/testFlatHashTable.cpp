@@ -0,0 +1,203 @@
+#include "System/UnorderedMap.hpp"
+#include "System/UnorderedSet.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+namespace {
+	// degenerate hash forcing every key into the same probe sequence
+	struct CollidingHash {
+		uint32_t operator()(int) const { return 0; }
+	};
+}
+
+
+TEST_CASE("FlatHashMap basic operations")
+{
+	spring::flat_hash_map<int, std::string> map;
+
+	REQUIRE(map.empty());
+	REQUIRE(map.find(1) == map.end());
+	REQUIRE(map.erase(1) == 0);
+
+	REQUIRE(map.insert(1, "one").second);
+	REQUIRE(!map.insert(1, "uno").second);
+	REQUIRE(map.emplace(2, "two").second);
+	map[3] = "three";
+
+	REQUIRE(map.size() == 3);
+	REQUIRE(map.find(1)->second == "one");
+	REQUIRE(map.contains(2));
+	REQUIRE(map.count(3) == 1);
+	REQUIRE(*map.try_get(3) == "three");
+	REQUIRE(map.try_get(4) == nullptr);
+
+	REQUIRE(map.erase(2) == 1);
+	REQUIRE(!map.contains(2));
+	REQUIRE(map.size() == 2);
+	REQUIRE(map[1] == "one");
+	REQUIRE(map[3] == "three");
+
+	map.clear();
+	REQUIRE(map.empty());
+	REQUIRE(!map.contains(1));
+	REQUIRE(map.capacity() != 0);
+}
+
+TEST_CASE("FlatHashMap matches std::unordered_map")
+{
+	spring::flat_hash_map<uint64_t, int> map;
+	std::unordered_map<uint64_t, int> ref;
+	std::mt19937 rng(1234);
+
+	for (int i = 0; i < 200000; i++) {
+		const uint64_t key = rng() % 4096;
+
+		switch (rng() % 4) {
+			case 0:
+			case 1: {
+				map[key] = i;
+				ref[key] = i;
+			} break;
+			case 2: {
+				REQUIRE(map.erase(key) == ref.erase(key));
+			} break;
+			case 3: {
+				const auto it = map.find(key);
+				const auto jt = ref.find(key);
+
+				REQUIRE((it == map.end()) == (jt == ref.end()));
+
+				if (jt != ref.end())
+					REQUIRE(it->second == jt->second);
+			} break;
+		}
+
+		REQUIRE(map.size() == ref.size());
+	}
+
+	for (const auto& p: map) {
+		REQUIRE(ref.at(p.first) == p.second);
+	}
+}
+
+TEST_CASE("FlatHashMap erase while iterating")
+{
+	spring::flat_hash_map<int, int> map;
+
+	for (int i = 0; i < 1000; i++) {
+		map[i] = i;
+	}
+
+	for (auto it = map.begin(); it != map.end(); ) {
+		it = ((it->first & 1) != 0)? map.erase(it): ++it;
+	}
+
+	REQUIRE(map.size() == 500);
+
+	for (int i = 0; i < 1000; i++) {
+		REQUIRE(map.contains(i) == ((i & 1) == 0));
+	}
+}
+
+TEST_CASE("FlatHashMap iteration order is independent of capacity and hash")
+{
+	spring::flat_hash_map<int, int> a;
+	spring::flat_hash_map<int, int, CollidingHash> b;
+
+	b.reserve(4096);
+
+	for (int i = 0; i < 300; i++) {
+		a[i * 7919] = i;
+		b[i * 7919] = i;
+	}
+	for (int i = 0; i < 300; i += 3) {
+		a.erase(i * 7919);
+		b.erase(i * 7919);
+	}
+
+	REQUIRE(a.size() == b.size());
+	REQUIRE(std::equal(a.begin(), a.end(), b.begin()));
+
+	// reinsertion in iteration order reproduces it (e.g. after a creg load)
+	spring::flat_hash_map<int, int> c;
+
+	for (const auto& p: a) {
+		c.insert(p);
+	}
+
+	REQUIRE(std::equal(a.begin(), a.end(), c.begin()));
+}
+
+TEST_CASE("FlatHashMap survives tombstone churn")
+{
+	spring::flat_hash_map<uint64_t, int> map;
+
+	map.reserve(100);
+
+	const size_t capacity = map.capacity();
+
+	// a sliding window of keys, like CPathCache's expiry queue
+	for (uint64_t i = 0; i < 100000; i++) {
+		map[i] = int(i);
+
+		if (i >= 100)
+			REQUIRE(map.erase(i - 100) == 1);
+	}
+
+	// tombstones are purged by rehashing in place instead of growing without bound
+	REQUIRE(map.size() == 100);
+	REQUIRE(map.capacity() <= capacity * 2);
+
+	for (uint64_t i = 100000 - 100; i < 100000; i++) {
+		REQUIRE(map.contains(i));
+	}
+}
+
+TEST_CASE("FlatHashMap copy and move")
+{
+	spring::flat_hash_map<std::string, int> a = {{"a", 1}, {"b", 2}, {"c", 3}};
+	spring::flat_hash_map<std::string, int> b = a;
+	spring::flat_hash_map<std::string, int> c = std::move(a);
+
+	REQUIRE(b.size() == 3);
+	REQUIRE(c.size() == 3);
+	REQUIRE(b["b"] == 2);
+	REQUIRE(c["c"] == 3);
+
+	// moved-from tables stay usable
+	a["d"] = 4;
+	REQUIRE(a.size() == 1);
+	REQUIRE(a.contains("d"));
+}
+
+TEST_CASE("FlatHashSet basic operations")
+{
+	spring::flat_hash_set<int> set;
+	std::unordered_set<int> ref;
+	std::mt19937 rng(4321);
+
+	for (int i = 0; i < 50000; i++) {
+		const int key = rng() % 1024;
+
+		if ((rng() % 3) != 0) {
+			REQUIRE(set.insert(key).second == ref.insert(key).second);
+		} else {
+			REQUIRE(set.erase(key) == ref.erase(key));
+		}
+	}
+
+	REQUIRE(set.size() == ref.size());
+
+	for (const int key: set) {
+		REQUIRE(ref.count(key) == 1);
+	}
+}
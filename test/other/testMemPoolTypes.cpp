@@ -1,8 +1,10 @@
 #include "System/MemPoolTypes.h"
+#include "System/MemAccounting.h"
 #include "System/Log/ILog.h"
 
 #include <vector>
 #include <cstddef>
+#include <cstring>
 
 #define CATCH_CONFIG_MAIN
 #include "lib/catch.hpp"
@@ -191,4 +193,49 @@ TEMPLATE_TEST_CASE_METHOD(AllocFixture, "test allocator's clear method", "[class
 	}
 }
 
+static MemAccounting::TagStats GetTagStats(const char* name)
+{
+	for (const MemAccounting::TagStats& s: MemAccounting::GetStats()) {
+		if (std::strcmp(s.name, name) == 0)
+			return s;
+	}
+
+	return {};
+}
+
+TEMPLATE_TEST_CASE_METHOD(AllocFixture, "test allocator's memory accounting", "[class][template]",
+		(StaticMemPoolT<TEST_ALLOCATOR_SIZE, TestData>),
+		(FixedDynMemPoolT<1, TEST_ALLOCATOR_SIZE, TestData>),
+		(DynMemPoolT<TestData>))
+{
+	AllocFixture<TestType> inst;
+	auto& mempool = *inst.mempool;
+
+	const MemAccounting::TagStats s0 = GetTagStats("TestPool");
+
+	// untagged pools report nothing
+	inst.alloc();
+	REQUIRE(GetTagStats("TestPool").numAllocs == s0.numAllocs);
+	mempool.clear();
+
+	mempool.set_mem_tag("TestPool");
+
+	std::vector<TestData*> allocated;
+	for (size_t i = 0; i < 16; ++i) {
+		allocated.push_back(inst.alloc());
+	}
+
+	const MemAccounting::TagStats s1 = GetTagStats("TestPool");
+
+	REQUIRE(s1.numAllocs - s0.numAllocs == 16);
+	REQUIRE(s1.liveBytes - s0.liveBytes == int64_t(16 * mempool.PAGE_SIZE()));
+
+	mempool.free(allocated[0]);
+	REQUIRE(GetTagStats("TestPool").liveBytes - s0.liveBytes == int64_t(15 * mempool.PAGE_SIZE()));
+
+	// clearing releases whatever is still live
+	mempool.clear();
+	REQUIRE(GetTagStats("TestPool").liveBytes == s0.liveBytes);
+}
+
 } // unnamed namespace
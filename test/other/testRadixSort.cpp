@@ -0,0 +1,122 @@
+#include "System/RadixSort.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+namespace {
+	struct Item {
+		uint64_t key;
+		uint32_t index;
+
+		bool operator == (const Item& i) const { return (key == i.key && index == i.index); }
+	};
+
+	// runs every chunk on its own thread, to catch chunks stepping on each other
+	struct ThreadedFor {
+		template<typename F> void operator () (int n, F&& f) const {
+			std::vector<std::thread> threads;
+
+			for (int i = 0; i < n; i++) {
+				threads.emplace_back([&f, i]() { f(i); });
+			}
+			for (auto& t: threads) {
+				t.join();
+			}
+		}
+	};
+
+	std::vector<Item> MakeItems(size_t n, uint64_t keyMask, uint32_t seed) {
+		std::vector<Item> items(n);
+		std::mt19937_64 rng(seed);
+
+		for (size_t i = 0; i < n; i++) {
+			items[i] = {rng() & keyMask, uint32_t(i)};
+		}
+
+		return items;
+	}
+
+	std::vector<Item> StableSorted(std::vector<Item> items) {
+		std::stable_sort(items.begin(), items.end(), [](const Item& a, const Item& b) { return (a.key < b.key); });
+		return items;
+	}
+
+	const auto ItemKey = [](const Item& i) { return i.key; };
+}
+
+
+TEST_CASE("RadixSort matches std::stable_sort")
+{
+	std::vector<Item> scratch;
+
+	// full keys, keys with few distinct values (stability), keys differing in a single byte
+	for (const uint64_t keyMask: {~uint64_t(0), uint64_t(0xF000000000000F00), uint64_t(0xFF0000)}) {
+		for (const size_t n: {0, 1, 2, 17, 1000, 50000}) {
+			const std::vector<Item> input = MakeItems(n, keyMask, n + 1);
+			const std::vector<Item> expected = StableSorted(input);
+
+			for (const int numChunks: {1, 3, 16}) {
+				std::vector<Item> items = input;
+
+				spring::RadixSort(items, scratch, ItemKey, numChunks);
+				REQUIRE(items == expected);
+			}
+
+			std::vector<Item> items = input;
+
+			spring::RadixSort(items, scratch, ItemKey, 8, ThreadedFor{});
+			REQUIRE(items == expected);
+		}
+	}
+}
+
+TEST_CASE("Ordered keys preserve ordering")
+{
+	const std::vector<float> floats = {
+		-std::numeric_limits<float>::infinity(), -1e30f, -2.5f, -1.0f, -1e-30f, -0.0f, 0.0f,
+		1e-30f, 1.0f, 2.5f, 1e30f, std::numeric_limits<float>::infinity()
+	};
+	const std::vector<int32_t> ints = {
+		std::numeric_limits<int32_t>::min(), -1000, -1, 0, 1, 1000, std::numeric_limits<int32_t>::max()
+	};
+
+	for (size_t i = 1; i < floats.size(); i++) {
+		REQUIRE(spring::FloatToOrderedKey(floats[i - 1]) < spring::FloatToOrderedKey(floats[i]));
+	}
+	for (size_t i = 1; i < ints.size(); i++) {
+		REQUIRE(spring::IntToOrderedKey(ints[i - 1]) < spring::IntToOrderedKey(ints[i]));
+	}
+}
+
+TEST_CASE("InsertionSortBounded")
+{
+	std::vector<Item> items = StableSorted(MakeItems(10000, 0xFFFFFFFF, 7));
+	std::mt19937 rng(13);
+
+	// a few local swaps, as after a small camera move
+	for (int i = 0; i < 100; i++) {
+		const size_t j = rng() % (items.size() - 4);
+		std::swap(items[j].key, items[j + 1 + rng() % 3].key);
+	}
+
+	const std::vector<Item> expected = StableSorted(items);
+
+	REQUIRE(spring::InsertionSortBounded(items.data(), items.size(), items.size(), ItemKey));
+	REQUIRE(items == expected);
+
+	// reversed input exceeds any small budget, but stays a permutation
+	std::reverse(items.begin(), items.end());
+	REQUIRE(!spring::InsertionSortBounded(items.data(), items.size(), items.size(), ItemKey));
+
+	std::vector<Item> scratch;
+	spring::RadixSort(items, scratch, ItemKey);
+
+	REQUIRE(items == expected);
+}
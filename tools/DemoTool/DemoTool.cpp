@@ -266,6 +266,17 @@ void TrafficDump(CDemoReader& reader, bool trafficStats)
 				std::cout << std::endl;
 				break;
 			}
+			case NETMSG_UNITCOMMANDS: {
+				std::cout << "UNITCOMMANDS: Playernum: " << (unsigned)buffer[3];
+				std::cout << " Length: " << (unsigned)packet->length;
+				cmdId = *((int*)(buffer + 4));
+				std::cout << " CommandId: " << GetCommandName(cmdId) << "(" << cmdId << ")";
+				std::cout << " Options: " << (unsigned)buffer[8];
+				std::cout << " NumParams: " << (unsigned)buffer[9];
+				std::cout << " UnitIDCount: " << *((unsigned short*)(buffer + 10));
+				std::cout << std::endl;
+				break;
+			}
 			case NETMSG_PLAYERNAME:
 				std::cout << "PLAYERNAME: Playernum: " << (unsigned)buffer[2] << " Name: " << buffer+3 << std::endl;
 				break;